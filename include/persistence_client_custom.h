@@ -47,7 +47,7 @@
 /** Module version
 The lower significant byte is equal 0 for released version only
 */
-#define     PERSIST_CUSTOMER_INTERFACE_VERSION            (0x01060000U)
+#define     PERSIST_CUSTOMER_INTERFACE_VERSION            (0x01070000U)
 
 /** \} */ /* End of Errors */
 
@@ -336,6 +336,46 @@ typedef struct _plugin_info_s
  */
 int plugin_get_info(plugin_info_s* pInfo_out);
 
+/**
+ * @brief item of a batch access, see ::plugin_get_data_batch and ::plugin_set_data_batch
+ */
+typedef struct _plugin_batch_item_s
+{
+    const char* path;   /*!< the path to the resource */
+    char*       buffer; /*!< the buffer to store the data to get or the data to set */
+    int         size;   /*!< the size of the buffer or the number of bytes to set */
+    int         result; /*!< set by the plugin: positive value: size of data get or set in bytes; negative value: error code (\ref PCCL_RETURNS) */
+}plugin_batch_item_s ;
+
+/**
+ * @brief get the data of several resources with one call
+ *
+ * @param items the resources to get, the result of each resource is returned in the item
+ * @param numItems the number of items
+ *
+ * @return positive value (0 or greater): the items have been processed; negative value: error code (\ref PCCL_RETURNS),
+ *         the results of the items are not valid
+ *
+ * @note
+ *       - Optional: if not provided by the plugin the persistence client library calls ::plugin_get_data for each resource.
+ *         Plugins with a high cost per call (e.g. IPC or secure hardware) should provide it.
+ */
+int plugin_get_data_batch(plugin_batch_item_s* items, int numItems);
+
+/**
+ * @brief set the data of several resources with one call
+ *
+ * @param items the resources to set, the result of each resource is returned in the item
+ * @param numItems the number of items
+ *
+ * @return positive value (0 or greater): the items have been processed; negative value: error code (\ref PCCL_RETURNS),
+ *         the results of the items are not valid
+ *
+ * @note
+ *       - Optional: if not provided by the plugin the persistence client library calls ::plugin_set_data for each resource.
+ */
+int plugin_set_data_batch(plugin_batch_item_s* items, int numItems);
+
 /** \} */
 /** \} */
 
@@ -182,6 +182,15 @@ extern "C" {
 
 /** \} */
 
+/** \defgroup PCL_DB_BACKEND database backend definitions
+ * \{
+ */
+
+#define PCL_DB_BACKEND_DEFAULT   0     /*!< databases are managed by the persistence common database plugin */
+#define PCL_DB_BACKEND_LOG       1     /*!< databases are managed by the built-in log-structured key/value database */
+
+/** \} */
+
 /** \defgroup SHUTDOWN_EVENTS shutdown events definitions
  * \{
  */
@@ -203,6 +212,128 @@ extern "C" {
 
 /** \} */
 
+/** \defgroup PCL_INIT_STATE initialization state definitions
+ * \{
+ */
+
+#define PCL_INIT_STATE_PENDING   0     /*!< local data can be accessed, IPC registrations and plugin loading in progress */
+#define PCL_INIT_STATE_READY     1     /*!< the library is completely initialized */
+
+/**
+ * @brief definition of the callback called when the library is completely initialized
+ *
+ * @param state ::PCL_INIT_STATE_READY or a negative error code if the initialization failed,
+ *        see ::pclInitLibrary for the error codes
+ */
+typedef void (*pclInitReadyCallback_t)(int state);
+
+/** \} */
+
+/** \defgroup PCL_SHUTDOWN_TIMING shutdown timing definitions
+ * \{
+ */
+
+#define PCL_SHUTDOWN_TIMING_PATH_LEN   256    /*!< max length of the resource path in ::pclShutdownTiming_s */
+#define PCL_SHUTDOWN_TIMING_SLOWEST    4      /*!< number of slowest files and databases in ::pclShutdownTiming_s */
+
+/**
+ * @brief a resource that took long to flush or close on the last shutdown
+ */
+typedef struct _pclShutdownSlowest_s
+{
+   unsigned int duration;                       /*!< duration in microseconds, 0 if the entry is not used */
+   char path[PCL_SHUTDOWN_TIMING_PATH_LEN];     /*!< path of the resource */
+} pclShutdownSlowest_s;
+
+/**
+ * @brief duration of the phases of the last shutdown in microseconds,
+ *        see ::pclGetShutdownTiming
+ */
+typedef struct _pclShutdownTiming_s
+{
+   unsigned int total;           /*!< duration of the complete shutdown */
+   unsigned int fileFlush;       /*!< flush (partial shutdown) or close (full shutdown) the open files */
+   unsigned int rctClose;        /*!< close the resource configuration tables */
+   unsigned int dbClose;         /*!< close the databases */
+   unsigned int pluginDeinit;    /*!< deinitialize the custom plugins (full shutdown only) */
+   unsigned int syncfs;          /*!< commit the buffer cache to the memory device */
+
+   unsigned int numFiles;        /*!< number of files flushed or closed */
+   unsigned int numDatabases;    /*!< number of databases closed */
+
+   pclShutdownSlowest_s slowestFiles[PCL_SHUTDOWN_TIMING_SLOWEST];      /*!< slowest files, the slowest first */
+   pclShutdownSlowest_s slowestDatabases[PCL_SHUTDOWN_TIMING_SLOWEST];  /*!< slowest databases, the slowest first */
+} pclShutdownTiming_s;
+
+/** \} */
+
+/** \defgroup PCL_TRACE trace mode definitions
+ * \{
+ */
+
+#define PCL_TRACE_OFF          0x00    /*!< API calls are not traced */
+#define PCL_TRACE_DLT          0x01    /*!< API calls are logged to DLT with log level info (default) */
+#define PCL_TRACE_RING         0x02    /*!< API calls are recorded in a ring buffer per thread, see ::pclTraceDump */
+#define PCL_TRACE_DUMP_ERROR   0x04    /*!< the ring buffer of a thread is dumped to DLT when an API call of the thread fails */
+
+/** \} */
+
+/** \defgroup PCL_STATISTICS statistics definitions
+ * \{
+ */
+
+#define PCL_STAT_OFF               0x00          /*!< API calls are not counted */
+#define PCL_STAT_COUNTERS          0x01          /*!< API calls are counted per logical database with atomic adds, no lock is taken (default) */
+#define PCL_STAT_RESOURCES         0x02          /*!< accesses are also counted per resource, a mutex is taken per API call */
+
+#define PCL_STAT_LDBID_ALL         0xFFFFFFFF    /*!< get the statistics summed up over all logical databases */
+#define PCL_STAT_LATENCY_BUCKETS   10            /*!< number of buckets of the latency histograms */
+#define PCL_STAT_TOP_RESOURCES     8             /*!< max number of most accessed resources reported */
+#define PCL_STAT_RESOURCE_LEN      64            /*!< max length of the resource id in ::pclResourceStatistics_s */
+
+/**
+ * @brief access count of a resource, see ::pclStatistics_s
+ */
+typedef struct _pclResourceStatistics_s
+{
+   unsigned int ldbid;                          /*!< logical database id of the resource */
+   unsigned long long accesses;                 /*!< number of key API calls, file opens and removals for the resource */
+   char resource_id[PCL_STAT_RESOURCE_LEN];     /*!< the resource id */
+} pclResourceStatistics_s;
+
+/**
+ * @brief access statistics since the library has been loaded or since ::pclResetStatistics.
+ *        The latency histograms count the API calls by duration, bucket 0 counts calls
+ *        taking less than 1 microsecond, bucket i counts calls taking less than 4^i
+ *        microseconds and the last bucket all calls taking longer.
+ */
+typedef struct _pclStatistics_s
+{
+   unsigned long long keyReads;           /*!< number of key reads */
+   unsigned long long keyWrites;          /*!< number of key writes */
+   unsigned long long keyDeletes;         /*!< number of key deletions */
+   unsigned long long keySizes;           /*!< number of key size requests */
+   unsigned long long keyBytesRead;       /*!< number of bytes read from keys */
+   unsigned long long keyBytesWritten;    /*!< number of bytes written to keys */
+   unsigned long long fileOpens;          /*!< number of files opened */
+   unsigned long long fileReads;          /*!< number of file reads */
+   unsigned long long fileWrites;         /*!< number of file writes */
+   unsigned long long fileRemoves;        /*!< number of files removed */
+   unsigned long long fileBytesRead;      /*!< number of bytes read from files */
+   unsigned long long fileBytesWritten;   /*!< number of bytes written to files */
+   unsigned long long errors;             /*!< number of key and file API calls which failed */
+   unsigned long long dbCacheHits;        /*!< number of key accesses to a database which was already open */
+   unsigned long long dbCacheMisses;      /*!< number of key accesses which opened a database */
+   unsigned long long defaultFallbacks;   /*!< number of key accesses answered with default data */
+   unsigned long long notifications;      /*!< number of change notifications sent */
+   unsigned long long keyLatency[PCL_STAT_LATENCY_BUCKETS];    /*!< histogram of the duration of key API calls */
+   unsigned long long fileLatency[PCL_STAT_LATENCY_BUCKETS];   /*!< histogram of the duration of file API calls */
+   unsigned int numTopResources;                                         /*!< number of valid entries in topResources */
+   pclResourceStatistics_s topResources[PCL_STAT_TOP_RESOURCES];         /*!< most accessed resources, most accessed first */
+} pclStatistics_s;
+
+/** \} */
+
 /** \defgroup PCL_OVERALL functions for Library initialization
  * The following functions have to be called for library initialization.
  * \{
@@ -226,6 +357,41 @@ extern "C" {
 int pclInitLibrary(const char* appname, int shutdownMode);
 
 
+
+/**
+ * @brief initialize client library, doing the IPC registrations in the background.
+ *        Like ::pclInitLibrary, but the function returns as soon as local key and file data
+ *        can be accessed. The registration to the persistence administration service
+ *        and the lifecycle and the loading of the custom plugins, except the default plugin,
+ *        will be done in the background.
+ *        Data of custom plugins loaded in the background can't be accessed before the library is ready,
+ *        the access functions return ::EPERS_NOT_READY.
+ *        If the background initialization fails, the library is deinitialized again,
+ *        like after a failed ::pclInitLibrary, and the callback is called with the error code.
+ *
+ * @param appname application name, the name must be a unique name in the system
+ * @param shutdownMode shutdown mode ::PCL_SHUTDOWN_TYPE_FAST or ::PCL_SHUTDOWN_TYPE_NORMAL ::PCL_SHUTDOWN_TYPE_NONE
+ * @param callback the callback to be called when the library is completely initialized, can be NULL.
+ *        If the library is already initialized, the callback will be called immediately.
+ *
+ * @return positive value: success;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_DBUS_MAINLOOP, ::EPERS_COMMON
+ */
+int pclInitLibraryAsync(const char* appname, int shutdownMode, pclInitReadyCallback_t callback);
+
+
+/**
+ * @brief get the initialization state of the client library
+ *
+ * @return ::PCL_INIT_STATE_PENDING if the background initialization is in progress,
+ *         ::PCL_INIT_STATE_READY if the library is completely initialized;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_NOT_INITIALIZED, or the error code of the failed background initialization
+ */
+int pclGetInitState(void);
+
+
 /**
  * @brief deinitialize client library
  *        This function will be called during the shutdown phase of the process which uses the PCL.
@@ -271,6 +437,170 @@ int pclDeinitLibrary(void);
 int pclLifecycleSet(int shutdown);
 
 
+
+/**
+ * @brief set the max time to flush open files on shutdown.
+ *        On shutdown the open files will be flushed in parallel, on a partial shutdown
+ *        only files written since the last sync will be flushed.
+ *        Files which could not be flushed within this time will be skipped,
+ *        the data of these files will be recovered from the backup on next open.
+ *
+ * @param deadline_ms the max time in milliseconds, 0 if the time is not limited (default)
+ *
+ * @return positive value: success;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_NOT_INITIALIZED
+ */
+int pclSetShutdownFlushDeadline(unsigned int deadline_ms);
+
+
+
+/**
+ * @brief get the duration of each phase of the last shutdown.
+ *        The timing of a shutdown triggered by the lifecycle, by ::pclLifecycleSet
+ *        or by ::pclDeinitLibrary will be available until the next shutdown,
+ *        so this function can also be called after ::pclDeinitLibrary.
+ *        The timing is also written to the log when the shutdown has been completed.
+ *
+ * @param timing the structure to store the timing, all durations are in microseconds
+ *
+ * @return positive value: success;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_COMMON
+ */
+int pclGetShutdownTiming(pclShutdownTiming_s* timing);
+
+
+
+/**
+ * @brief load the resource configuration tables in full into an in-memory index.
+ *        When enabled, each resource configuration table will be read once
+ *        when it is accessed the first time, all following resource lookups
+ *        are done in memory without accessing the table.
+ *        Use this for applications with large resource configuration tables
+ *        and many different resources.
+ *
+ * @param enable 1 to load the tables into an index, 0 to read the tables for each lookup (default)
+ *
+ * @return positive value: success;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_NOT_INITIALIZED
+ */
+int pclSetRctPreload(int enable);
+
+
+
+/**
+ * @brief set the limits of the open databases.
+ *        Databases are kept open after they have been accessed, databases not used for
+ *        longer than the idle time and the least recently used databases above the
+ *        max number of open databases will be closed. A closed database will be
+ *        opened again on the next access. Closing a cached database writes its data back.
+ *
+ * @param idle_ms the time in milliseconds after which an unused database will be closed,
+ *        0 if databases are kept open until shutdown (default)
+ * @param max_open the max number of open databases, 0 if not limited (default)
+ *
+ * @return positive value: success;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_NOT_INITIALIZED
+ */
+int pclSetDatabaseLimits(unsigned int idle_ms, unsigned int max_open);
+
+
+
+/**
+ * @brief select the backend of the cached and write through databases of a logical database.
+ *        The log backend appends each write to a log with a checksum per record
+ *        and keeps a hash index of the keys next to the log, so small values are
+ *        written and read with a single file access. If the application has not been
+ *        shut down cleanly the index is rebuilt from the log on the next access.
+ *        The selection applies to databases opened afterwards, the keys of an existing
+ *        database will be imported when the log database is created.
+ *        The default databases are always managed by the default backend.
+ *
+ * @param ldbid logical database ID, see ::PCL_LDBID_LOCAL and ::PCL_LDBID_PUBLIC
+ * @param backend ::PCL_DB_BACKEND_DEFAULT or ::PCL_DB_BACKEND_LOG
+ *
+ * @return positive value: success;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_NOT_INITIALIZED, ::EPERS_COMMON
+ */
+int pclSetDatabaseBackend(unsigned int ldbid, int backend);
+
+
+
+/**
+ * @brief get the access statistics of a logical database.
+ *        The key and file API calls are counted per logical database, so applications
+ *        and resources causing the storage load and latency can be identified.
+ *        The most accessed resources are tracked approximately, the counts of resources
+ *        which are accessed rarely may be too high. Resources are only tracked
+ *        with ::PCL_STAT_RESOURCES, see ::pclSetStatisticsMode.
+ *        This function can also be called before ::pclInitLibrary and after ::pclDeinitLibrary.
+ *
+ * @param ldbid logical database ID or ::PCL_STAT_LDBID_ALL for the statistics of all logical databases
+ * @param statistics the structure to store the statistics
+ *
+ * @return positive value: success;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_COMMON
+ */
+int pclGetStatistics(unsigned int ldbid, pclStatistics_s* statistics);
+
+
+
+/**
+ * @brief reset the access statistics of all logical databases
+ *
+ * @return positive value: success
+ */
+int pclResetStatistics(void);
+
+
+
+/**
+ * @brief set the statistics mode of the key and file API calls.
+ *        With ::PCL_STAT_OFF the API calls don't read the clock for the statistics,
+ *        the clock is still read if the calls are recorded with ::PCL_TRACE_RING.
+ *        This function can also be called before ::pclInitLibrary.
+ *
+ * @param mode ::PCL_STAT_OFF or a combination of ::PCL_STAT_COUNTERS and ::PCL_STAT_RESOURCES
+ *
+ * @return positive value: success;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_COMMON if the mode is invalid
+ */
+int pclSetStatisticsMode(int mode);
+
+
+
+/**
+ * @brief set the trace mode of the key and file API calls.
+ *        With ::PCL_TRACE_RING each call is recorded as a binary event with the API call,
+ *        handle, logical database, duration and result in a ring buffer of the calling thread.
+ *        Recording an event takes no lock and does not format a message, the events are
+ *        converted to DLT messages only if the ring buffers are dumped.
+ *        This function can also be called before ::pclInitLibrary.
+ *
+ * @param mode ::PCL_TRACE_OFF or a combination of ::PCL_TRACE_DLT, ::PCL_TRACE_RING and ::PCL_TRACE_DUMP_ERROR
+ *
+ * @return positive value: success;
+ *   On error a negative value will be returned with the following error codes:
+ *   ::EPERS_COMMON if the mode is invalid or the ring buffers are not supported by the library build
+ */
+int pclSetTraceMode(int mode);
+
+
+
+/**
+ * @brief dump the ring buffers of all threads to DLT, see ::PCL_TRACE_RING
+ *
+ * @return the number of events dumped
+ */
+int pclTraceDump(void);
+
+
 /** \} */
 
 #ifdef __cplusplus
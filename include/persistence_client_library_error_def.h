@@ -127,6 +127,8 @@ extern "C" {
 #define EPERS_NO_PLUGIN_VAR       (-46)
 /// requested handle is not valid. \since PCL v7.0.3
 #define EPERS_NO_REG_TO_PAS       (-47)
+/// the library initialization is still in progress, the resource can not be accessed yet
+#define EPERS_NOT_READY           (-48)
 /// requested handle is not valid. \since PCL v7.0.3
 #define EPERS_INVALID_HANDLE     (-1000)
 
@@ -31,10 +31,63 @@ extern "C" {
 #endif
 
 
-#define  PERSIST_FILEAPI_INTERFACE_VERSION   (0x03010000U)
+#define  PERSIST_FILEAPI_INTERFACE_VERSION   (0x03020000U)
 
 #include "persistence_client_library.h"
 
+#include <sys/uio.h>
+
+
+/** \defgroup PCL_FILE_SYNC file sync policies
+ * Used with ::pclFileSetSyncPolicy to define when written data of a
+ * cached file will be committed to the memory device.
+ * Independent of the policy, data will be committed on ::pclFileClose,
+ * ::pclFileSync, on shutdown and on a write back request of the
+ * persistence administration service.
+ * The default policy of a file resource can be configured in the resource
+ * configuration table, the custom id of a resource not on custom storage
+ * may be set to ::PCL_FILE_SYNC_RCT_ON_CLOSE or to ::PCL_FILE_SYNC_RCT_INTERVAL
+ * followed by the interval in ms, e.g. "PCL_FILE_SYNC_INTERVAL:500".
+ * \{
+ */
+
+#define PCL_FILE_SYNC_PER_WRITE  0    /*!< commit data after each write (default) */
+#define PCL_FILE_SYNC_ON_CLOSE   1    /*!< commit data when the file will be closed */
+#define PCL_FILE_SYNC_INTERVAL   2    /*!< commit data by a timer when the sync interval since the last sync has elapsed */
+
+#define PCL_FILE_SYNC_RCT_ON_CLOSE  "PCL_FILE_SYNC_ON_CLOSE"     /*!< custom id selecting ::PCL_FILE_SYNC_ON_CLOSE */
+#define PCL_FILE_SYNC_RCT_INTERVAL  "PCL_FILE_SYNC_INTERVAL:"    /*!< custom id prefix selecting ::PCL_FILE_SYNC_INTERVAL */
+
+/** \} */
+
+
+/** \defgroup PCL_FILE_MAP file mapping flags
+ * Used with ::pclFileMapDataHinted to describe the expected access pattern
+ * of a mapping. The flags can be combined, ::PCL_FILE_MAP_HINT_SEQUENTIAL and
+ * ::PCL_FILE_MAP_HINT_RANDOM are mutually exclusive.
+ * \{
+ */
+
+#define PCL_FILE_MAP_HINT_NORMAL      0x00    /*!< no access pattern hint */
+#define PCL_FILE_MAP_HINT_SEQUENTIAL  0x01    /*!< mapping will be accessed sequentially, aggressive read ahead */
+#define PCL_FILE_MAP_HINT_RANDOM      0x02    /*!< mapping will be accessed in random order, no read ahead */
+#define PCL_FILE_MAP_HINT_WILLNEED    0x04    /*!< mapping will be accessed soon, start reading ahead */
+#define PCL_FILE_MAP_POPULATE         0x08    /*!< populate the page tables of the mapping up front */
+
+/** \} */
+
+
+/**
+ * @brief definition of the completion callback of an asynchronous file request.
+ *        The callback will be called from a worker thread of the library.
+ *
+ * @param requestId the id of the completed request
+ * @param result the result of the request, same as the corresponding synchronous function returns
+ * @param userData the user data given when the request has been submitted
+ */
+typedef void (* pclFileAsyncCallback_t)(int requestId, int result, void* userData);
+
+
 /** \defgroup PCL_FILE functions file access
  * \{
  */
@@ -80,6 +133,28 @@ void* pclFileMapData(void* addr, long size, long offset, int fd);
 
 
 
+/**
+ * @brief map a file into the memory using access pattern hints
+ *
+ * The mapping protection will be derived from the permission of the file,
+ * files opened read only will be mapped read only.
+ *
+ * @attention The mapping is tracked by the library, modified pages will be committed
+ *            with ::pclFileSync and the mapping will be unmapped with ::pclFileClose.
+ *            The pointer must not be used after the file has been closed.
+ *
+ * @param size the size in bytes to map into the memory
+ * @param offset in the file to map, must be a multiple of the page size
+ * @param fd the POSIX file descriptor of the file to map
+ * @param flags a combination of the \ref PCL_FILE_MAP flags
+ *
+ * @return a pointer to the mapped area, or on error the value MAP_FAILED or
+ *  EPERS_MAP_FAILEDLOCK if filesystem is currrently locked
+ */
+void* pclFileMapDataHinted(long size, long offset, int fd, int flags);
+
+
+
 /**
  * @brief open a file
  *
@@ -114,6 +189,41 @@ int pclFileReadData(int fd, void * buffer, int buffer_size);
 
 
 
+/**
+ * @brief read persistent data from a file at the given offset.
+ *        The file offset will not be changed.
+ *
+ * @param fd POSIX file descriptor
+ * @param buffer buffer to read the data
+ * @param buffer_size the size buffer for reading
+ * @param offset the offset in the file to read from
+ *
+ * @return positive value (0 or greater): the size read;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_NOT_INITIALIZED, ::EPERS_COMMON.
+ * If ::EPERS_COMMON will be returned errno will be set
+ */
+int pclFileReadAt(int fd, void * buffer, int buffer_size, long offset);
+
+
+
+/**
+ * @brief read persistent data from a file into multiple buffers (scatter read)
+ *        starting at the current file offset
+ *
+ * @param fd POSIX file descriptor
+ * @param iov array of buffers to read the data
+ * @param iovcnt number of buffers in the array
+ *
+ * @return positive value (0 or greater): the size read;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_NOT_INITIALIZED, ::EPERS_COMMON.
+ * If ::EPERS_COMMON will be returned errno will be set
+ */
+int pclFileReadV(int fd, const struct iovec* iov, int iovcnt);
+
+
+
 /**
  * @brief remove the file
  *
@@ -153,6 +263,116 @@ int pclFileSeek(int fd, long int offset, int whence);
 
 
 
+/**
+ * @brief set the sync policy of an open file
+ *
+ * @param fd the POSIX file descriptor
+ * @param policy the sync policy ::PCL_FILE_SYNC_PER_WRITE, ::PCL_FILE_SYNC_ON_CLOSE or ::PCL_FILE_SYNC_INTERVAL
+ * @param interval_ms the sync interval in milliseconds, only used with ::PCL_FILE_SYNC_INTERVAL
+ *
+ * @return zero on success.
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_NOT_INITIALIZED, ::EPERS_MAXHANDLE, ::EPERS_BADPOL
+ */
+int pclFileSetSyncPolicy(int fd, int policy, unsigned int interval_ms);
+
+
+
+/**
+ * @brief commit written data of the file to the memory device
+ *
+ * @param fd the POSIX file descriptor
+ *
+ * @return zero on success.
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_NOT_INITIALIZED, ::EPERS_MAXHANDLE, ::EPERS_COMMON
+ * If ::EPERS_COMMON will be returned errno will be set.
+ */
+int pclFileSync(int fd);
+
+
+
+/**
+ * @brief submit an asynchronous read from a file at the given offset (see ::pclFileReadAt)
+ *
+ * @param fd POSIX file descriptor
+ * @param buffer buffer to read the data, must be valid until the request has completed
+ * @param buffer_size the size buffer for reading
+ * @param offset the offset in the file to read from
+ * @param callback the completion callback; if NULL the result must be retrieved
+ *                 with ::pclFileAsyncPoll or ::pclFileAsyncWait
+ * @param userData user data passed to the callback
+ *
+ * @return positive value (1 or greater): the request id;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_NOT_INITIALIZED, ::EPERS_MAXHANDLE if too many requests are outstanding, ::EPERS_COMMON
+ */
+int pclFileReadAsync(int fd, void * buffer, int buffer_size, long offset, pclFileAsyncCallback_t callback, void* userData);
+
+
+
+/**
+ * @brief submit an asynchronous write to a file at the given offset (see ::pclFileWriteAt)
+ *
+ * @param fd the POSIX file descriptor
+ * @param buffer the buffer to write, must be valid until the request has completed
+ * @param buffer_size the size of the buffer to write in bytes
+ * @param offset the offset in the file to write to
+ * @param callback the completion callback; if NULL the result must be retrieved
+ *                 with ::pclFileAsyncPoll or ::pclFileAsyncWait
+ * @param userData user data passed to the callback
+ *
+ * @return positive value (1 or greater): the request id;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_NOT_INITIALIZED, ::EPERS_LOCKFS, ::EPERS_MAXHANDLE if too many requests are outstanding, ::EPERS_COMMON
+ */
+int pclFileWriteAsync(int fd, const void * buffer, int buffer_size, long offset, pclFileAsyncCallback_t callback, void* userData);
+
+
+
+/**
+ * @brief submit an asynchronous commit of the written data to the memory device (see ::pclFileSync)
+ *
+ * @param fd the POSIX file descriptor
+ * @param callback the completion callback; if NULL the result must be retrieved
+ *                 with ::pclFileAsyncPoll or ::pclFileAsyncWait
+ * @param userData user data passed to the callback
+ *
+ * @return positive value (1 or greater): the request id;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_NOT_INITIALIZED, ::EPERS_MAXHANDLE if too many requests are outstanding, ::EPERS_COMMON
+ */
+int pclFileSyncAsync(int fd, pclFileAsyncCallback_t callback, void* userData);
+
+
+
+/**
+ * @brief check if an asynchronous request without callback has completed
+ *
+ * @param requestId the request id
+ * @param result returns the result of the request if completed
+ *
+ * @return 1 if the request has completed, the request id is released;
+ *         0 if the request is still pending;
+ *         ::EPERS_COMMON if the request id is not valid
+ */
+int pclFileAsyncPoll(int requestId, int* result);
+
+
+
+/**
+ * @brief wait until an asynchronous request without callback has completed
+ *
+ * @param requestId the request id
+ * @param result returns the result of the request
+ *
+ * @return 1 if the request has completed, the request id is released;
+ *         ::EPERS_COMMON if the request id is not valid
+ */
+int pclFileAsyncWait(int requestId, int* result);
+
+
+
 /**
  * @brief unmap the file from the memory
  *
@@ -184,6 +404,134 @@ int pclFileWriteData(int fd, const void * buffer, int buffer_size);
 
 
 
+/**
+ * @brief write persistent data to file at the given offset.
+ *        The file offset will not be changed.
+ *
+ * @param fd the POSIX file descriptor
+ * @param buffer the buffer to write
+ * @param buffer_size the size of the buffer to write in bytes
+ * @param offset the offset in the file to write to
+ *
+ * @return positive value (0 or greater): bytes written;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_LOCKFS, ::EPERS_NOT_INITIALIZED or ::EPERS_COMMON ::EPERS_RESOURCE_READ_ONLY
+ * If ::EPERS_COMMON will be returned errno will be set.
+ */
+int pclFileWriteAt(int fd, const void * buffer, int buffer_size, long offset);
+
+
+
+/**
+ * @brief write persistent data from multiple buffers to file (gather write)
+ *        starting at the current file offset
+ *
+ * @param fd the POSIX file descriptor
+ * @param iov array of buffers to write
+ * @param iovcnt number of buffers in the array
+ *
+ * @return positive value (0 or greater): bytes written;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_LOCKFS, ::EPERS_NOT_INITIALIZED or ::EPERS_COMMON ::EPERS_RESOURCE_READ_ONLY
+ * If ::EPERS_COMMON will be returned errno will be set.
+ */
+int pclFileWriteV(int fd, const struct iovec* iov, int iovcnt);
+
+
+
+/**
+ * @brief replace the whole content of a file atomically.
+ *        The data will be written to a temporary file in the same folder,
+ *        committed to the memory device and renamed over the file.
+ *        After a reset either the previous or the new content is available,
+ *        no backup and checksum file will be created.
+ *
+ * @attention The file must not be opened with ::pclFileOpen while it will be replaced,
+ *            an open file descriptor still refers to the previous content.
+ *
+ * @param ldbid logical database ID
+ * @param resource_id the resource ID
+ * @param user_no  the user ID; user_no=0 can not be used as user-ID beacause ‘0’ is defined as System/node
+ * @param seat_no  the seat number
+ * @param buffer the buffer with the new file content
+ * @param buffer_size the size of the buffer in bytes
+ *
+ * @return positive value (0 or greater): bytes written;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_LOCKFS, ::EPERS_NOT_INITIALIZED, ::EPERS_RESOURCE_NO_FILE, ::EPERS_RESOURCE_READ_ONLY,
+ * ::EPERS_MAXHANDLE or ::EPERS_COMMON
+ * If ::EPERS_COMMON will be returned errno will be set.
+ */
+int pclFileWriteAtomic(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
+                       const void* buffer, int buffer_size);
+
+
+
+/**
+ * @brief begin an atomic replace of the whole content of a file.
+ *        The new content will be written with ::pclFileAtomicAppend and
+ *        becomes visible with ::pclFileAtomicCommit, see ::pclFileWriteAtomic.
+ *
+ * @param ldbid logical database ID
+ * @param resource_id the resource ID
+ * @param user_no  the user ID; user_no=0 can not be used as user-ID beacause ‘0’ is defined as System/node
+ * @param seat_no  the seat number
+ *
+ * @return positive value (0 or greater): the handle of the atomic replace;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_LOCKFS, ::EPERS_NOT_INITIALIZED, ::EPERS_RESOURCE_NO_FILE, ::EPERS_RESOURCE_READ_ONLY,
+ * ::EPERS_MAXHANDLE or ::EPERS_COMMON
+ * If ::EPERS_COMMON will be returned errno will be set.
+ */
+int pclFileAtomicBegin(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no);
+
+
+
+/**
+ * @brief append data to the new content of an atomic replace
+ *
+ * @param handle the handle returned by ::pclFileAtomicBegin
+ * @param buffer the buffer to append
+ * @param buffer_size the size of the buffer in bytes
+ *
+ * @return positive value (0 or greater): bytes written;
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_LOCKFS, ::EPERS_NOT_INITIALIZED, ::EPERS_MAXHANDLE or ::EPERS_COMMON
+ * If ::EPERS_COMMON will be returned errno will be set.
+ */
+int pclFileAtomicAppend(int handle, const void* buffer, int buffer_size);
+
+
+
+/**
+ * @brief commit an atomic replace, the new content replaces the file content.
+ *        The handle is invalid afterwards, also if the commit failed.
+ *
+ * @param handle the handle returned by ::pclFileAtomicBegin
+ *
+ * @return zero on success.
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_LOCKFS, ::EPERS_NOT_INITIALIZED, ::EPERS_MAXHANDLE or ::EPERS_COMMON
+ * If ::EPERS_LOCKFS will be returned the handle is still valid.
+ * If ::EPERS_COMMON will be returned errno will be set.
+ */
+int pclFileAtomicCommit(int handle);
+
+
+
+/**
+ * @brief abort an atomic replace, the file content will not be changed
+ *
+ * @param handle the handle returned by ::pclFileAtomicBegin
+ *
+ * @return zero on success.
+ * On error a negative value will be returned with th following error codes:
+ * ::EPERS_NOT_INITIALIZED or ::EPERS_MAXHANDLE
+ */
+int pclFileAtomicAbort(int handle);
+
+
+
 /**
  * @brief create a path to a file
  *
@@ -23,6 +23,7 @@
  * 28/05/13 Ingo Huerner    5.0.0 - Add pclInitLibrary(), pcl DeInitLibrary() incl. shutdown notification
  * 05/06/13 Oliver Bach     6.0.0 - Rework of Init functions
  * 04/11/13 Ingo Huerner    6.1.0 - Added functions to unregister notifications
+ * 18/10/26 Ingo Huerner    6.2.0 - Added functions to read and write several keys with one call
  */
 /** \ingroup GEN_PERS */
 /** \defgroup PERS_KEYVALUE Client: Key-value access
@@ -40,7 +41,7 @@ extern "C" {
  * \{
  */
 
-#define  PERSIST_KEYVALUEAPI_INTERFACE_VERSION   (0x06010000U)
+#define  PERSIST_KEYVALUEAPI_INTERFACE_VERSION   (0x06020000U)
 
 #include "persistence_client_library.h"
 
@@ -72,6 +73,21 @@ typedef struct _pclNotification_s
 } pclNotification_s;
 
 
+/**
+* item of a batch access, see ::pclKeyReadDataBatch and ::pclKeyWriteDataBatch
+*/
+typedef struct _pclKeyBatchItem_s
+{
+   unsigned int ldbid;                       /// logical db id
+   const char * resource_id;                 /// resource id
+   unsigned int user_no;                     /// user id
+   unsigned int seat_no;                     /// seat id
+   unsigned char* buffer;                    /// buffer to read the data to or data to write
+   int buffer_size;                          /// size of the buffer or number of bytes to write
+   int result;                               /// set by the call: the bytes read or written or a negative error code
+} pclKeyBatchItem_s;
+
+
 
 /** \} */
 
@@ -248,6 +264,25 @@ int pclKeyReadData(unsigned int ldbid, const char* resource_id, unsigned int use
 
 
 
+/**
+ * @brief reads the persistent data of several keys with one call
+ *
+ * The keys of a custom storage plugin providing plugin_get_data_batch are read with one call of the plugin,
+ * which saves the fixed cost per call of plugins accessed via IPC or secure hardware.
+ * All other keys are read like with ::pclKeyReadData.
+ *
+ * @param items the keys to read, the result of each key is returned in the item
+ *        (the bytes read or the error codes of ::pclKeyReadData)
+ * @param numItems the number of items
+ *
+ * @return positive value (0 or greater): the number of keys read;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeyReadDataBatch(pclKeyBatchItem_s* items, int numItems);
+
+
+
 /**
  * @brief register for a change notification for persistent data
  *
@@ -306,6 +341,24 @@ int pclKeyUnRegisterNotifyOnChange( unsigned int  ldbid, const char *  resource_
 int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no, unsigned char* buffer, int buffer_size);
 
 
+
+/**
+ * @brief writes the persistent data of several keys with one call
+ *
+ * The keys of a custom storage plugin providing plugin_set_data_batch are written with one call of the plugin,
+ * all other keys are written like with ::pclKeyWriteData.
+ *
+ * @param items the keys to write, the result of each key is returned in the item
+ *        (the bytes written or the error codes of ::pclKeyWriteData)
+ * @param numItems the number of items
+ *
+ * @return positive value (0 or greater): the number of keys written;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeyWriteDataBatch(pclKeyBatchItem_s* items, int numItems);
+
+
 /** \} */
 
 #ifdef __cplusplus
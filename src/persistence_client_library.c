@@ -26,6 +26,9 @@
 #include "persistence_client_library_backup_filelist.h"
 #include "persistence_client_library_db_access.h"
 #include "persistence_client_library_dbus_cmd.h"
+#include "persistence_client_library_file_async.h"
+#include "persistence_client_library_statistics.h"
+#include "persistence_client_library_trace.h"
 
 #if USE_FILECACHE
    #include <persistence_file_cache.h>
@@ -52,8 +55,21 @@ static int gCancelCounter = 0;
 
 static pthread_mutex_t gInitMutex = PTHREAD_MUTEX_INITIALIZER;
 
+/// thread doing the background part of the initialization
+static pthread_t gInitThread;
+/// flag to indicate if the background initialization thread must be joined
+static int gInitThreadRunning = 0;
+/// signaled with gInitMutex when the background initialization has been finished
+static pthread_cond_t gInitCond = PTHREAD_COND_INITIALIZER;
+/// initialization state ::PCL_INIT_STATE_PENDING, ::PCL_INIT_STATE_READY or an error code
+static int gInitState = PCL_INIT_STATE_READY;
+/// callback to be called when the background initialization has been finished
+static pclInitReadyCallback_t gInitReadyCallback = NULL;
+
 /// name of the backup blacklist file (contains all the files which are excluded from backup creation)
 static const char* gBackupFilename = "BackupFileList.info";
+/// verification ledger filename
+static const char* gLedgerFilename = "VerifyLedger.info";
 static const char* gNsmAppId = "NodeStateManager";
 
 static const char* gArtefactTemplate[]  = { "_Data_mnt_wt_%s_wt_itz-sem",
@@ -84,7 +100,10 @@ int customAsyncInitClbk(int errcode)
 }
 
 // forward declaration
-static int private_pclInitLibrary(const char* appName, int shutdownMode);
+static int private_pclInitLibrary(const char* appName, int shutdownMode, int async);
+static int private_pclInitBackground(int withPas);
+static int register_pas(void);
+static void join_init_thread(void);
 static int private_pclDeinitLibrary(void);
 
 
@@ -193,7 +212,7 @@ void checkLocalArtefacts(const char* thePath, const char* appName)
 
 
 
-int pclInitLibrary(const char* appName, int shutdownMode)
+static int init_library(const char* appName, int shutdownMode, int async, pclInitReadyCallback_t callback)
 {
    int rval = 1;
 
@@ -212,11 +231,17 @@ int pclInitLibrary(const char* appName, int shutdownMode)
             // do check if there are remaining semaphores for local app from previous lifecycle caused by app crash
             // (only when PCO key-value-store database backend is beeing used)
             checkLocalArtefacts("/dev/shm/", appName);
-            rval = private_pclInitLibrary(appName, shutdownMode);
+            join_init_thread();        // the thread of a failed background initialization
+            gInitReadyCallback = callback;
+            rval = private_pclInitLibrary(appName, shutdownMode, async);
             if(rval >= 0)
             {
                gPclInitCounter++;     // increment after private init, otherwise atomic access is too early
             }
+            else
+            {
+               (void)__sync_lock_test_and_set(&gInitState, rval);
+            }
          }
          else
          {
@@ -224,6 +249,11 @@ int pclInitLibrary(const char* appName, int shutdownMode)
                                                   DLT_STRING("- ONLY INCREMENT init counter: "), DLT_UINT(gPclInitCounter) );
 
             gPclInitCounter++;     // increment after private init, otherwise atomic access is too early
+
+            if(callback != NULL && __sync_add_and_fetch(&gInitState, 0) != PCL_INIT_STATE_PENDING)
+            {
+               callback(gInitState);   // already initialized, report the current state
+            }
          }
       }
       else
@@ -242,14 +272,121 @@ int pclInitLibrary(const char* appName, int shutdownMode)
    return rval;
 }
 
-static int private_pclInitLibrary(const char* appName, int shutdownMode)
+
+
+int pclInitLibrary(const char* appName, int shutdownMode)
+{
+   return init_library(appName, shutdownMode, 0, NULL);
+}
+
+
+
+int pclInitLibraryAsync(const char* appName, int shutdownMode, pclInitReadyCallback_t callback)
+{
+   return init_library(appName, shutdownMode, 1, callback);
+}
+
+
+
+int pclGetInitState(void)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+   int state = __sync_add_and_fetch(&gInitState, 0);
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0 || state < 0)
+   {
+      rval = state;     // the error code of a failed initialization is kept until the next init
+   }
+
+   return rval;
+}
+
+
+
+/// wait until the background initialization thread has finished and join it.
+/// Must be called with gInitMutex locked, the thread locks it to finish the initialization.
+static void join_init_thread(void)
+{
+   while(gInitThreadRunning == 1 && __sync_add_and_fetch(&gInitState, 0) == PCL_INIT_STATE_PENDING)
+   {
+      pthread_cond_wait(&gInitCond, &gInitMutex);
+   }
+
+   if(gInitThreadRunning == 1)
+   {
+      if(pthread_equal(pthread_self(), gInitThread) != 0)
+      {
+         pthread_detach(gInitThread);     // called from the init ready callback
+      }
+      else
+      {
+         pthread_join(gInitThread, NULL);
+      }
+      gInitThreadRunning = 0;
+   }
+}
+
+
+
+/// set the result of the background part of the initialization.
+/// If it failed, the initialization is undone, the library is not initialized like after a failed
+/// ::pclInitLibrary. Must be called with gInitMutex locked.
+static int set_init_state(int state)
+{
+   if(state < 0)
+   {
+      // applications may already use the library initialized asynchronously, lock the access
+      // before the databases, files and the mainloop will be torn down. The init counter is
+      // reset afterwards, the files are closed through the file API which requires it.
+      pers_lock_access();
+
+      if(state == EPERS_NO_REG_TO_PAS)
+      {
+         gShutdownMode = PCL_SHUTDOWN_TYPE_NONE;   // registration to the lifecycle has not been done
+      }
+      (void)private_pclDeinitLibrary();
+      gDbusMainloopRunning = 0;
+      (void)__sync_lock_test_and_set(&gPclInitCounter, 0);
+   }
+   else
+   {
+      state = PCL_INIT_STATE_READY;
+   }
+
+   (void)__sync_lock_test_and_set(&gInitState, state);
+   pthread_cond_broadcast(&gInitCond);
+
+   return state;
+}
+
+
+
+static void* init_background_thread(void* dataPtr)
+{
+   int state = private_pclInitBackground(1);
+   (void)dataPtr;
+
+   pthread_mutex_lock(&gInitMutex);
+   state = set_init_state(state);
+   pthread_mutex_unlock(&gInitMutex);
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("initLibrary - background init done, state:"), DLT_INT(state));
+
+   if(gInitReadyCallback != NULL)
+   {
+      gInitReadyCallback(state);
+   }
+
+   return NULL;
+}
+
+
+
+static int private_pclInitLibrary(const char* appName, int shutdownMode, int async)
 {
    // no need for NULL ptr check for appName, already done in calling function
 
    int rval = 1;
-#if USE_PASINTERFACE
-   int pasRegStatus = -1;
-#endif
 
    char blacklistPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
 
@@ -276,28 +413,10 @@ static int private_pclInitLibrary(const char* appName, int shutdownMode)
       gDbusMainloopRunning = 1;
    }
 
-#if USE_PASINTERFACE
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("PAS interface is enabled!!"));
-
-   pasRegStatus = register_pers_admin_service();
-
-   if(pasRegStatus == -1)
-   {
-     DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("initLibrary - Failed reg to PAS dbus interface"));
-   }
-   else if(pasRegStatus < -1)
+   if(async == 0 && (rval = register_pas()) < 0)   // register before local data can be accessed
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_INFO,  DLT_STRING("initLibrary - registration to PAS currently not possible."));
-      return EPERS_NO_REG_TO_PAS;
-   }
-   else
-   {
-     DLT_LOG(gPclDLTContext, DLT_LOG_INFO,  DLT_STRING("initLibrary - Successfully established IPC protocol for PCL."));
-     gPasRegistered = 1;   // remember registration to PAS
+      return rval;
    }
-#else
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("PAS interface not enabled, enable with \"./configure --enable-pasinterface\""));
-#endif
 
    strncpy(gAppId, appName, PERS_RCT_MAX_LENGTH_RESPONSIBLE);  // assign application name
    gAppId[PERS_RCT_MAX_LENGTH_RESPONSIBLE-1] = '\0';
@@ -330,16 +449,12 @@ static int private_pclInitLibrary(const char* appName, int shutdownMode)
      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("initLibrary - Err access blacklist:"), DLT_STRING(blacklistPath));
    }
 
+   // Assemble verification ledger path, reuse the blacklist path buffer
+   snprintf(blacklistPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s/%s", CACHEPREFIX, appName, gLedgerFilename);
+   pclLedgerLoad(blacklistPath);
 
-   if(gShutdownMode != PCL_SHUTDOWN_TYPE_NONE)
-   {
-     if(register_lifecycle(shutdownMode) == -1) // register for lifecycle dbus messages
-     {
-       DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("initLibrary => Failed reg to LC dbus interface"));
-     }
-   }
 
-   if((rval = load_custom_plugins(customAsyncInitClbk)) < 0)      // load custom plugins
+   if((rval = load_custom_plugins(customAsyncInitClbk)) < 0)      // load custom library config and default plugin
    {
      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("Failed to load custom plugins"));
      return rval;
@@ -347,11 +462,100 @@ static int private_pclInitLibrary(const char* appName, int shutdownMode)
 
    init_key_handle_array();
 
+   pclFileAsyncInit();
+
 #if USE_APPCHECK
    doInitAppcheck(appName);      // check if we have a trusted application
 #endif
 
-   pers_unlock_access();
+   pers_unlock_access();      // local data can be accessed now
+
+   if(async == 1)
+   {
+      // IPC registrations and plugin loading are done in the background
+      gInitState = PCL_INIT_STATE_PENDING;
+      if(pthread_create(&gInitThread, NULL, init_background_thread, NULL) == 0)
+      {
+         gInitThreadRunning = 1;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("initLibrary - failed to create init thread, init now"));
+         rval = set_init_state(private_pclInitBackground(1));
+
+         if(gInitReadyCallback != NULL)
+         {
+            gInitReadyCallback(rval);
+         }
+      }
+   }
+   else
+   {
+      rval = set_init_state(private_pclInitBackground(0));
+   }
+
+   return rval;
+}
+
+
+
+/// register to the persistence administration service
+static int register_pas(void)
+{
+   int rval = 1;
+
+#if USE_PASINTERFACE
+   int pasRegStatus = -1;
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("PAS interface is enabled!!"));
+
+   pasRegStatus = register_pers_admin_service();
+
+   if(pasRegStatus == -1)
+   {
+     DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("initLibrary - Failed reg to PAS dbus interface"));
+   }
+   else if(pasRegStatus < -1)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO,  DLT_STRING("initLibrary - registration to PAS currently not possible."));
+      return EPERS_NO_REG_TO_PAS;
+   }
+   else
+   {
+     DLT_LOG(gPclDLTContext, DLT_LOG_INFO,  DLT_STRING("initLibrary - Successfully established IPC protocol for PCL."));
+     gPasRegistered = 1;   // remember registration to PAS
+   }
+#else
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("PAS interface not enabled, enable with \"./configure --enable-pasinterface\""));
+#endif
+
+   return rval;
+}
+
+
+
+/// background part of the initialization, withPas is 0 if the registration to PAS has already been done
+static int private_pclInitBackground(int withPas)
+{
+   int rval = 1;
+
+   if(withPas == 1 && (rval = register_pas()) < 0)
+   {
+      return rval;
+   }
+
+   if(gShutdownMode != PCL_SHUTDOWN_TYPE_NONE)
+   {
+     if(register_lifecycle(gShutdownMode) == -1) // register for lifecycle dbus messages
+     {
+       DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("initLibrary => Failed reg to LC dbus interface"));
+     }
+   }
+
+   if((rval = load_init_custom_plugins()) < 0)      // load custom plugins
+   {
+     DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("Failed to load custom plugins"));
+   }
 
    return rval;
 }
@@ -366,6 +570,11 @@ int pclDeinitLibrary(void)
 
    if(lock == 0)
    {
+      if(gPclInitCounter <= 1)
+      {
+         join_init_thread();     // registrations must be done before they will be undone
+      }
+
       if(gPclInitCounter == 1)
       {
          DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclDeinitLibrary - DEINIT  client lib - "), DLT_STRING(gAppId),
@@ -420,6 +629,8 @@ static int private_pclDeinitLibrary(void)
    }
 #endif
 
+   pclFileAsyncDeinit();                  // finish queued asynchronous file requests before the files will be closed
+
    memset(&data, 0, sizeof(MainLoopData_u));
    data.cmd = (uint32_t)CMD_LC_PREPARE_SHUTDOWN;
    data.params[0] = Shutdown_Full;        // shutdown full
@@ -436,8 +647,11 @@ static int private_pclDeinitLibrary(void)
 
    pthread_join(gMainLoopThread, (void**)&retval);    // wait until the dbus mainloop has ended
 
+   pclLedgerStore();                                  // all files have been closed, store the clean state
+
    deleteHandleTrees();                               // delete allocated trees
    deleteBackupTree();
+   deleteDirCache();
    deleteNotifyTree();
 
 #if USE_FILECACHE
@@ -500,6 +714,180 @@ int pclLifecycleSet(int shutdown)
 }
 
 
+
+int pclSetShutdownFlushDeadline(unsigned int deadline_ms)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      gShutdownFlushDeadline = deadline_ms;
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("setShutdownFlushDeadline - ms:"), DLT_UINT(deadline_ms));
+      rval = 1;
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("setShutdownFlushDeadline - not initialized"));
+   }
+
+   return rval;
+}
+
+
+int pclGetShutdownTiming(pclShutdownTiming_s* timing)
+{
+   int rval = EPERS_COMMON;
+
+   if(timing != NULL)
+   {
+      process_get_shutdown_timing(timing);
+      rval = 1;
+   }
+
+   return rval;
+}
+
+
+int pclSetRctPreload(int enable)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      gRctPreload = (enable != 0) ? 1 : 0;
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("setRctPreload - enable:"), DLT_INT(gRctPreload));
+      rval = 1;
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("setRctPreload - not initialized"));
+   }
+
+   return rval;
+}
+
+
+int pclSetDatabaseLimits(unsigned int idle_ms, unsigned int max_open)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      gDbIdleTimeout = idle_ms;
+      gDbMaxOpen     = max_open;
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("setDatabaseLimits - idle ms:"), DLT_UINT(idle_ms),
+                                            DLT_STRING("max open:"), DLT_UINT(max_open));
+      rval = 1;
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("setDatabaseLimits - not initialized"));
+   }
+
+   return rval;
+}
+
+
+
+int pclSetDatabaseBackend(unsigned int ldbid, int backend)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int dbBackend = (backend == PCL_DB_BACKEND_LOG) ? DbBackend_Log : DbBackend_Plugin;
+
+      if((backend == PCL_DB_BACKEND_DEFAULT || backend == PCL_DB_BACKEND_LOG) && database_set_backend(ldbid, dbBackend) == 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("setDatabaseBackend - ldbid:"), DLT_UINT(ldbid),
+                                               DLT_STRING("backend:"), DLT_INT(backend));
+         rval = 1;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("setDatabaseBackend - invalid ldbid or backend"));
+         rval = EPERS_COMMON;
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("setDatabaseBackend - not initialized"));
+   }
+
+   return rval;
+}
+
+
+
+int pclGetStatistics(unsigned int ldbid, pclStatistics_s* statistics)
+{
+   int rval = EPERS_COMMON;
+
+   if(statistics != NULL)
+   {
+      pers_stat_get(ldbid, statistics);
+      rval = 1;
+   }
+
+   return rval;
+}
+
+
+
+int pclResetStatistics(void)
+{
+   pers_stat_reset();
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("resetStatistics"));
+
+   return 1;
+}
+
+
+
+int pclSetStatisticsMode(int mode)
+{
+   int rval = EPERS_COMMON;
+
+   if(pers_stat_set_mode(mode) == 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("setStatisticsMode - mode:"), DLT_INT(mode));
+      rval = 1;
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("setStatisticsMode - mode not supported:"), DLT_INT(mode));
+   }
+
+   return rval;
+}
+
+
+
+int pclSetTraceMode(int mode)
+{
+   int rval = EPERS_COMMON;
+
+   if(pers_trace_set_mode(mode) == 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("setTraceMode - mode:"), DLT_INT(mode));
+      rval = 1;
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("setTraceMode - mode not supported:"), DLT_INT(mode));
+   }
+
+   return rval;
+}
+
+
+
+int pclTraceDump(void)
+{
+   return pers_trace_dump();
+}
+
+
 #if 0
 void pcl_test_send_shutdown_command()
 {
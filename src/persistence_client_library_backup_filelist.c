@@ -18,8 +18,8 @@
 
 
 #include "persistence_client_library_backup_filelist.h"
+#include "persistence_client_library_config_cache.h"
 #include "crc32.h"
-#include "rbtree.h"
 
 
 #if USE_FILECACHE
@@ -31,6 +31,9 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <sys/sendfile.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
 #include <dlt.h>
 
 DLT_IMPORT_CONTEXT(gPclDLTContext);
@@ -38,21 +41,150 @@ DLT_IMPORT_CONTEXT(gPclDLTContext);
 static char* gpTokenArray[TOKENARRAYSIZE] = {0};
 
 
-/// the rb tree
-static jsw_rbtree_t *gRb_tree_bl = NULL;
+/// blacklist binary form magic
+static const char gBlacklistMagic[4] = {'P', 'B', 'L', 'K'};
+/// blacklist binary form version, 2: hash set of the full paths
+static const uint32_t gBlacklistVersion = 2;
+/// postfix of the blacklist binary form (appended to the blacklist path)
+static const char* gBlacklistCachePostfix = ".bin";
+
+/// blacklist hash set slot
+typedef struct _PclBlacklistSlot_s
+{
+   /// crc32 of the path
+   uint32_t hash;
+   /// offset of the path in the string area, 0 if the slot is empty
+   uint32_t offset;
+} PclBlacklistSlot_s;
+
+/// blacklist hash set header, followed by the slots and the string area
+typedef struct _PclBlacklistSet_s
+{
+   /// number of slots, power of two
+   uint32_t numSlots;
+   /// number of paths stored
+   uint32_t count;
+} PclBlacklistSet_s;
+
+/// mapped binary form of the blacklist
+static PclConfigCache_s gBlacklistCache = {NULL, 0, NULL, 0};
+/// the blacklist hash set, mapped or allocated
+static const PclBlacklistSet_s* gBlacklistSet = NULL;
+/// size of the blacklist hash set including slots and string area
+static size_t gBlacklistSetSize = 0;
+/// blacklist hash set allocated if the binary form could not be stored
+static PclBlacklistSet_s* gBlacklistAlloc = NULL;
+
+/// range journal filename postfix (appended to the backup path)
+static const char* gJournalPostfix = ".jnl";
+/// range journal magic
+static const char gJournalMagic[4] = {'P', 'J', 'N', 'L'};
+/// range journal format version
+static const uint32_t gJournalVersion = 1;
+
+/// range journal header, written once when the journal is created
+typedef struct _PclJournalHeader_s
+{
+   /// journal magic ::gJournalMagic
+   char magic[4];
+   /// journal format version
+   uint32_t version;
+   /// size of the file before the first write
+   uint64_t origSize;
+   /// crc32 of the preceding header fields
+   uint32_t crc;
+   /// reserved, set to 0
+   uint32_t reserved;
+} PclJournalHeader_s;
+
+/// range journal record, followed by 'length' bytes of original file content
+typedef struct _PclJournalRecord_s
+{
+   /// file offset of the range
+   uint64_t offset;
+   /// length of the range
+   uint32_t length;
+   /// crc32 over offset, length and the original content
+   uint32_t crc;
+} PclJournalRecord_s;
+
+/// verification ledger magic
+static const char gLedgerMagic[4] = {'P', 'V', 'L', 'G'};
+/// verification ledger format version
+static const uint32_t gLedgerVersion = 1;
+
+/// verification ledger entry, state of a file when it has been closed cleanly
+typedef struct _PclLedgerEntry_s
+{
+   /// crc32 of the backup path of the file, 0 if the entry is not used
+   uint32_t key;
+   /// reserved, set to 0
+   uint32_t reserved;
+   /// device of the file
+   uint64_t dev;
+   /// inode of the file
+   uint64_t ino;
+   /// size of the file
+   uint64_t size;
+   /// modification time of the file, seconds
+   uint64_t mtimeSec;
+   /// modification time of the file, nanoseconds
+   uint64_t mtimeNsec;
+} PclLedgerEntry_s;
+
+/// verification ledger file header
+typedef struct _PclLedgerHeader_s
+{
+   /// ledger magic ::gLedgerMagic
+   char magic[4];
+   /// ledger format version
+   uint32_t version;
+   /// number of entries following the header
+   uint32_t count;
+   /// crc32 of the entries
+   uint32_t crc;
+} PclLedgerHeader_s;
+
+/// verification ledger
+static PclLedgerEntry_s gLedger[VerifyLedgerSize];
+/// next ledger entry to be replaced if the ledger is full
+static int gLedgerNext = 0;
+/// path of the ledger file
+static char gLedgerPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+/// mutex to protect the verification ledger
+static pthread_mutex_t gLedgerMtx = PTHREAD_MUTEX_INITIALIZER;
+
+/// folder known to exist
+typedef struct _PclDirCacheEntry_s
+{
+   /// crc32 of the folder path
+   uint32_t key;
+   /// file descriptor of the folder, -1 if the entry is not used
+   int fd;
+   /// path of the folder
+   char path[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+} PclDirCacheEntry_s;
+
+/// cache of folders known to exist
+static PclDirCacheEntry_s gDirCache[DirCacheSize] = { [0 ... DirCacheSize-1] = { 0, -1, {0} } };
+/// next folder cache entry to be replaced
+static int gDirCacheNext = 0;
+/// mutex to protect the folder cache
+static pthread_mutex_t gDirCacheMtx = PTHREAD_MUTEX_INITIALIZER;
 
 // local function prototypes
-static int need_backup_key(unsigned int key);
+static int need_backup_path(const char* path);
 static int pclRecoverFromBackup(int backupFd, const char* original);
+static int pclRecoverFromJournal(const char* jnlPath, const char* original);
 
 
 void deleteBackupTree(void)
 {
-   if(gRb_tree_bl != NULL)
-   {
-      jsw_rbdelete(gRb_tree_bl);
-      gRb_tree_bl = NULL;
-   }
+   pclConfigCacheClose(&gBlacklistCache);
+   free(gBlacklistAlloc);
+   gBlacklistAlloc   = NULL;
+   gBlacklistSet     = NULL;
+   gBlacklistSetSize = 0;
 }
 
 static void fillFileBackupCharTokenArray(unsigned int customConfigFileSize, char* fileMap)
@@ -84,42 +216,102 @@ static void fillFileBackupCharTokenArray(unsigned int customConfigFileSize, char
 }
 
 
-static void createAndStoreFileNames()
+static PclBlacklistSlot_s* blacklist_slots(const PclBlacklistSet_s* set)
 {
-   int i= 0;
-   char path[128] = {0};
-   key_value_s* item;
+   return (PclBlacklistSlot_s*)(set + 1);
+}
 
-   // create new tree
-   gRb_tree_bl = jsw_rbnew(key_val_cmp, key_val_dup, key_val_rel);
 
-   if(gRb_tree_bl != NULL)
+
+static int blacklist_set_valid(const PclBlacklistSet_s* set, size_t size)
+{
+   int rval = 0;
+
+   if(size >= sizeof(PclBlacklistSet_s))
    {
-      while( i < (TOKENARRAYSIZE-1) )
+      size_t slotSize = (size_t)set->numSlots * sizeof(PclBlacklistSlot_s);
+
+      if(   set->numSlots != 0 && (set->numSlots & (set->numSlots - 1)) == 0     // power of two
+         && set->count < set->numSlots
+         && size > sizeof(PclBlacklistSet_s) + slotSize
+         && ((const char*)set)[size-1] == '\0')                                 // string area is terminated
       {
-         if(gpTokenArray[i+1]  != 0 )
-         {
-            memset(path, 0, sizeof(path));
-            snprintf(path, 128, "%s", gpTokenArray[i]);    // storage type
+         const PclBlacklistSlot_s* slots = blacklist_slots(set);
+         size_t strSize = size - sizeof(PclBlacklistSet_s) - slotSize;
+         uint32_t i = 0;
 
-            item = malloc(sizeof(key_value_s));    // asign key and value to the rbtree item
-            if(item != NULL)
+         rval = 1;
+         for(i=0; i<set->numSlots; i++)
+         {
+            if(slots[i].offset >= strSize)
             {
-               //printf("createAndStoreFileNames => path: %s\n", path);
-               item->key = pclCrc32(0, (unsigned char*)path, strlen(path));
-               // we don't need the path name here, we just need to know that this key is available in the tree
-               item->value = "";
-               (void)jsw_rbinsert(gRb_tree_bl, item);
-               free(item);
+               rval = 0;
+               break;
             }
-            i+=1;
          }
-         else
+      }
+   }
+
+   return rval;
+}
+
+
+
+static PclBlacklistSet_s* createAndStoreFileNames(size_t* setSize)
+{
+   int i= 0, j = 0;
+   uint32_t numSlots = 2;
+   size_t strSize = 1, size = 0;     // offset 0 marks an empty slot
+   PclBlacklistSet_s* set = NULL;
+
+   while(i < (TOKENARRAYSIZE-1) && gpTokenArray[i+1] != 0)
+   {
+      strSize += strlen(gpTokenArray[i]) + 1;
+      i++;
+   }
+
+   while(numSlots < (uint32_t)(2*i))     // keep the load factor <= 0.5
+   {
+      numSlots <<= 1;
+   }
+
+   size = sizeof(PclBlacklistSet_s) + numSlots * sizeof(PclBlacklistSlot_s) + strSize;
+   set = calloc(1, size);
+   if(set != NULL)
+   {
+      PclBlacklistSlot_s* slots = blacklist_slots(set);
+      char* strArea = (char*)(slots + numSlots);
+      uint32_t offset = 1;
+
+      set->numSlots = numSlots;
+
+      for(j=0; j<i; j++)
+      {
+         size_t len = strlen(gpTokenArray[j]);
+         uint32_t hash = pclCrc32(0, (unsigned char*)gpTokenArray[j], len);
+         uint32_t slot = hash & (numSlots - 1);
+
+         // linear probing, identical paths are stored only once
+         while(   slots[slot].offset != 0
+               && (slots[slot].hash != hash || strcmp(strArea + slots[slot].offset, gpTokenArray[j]) != 0))
          {
-            break;
+            slot = (slot + 1) & (numSlots - 1);
+         }
+
+         if(slots[slot].offset == 0)
+         {
+            memcpy(strArea + offset, gpTokenArray[j], len + 1);
+            slots[slot].hash   = hash;
+            slots[slot].offset = offset;
+            offset += (uint32_t)(len + 1);
+            set->count++;
          }
       }
+      size = sizeof(PclBlacklistSet_s) + numSlots * sizeof(PclBlacklistSlot_s) + offset;
    }
+   *setSize = size;
+
+   return set;
 }
 
 
@@ -127,6 +319,8 @@ int readBlacklistConfigFile(const char* filename)
 {
    int rval = 0;
 
+   deleteBackupTree();
+
    if(filename != NULL)
    {
       struct stat buffer;
@@ -136,32 +330,66 @@ int readBlacklistConfigFile(const char* filename)
       {
          if(buffer.st_size > 0)     // check for empty file
          {
-            char* configFileMap = 0;
-            int fd = open(filename, O_RDONLY);
+            char cachePath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+            snprintf(cachePath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", filename, gBlacklistCachePostfix);
 
-            if(fd == -1)
+            // use the binary form if it has been created from the current configuration file
+            if(   pclConfigCacheOpen(&gBlacklistCache, cachePath, gBlacklistMagic, gBlacklistVersion, &buffer) == 1
+               && blacklist_set_valid(gBlacklistCache.data, gBlacklistCache.size) == 1)
             {
-              DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("blacklist - Err file open"), DLT_STRING(filename), DLT_STRING(strerror(errno)) );
-              return EPERS_COMMON;
+               gBlacklistSet     = gBlacklistCache.data;
+               gBlacklistSetSize = gBlacklistCache.size;
             }
+            else
+            {
+               char* configFileMap = 0;
+               PclBlacklistSet_s* set = NULL;
+               size_t setSize = 0;
+               int fd = open(filename, O_RDONLY);
 
-            configFileMap = (char*)mmap(0, (size_t)buffer.st_size, PROT_WRITE, MAP_PRIVATE, fd, 0);  // map the configuration file into memory
+               if(fd == -1)
+               {
+                 DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("blacklist - Err file open"), DLT_STRING(filename), DLT_STRING(strerror(errno)) );
+                 return EPERS_COMMON;
+               }
 
-            if(configFileMap == MAP_FAILED)
-            {
-              close(fd);
-              DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("blacklist - Err mapping file:"), DLT_STRING(filename), DLT_STRING(strerror(errno)) );
+               configFileMap = (char*)mmap(0, (size_t)buffer.st_size, PROT_WRITE, MAP_PRIVATE, fd, 0);  // map the configuration file into memory
 
-              return EPERS_COMMON;
-            }
+               if(configFileMap == MAP_FAILED)
+               {
+                 close(fd);
+                 DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("blacklist - Err mapping file:"), DLT_STRING(filename), DLT_STRING(strerror(errno)) );
 
-            fillFileBackupCharTokenArray((unsigned int)buffer.st_size, configFileMap);
+                 return EPERS_COMMON;
+               }
 
-            createAndStoreFileNames();    // create filenames and store them in the tree
+               fillFileBackupCharTokenArray((unsigned int)buffer.st_size, configFileMap);
 
-            (void)munmap(configFileMap, (size_t)buffer.st_size);
+               set = createAndStoreFileNames(&setSize);   // create the hash set of filenames
 
-            close(fd);
+               (void)munmap(configFileMap, (size_t)buffer.st_size);
+
+               close(fd);
+
+               if(set != NULL)
+               {
+                  // store the binary form for the next init and the other clients
+                  if(   pclConfigCacheStore(cachePath, gBlacklistMagic, gBlacklistVersion, &buffer, set, setSize) == 1
+                     && pclConfigCacheOpen(&gBlacklistCache, cachePath, gBlacklistMagic, gBlacklistVersion, &buffer) == 1)
+                  {
+                     free(set);
+                     gBlacklistSet     = gBlacklistCache.data;
+                     gBlacklistSetSize = gBlacklistCache.size;
+                  }
+                  else
+                  {
+                     gBlacklistAlloc   = set;
+                     gBlacklistSet     = set;
+                     gBlacklistSetSize = setSize;
+                  }
+               }
+            }
          }
          else
          {
@@ -186,29 +414,28 @@ int readBlacklistConfigFile(const char* filename)
 
 
 
-int need_backup_key(unsigned int key)
+int need_backup_path(const char* path)
 {
    int rval = CREATE_BACKUP;
-   key_value_s* item = NULL;
 
-   item = malloc(sizeof(key_value_s));
-   if(item != NULL && gRb_tree_bl != NULL)
+   if(gBlacklistSet != NULL)
    {
-      key_value_s* foundItem = NULL;
-      item->key = key;
-      foundItem = (key_value_s*)jsw_rbfind(gRb_tree_bl, item);
-      if(foundItem != NULL)
+      const PclBlacklistSlot_s* slots = blacklist_slots(gBlacklistSet);
+      const char* strArea = (const char*)(slots + gBlacklistSet->numSlots);
+      uint32_t mask = gBlacklistSet->numSlots - 1;
+      uint32_t hash = pclCrc32(0, (const unsigned char*)path, strlen(path));
+      uint32_t slot = hash & mask;
+
+      // the set is never full, so probing ends at an empty slot
+      while(slots[slot].offset != 0)
       {
-         rval = DONT_CREATE_BACKUP;
+         if(slots[slot].hash == hash && strcmp(strArea + slots[slot].offset, path) == 0)
+         {
+            rval = DONT_CREATE_BACKUP;
+            break;
+         }
+         slot = (slot + 1) & mask;
       }
-      free(item);
-   }
-   else
-   {
-      if(item!=NULL)
-        free(item);
-
-      rval = CREATE_BACKUP;
    }
 
    return rval;
@@ -232,68 +459,200 @@ static int pclBackupDoFileCopy(int srcFd, int dstFd)
 }
 
 
-int pclCreateFile(const char* path, int chached)
+static int pclDirCacheFind(const char* path, size_t len)
 {
-   const char* delimiters = "/\n";   // search for blank and end of line
-   char* tokenArray[24] = {0};
-   char thePath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
-   int numTokens = 0, i = 0, validPath = 1, handle = -1;
+   int i = 0;
+   uint32_t key = pclCrc32(0, (const unsigned char*)path, len);
 
-   if (path == NULL) 
+   for(i=0; i<DirCacheSize; i++)
    {
-      return handle;
+      if(   gDirCache[i].fd != -1
+         && gDirCache[i].key == key
+         && strlen(gDirCache[i].path) == len
+         && strncmp(gDirCache[i].path, path, len) == 0)
+      {
+         return gDirCache[i].fd;
+      }
    }
 
-   strncpy(thePath, path, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
-   thePath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
+   return -1;
+}
+
+
 
-   tokenArray[numTokens++] = strtok(thePath, delimiters);
-   while(tokenArray[numTokens-1] != NULL )
+static int pclDirCacheAdd(const char* path, size_t len, int fd)
+{
+   int idx = gDirCacheNext;
+
+   if(gIsNodeStateManager == 1 || len >= PERS_ORG_MAX_LENGTH_PATH_FILENAME)
    {
-     tokenArray[numTokens] = strtok(NULL, delimiters);
-     if(tokenArray[numTokens] != NULL)
-     {
-        numTokens++;
-        if(numTokens >= 24)
-        {
-           validPath = 0;
-           break;
-        }
-     }
-     else
-     {
-        break;
-     }
+      return -1;     // don't keep folders open, see private_pclInitLibrary
    }
 
-   if(validPath == 1)
+   gDirCacheNext = (gDirCacheNext + 1) % DirCacheSize;
+
+   if(gDirCache[idx].fd != -1)
    {
-      char createPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
-      snprintf(createPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "/%s",tokenArray[0] );
-      for(i=1; i<numTokens-1; i++)
+      close(gDirCache[idx].fd);
+   }
+
+   gDirCache[idx].key = pclCrc32(0, (const unsigned char*)path, len);
+   gDirCache[idx].fd  = fd;
+   memcpy(gDirCache[idx].path, path, len);
+   gDirCache[idx].path[len] = '\0';
+
+   return 0;
+}
+
+
+
+static void pclDirCacheClear(void)
+{
+   int i = 0;
+
+   for(i=0; i<DirCacheSize; i++)
+   {
+      if(gDirCache[i].fd != -1)
       {
-         // create folders
-         strncat(createPath, "/", PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
-         strncat(createPath, tokenArray[i], PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
-         (void)mkdir(createPath, 0744);
+         close(gDirCache[i].fd);
+         gDirCache[i].fd = -1;
       }
-      // finally create the file
-      strncat(createPath, "/", PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
-      strncat(createPath, tokenArray[i], PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
+   }
+   gDirCacheNext = 0;
+}
 
-#if USE_FILECACHE
-      if(chached == 0)
+
+
+void deleteDirCache(void)
+{
+   if(pthread_mutex_lock(&gDirCacheMtx) == 0)
+   {
+      pclDirCacheClear();
+      pthread_mutex_unlock(&gDirCacheMtx);
+   }
+}
+
+
+
+static int pclCreateFolders(const char* path, size_t dirLen)
+{
+   int rval = -1;
+   size_t len = dirLen;
+   int parentFd = -1, parentOwned = 0;
+
+   // find the deepest folder known to exist
+   while(len > 0 && (parentFd = pclDirCacheFind(path, len)) == -1)
+   {
+      while(len > 0 && path[--len] != '/')
       {
-         handle = open(createPath, O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+         ;
       }
-      else
+   }
+
+   if(parentFd == -1)
+   {
+      parentFd = open("/", O_PATH | O_DIRECTORY | O_CLOEXEC);
+      parentOwned = 1;
+   }
+
+   if(parentFd != -1)
+   {
+      rval = 0;
+
+      // create the missing folders relative to the parent folder
+      while(len < dirLen)
+      {
+         char folder[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+         size_t start = len + 1, end = len + 1;
+         int fd = -1;
+
+         while(end < dirLen && path[end] != '/')
+         {
+            end++;
+         }
+         len = end;
+
+         if(end == start)
+         {
+            continue;     // skip empty path component
+         }
+
+         memcpy(folder, path + start, end - start);
+         (void)mkdirat(parentFd, folder, 0744);
+
+         fd = openat(parentFd, folder, O_PATH | O_DIRECTORY | O_CLOEXEC);
+         if(fd == -1)
+         {
+            rval = -1;
+            break;
+         }
+
+         if(parentOwned == 1)
+         {
+            close(parentFd);
+         }
+         parentOwned = (pclDirCacheAdd(path, end, fd) == -1);
+         parentFd = fd;
+      }
+
+      if(parentOwned == 1)
       {
-         handle = pfcOpenFile(createPath, CreateFile);
+         close(parentFd);
       }
+   }
+
+   return rval;
+}
+
+
+
+int pclCreateFile(const char* path, int chached)
+{
+   int handle = -1;
+   const char* fileName = NULL;
+
+   if (path == NULL) 
+   {
+      return handle;
+   }
+
+   fileName = strrchr(path, '/');
+
+   if(   path[0] == '/' && fileName[1] != '\0'
+      && strlen(path) < PERS_ORG_MAX_LENGTH_PATH_FILENAME
+      && pthread_mutex_lock(&gDirCacheMtx) == 0)
+   {
+      size_t dirLen = (size_t)(fileName - path);
+      int retry = 0;
+
+      for(retry=0; retry<2; retry++)
+      {
+         if(pclCreateFolders(path, dirLen) == 0)
+         {
+#if USE_FILECACHE
+            if(chached == 0)
+            {
+               handle = open(path, O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+            }
+            else
+            {
+               handle = pfcOpenFile(path, CreateFile);
+            }
 #else
-      (void)chached;
-      handle = open(createPath, O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+            (void)chached;
+            handle = open(path, O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
 #endif
+         }
+
+         if(handle != -1)
+         {
+            break;
+         }
+
+         // a cached folder might have been removed, create the folders again
+         pclDirCacheClear();
+      }
+      pthread_mutex_unlock(&gDirCacheMtx);
    }
    else
    {
@@ -307,21 +666,37 @@ int pclCreateFile(const char* path, int chached)
 
 int pclVerifyConsistency(const char* origPath, const char* backupPath, const char* csumPath, int openFlags)
 {
-   int handle = 0, readSize = 0, backupAvail = 0, csumAvail = 0;
+   int handle = 0, readSize = 0, backupAvail = 0, csumAvail = 0, jnlAvail = 0;
    int fdCsum = 0, fdBackup = 0;
 
    char origCsumBuf[ChecksumBufSize] = {0};
    char backCsumBuf[ChecksumBufSize] = {0};
    char csumBuf[ChecksumBufSize]     = {0};
+   char jnlPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
 
-   // check if we have a backup and checksum file
+   snprintf(jnlPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", backupPath, gJournalPostfix);
+
+   // check if we have a journal, backup and checksum file
+   jnlAvail    = access(jnlPath, F_OK);
    backupAvail = access(backupPath, F_OK);
    csumAvail   = access(csumPath, F_OK);
 
+   // *************************************************
+   // there is a range journal
+   // *************************************************
+   if(jnlAvail == 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("verifyConsist - there is a range journal, roll back"));
+
+      if(pclRecoverFromJournal(jnlPath, origPath) == -1)
+      {
+         handle = -1;   // error: file corrupt
+      }
+   }
    // *************************************************
    // there is a backup file and a checksum
    // *************************************************
-   if((backupAvail == 0) && (csumAvail == 0) )
+   else if((backupAvail == 0) && (csumAvail == 0) )
    {
       DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("verifyConsist- there is a backup file AND csum"));
 
@@ -478,6 +853,7 @@ int pclVerifyConsistency(const char* origPath, const char* backupPath, const cha
       (void)remove(origPath);
       (void)remove(backupPath);
       (void)remove(csumPath);
+      (void)remove(jnlPath);
    }
 
    return handle;
@@ -501,6 +877,372 @@ int pclRecoverFromBackup(int backupFd, const char* original)
 
 
 
+static unsigned int pclJournalRecordCrc(const PclJournalRecord_s* record, const char* data)
+{
+   unsigned int crc = pclCrc32(0, (const unsigned char*)&record->offset, sizeof(record->offset));
+   crc = pclCrc32(crc, (const unsigned char*)&record->length, sizeof(record->length));
+
+   return pclCrc32(crc, (const unsigned char*)data, record->length);
+}
+
+
+
+static int pclJournalHeaderValid(const PclJournalHeader_s* header)
+{
+   return (   memcmp(header->magic, gJournalMagic, sizeof(gJournalMagic)) == 0
+           && header->version == gJournalVersion
+           && header->crc == pclCrc32(0, (const unsigned char*)header, offsetof(PclJournalHeader_s, crc)) );
+}
+
+
+
+int pclRecoverFromJournal(const char* jnlPath, const char* original)
+{
+   int rval = 0, jnlFd = -1, origFd = -1;
+   PclJournalHeader_s header;
+
+   jnlFd = open(jnlPath, O_RDONLY);
+   if(jnlFd == -1)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("rJournal - failed open journal"), DLT_STRING(strerror(errno)));
+      return -1;
+   }
+
+   // the header is synced before the first write to the file,
+   // an incomplete header means the file has not been modified
+   if(   read(jnlFd, &header, sizeof(header)) == (ssize_t)sizeof(header)
+      && pclJournalHeaderValid(&header) )
+   {
+      origFd = open(original, O_RDWR);
+      if(origFd != -1)
+      {
+         PclJournalRecord_s record;
+         struct stat jnlStat;
+         off_t* recordPos = NULL;
+         char* data = NULL;
+         size_t numRecords = 0, maxRecords = 0, dataSize = 0;
+         off_t pos = (off_t)sizeof(header);
+
+         memset(&jnlStat, 0, sizeof(jnlStat));
+         (void)fstat(jnlFd, &jnlStat);
+
+         // collect the complete records, a torn record at the end has not been followed by a write
+         while(pread(jnlFd, &record, sizeof(record), pos) == (ssize_t)sizeof(record))
+         {
+            if(pos + (off_t)sizeof(record) + (off_t)record.length > jnlStat.st_size)
+            {
+               break;
+            }
+
+            if(record.length > dataSize)
+            {
+               char* tmp = realloc(data, record.length);
+               if(tmp == NULL)
+               {
+                  rval = -1;
+                  break;
+               }
+               data = tmp;
+               dataSize = record.length;
+            }
+
+            if(   pread(jnlFd, data, record.length, pos + (off_t)sizeof(record)) != (ssize_t)record.length
+               || pclJournalRecordCrc(&record, data) != record.crc)
+            {
+               break;
+            }
+
+            if(numRecords == maxRecords)
+            {
+               off_t* tmp = NULL;
+               maxRecords = (maxRecords == 0) ? 64 : maxRecords * 2;
+               tmp = realloc(recordPos, maxRecords * sizeof(off_t));
+               if(tmp == NULL)
+               {
+                  rval = -1;
+                  break;
+               }
+               recordPos = tmp;
+            }
+            recordPos[numRecords++] = pos;
+            pos += (off_t)(sizeof(record) + record.length);
+         }
+
+         // apply in reverse order, so the oldest content of a range will be written last
+         while(rval != -1 && numRecords > 0)
+         {
+            pos = recordPos[--numRecords];
+
+            if(   pread(jnlFd, &record, sizeof(record), pos) != (ssize_t)sizeof(record)
+               || pread(jnlFd, data, record.length, pos + (off_t)sizeof(record)) != (ssize_t)record.length
+               || pwrite(origFd, data, record.length, (off_t)record.offset) != (ssize_t)record.length)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("rJournal - failed roll back range"), DLT_STRING(strerror(errno)));
+               rval = -1;
+            }
+         }
+
+         if(rval != -1)
+         {
+            if(ftruncate(origFd, (off_t)header.origSize) == -1 || fsync(origFd) == -1)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("rJournal - failed restore size"), DLT_STRING(strerror(errno)));
+               rval = -1;
+            }
+            else
+            {
+               rval = 1;
+            }
+         }
+
+         free(recordPos);
+         free(data);
+         close(origFd);
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("rJournal - failed open original"), DLT_STRING(strerror(errno)));
+      }
+   }
+   close(jnlFd);
+
+   if(rval != -1)
+   {
+      (void)remove(jnlPath);
+   }
+
+   return rval;
+}
+
+
+
+/// commit the directory entry of a created file, returns 0 on success
+static int pclSyncParentDir(const char* path)
+{
+   int rval = -1;
+   char dirPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+   char* delimiter = NULL;
+
+   strncpy(dirPath, path, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
+   dirPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
+
+   delimiter = strrchr(dirPath, '/');
+   if(delimiter != NULL)
+   {
+      int dirFd = -1;
+
+      *(delimiter == dirPath ? delimiter+1 : delimiter) = '\0';
+      dirFd = open(dirPath, O_RDONLY | O_DIRECTORY);
+      if(dirFd != -1)
+      {
+         rval = fsync(dirFd);
+         close(dirFd);
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclCreateJournal(const char* backupPath, int srcfd)
+{
+   int rval = -1, jnlFd = -1;
+   struct stat buf;
+   char jnlPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+   if(backupPath == NULL || backupPath[0] == '\0' || fstat(srcfd, &buf) == -1)
+   {
+      return rval;
+   }
+
+   snprintf(jnlPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", backupPath, gJournalPostfix);
+
+   jnlFd = open(jnlPath, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+   if(jnlFd == -1 && errno == ENOENT)
+   {
+      jnlFd = pclCreateFile(jnlPath, 0);     // create the folders
+   }
+
+   if(jnlFd != -1)
+   {
+      PclJournalHeader_s header;
+
+      memset(&header, 0, sizeof(header));
+      memcpy(header.magic, gJournalMagic, sizeof(gJournalMagic));
+      header.version  = gJournalVersion;
+      header.origSize = (uint64_t)buf.st_size;
+      header.crc      = pclCrc32(0, (const unsigned char*)&header, offsetof(PclJournalHeader_s, crc));
+
+      // the header and the directory entry must be on disk before the file will be modified,
+      // otherwise the journal could be lost while the file has already been modified
+      if(   write(jnlFd, &header, sizeof(header)) == (ssize_t)sizeof(header) && fdatasync(jnlFd) != -1
+         && pclSyncParentDir(jnlPath) != -1)
+      {
+         rval = 1;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("cJournal - failed write header"), DLT_STRING(strerror(errno)));
+      }
+      close(jnlFd);
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("cJournal - failed create journal"),
+                                             DLT_STRING(jnlPath), DLT_STRING(strerror(errno)));
+   }
+
+   if(rval == -1)
+   {
+      (void)remove(jnlPath);
+   }
+
+   return rval;
+}
+
+
+
+int pclJournalRange(const char* backupPath, int srcfd, off_t offset, size_t size)
+{
+   int rval = -1, jnlFd = -1;
+   char jnlPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+   if(backupPath == NULL || offset < 0)
+   {
+      return rval;
+   }
+
+   snprintf(jnlPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", backupPath, gJournalPostfix);
+
+   jnlFd = open(jnlPath, O_RDWR | O_APPEND);
+   if(jnlFd != -1)
+   {
+      PclJournalHeader_s header;
+
+      if(pread(jnlFd, &header, sizeof(header), 0) == (ssize_t)sizeof(header))
+      {
+         rval = 0;
+
+         // ranges beyond the original file size will be removed by truncation on recovery
+         if((uint64_t)offset < header.origSize)
+         {
+            PclJournalRecord_s* record = NULL;
+            size_t length = size;
+
+            if((uint64_t)offset + length > header.origSize)
+            {
+               length = (size_t)(header.origSize - (uint64_t)offset);
+            }
+
+            if(length > UINT32_MAX)    // the record length is 32 bit
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("jRange - range too large"), DLT_UINT64((uint64_t)length));
+               close(jnlFd);
+               return -1;
+            }
+
+            record = malloc(sizeof(PclJournalRecord_s) + length);
+            if(record != NULL)
+            {
+               char* data = (char*)(record + 1);
+               ssize_t readSize = 0;
+
+               // the whole range must be journaled, read until the end of the range or the end of the file
+               while((size_t)readSize < length)
+               {
+                  ssize_t chunk = pread(srcfd, data + readSize, length - (size_t)readSize, offset + (off_t)readSize);
+
+                  if(chunk > 0)
+                  {
+                     readSize += chunk;
+                  }
+                  else if(chunk == 0)
+                  {
+                     break;
+                  }
+                  else if(errno != EINTR)
+                  {
+                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("jRange - failed read range"), DLT_STRING(strerror(errno)));
+                     readSize = -1;
+                     rval = -1;
+                     break;
+                  }
+               }
+
+               if(readSize > 0)
+               {
+                  record->offset = (uint64_t)offset;
+                  record->length = (uint32_t)readSize;
+                  record->crc    = pclJournalRecordCrc(record, data);
+
+                  // the record must be on disk before the range will be overwritten
+                  if(   write(jnlFd, record, sizeof(PclJournalRecord_s) + (size_t)readSize) == (ssize_t)(sizeof(PclJournalRecord_s) + (size_t)readSize)
+                     && fdatasync(jnlFd) != -1)
+                  {
+                     rval = (int)readSize;
+                  }
+                  else
+                  {
+                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("jRange - failed write record"), DLT_STRING(strerror(errno)));
+                     rval = -1;
+                  }
+               }
+               free(record);
+            }
+            else
+            {
+               rval = -1;
+            }
+         }
+      }
+      close(jnlFd);
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("jRange - failed open journal"),
+                                             DLT_STRING(jnlPath), DLT_STRING(strerror(errno)));
+   }
+
+   return rval;
+}
+
+
+
+int pclRemoveJournal(const char* backupPath)
+{
+   char jnlPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+   snprintf(jnlPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", backupPath, gJournalPostfix);
+
+   return remove(jnlPath);
+}
+
+
+
+int pclDiscardBackup(const char* backupPath, const char* csumPath)
+{
+   int rval = 0;
+
+   // the journal would be rolled back, the backup is only restored together with the checksum file
+   if(pclRemoveJournal(backupPath) == -1 && errno != ENOENT)
+   {
+      rval = -1;
+   }
+   if(remove(csumPath) == -1 && errno != ENOENT)
+   {
+      rval = -1;
+   }
+   if(remove(backupPath) == -1 && errno != ENOENT)
+   {
+      rval = -1;
+   }
+
+   return rval;
+}
+
+
+
 int pclCreateBackup(const char* dstPath, int srcfd, const char* csumPath, const char* csumBuf)
 {
    int dstFd = 0, csfd = 0, readSize = -1;
@@ -620,7 +1362,7 @@ int pclCalcCrc32Csum(int fd, char crc32sum[])
 
 int pclBackupNeeded(const char* path)
 {
-   return need_backup_key(pclCrc32(0, (const unsigned char*)path, strlen(path)));
+   return need_backup_path(path);
 }
 
 
@@ -650,3 +1392,165 @@ int pclGetPosixPermission(PersistencePermission_e permission)
 
 
 
+void pclLedgerLoad(const char* ledgerPath)
+{
+   if(pthread_mutex_lock(&gLedgerMtx) == 0)
+   {
+      int fd = -1;
+
+      memset(gLedger, 0, sizeof(gLedger));
+      gLedgerNext = 0;
+      strncpy(gLedgerPath, ledgerPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
+      gLedgerPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
+
+      fd = open(gLedgerPath, O_RDONLY);
+      if(fd != -1)
+      {
+         PclLedgerHeader_s header;
+
+         if(   read(fd, &header, sizeof(header)) == (ssize_t)sizeof(header)
+            && memcmp(header.magic, gLedgerMagic, sizeof(gLedgerMagic)) == 0
+            && header.version == gLedgerVersion
+            && header.count <= (uint32_t)VerifyLedgerSize)
+         {
+            size_t size = header.count * sizeof(PclLedgerEntry_s);
+
+            if(   read(fd, gLedger, size) != (ssize_t)size
+               || header.crc != pclCrc32(0, (const unsigned char*)gLedger, size))
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("ledgerLoad - invalid ledger, verify all files"));
+               memset(gLedger, 0, sizeof(gLedger));
+            }
+            else
+            {
+               gLedgerNext = (int)header.count % VerifyLedgerSize;
+            }
+         }
+         close(fd);
+
+         // the ledger is only valid until the files are opened again, it will be written on a clean shutdown.
+         // If the application does not shut down cleanly, all files will be verified on the next start
+         (void)remove(gLedgerPath);
+      }
+      pthread_mutex_unlock(&gLedgerMtx);
+   }
+}
+
+
+
+void pclLedgerStore(void)
+{
+   if(pthread_mutex_lock(&gLedgerMtx) == 0)
+   {
+      if(gLedgerPath[0] != '\0')
+      {
+         int fd = open(gLedgerPath, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+         if(fd != -1)
+         {
+            PclLedgerHeader_s header;
+
+            memcpy(header.magic, gLedgerMagic, sizeof(gLedgerMagic));
+            header.version = gLedgerVersion;
+            header.count   = (uint32_t)VerifyLedgerSize;
+            header.crc     = pclCrc32(0, (const unsigned char*)gLedger, sizeof(gLedger));
+
+            if(   write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header)
+               || write(fd, gLedger, sizeof(gLedger)) != (ssize_t)sizeof(gLedger)
+               || fsync(fd) == -1)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("ledgerStore - failed to write ledger:"), DLT_STRING(strerror(errno)));
+            }
+            close(fd);
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("ledgerStore - failed to open ledger:"), DLT_STRING(strerror(errno)));
+         }
+      }
+      pthread_mutex_unlock(&gLedgerMtx);
+   }
+}
+
+
+
+static int pclLedgerFind(uint32_t key)
+{
+   int i = 0;
+
+   for(i=0; i<VerifyLedgerSize; i++)
+   {
+      if(gLedger[i].key == key)
+      {
+         return i;
+      }
+   }
+
+   return -1;
+}
+
+
+
+void pclLedgerAdd(const char* backupPath, const struct stat* buf)
+{
+   uint32_t key = pclCrc32(0, (const unsigned char*)backupPath, strlen(backupPath));
+
+   if(backupPath[0] != '\0' && key != 0 && pthread_mutex_lock(&gLedgerMtx) == 0)
+   {
+      int idx = pclLedgerFind(key);
+
+      if(idx == -1)
+      {
+         idx = pclLedgerFind(0);       // free entry
+      }
+
+      if(idx == -1)
+      {
+         idx = gLedgerNext;            // ledger full, replace the oldest entry
+         gLedgerNext = (gLedgerNext + 1) % VerifyLedgerSize;
+      }
+
+      gLedger[idx].key       = key;
+      gLedger[idx].reserved  = 0;
+      gLedger[idx].dev       = (uint64_t)buf->st_dev;
+      gLedger[idx].ino       = (uint64_t)buf->st_ino;
+      gLedger[idx].size      = (uint64_t)buf->st_size;
+      gLedger[idx].mtimeSec  = (uint64_t)buf->st_mtim.tv_sec;
+      gLedger[idx].mtimeNsec = (uint64_t)buf->st_mtim.tv_nsec;
+
+      pthread_mutex_unlock(&gLedgerMtx);
+   }
+}
+
+
+
+int pclLedgerTake(const char* backupPath, const char* origPath)
+{
+   int rval = 0;
+   uint32_t key = pclCrc32(0, (const unsigned char*)backupPath, strlen(backupPath));
+
+   if(key != 0 && pthread_mutex_lock(&gLedgerMtx) == 0)
+   {
+      int idx = pclLedgerFind(key);
+
+      if(idx != -1)
+      {
+         struct stat buf;
+
+         if(   stat(origPath, &buf) == 0
+            && gLedger[idx].dev       == (uint64_t)buf.st_dev
+            && gLedger[idx].ino       == (uint64_t)buf.st_ino
+            && gLedger[idx].size      == (uint64_t)buf.st_size
+            && gLedger[idx].mtimeSec  == (uint64_t)buf.st_mtim.tv_sec
+            && gLedger[idx].mtimeNsec == (uint64_t)buf.st_mtim.tv_nsec)
+         {
+            rval = 1;
+         }
+
+         // the file can be modified from now on, it will be added again when it has been closed cleanly
+         memset(&gLedger[idx], 0, sizeof(PclLedgerEntry_s));
+      }
+      pthread_mutex_unlock(&gLedgerMtx);
+   }
+
+   return rval;
+}
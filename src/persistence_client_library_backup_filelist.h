@@ -22,6 +22,8 @@
 #include "persistence_client_library_handle.h"
 #include "persistence_client_library_tree_helper.h"
 
+#include <sys/stat.h>
+
 
 /**
  * @brief Read the blacklist configuration file
@@ -35,7 +37,9 @@ int readBlacklistConfigFile(const char* filename);
 
 /**
  * @brief Create the file under the given path.
- *        If the path does not exist, the folders will be created
+ *        If the path does not exist, the folders will be created.
+ *        Folders known to exist are cached, missing folders will be
+ *        created relative to the deepest cached folder.
  *
  * @param path of the file to be created
  * @param cached 1 if file should be cached,
@@ -60,6 +64,58 @@ int pclCreateFile(const char* path, int chached);
 int pclCreateBackup(const char* srcPath, int srcfd, const char* csumPath, const char* csumBuf);
 
 
+/**
+ * @brief Create a range journal for a file.
+ *        Instead of copying the whole file only the original size is recorded,
+ *        the original content of each range to be overwritten will be added
+ *        with ::pclJournalRange. The journal is stored next to the backup file.
+ *
+ * @param backupPath the path of the backup file
+ * @param srcfd the file descriptor of the file
+ *
+ * @return -1 on error or 1 if succeeded
+ */
+int pclCreateJournal(const char* backupPath, int srcfd);
+
+
+/**
+ * @brief Add the original content of a range that is about to be overwritten to the journal.
+ *        Only the part of the range within the original file size will be journaled,
+ *        data appended to the file will be removed by truncation on recovery.
+ *
+ * @param backupPath the path of the backup file
+ * @param srcfd the file descriptor of the file
+ * @param offset the offset of the range to be overwritten
+ * @param size the size of the range to be overwritten, the part within the original size must be less than 4 GiB
+ *
+ * @return -1 on error or the number of bytes journaled
+ */
+int pclJournalRange(const char* backupPath, int srcfd, off_t offset, size_t size);
+
+
+/**
+ * @brief Remove the range journal of a file
+ *
+ * @param backupPath the path of the backup file
+ *
+ * @return -1 on error or 0 if succeeded
+ */
+int pclRemoveJournal(const char* backupPath);
+
+
+
+/**
+ * @brief Discard the range journal, the backup and the checksum file of a file,
+ *        the current content of the file will be kept on the next open
+ *
+ * @param backupPath the path of the backup file
+ * @param csumPath the path to the checksum file
+ *
+ * @return -1 if a file could not be removed or 0 if succeeded
+ */
+int pclDiscardBackup(const char* backupPath, const char* csumPath);
+
+
 
 /**
  * @brief calculate crc32 checksum
@@ -73,7 +129,8 @@ int pclCalcCrc32Csum(int fd, char crc32sum[]);
 
 
 /**
- * @brief verify file for consistency
+ * @brief verify file for consistency.
+ *        If a range journal is available, the journaled ranges will be rolled back.
  *
  * @param origPath the path of the file to verify
  * @param backupPath the path of the backup file
@@ -85,6 +142,44 @@ int pclCalcCrc32Csum(int fd, char crc32sum[]);
 int pclVerifyConsistency(const char* origPath, const char* backupPath, const char* csumPath, int openFlags);
 
 
+/**
+ * @brief load the verification ledger.
+ *        The ledger file will be removed after it has been loaded,
+ *        it will be written again with ::pclLedgerStore on a clean shutdown.
+ *
+ * @param ledgerPath the path of the ledger file
+ */
+void pclLedgerLoad(const char* ledgerPath);
+
+
+/**
+ * @brief store the verification ledger to the file given with ::pclLedgerLoad
+ */
+void pclLedgerStore(void);
+
+
+/**
+ * @brief add a cleanly closed file to the verification ledger
+ *
+ * @param backupPath the path of the backup file, used as ledger key
+ * @param buf the status of the file after it has been closed
+ */
+void pclLedgerAdd(const char* backupPath, const struct stat* buf);
+
+
+/**
+ * @brief check if a file is unchanged since it has been closed cleanly,
+ *        so the consistency verification can be skipped.
+ *        The ledger entry of the file will be removed.
+ *
+ * @param backupPath the path of the backup file, used as ledger key
+ * @param origPath the path of the file
+ *
+ * @return 1 if the file is unchanged, 0 if the file must be verified
+ */
+int pclLedgerTake(const char* backupPath, const char* origPath);
+
+
 /**
  * @brief check if file needs a backup
  *
@@ -114,4 +209,10 @@ int pclGetPosixPermission(PersistencePermission_e permission);
 void deleteBackupTree(void);
 
 
+/**
+ * @brief close the folders cached by ::pclCreateFile
+ */
+void deleteDirCache(void);
+
+
 #endif /* PERS_BACKUP_BLACKLIST_H */
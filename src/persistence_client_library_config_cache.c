@@ -0,0 +1,160 @@
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_config_cache.c
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Implementation of the persistence client library binary configuration cache.
+ * @see
+ */
+
+#include "persistence_client_library_config_cache.h"
+#include "crc32.h"
+
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <dlt.h>
+
+DLT_IMPORT_CONTEXT(gPclDLTContext);
+
+
+/// binary configuration header, followed by the configuration data
+typedef struct _PclConfigCacheHeader_s
+{
+   /// magic identifying the kind of configuration
+   char magic[4];
+   /// layout version of the configuration data
+   uint32_t version;
+   /// size of the configuration file the binary form has been created from
+   uint64_t srcSize;
+   /// modification time of the configuration file, seconds
+   uint64_t srcMtimeSec;
+   /// modification time of the configuration file, nanoseconds
+   uint64_t srcMtimeNsec;
+   /// size of the configuration data
+   uint32_t size;
+   /// crc32 of the configuration data
+   uint32_t crc;
+} PclConfigCacheHeader_s;
+
+
+
+int pclConfigCacheOpen(PclConfigCache_s* cache, const char* cachePath, const char* magic, uint32_t version,
+                       const struct stat* srcStat)
+{
+   int rval = 0;
+   int fd = -1;
+
+   pclConfigCacheClose(cache);
+
+   fd = open(cachePath, O_RDONLY);
+   if(fd != -1)
+   {
+      struct stat buf;
+
+      if(   fstat(fd, &buf) != -1
+         && buf.st_size >= (off_t)sizeof(PclConfigCacheHeader_s))
+      {
+         void* map = mmap(0, (size_t)buf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+         if(map != MAP_FAILED)
+         {
+            const PclConfigCacheHeader_s* header = (const PclConfigCacheHeader_s*)map;
+            const unsigned char* data = (const unsigned char*)map + sizeof(PclConfigCacheHeader_s);
+
+            if(   memcmp(header->magic, magic, sizeof(header->magic)) == 0
+               && header->version == version
+               && header->srcSize == (uint64_t)srcStat->st_size
+               && header->srcMtimeSec == (uint64_t)srcStat->st_mtim.tv_sec
+               && header->srcMtimeNsec == (uint64_t)srcStat->st_mtim.tv_nsec
+               && header->size == (uint64_t)buf.st_size - sizeof(PclConfigCacheHeader_s)
+               && header->crc == pclCrc32(0, data, header->size))
+            {
+               cache->map     = map;
+               cache->mapSize = (size_t)buf.st_size;
+               cache->data    = data;
+               cache->size    = header->size;
+               rval = 1;
+            }
+            else
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("configCache - out of date:"), DLT_STRING(cachePath));
+               (void)munmap(map, (size_t)buf.st_size);
+            }
+         }
+      }
+      close(fd);
+   }
+
+   return rval;
+}
+
+
+
+int pclConfigCacheStore(const char* cachePath, const char* magic, uint32_t version,
+                        const struct stat* srcStat, const void* data, size_t size)
+{
+   int rval = -1;
+   int fd = -1;
+   char tmpPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+   // other clients may rebuild at the same time, each one writes its own file
+   snprintf(tmpPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s.%d", cachePath, (int)getpid());
+
+   fd = open(tmpPath, O_CREAT|O_WRONLY|O_TRUNC, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+   if(fd != -1)
+   {
+      PclConfigCacheHeader_s header;
+
+      memset(&header, 0, sizeof(header));
+      memcpy(header.magic, magic, sizeof(header.magic));
+      header.version      = version;
+      header.srcSize      = (uint64_t)srcStat->st_size;
+      header.srcMtimeSec  = (uint64_t)srcStat->st_mtim.tv_sec;
+      header.srcMtimeNsec = (uint64_t)srcStat->st_mtim.tv_nsec;
+      header.size         = (uint32_t)size;
+      header.crc          = pclCrc32(0, (const unsigned char*)data, size);
+
+      if(   write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header)
+         && write(fd, data, size) == (ssize_t)size
+         && rename(tmpPath, cachePath) == 0)
+      {
+         rval = 1;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("configCache - failed to store:"), DLT_STRING(cachePath), DLT_STRING(strerror(errno)));
+         (void)remove(tmpPath);
+      }
+      close(fd);
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("configCache - can't create:"), DLT_STRING(tmpPath), DLT_STRING(strerror(errno)));
+   }
+
+   return rval;
+}
+
+
+
+void pclConfigCacheClose(PclConfigCache_s* cache)
+{
+   if(cache->map != NULL)
+   {
+      (void)munmap(cache->map, cache->mapSize);
+   }
+   memset(cache, 0, sizeof(PclConfigCache_s));
+}
@@ -0,0 +1,88 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_CONFIG_CACHE_H
+#define PERSISTENCE_CLIENT_LIBRARY_CONFIG_CACHE_H
+
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_config_cache.h
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Header of the persistence client library binary configuration cache.
+ *                 A configuration file is parsed once into a binary form,
+ *                 the binary form is mapped read-only by all clients.
+ * @see
+ */
+
+#include "persistence_client_library_data_organization.h"
+
+#include <sys/stat.h>
+#include <stdint.h>
+
+
+/// mapped binary form of a configuration file
+typedef struct _PclConfigCache_s
+{
+   /// address of the mapping, NULL if not mapped
+   void* map;
+   /// size of the mapping
+   size_t mapSize;
+   /// the binary configuration data
+   const void* data;
+   /// size of the binary configuration data
+   size_t size;
+} PclConfigCache_s;
+
+
+/**
+ * @brief map the binary form of a configuration file read-only.
+ *        The binary form will only be used if it has been created from the current
+ *        version of the configuration file, identified by the size and modification time.
+ *
+ * @param cache the cache to map, will be unmapped first if already mapped
+ * @param cachePath the path of the binary form
+ * @param magic the 4 character magic identifying the kind of configuration
+ * @param version the layout version of the configuration data, to be increased when the layout changes
+ * @param srcStat the status of the configuration file
+ *
+ * @return 1 if the binary form has been mapped,
+ *         0 if it is missing, invalid, of another layout version or out of date and must be rebuilt
+ */
+int pclConfigCacheOpen(PclConfigCache_s* cache, const char* cachePath, const char* magic, uint32_t version,
+                       const struct stat* srcStat);
+
+
+/**
+ * @brief store the binary form of a configuration file.
+ *        The file will be replaced atomically, so clients mapping the
+ *        previous version are not affected.
+ *
+ * @param cachePath the path of the binary form
+ * @param magic the 4 character magic identifying the kind of configuration
+ * @param version the layout version of the configuration data
+ * @param srcStat the status of the configuration file
+ * @param data the binary configuration data
+ * @param size the size of the binary configuration data
+ *
+ * @return 1 if stored, -1 on error
+ */
+int pclConfigCacheStore(const char* cachePath, const char* magic, uint32_t version,
+                        const struct stat* srcStat, const void* data, size_t size);
+
+
+/**
+ * @brief unmap the binary form of a configuration file
+ *
+ * @param cache the cache to unmap
+ */
+void pclConfigCacheClose(PclConfigCache_s* cache);
+
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_CONFIG_CACHE_H */
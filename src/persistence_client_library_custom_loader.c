@@ -17,12 +17,15 @@
  */
 
 #include "persistence_client_library_custom_loader.h"
+#include "persistence_client_library_config_cache.h"
+#include "crc32.h"
 
 #include <errno.h>
 #include <sys/mman.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <dlfcn.h>
+#include <pthread.h>
 #include <dlt.h>
 
 DLT_IMPORT_CONTEXT(gPclDLTContext);
@@ -56,6 +59,20 @@ static const char* gPluginTypeCustom3   = "custom3";
 
 /// array with custom client library names
 static PersCustomLibInfo gCustomLibArray[PersCustomLib_LastEntry];
+
+/// mutex to serialize the loading of the plugins
+static pthread_mutex_t gPluginLoadMtx = PTHREAD_MUTEX_INITIALIZER;
+/// load state of the plugins, see ::PersPluginState_e
+static int gPluginState[PersCustomLib_LastEntry] = {0};
+/// custom client library information used for lookups, mapped binary form or ::gCustomLibArray
+static const PersCustomLibInfo* gpCustomLibInfo = gCustomLibArray;
+
+/// custom library config binary form magic
+static const char gCustomLibMagic[4] = {'P', 'C', 'L', 'B'};
+/// custom library config binary form version
+static const uint32_t gCustomLibVersion = 1;
+/// mapped binary form of the custom library config file
+static PclConfigCache_s gCustomLibCache = {NULL, 0, NULL, 0};
 static char* gpCustomTokenArray[TOKENARRAYSIZE];
 
 int(* gPlugin_callback_async_t)(int errcode);
@@ -129,14 +146,14 @@ static PersInitType_e getInitType(const char* policy)
 
 PersLoadingType_e getCustomLoadingType(int i)
 {
-   return gCustomLibArray[i].loadingType;
+   return gpCustomLibInfo[i].loadingType;
 }
 
 
 
 PersInitType_e getCustomInitType(int i)
 {
-   return gCustomLibArray[i].initFunction;
+   return gpCustomLibInfo[i].initFunction;
 }
 
 
@@ -240,6 +257,9 @@ int get_custom_libraries()
       filename = "/etc/pclCustomLibConfigFile.cfg";  // use default filename
    }
 
+   pclConfigCacheClose(&gCustomLibCache);
+   gpCustomLibInfo = gCustomLibArray;
+
    for(j=0; j<PersCustomLib_LastEntry; j++)
    {
       gCustomLibArray[j].valid = -1;         // init pos to -1
@@ -248,7 +268,18 @@ int get_custom_libraries()
    memset(&buffer, 0, sizeof(buffer));
    if(stat(filename, &buffer) != -1)
    {
-      if(buffer.st_size > 0)                 // check for empty file
+      char cachePath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+      // the binary form is identified by the config file name, it's rebuilt if the config file is newer
+      snprintf(cachePath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%spclCustomLibConfig_%08x.bin", CACHEPREFIX,
+               pclCrc32(0, (const unsigned char*)filename, strlen(filename)));
+
+      if(   pclConfigCacheOpen(&gCustomLibCache, cachePath, gCustomLibMagic, gCustomLibVersion, &buffer) == 1
+         && gCustomLibCache.size == sizeof(gCustomLibArray))
+      {
+         gpCustomLibInfo = (const PersCustomLibInfo*)gCustomLibCache.data;
+      }
+      else if(buffer.st_size > 0)            // check for empty file
       {
          char* customConfFileMap = NULL;
          int i = 0;
@@ -295,7 +326,11 @@ int get_custom_libraries()
             }
             i+=4;       // move to the next configuration file entry
          }
+         (void)munmap(customConfFileMap, (size_t)buffer.st_size);
          close(fd);
+
+         // store the binary form for the next init and the other clients
+         (void)pclConfigCacheStore(cachePath, gCustomLibMagic, gCustomLibVersion, &buffer, gCustomLibArray, sizeof(gCustomLibArray));
       }
       else
       {
@@ -381,6 +416,16 @@ int load_default_library(void* handle)
       {
          DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("load_default_library - error:"), DLT_STRING(error));
       }
+      *(void **) (&plugin_persComRctGetSizeResourcesList) = dlsym(handle, "persComRctGetSizeResourcesList");
+      if ((error = dlerror()) != NULL)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("load_default_library - error:"), DLT_STRING(error));
+      }
+      *(void **) (&plugin_persComRctGetResourcesList) = dlsym(handle, "persComRctGetResourcesList");
+      if ((error = dlerror()) != NULL)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("load_default_library - error:"), DLT_STRING(error));
+      }
 
       /// V A R I A B L E S
       // it is an error if varaibles coulr not be loaded, and will cause an error
@@ -491,7 +536,7 @@ int load_custom_library(PersistenceCustomLibs_e customLib, Pers_custom_functs_s
    if(customLib < PersCustomLib_LastEntry)
    {
       PersInitType_e initType = getCustomInitType(customLib);
-      void* handle = dlopen(gCustomLibArray[customLib].libname, RTLD_LAZY);
+      void* handle = dlopen(gpCustomLibInfo[customLib].libname, RTLD_LAZY);
       customFuncts->handle = handle;
 
       if(customLib == PersCustomLib_default)
@@ -599,15 +644,20 @@ int load_custom_library(PersistenceCustomLibs_e customLib, Pers_custom_functs_s
                  DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("load_custom_library - error:"), DLT_STRING(error));
             }
 
+            // optional functions, the key access falls back to the per resource functions if not provided
+            *(void **) (&customFuncts->custom_plugin_get_data_batch) = dlsym(handle, "plugin_get_data_batch");
+            *(void **) (&customFuncts->custom_plugin_set_data_batch) = dlsym(handle, "plugin_set_data_batch");
+            dlerror();    // reset error
+
             //
             // initialize the library
             //
             if(initType == Init_Synchronous)
             {
-               if( (gPersCustomFuncs[customLib].custom_plugin_init) != NULL)
+               if( (customFuncts->custom_plugin_init) != NULL)
                {
                   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("load_custom_library => (sync)  : "), DLT_STRING(get_custom_client_lib_name(customLib)));
-                  gPersCustomFuncs[customLib].custom_plugin_init();
+                  customFuncts->custom_plugin_init();
                }
                else
                {
@@ -618,12 +668,12 @@ int load_custom_library(PersistenceCustomLibs_e customLib, Pers_custom_functs_s
             }
             else if(initType == Init_Asynchronous)
             {
-               if( (gPersCustomFuncs[customLib].custom_plugin_init_async) != NULL)
+               if( (customFuncts->custom_plugin_init_async) != NULL)
                {
                   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("load_custom_library => (async) : "),
                                           DLT_STRING(get_custom_client_lib_name(customLib)));
 
-                  gPersCustomFuncs[customLib].custom_plugin_init_async(gPlugin_callback_async_t);
+                  customFuncts->custom_plugin_init_async(gPlugin_callback_async_t);
                }
                else
                {
@@ -661,7 +711,7 @@ char* get_custom_client_lib_name(int idx)
 {
    if(idx < PersCustomLib_LastEntry)
    {
-      return gCustomLibArray[idx].libname;
+      return (char*)gpCustomLibInfo[idx].libname;
    }
    else
    {
@@ -676,7 +726,82 @@ int check_valid_idx(int idx)
 
    if(idx < PersCustomLib_LastEntry)
    {
-      rval = gCustomLibArray[idx].valid;
+      rval = gpCustomLibInfo[idx].valid;
+   }
+
+   return rval;
+}
+
+
+int load_custom_plugin(int idx)
+{
+   int rval = 1;
+
+   if(idx < 0 || idx >= PersCustomLib_LastEntry)
+   {
+      return EPERS_DLOPENERROR;
+   }
+
+   pthread_mutex_lock(&gPluginLoadMtx);
+
+   if(__sync_add_and_fetch(&gPluginState[idx], 0) != PluginState_Loaded)
+   {
+      Pers_custom_functs_s customFuncts;
+
+      memset(&customFuncts, 0, sizeof(Pers_custom_functs_s));
+
+      if((rval = load_custom_library(idx, &customFuncts)) > 0)
+      {
+         // publish the functions before the state, readers check the state first
+         gPersCustomFuncs[idx] = customFuncts;
+         __sync_synchronize();
+         (void)__sync_lock_test_and_set(&gPluginState[idx], PluginState_Loaded);
+      }
+      else
+      {
+         if(customFuncts.handle != NULL && idx != PersCustomLib_default)
+         {
+            dlclose(customFuncts.handle);
+         }
+         (void)__sync_lock_test_and_set(&gPluginState[idx], PluginState_NotLoaded);
+      }
+   }
+
+   pthread_mutex_unlock(&gPluginLoadMtx);
+
+   return rval;
+}
+
+
+
+int get_custom_plugin_state(int idx)
+{
+   int rval = PluginState_NotLoaded;
+
+   if(idx >= 0 && idx < PersCustomLib_LastEntry)
+   {
+      rval = __sync_add_and_fetch(&gPluginState[idx], 0);
+   }
+
+   return rval;
+}
+
+
+
+static int load_init_custom_plugin(int idx)
+{
+   int rval = 0;
+
+   if(check_valid_idx(idx) != -1)
+   {
+      if(getCustomLoadingType(idx) == LoadType_PclInit) // check if the plugin must be loaded on pclInitLibrary
+      {
+         if((rval = load_custom_plugin(idx)) <= 0)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("load_custom_plugins => E r r o r could not load plugin: "),
+                                 DLT_STRING(get_custom_client_lib_name(idx)));
+         }
+      }
    }
 
    return rval;
@@ -696,26 +821,15 @@ int load_custom_plugins(plugin_callback_async_t pfInitCompletedCB)
       for(i=0; i < PersCustomLib_LastEntry; i++)
       {
          invalidate_custom_plugin(i);
-      }
 
-      for(i=0; i < PersCustomLib_LastEntry; i++ )
-      {
-         if(check_valid_idx(i) != -1)
+         if(i != PersCustomLib_default && check_valid_idx(i) != -1 && getCustomLoadingType(i) == LoadType_PclInit)
          {
-            if(getCustomLoadingType(i) == LoadType_PclInit) // check if the plugin must be loaded on pclInitLibrary
-            {
-               if((rval = load_custom_library(i, &gPersCustomFuncs[i] )) <= 0)
-               {
-                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("load_custom_plugins => E r r o r could not load plugin: "),
-                                       DLT_STRING(get_custom_client_lib_name(i)));
-               }
-            }
-         }
-         else
-         {
-            continue;
+            // loaded by load_init_custom_plugins, accessing it before is reported as not ready
+            (void)__sync_lock_test_and_set(&gPluginState[i], PluginState_Pending);
          }
       }
+
+      rval = load_init_custom_plugin(PersCustomLib_default);   // the default plugin is needed to access local data
    }
    else
    {
@@ -727,7 +841,26 @@ int load_custom_plugins(plugin_callback_async_t pfInitCompletedCB)
 }
 
 
+int load_init_custom_plugins(void)
+{
+   int rval = 0, i = 0;
+
+   for(i=PersCustomLib_default+1; i < PersCustomLib_LastEntry; i++ )
+   {
+      int loaded = load_init_custom_plugin(i);
+
+      if(loaded != 0)
+      {
+         rval = loaded;
+      }
+   }
+
+   return rval;
+}
+
+
 void invalidate_custom_plugin(int idx)
 {
+   (void)__sync_lock_test_and_set(&gPluginState[idx], PluginState_NotLoaded);
    memset(&gPersCustomFuncs[idx], 0, sizeof(Pers_custom_functs_s));
 }
@@ -84,6 +84,18 @@ typedef enum PersLoadingType_e_
 } PersLoadingType_e;
 
 
+/// indicates the load state of a plugin
+typedef enum PersPluginState_e_
+{
+   /// plugin not loaded
+   PluginState_NotLoaded = 0,
+   /// plugin will be loaded by the background part of the initialization
+   PluginState_Pending   = 1,
+   /// plugin loaded and initialized, the functions in ::gPersCustomFuncs can be used
+   PluginState_Loaded    = 2
+} PersPluginState_e;
+
+
 /// directory structure seat name definition
 char* plugin_gSeat;
 /// path prefix for local write through database /Data/mnt-wt/\<appId\>/\<database_name\>
@@ -139,6 +151,12 @@ signed int (*plugin_persComRctClose)(signed int handlerRCT) ;
 /// read a resourceID's configuration from RCT
 signed int (*plugin_persComRctRead)(signed int handlerRCT, char const * resourceID, PersistenceConfigurationKey_s const * psConfig_out) ;
 
+/// Find the buffer's size needed to accomodate the list of resourceIDs in RCT
+signed int (*plugin_persComRctGetSizeResourcesList)(signed int handlerRCT) ;
+
+/// Get the list of the resourceIDs in RCT
+signed int (*plugin_persComRctGetResourcesList)(signed int handlerRCT, char* listBuffer_out, signed int listBufferSize) ;
+
 
 /**
  * @brief definition of async init callback function.
@@ -210,6 +228,12 @@ typedef struct _Pers_custom_functs_s
    /// sync all data
    int (*custom_plugin_sync)(void);
 
+   /// get the data of several resources (optional)
+   int (*custom_plugin_get_data_batch)(plugin_batch_item_s* items, int numItems);
+
+   /// set the data of several resources (optional)
+   int (*custom_plugin_set_data_batch)(plugin_batch_item_s* items, int numItems);
+
 
 }Pers_custom_functs_s;
 
@@ -258,6 +282,29 @@ int load_default_library(void* handle);
 int load_custom_library(PersistenceCustomLibs_e customLib, Pers_custom_functs_s *customFuncts);
 
 
+/**
+ * @brief load and initialize a custom library and publish its functions in ::gPersCustomFuncs.
+ *        The functions are published after the library has been initialized,
+ *        readers must check the state with ::get_custom_plugin_state before using them.
+ *
+ * @param idx the index to identifying the custom library
+ *
+ * @return 1 if the library is loaded or a negative value with one of the following errors:
+ *  EPERS_COMMON   EPERS_DLOPENERROR
+ */
+int load_custom_plugin(int idx);
+
+
+/**
+ * @brief get the load state of a custom library
+ *
+ * @param idx the index to identifying the custom library
+ *
+ * @return the state, see ::PersPluginState_e
+ */
+int get_custom_plugin_state(int idx);
+
+
 /**
  * @brief get the position in the array
  *
@@ -288,18 +335,33 @@ void invalidate_custom_plugin(int idx);
 
 
 /**
- * @brief load the custom plugins.
+ * @brief load the custom library configuration and the default plugin.
  *        The custom library configuration file will be loaded to see
  *        if there a re plugins that must be loaded in the pclInitLibrary function.
- *        The other plugins will be loaded on demand.
+ *        Only the default plugin will be loaded, the other plugins to be loaded
+ *        on init will be loaded with ::load_init_custom_plugins,
+ *        the remaining plugins will be loaded on demand.
  *
  *
  * @param pfInitCompletedCB the callback function to be called when
  *        a plugin with asyncnonous init function will be laoded
+ *
+ * @return the result of loading the default plugin (1 loaded, 0 not loaded on init),
+ *         or a negative value on error
  */
 int load_custom_plugins(plugin_callback_async_t pfInitCompletedCB);
 
 
+/**
+ * @brief load the plugins, except the default plugin, that must be loaded in the pclInitLibrary function.
+ *        The configuration must have been loaded with ::load_custom_plugins before.
+ *
+ * @return the result of the last plugin loaded (1 loaded), 0 if no plugin has been loaded,
+ *         or a negative value on error
+ */
+int load_init_custom_plugins(void);
+
+
 /**
  * @brief Get the custom loading type.
  *        The loading type is
@@ -37,6 +37,14 @@ int gSyncFd = -1;
 
 int gIsNodeStateManager = 0;
 
+unsigned int gShutdownFlushDeadline = 0;
+
+int gRctPreload = 0;
+
+unsigned int gDbIdleTimeout = 0;
+
+unsigned int gDbMaxOpen = 0;
+
 
 int(* gChangeNotifyCallback)(pclNotification_s * notifyStruct);
 
@@ -116,6 +116,8 @@ enum _PersistenceConstantDef
 	DONT_CREATE_BACKUP   = 0,
 	/// flag to identify if a backup should be created
 	CREATE_BACKUP        = 1,
+	/// backup status: the file is protected by a range journal instead of a full backup copy
+	BackupStatus_Journal = 2,
 	/// flag to identify that resource a not file
    ResIsNoFile          = 0,
    /// flag to identify that resource a file
@@ -126,12 +128,20 @@ enum _PersistenceConstantDef
    FileClosed           = 1,
    /// flag to identify if file has been opened
    FileOpen             = 1,
+   /// file has not been written since the last sync
+   FileDirty_Clean      = 0,
+   /// file has been written since the last sync
+   FileDirty_Written    = 1,
+   /// file has been mapped writable, dirty until it will be closed
+   FileDirty_Mapped     = 2,
    /// make partial Shutdown (close but not free everything)
    Shutdown_Partial      = 0,
    /// make complete Shutdown (close and free everything)
    Shutdown_Full         = 1,
    /// max number of shutdown cancel calls
    Shutdown_MaxCount     = 3,
+   /// number of threads flushing files in parallel on shutdown
+   ShutdownFlushThreads  = 4,
    /// lifecycle shutdown normal
    NsmShutdownNormal       = 1,
    /// lifecycle return OK indicator
@@ -142,6 +152,20 @@ enum _PersistenceConstantDef
    NsmErrorStatus_ResponsePending = 7,
    /// max checksum size
    ChecksumBufSize         = 64,
+   /// min file size in bytes to journal overwritten ranges instead of creating a full backup copy
+   JournalMinFileSize      = 64 * 1024,
+   /// number of files in the verification ledger
+   VerifyLedgerSize        = 128,
+   /// number of folders cached by pclCreateFile
+   DirCacheSize            = 16,
+   /// resource configuration table index is not built
+   RctIndex_None           = 0,
+   /// resource configuration table index is built
+   RctIndex_Built          = 1,
+   /// resource configuration table index could not be built, the table will be read
+   RctIndex_Failed         = -1,
+   /// size of the buffer to read resource configuration table change events
+   RctWatchBufferSize      = 4096,
    /// max character sub match size
    DbusSubMatchSize        = 12,
    /// max character size of the dbus match rule size
@@ -152,8 +176,40 @@ enum _PersistenceConstantDef
    PrctDbTableSize         = 1024,
    /// write buffer size
    RDRWBufferSize          = 1024,
-   /// database table size
-   DbTableSize             = 1024,
+   /// number of buckets of the open database registry, power of two
+   DbRegistryBuckets       = 64,
+   /// database backend: persistence common database plugin
+   DbBackend_Plugin        = 0,
+   /// database backend: log-structured key/value database
+   DbBackend_Log           = 1,
+   /// max number of open log-structured key/value databases
+   MaxKvLogHandles         = 64,
+   /// initial number of slots of a log database index, power of two
+   KvLogIndexSlots         = 256,
+   /// min number of dead bytes in a log database before it will be compacted
+   KvLogCompactMinDead     = 64 * 1024,
+   /// min percentage of dead bytes in a log database before it will be compacted
+   KvLogCompactDeadPercent = 50,
+   /// time in ms without database access before the background compaction starts
+   KvLogCompactIdleMs      = 500,
+   /// number of bytes copied by the background compaction before the database is unlocked
+   KvLogCompactBatchSize   = 64 * 1024,
+   /// max number of bytes per second copied by the background compaction
+   KvLogCompactIoBudget    = 1024 * 1024,
+   /// number of logical database ids with separate access statistics
+   StatLdbidSlots          = 256,
+   /// number of resources tracked by the access statistics, power of two
+   StatResourceSlots       = 256,
+   /// number of slots probed for a resource, the least accessed one is replaced if all are used
+   StatResourceProbe       = 8,
+   /// number of events in the trace ring buffer of a thread, power of two
+   TraceRingSize           = 256,
+   /// number of resources with a cached custom storage plugin resolution, power of two
+   CustomResourceSlots     = 64,
+   /// max size of the path of a resource passed to a custom storage plugin
+   CustomPathKeySize       = 128,
+   /// max number of keys accessed with one batch, larger batches are split
+   KeyBatchSize            = 32,
    /// persistence administration service block access
    PasMsg_Block            = 0x0001,
    /// persistence administration service unblock access
@@ -168,6 +224,12 @@ enum _PersistenceConstantDef
    PasErrorStatus_FAIL     = 0x8000,
    /// max number of parallel open persistence handles
    MaxPersHandle = 512,
+   /// max number of outstanding asynchronous file requests
+   MaxAsyncFileRequests = 64,
+   /// number of worker threads executing asynchronous file requests
+   AsyncFileWorkerThreads = 2,
+   /// delay in ms before a failed interval sync will be retried
+   FileSyncRetryMs = 1000,
    /// length of the config key responsible name
    MaxConfKeyLengthResp    = 32,
    /// length of the config key custom name
@@ -275,6 +337,18 @@ extern int gSyncFd;
 /// flag to didicate if the lib is used by the NodeStateManager (appid)
 extern int gIsNodeStateManager;
 
+/// max time in ms to flush open files on shutdown, 0 if not limited
+extern unsigned int gShutdownFlushDeadline;
+
+/// flag to indicate if resource configuration tables will be loaded in full into an index
+extern int gRctPreload;
+
+/// time in ms after which an unused database will be closed, 0 if not limited
+extern unsigned int gDbIdleTimeout;
+
+/// max number of open databases, 0 if not limited
+extern unsigned int gDbMaxOpen;
+
 
 /// application id
 extern char gAppId[PERS_RCT_MAX_LENGTH_RESPONSIBLE] __attribute__ ((visibility ("hidden")));
@@ -22,20 +22,107 @@
 #include "persistence_client_library_dbus_service.h"
 #include "persistence_client_library_prct_access.h"
 #include "persistence_client_library_tree_helper.h"
+#include "persistence_client_library_kvlog.h"
+#include "persistence_client_library_statistics.h"
 #include "crc32.h"
 
 #include <persComErrors.h>
 
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
 #include <dlt.h>
 
 DLT_IMPORT_CONTEXT(gPclDLTContext);
 
 
 
-/// btree array
-static int gHandlesDB[DbTableSize][PersistenceDB_LastEntry];
-static int gHandlesDBCreated[DbTableSize][PersistenceDB_LastEntry] = { {0} };
+/// open database registry entry
+typedef struct _PclDbEntry_s
+{
+   /// storage ::PersistenceStorage_e
+   unsigned int storage;
+   /// logical database id
+   unsigned int ldbid;
+   /// database type ::PersistencePolicy_e or ::PersistenceDB_e
+   int dbType;
+   /// crc32 of the database path
+   uint32_t hash;
+   /// the database handle
+   int handle;
+   /// the database backend ::DbBackend_Plugin or ::DbBackend_Log
+   int backend;
+   /// number of users of the handle, the database will only be closed if not used
+   int refCount;
+   /// time of the last use in microseconds
+   unsigned long long lastUsed;
+   /// path of the database
+   char* path;
+   /// next entry in the bucket
+   struct _PclDbEntry_s* next;
+} PclDbEntry_s;
+
+/// custom storage plugin resolved for a resource
+typedef struct _PclCustomResource_s
+{
+   /// crc32 of the resource id, 0 if the entry is empty
+   uint32_t hash;
+   /// logical database id
+   unsigned int ldbid;
+   /// generation of the resource configuration table the entry has been resolved with
+   unsigned int generation;
+   /// the custom plugin ::PersistenceCustomLibs_e
+   int idx;
+   /// the resource id
+   char resource_id[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// path of the resource passed to the plugin
+   char pathKey[CustomPathKeySize];
+} PclCustomResource_s;
+
+/// plugin handle opened for a key handle on a custom storage resource
+typedef struct _PclCustomHandle_s
+{
+   /// 1 if a plugin handle is open
+   int isOpen;
+   /// the plugin handle
+   int handle;
+   /// the custom plugin ::PersistenceCustomLibs_e
+   int idx;
+   /// logical database id
+   unsigned int ldbid;
+   /// generation of the resource configuration table the plugin handle has been opened with
+   unsigned int generation;
+   /// 1 if the resource is read only, the plugin handle is only used to read
+   int readOnly;
+} PclCustomHandle_s;
+
+/// open databases, hashed by the database key
+static PclDbEntry_s* gDbRegistry[DbRegistryBuckets] = {NULL};
+/// number of open databases
+static unsigned int gDbOpenCount = 0;
+/// time of the last check for idle databases in microseconds
+static unsigned long long gDbLastIdleCheck = 0;
+/// mutex to protect the database registry
+static pthread_mutex_t gDbRegistryMtx = PTHREAD_MUTEX_INITIALIZER;
+/// database backend of the cached and write through databases, indexed by the logical database id
+static unsigned char gDbBackend[256] = {0};
+/// log database filename postfix (appended to the database path)
+static const char* gDbLogPostfix = ".kvl";
+/// postfix of the log database while the plugin database is imported (appended to the log path)
+static const char* gDbImportPostfix = ".import";
+/// custom storage plugins resolved for the recently accessed resources, hashed by the resource id
+static PclCustomResource_s gCustomResource[CustomResourceSlots];
+/// mutex to protect the resolved custom storage plugins
+static pthread_mutex_t gCustomResourceMtx = PTHREAD_MUTEX_INITIALIZER;
+/// plugin handles of the key handles, indexed by the key handle
+static PclCustomHandle_s gCustomHandle[MaxPersHandle];
+/// mutex to protect the plugin handles, held while a plugin handle is used
+static pthread_mutex_t gCustomHandleMtx = PTHREAD_MUTEX_INITIALIZER;
 
 /// tree to store notification information
 static jsw_rbtree_t *gNotificationTree = NULL;
@@ -51,84 +138,557 @@ void deleteNotifyTree(void)
 }
 
 
-static int database_get(PersistenceInfo_s* info, const char* dbPath, int dbType)
+static unsigned long long database_now_us(void)
 {
-   unsigned int arrayIdx = 0;
-   int handleDB = -1;
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return (unsigned long long)now.tv_sec * 1000000ULL + (unsigned long long)now.tv_nsec / 1000ULL;
+}
+
+
+
+static unsigned int database_bucket(uint32_t hash, unsigned int storage, unsigned int ldbid, int dbType)
+{
+   return (hash ^ (storage * 0x9E3779B1U) ^ (ldbid * 0x85EBCA6BU) ^ (unsigned int)dbType) & (DbRegistryBuckets - 1);
+}
+
 
-   // create array index: index is a combination of resource configuration table type and group
-   arrayIdx = info->configKey.storage + info->context.ldbid ;
 
-   if(arrayIdx < DbTableSize)
+int database_set_backend(unsigned int ldbid, int backend)
+{
+   int rval = -1;
+
+   if(ldbid < sizeof(gDbBackend) && (backend == DbBackend_Plugin || backend == DbBackend_Log))
    {
-      unsigned char openFlags = 0x01;   // by default create file if not existing
+      pthread_mutex_lock(&gDbRegistryMtx);
+      gDbBackend[ldbid] = (unsigned char)backend;
+      pthread_mutex_unlock(&gDbRegistryMtx);
+      rval = 0;
+   }
+
+   return rval;
+}
 
-      if(gHandlesDBCreated[arrayIdx][dbType] == 0)
-      {
-         char path[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
 
-         if(PersistencePolicy_wt == dbType)				/// write through database
+
+/**
+ * Copy all keys of the plugin database to a new log database.
+ * The keys are written to an import log without syncing each key, the import log
+ * is committed once and renamed to the log path. An interrupted import leaves no log,
+ * the import will be repeated on the next open.
+ *
+ * @return 0 on success or if there is no plugin database, a negative value on error
+ */
+static int database_import(const char* path, unsigned char openFlags, const char* logPath)
+{
+   int rval = 0, handleDB = -1;
+
+   if(   *plugin_persComDbOpen == NULL || *plugin_persComDbClose == NULL || *plugin_persComDbReadKey == NULL
+      || *plugin_persComDbGetSizeKeysList == NULL || *plugin_persComDbGetKeysList == NULL)
+   {
+      return 0;
+   }
+
+   // don't create the plugin database if not existing
+   handleDB = plugin_persComDbOpen(path, (unsigned char)(openFlags & 0x02));
+   if(handleDB >= 0)
+   {
+      char importPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+      int listSize = plugin_persComDbGetSizeKeysList(handleDB);
+      char* list = (listSize > 0) ? malloc((size_t)listSize) : NULL;
+      char* buffer = malloc(PERS_DB_MAX_SIZE_KEY_DATA);
+      int numKeys = 0, logHandle = -1;
+
+      snprintf(importPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", logPath, gDbImportPostfix);
+
+      // left over by an interrupted import
+      pclKvLogRemove(importPath);
+
+      if(listSize < 0 || (listSize > 0 && list == NULL) || buffer == NULL)
+      {
+         rval = (listSize < 0) ? listSize : EPERS_COMMON;
+      }
+      else if((logHandle = pclKvLogOpen(importPath, 0, NULL)) < 0)
+      {
+         rval = logHandle;
+      }
+      else
+      {
+         if(listSize > 0)
          {
-            /// 0x02 ==> open database in write through mode,keep bit 1 set in order to create db if not existing
-            openFlags |= 0x02;
-            snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalWt);
+            int pos = 0;
+
+            rval = plugin_persComDbGetKeysList(handleDB, list, listSize);
+            rval = (rval < 0) ? rval : 0;
+
+            while(rval == 0 && pos < listSize && list[pos] != '\0')
+            {
+               const char* key = &list[pos];
+               int size = plugin_persComDbReadKey(handleDB, key, buffer, PERS_DB_MAX_SIZE_KEY_DATA);
+
+               if(size < 0)
+               {
+                  rval = size;
+               }
+               else if((rval = pclKvLogWriteKey(logHandle, key, buffer, size)) >= 0)
+               {
+                  rval = 0;
+                  numKeys++;
+               }
+               pos += (int)strlen(key) + 1;
+            }
          }
-         else if(PersistencePolicy_wc == dbType)		// cached database
+
+         // the import log is committed once when closed
+         if(pclKvLogClose(logHandle) < 0 && rval == 0)
          {
-            snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalCached);
+            rval = EPERS_COMMON;
          }
-         else if(PersistenceDB_confdefault == dbType)	// configurable default database
-			{
-			  snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalConfigurableDefault);
-			}
-			else if(PersistenceDB_default == dbType)		// default database
-			{
-			  snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalFactoryDefault);
-			}
-         else
+
+         if(rval == 0)
          {
-            handleDB = -2;
+            rval = pclKvLogRename(importPath, logPath);
          }
+      }
+
+      if(rval == 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("dbImport - imported keys:"), DLT_INT(numKeys), DLT_STRING("from:"), DLT_STRING(path));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbImport - failed to import:"), DLT_STRING(path), DLT_INT(rval));
+         pclKvLogRemove(importPath);
+      }
+
+      free(buffer);
+      free(list);
+      (void)plugin_persComDbClose(handleDB);
+   }
+
+   return rval;
+}
+
+
+
+/// open a database with the backend selected for the logical database
+static int database_open(const char* path, unsigned char openFlags, unsigned int ldbid, int dbType, int* backend)
+{
+   int handleDB = EPERS_NO_PLUGIN_FUNCT;
+
+   *backend = DbBackend_Plugin;
+
+   // the default databases are provided by the plugin database format
+   if(   (PersistencePolicy_wc == dbType || PersistencePolicy_wt == dbType)
+      && ldbid < sizeof(gDbBackend) && gDbBackend[ldbid] == DbBackend_Log)
+   {
+      char logPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+      snprintf(logPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", path, gDbLogPostfix);
+
+      // the keys of the plugin database are imported before the log database is used the first time
+      handleDB = (access(logPath, F_OK) == -1) ? database_import(path, openFlags, logPath) : 0;
+      if(handleDB >= 0)
+      {
+         handleDB = pclKvLogOpen(logPath, (PersistencePolicy_wt == dbType) ? 1 : 0, NULL);
+      }
+
+      if(handleDB >= 0)
+      {
+         *backend = DbBackend_Log;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbOpen - failed to open log db:"), DLT_STRING(logPath), DLT_INT(handleDB));
+      }
+   }
+   else if(*plugin_persComDbOpen != NULL)
+   {
+      handleDB = plugin_persComDbOpen(path, openFlags);
+      if(handleDB < 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbOpen - persComDbOpen() failed"));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbOpen - EPERS_NO_PLUGIN_FUNCT"));
+   }
+
+   return handleDB;
+}
+
+
+
+static int database_read_key(PclDbEntry_s* entry, const char* key, char* buffer, int bufferSize)
+{
+   if(entry->backend == DbBackend_Log)
+   {
+      return pclKvLogReadKey(entry->handle, key, buffer, bufferSize);
+   }
+
+   return plugin_persComDbReadKey(entry->handle, key, buffer, bufferSize);
+}
+
+
+
+static int database_write_key(PclDbEntry_s* entry, const char* key, const char* data, int dataSize, PclKvLogCommit_s* commit)
+{
+   if(entry->backend == DbBackend_Log)
+   {
+      if(commit != NULL)
+      {
+         return pclKvLogAppendKey(entry->handle, key, data, dataSize, commit);
+      }
+      return pclKvLogWriteKey(entry->handle, key, data, dataSize);
+   }
+
+   return plugin_persComDbWriteKey(entry->handle, key, data, dataSize);
+}
+
+
+
+static int database_get_key_size(PclDbEntry_s* entry, const char* key)
+{
+   if(entry->backend == DbBackend_Log)
+   {
+      return pclKvLogGetKeySize(entry->handle, key);
+   }
+
+   return plugin_persComDbGetKeySize(entry->handle, key);
+}
 
-         if (handleDB == -1)
+
+
+static int database_delete_key(PclDbEntry_s* entry, const char* key)
+{
+   if(entry->backend == DbBackend_Log)
+   {
+      return pclKvLogDeleteKey(entry->handle, key);
+   }
+
+   return plugin_persComDbDeleteKey(entry->handle, key);
+}
+
+
+
+static int database_close_entry(PclDbEntry_s* entry, unsigned int* durationUs)
+{
+   int iErrorCode = EPERS_NO_PLUGIN_FUNCT;
+
+   if(entry->backend == DbBackend_Log)
+   {
+      unsigned long long start = database_now_us();
+
+      iErrorCode = pclKvLogClose(entry->handle);
+      if(durationUs != NULL)
+      {
+         *durationUs = (unsigned int)(database_now_us() - start);
+      }
+   }
+   else if(*plugin_persComDbClose != NULL)
+   {
+      unsigned long long start = database_now_us();
+
+      iErrorCode = plugin_persComDbClose(entry->handle);
+      if(durationUs != NULL)
+      {
+         *durationUs = (unsigned int)(database_now_us() - start);
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbClose - plugin function NULL"));
+   }
+
+   return iErrorCode;
+}
+
+
+
+/// close databases not used for longer than the idle time, and the least recently used ones above the max number
+static void database_evict(unsigned long long now, unsigned int keepOpen)
+{
+   unsigned int b = 0;
+
+   if(gDbIdleTimeout != 0 && now - gDbLastIdleCheck >= (unsigned long long)gDbIdleTimeout * 500ULL)
+   {
+      gDbLastIdleCheck = now;
+
+      for(b=0; b<DbRegistryBuckets; b++)
+      {
+         PclDbEntry_s** link = &gDbRegistry[b];
+
+         while(*link != NULL)
          {
-            if(*plugin_persComDbOpen != NULL)
+            PclDbEntry_s* entry = *link;
+
+            if(   entry->refCount == 0
+               && now - entry->lastUsed >= (unsigned long long)gDbIdleTimeout * 1000ULL
+               && database_close_entry(entry, NULL) >= 0)
             {
-               handleDB = plugin_persComDbOpen(path, openFlags);
-               if(handleDB >= 0)
-               {
-                  gHandlesDB[arrayIdx][dbType] = handleDB ;
-                  gHandlesDBCreated[arrayIdx][dbType] = 1;
-               }
-               else
-               {
-                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - persComDbOpen() failed"));
-               }
+               DLT_LOG(gPclDLTContext, DLT_LOG_DEBUG, DLT_STRING("dbEvict - closed idle db:"), DLT_STRING(entry->path));
+               *link = entry->next;
+               free(entry->path);
+               free(entry);
+               gDbOpenCount--;
             }
             else
             {
-               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - EPERS_NO_PLUGIN_FUNCT"));
-               handleDB = EPERS_NO_PLUGIN_FUNCT;
+               link = &entry->next;
             }
          }
-         else
+      }
+   }
+
+   while(gDbMaxOpen != 0 && gDbOpenCount + keepOpen > gDbMaxOpen)
+   {
+      PclDbEntry_s** oldest = NULL;
+
+      for(b=0; b<DbRegistryBuckets; b++)
+      {
+         PclDbEntry_s** link = NULL;
+
+         for(link = &gDbRegistry[b]; *link != NULL; link = &(*link)->next)
          {
-            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - wrong policy! Cannot extend dbPath wit db."));
+            if((*link)->refCount == 0 && (oldest == NULL || (*link)->lastUsed < (*oldest)->lastUsed))
+            {
+               oldest = link;
+            }
          }
       }
+
+      if(oldest != NULL && database_close_entry(*oldest, NULL) >= 0)
+      {
+         PclDbEntry_s* entry = *oldest;
+
+         DLT_LOG(gPclDLTContext, DLT_LOG_DEBUG, DLT_STRING("dbEvict - closed lru db:"), DLT_STRING(entry->path));
+         *oldest = entry->next;
+         free(entry->path);
+         free(entry);
+         gDbOpenCount--;
+      }
       else
       {
-         handleDB = gHandlesDB[arrayIdx][dbType];
+         break;      // all databases are in use, exceed the max number
       }
    }
+}
+
+
+
+static int database_get(PersistenceInfo_s* info, const char* dbPath, int dbType, PclDbEntry_s** dbEntry)
+{
+   int handleDB = -1;
+   unsigned char openFlags = 0x01;   // by default create file if not existing
+   char path[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+   if(PersistencePolicy_wt == dbType)				/// write through database
+   {
+      /// 0x02 ==> open database in write through mode,keep bit 1 set in order to create db if not existing
+      openFlags |= 0x02;
+      snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalWt);
+   }
+   else if(PersistencePolicy_wc == dbType)		// cached database
+   {
+      snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalCached);
+   }
+   else if(PersistenceDB_confdefault == dbType)	// configurable default database
+   {
+      snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalConfigurableDefault);
+   }
+   else if(PersistenceDB_default == dbType)		// default database
+   {
+      snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalFactoryDefault);
+   }
    else
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - inval storage type"), DLT_STRING(dbPath));
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - wrong policy! Cannot extend dbPath wit db."));
+      return -2;
+   }
+
+   if(pthread_mutex_lock(&gDbRegistryMtx) == 0)
+   {
+      unsigned long long now = database_now_us();
+      uint32_t hash = pclCrc32(0, (const unsigned char*)path, strlen(path));
+      unsigned int bucket = database_bucket(hash, info->configKey.storage, info->context.ldbid, dbType);
+      PclDbEntry_s* entry = gDbRegistry[bucket];
+
+      while(entry != NULL)    // find the database with the exact key
+      {
+         if(   entry->hash == hash && entry->storage == info->configKey.storage && entry->ldbid == info->context.ldbid
+            && entry->dbType == dbType && strcmp(entry->path, path) == 0)
+         {
+            break;
+         }
+         entry = entry->next;
+      }
+
+      if(entry == NULL)
+      {
+         int backend = DbBackend_Plugin;
+
+         pers_stat_count(info->context.ldbid, PclStat_DbCacheMiss);
+         database_evict(now, 1);
+
+         handleDB = database_open(path, openFlags, info->context.ldbid, dbType, &backend);
+         if(handleDB >= 0)
+         {
+            entry = malloc(sizeof(PclDbEntry_s));
+            if(entry != NULL)
+            {
+               entry->storage  = info->configKey.storage;
+               entry->ldbid    = info->context.ldbid;
+               entry->dbType   = dbType;
+               entry->hash     = hash;
+               entry->handle   = handleDB;
+               entry->backend  = backend;
+               entry->refCount = 0;
+               entry->path     = strdup(path);
+               entry->next     = gDbRegistry[bucket];
+               gDbRegistry[bucket] = entry;
+               gDbOpenCount++;
+            }
+            else
+            {
+               PclDbEntry_s closeEntry = {0};
+
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - failed to register db"));
+               closeEntry.handle  = handleDB;
+               closeEntry.backend = backend;
+               (void)database_close_entry(&closeEntry, NULL);
+               handleDB = EPERS_COMMON;
+            }
+         }
+      }
+      else
+      {
+         handleDB = entry->handle;
+         pers_stat_count(info->context.ldbid, PclStat_DbCacheHit);
+         database_evict(now, 0);
+      }
+
+      if(entry != NULL)
+      {
+         entry->refCount++;
+         entry->lastUsed = now;
+         *dbEntry = entry;
+      }
+
+      pthread_mutex_unlock(&gDbRegistryMtx);
    }
+
    return handleDB;
 }
 
 
+
+static void database_put(PclDbEntry_s* dbEntry)
+{
+   if(dbEntry != NULL)
+   {
+      pthread_mutex_lock(&gDbRegistryMtx);
+      dbEntry->refCount--;
+      dbEntry->lastUsed = database_now_us();
+      pthread_mutex_unlock(&gDbRegistryMtx);
+   }
+}
+
+
+/// get the functions of the custom storage plugin of a resource and the path of the resource in the plugin.
+/// The plugin and path are resolved once per resource until the resource configuration changes,
+/// a plugin loaded on demand will be loaded on the first access.
+static Pers_custom_functs_s* custom_resource_get(const PersistenceInfo_s* info, const char* dbPath, const char* key, char pathKey[])
+{
+   int idx = PersCustomLib_LastEntry;
+   size_t keyLen = strlen(key);
+   uint32_t hash = pclCrc32(info->context.ldbid, (const unsigned char*)key, keyLen) | 1U;
+   unsigned int generation = get_rct_generation(info->context.ldbid);
+   PclCustomResource_s* entry = &gCustomResource[hash & (CustomResourceSlots - 1)];
+
+   pthread_mutex_lock(&gCustomResourceMtx);
+
+   if(   entry->hash == hash && entry->ldbid == info->context.ldbid && entry->generation == generation
+      && strcmp(entry->resource_id, key) == 0)
+   {
+      idx = entry->idx;
+      memcpy(pathKey, entry->pathKey, CustomPathKeySize);
+   }
+   else
+   {
+      idx = custom_client_name_to_id(dbPath, 1);
+
+      if(info->configKey.customID[0] == '\0')   // if we have not a customID we use the key
+      {
+         snprintf(pathKey, CustomPathKeySize, "0x%08X/%s/%s", info->context.ldbid, info->configKey.custom_name, key);
+      }
+      else
+      {
+         snprintf(pathKey, CustomPathKeySize, "0x%08X/%s", info->context.ldbid, info->configKey.customID);
+      }
+
+      if(keyLen < PERS_DB_MAX_LENGTH_KEY_NAME)
+      {
+         entry->hash       = hash;
+         entry->ldbid      = info->context.ldbid;
+         entry->generation = generation;
+         entry->idx        = idx;
+         memcpy(entry->resource_id, key, keyLen + 1);
+         memcpy(entry->pathKey, pathKey, CustomPathKeySize);
+      }
+   }
+
+   pthread_mutex_unlock(&gCustomResourceMtx);
+
+   if(idx >= PersCustomLib_LastEntry)
+   {
+      return NULL;
+   }
+
+   if(get_custom_plugin_state(idx) == PluginState_NotLoaded && getCustomLoadingType(idx) == LoadType_OnDemand)
+   {
+      // plugin not loaded, try to load the requested plugin
+      (void)load_custom_plugin(idx);
+   }
+
+   if(get_custom_plugin_state(idx) != PluginState_Loaded)
+   {
+      return NULL;
+   }
+
+   return &gPersCustomFuncs[idx];
+}
+
+
+
+/// error code if the plugin function of a custom storage resource is not available.
+/// EPERS_NOT_READY if the plugin will be loaded by the background initialization still in progress,
+/// EPERS_COMMON if the plugin is not loaded because its loading type is unknown.
+static int custom_resource_error(const char* dbPath)
+{
+   int idx = custom_client_name_to_id(dbPath, 1);
+   int state = get_custom_plugin_state(idx);
+
+   if(state == PluginState_Pending)
+   {
+      return EPERS_NOT_READY;
+   }
+
+   if(   state == PluginState_NotLoaded && idx >= 0 && idx < PersCustomLib_LastEntry
+      && getCustomLoadingType(idx) != LoadType_OnDemand && getCustomLoadingType(idx) != LoadType_PclInit)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("customResource - Plugin not avail, unknown loading type: "),
+                                            DLT_INT(getCustomLoadingType(idx)));
+      return EPERS_COMMON;
+   }
+
+   return EPERS_NOPLUGINFUNCT;
+}
+
+
+
 int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned char* buffer, unsigned int buffer_size, PersGetDefault_e job)
 {
    PersDefaultType_e i = PersDefaultType_Configurable;
@@ -137,13 +697,15 @@ int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned
 
    for(i=(int)PersistenceDB_confdefault; i<(int)PersistenceDB_LastEntry; i++)
    {
-   	handleDefaultDB = database_get(info, dbPath, i);
+      PclDbEntry_s* dbEntry = NULL;
+
+      handleDefaultDB = database_get(info, dbPath, i, &dbEntry);
       if(handleDefaultDB >= 0)
       {
          if (PersGetDefault_Data == job)
          {
-            if(*plugin_persComDbReadKey != NULL)
-               read_size = plugin_persComDbReadKey(handleDefaultDB, key, (char*)buffer, (signed int)buffer_size);
+            if(dbEntry->backend == DbBackend_Log || *plugin_persComDbReadKey != NULL)
+               read_size = database_read_key(dbEntry, key, (char*)buffer, (signed int)buffer_size);
             else
             {
                DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("getDefaults - EPERS_NO_PLUGIN_FUNCT"));
@@ -152,8 +714,8 @@ int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned
          }
          else if (PersGetDefault_Size == job)
          {
-            if(*plugin_persComDbGetKeySize != NULL)
-               read_size = plugin_persComDbGetKeySize(handleDefaultDB, key);
+            if(dbEntry->backend == DbBackend_Log || *plugin_persComDbGetKeySize != NULL)
+               read_size = database_get_key_size(dbEntry, key);
             else
             {
                DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("getDefaults - EPERS_NO_PLUGIN_FUNCT"));
@@ -163,8 +725,10 @@ int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned
          else
          {
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("getDefaults - unknown job"));
+            database_put(dbEntry);
             break;
          }
+         database_put(dbEntry);
 
          if(read_size < 0) // check read_size
          {
@@ -185,68 +749,139 @@ int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned
             }
             DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("getDefaults - default data will be used for Key"), DLT_STRING(key),
                                                   DLT_STRING("from"), DLT_STRING(dltMessage));
+            pers_stat_count(info->context.ldbid, PclStat_DefaultFallback);
             break;
          }
       }
    }
 
-   if (read_size < 0)
-   {
-       DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("getDefaults - default data not available for Key"), DLT_STRING(key),
-                                             DLT_STRING("Path:"), DLT_STRING(dbPath));
-   }
+   if (read_size < 0)
+   {
+       DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("getDefaults - default data not available for Key"), DLT_STRING(key),
+                                             DLT_STRING("Path:"), DLT_STRING(dbPath));
+   }
+
+   return read_size;
+}
+
+
+
+void shutdown_slowest_insert(pclShutdownSlowest_s* slowest, unsigned int duration, const char* path)
+{
+   int i = 0, pos = 0;
+
+   // find the first entry faster than the new one, unused entries have no path
+   while(pos < PCL_SHUTDOWN_TIMING_SLOWEST
+         && slowest[pos].path[0] != '\0'
+         && slowest[pos].duration >= duration)
+   {
+      pos++;
+   }
+
+   if(pos < PCL_SHUTDOWN_TIMING_SLOWEST)
+   {
+      for(i=PCL_SHUTDOWN_TIMING_SLOWEST-1; i>pos; i--)
+      {
+         slowest[i] = slowest[i-1];
+      }
+      slowest[pos].duration = duration;
+      snprintf(slowest[pos].path, sizeof(slowest[pos].path), "%s", path);
+   }
+}
+
+
+
+int database_close_all(pclShutdownSlowest_s* slowest)
+{
+   int numClosed = 0;
+   unsigned int b = 0;
+
+   pthread_mutex_lock(&gDbRegistryMtx);
+
+   for(b=0; b<DbRegistryBuckets; b++)
+   {
+      PclDbEntry_s** link = &gDbRegistry[b];
+
+      while(*link != NULL)
+      {
+         PclDbEntry_s* entry = *link;
+         unsigned int duration = 0;
+         int iErrorCode = database_close_entry(entry, &duration);
+
+         if(iErrorCode == EPERS_NO_PLUGIN_FUNCT)
+         {
+            break;
+         }
+
+         DLT_LOG(gPclDLTContext, DLT_LOG_DEBUG, DLT_STRING("dbCloseAll - closed db:"), DLT_STRING(entry->path),
+                                                DLT_STRING("us:"), DLT_UINT(duration));
+         if(slowest != NULL)
+         {
+            shutdown_slowest_insert(slowest, duration, entry->path);
+         }
+
+         if (iErrorCode < 0)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbCloseAll - Err close db"));
+            link = &entry->next;
+         }
+         else
+         {
+            *link = entry->next;
+            free(entry->path);
+            free(entry);
+            gDbOpenCount--;
+            numClosed++;
+         }
+      }
+   }
+
+   pthread_mutex_unlock(&gDbRegistryMtx);
 
-   return read_size;
+   pclKvLogDeinit();
+
+   return numClosed;
 }
 
 
 
-void database_close_all()
+/// get the default data of a custom storage resource if the plugin has no data, returns read_size if no default data is available
+static int custom_get_defaults(char* dbPath, char* key, const char* resourceID, PersistenceInfo_s* info,
+                               unsigned char* buffer, int buffer_size, int read_size)
 {
-   int i = 0, j = 0;
+   int ret_defaults = -1;
+
+   info->configKey.policy = PersistencePolicy_wc;			 // Set the policy
+   info->configKey.type   = PersistenceResourceType_key;  // Set the type
 
-   for(i=0; i<DbTableSize; i++)
+   (void)get_db_path_and_key(info, key, NULL, dbPath);
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("getData - Plugin data not available - get default data of key:"), DLT_STRING(key));
+   ret_defaults = pers_get_defaults(dbPath, (char*)resourceID, info, buffer, (unsigned int)buffer_size, PersGetDefault_Data);
+   if (0 < ret_defaults)
    {
-   	for(j=0; j < PersistenceDB_LastEntry; j++)
-   	{
-			if(gHandlesDBCreated[i][j] == 1)
-			{
-			   if(*plugin_persComDbClose != NULL)
-			   {
-               int iErrorCode = plugin_persComDbClose(gHandlesDB[i][j]);
-               if (iErrorCode < 0)
-               {
-                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbCloseAll - Err close db"));
-               }
-               else
-               {
-                   gHandlesDBCreated[i][j] = 0;
-               }
-			   }
-			   else
-			   {
-			      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbCloseAll - plugin function NULL"));
-			   }
-			}
-   	}
+      read_size = ret_defaults;
    }
+
+   return read_size;
 }
 
 
 
 int persistence_get_data(char* dbPath, char* key, const char* resourceID, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size)
 {
-   int read_size = -1, ret_defaults = -1;
+   int read_size = -1;
 
    if(   PersistenceStorage_shared == info->configKey.storage
       || PersistenceStorage_local == info->configKey.storage)
    {
-      int handleDB = database_get(info, dbPath, info->configKey.policy);
+      PclDbEntry_s* dbEntry = NULL;
+      int handleDB = database_get(info, dbPath, info->configKey.policy, &dbEntry);
       if(handleDB >= 0)
       {
-         if(*plugin_persComDbReadKey != NULL)
+         if(dbEntry->backend == DbBackend_Log || *plugin_persComDbReadKey != NULL)
          {
-            read_size = plugin_persComDbReadKey(handleDB, key, (char*)buffer, buffer_size);
+            read_size = database_read_key(dbEntry, key, (char*)buffer, buffer_size);
             if(read_size < 0)
             {
                read_size = pers_get_defaults(dbPath, (char*)resourceID, info, buffer, (unsigned int)buffer_size, PersGetDefault_Data); /* 0 ==> Get data */
@@ -257,86 +892,26 @@ int persistence_get_data(char* dbPath, char* key, const char* resourceID, Persis
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("getData - EPERS_NO_PLUGIN_FUNCT"));
             read_size = EPERS_NO_PLUGIN_FUNCT;
          }
+         database_put(dbEntry);
       }
    }
    else if(PersistenceStorage_custom == info->configKey.storage)   // custom storage implementation via custom library
    {
-      int idx =  custom_client_name_to_id(dbPath, 1);
-      char workaroundPath[128];  								         // workaround, because /sys/ can not be accessed on host!!!!
-      snprintf(workaroundPath, 128, "%s%s", "/Data", dbPath  );
-
-      if(idx < PersCustomLib_LastEntry)
-      {
-      	int available = 0;
-      	if(gPersCustomFuncs[idx].custom_plugin_get_size == NULL )
-			{
-				if(getCustomLoadingType(idx) == LoadType_OnDemand)
-				{
-					// plugin not loaded, try to load the requested plugin
-					if(load_custom_library(idx, &gPersCustomFuncs[idx]) == 1)
-					{
-						// check again if the plugin function is now available
-						if(gPersCustomFuncs[idx].custom_plugin_get_data != NULL)
-						{
-							available = 1;
-						}
-					}
-				}
-				else if(getCustomLoadingType(idx) == LoadType_PclInit)
-				{
-					if(gPersCustomFuncs[idx].custom_plugin_get_data != NULL)
-					{
-						available = 1;
-					}
-				}
-				else
-				{
-					 DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("getData - Plugin not avail, unknown loading type: "),
-					                                       DLT_INT(getCustomLoadingType(idx)));
-					 read_size = EPERS_COMMON;
-				}
-			}
-      	else
-      	{
-      		available = 1;	// already loaded
-      	}
-
-      	if(available == 1)
-      	{
-				char pathKeyString[128] = {0};
-				if(info->configKey.customID[0] == '\0')   // if we have not a customID we use the key
-				{
-					snprintf(pathKeyString, 128, "0x%08X/%s/%s", info->context.ldbid, info->configKey.custom_name, key);
-				}
-				else
-				{
-					snprintf(pathKeyString, 128, "0x%08X/%s", info->context.ldbid, info->configKey.customID);
-				}
-				read_size = gPersCustomFuncs[idx].custom_plugin_get_data(pathKeyString, (char*)buffer, buffer_size);
-      	}
-      	else
-      	{
-      		read_size = EPERS_NOPLUGINFUNCT;
-      	}
+      char pathKeyString[CustomPathKeySize];
+      Pers_custom_functs_s* customFuncs = custom_resource_get(info, dbPath, key, pathKeyString);
+
+      if(customFuncs != NULL && customFuncs->custom_plugin_get_data != NULL)
+      {
+         read_size = customFuncs->custom_plugin_get_data(pathKeyString, (char*)buffer, buffer_size);
       }
       else
       {
-         read_size = EPERS_NOPLUGINFUNCT;
+         read_size = custom_resource_error(dbPath);
       }
 
-      if (1 > read_size) // Try to get default values
+      if (1 > read_size && read_size != EPERS_NOT_READY) // Try to get default values
       {
-         info->configKey.policy = PersistencePolicy_wc;			 // Set the policy
-         info->configKey.type   = PersistenceResourceType_key;  // Set the type
-
-         (void)get_db_path_and_key(info, key, NULL, dbPath);
-
-         DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("getData - Plugin data not available - get default data of key:"), DLT_STRING(key));
-         ret_defaults = pers_get_defaults(dbPath, (char*)resourceID, info, buffer, (unsigned int)buffer_size, PersGetDefault_Data);
-         if (0 < ret_defaults)
-         {
-        	   read_size = ret_defaults;
-         }
+         read_size = custom_get_defaults(dbPath, key, resourceID, info, buffer, buffer_size, read_size);
       }
    }
    return read_size;
@@ -344,7 +919,8 @@ int persistence_get_data(char* dbPath, char* key, const char* resourceID, Persis
 
 
 
-int persistence_set_data(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size)
+int persistence_set_data(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size,
+                         PclKvLogCommit_s* commit)
 {
    int write_size = -1;
 
@@ -352,6 +928,7 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
       || PersistenceStorage_shared == info->configKey.storage )
    {
       int handleDB = -1 ;
+      PclDbEntry_s* dbEntry = NULL;
       int dbType = info->configKey.policy;      // assign default policy
       const char* dbInput = key;                // assign default key
 
@@ -361,20 +938,22 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
          dbInput = resource_id;                 // change database key when writing configurable default data
       }
 
-      handleDB = database_get(info, dbPath, dbType);
+      handleDB = database_get(info, dbPath, dbType, &dbEntry);
 
       if(handleDB >= 0)
       {
-         if(*plugin_persComDbWriteKey != NULL)
+         if(dbEntry->backend == DbBackend_Log || *plugin_persComDbWriteKey != NULL)
          {
-            write_size = plugin_persComDbWriteKey(handleDB, dbInput, (char*)buffer, buffer_size) ;
+            write_size = database_write_key(dbEntry, dbInput, (char*)buffer, buffer_size, commit) ;
             if(write_size < 0)
             {
                DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("setData - persComDbWriteKey() failure"));
             }
             else
             {
-               if(PersistenceStorage_shared == info->configKey.storage)
+               // a pending write through commit sends the notification in persistence_commit_data
+               if(   PersistenceStorage_shared == info->configKey.storage
+                  && (commit == NULL || commit->seq == 0) )
                {
                   int rval = pers_send_Notification_Signal(resource_id, &info->context, pclNotifyStatus_changed);
                   if(rval <= 0)
@@ -390,6 +969,7 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("setData - EPERS_NO_PLUGIN_FUNCT"));
             write_size = EPERS_NO_PLUGIN_FUNCT;
          }
+         database_put(dbEntry);
       }
       else
       {
@@ -399,74 +979,26 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
    }
    else if(PersistenceStorage_custom == info->configKey.storage)   // custom storage implementation via custom library
    {
-   	int available = 0, idx = custom_client_name_to_id(dbPath, 1);
-
-      if(idx < PersCustomLib_LastEntry )
-      {
-      	if(gPersCustomFuncs[idx].custom_plugin_set_data == NULL)
-      	{
-				if (getCustomLoadingType(idx) == LoadType_OnDemand)
-				{
-					// plugin not loaded, try to load the requested plugin
-					if(load_custom_library(idx, &gPersCustomFuncs[idx]) == 1)
-					{
-						// check again if the plugin function is now available
-						if(gPersCustomFuncs[idx].custom_plugin_set_data != NULL)
-						{
-							available = 1;
-						}
-					}
-				}
-				else if(getCustomLoadingType(idx) == LoadType_PclInit)
-				{
-					if(gPersCustomFuncs[idx].custom_plugin_set_data != NULL)
-					{
-						available = 1;
-					}
-				}
-				else
-				{
-					 DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("setData - Plugin not avail, unknown loading type: "),
-					                                       DLT_INT(getCustomLoadingType(idx)));
-					 write_size = EPERS_COMMON;
-				}
-			}
-      	else
-      	{
-      		available = 1;	// already loaded
-      	}
-
-      	if(available == 1)
-      	{
-				char pathKeyString[128] = {0};
-				if(info->configKey.customID[0] == '\0')   // if we have not a customID we use the key
-				{
-					snprintf(pathKeyString, 128, "0x%08X/%s/%s", info->context.ldbid, info->configKey.custom_name, key);
-				}
-				else
-				{
-					snprintf(pathKeyString, 128, "0x%08X/%s", info->context.ldbid, info->configKey.customID);
-				}
-				write_size = gPersCustomFuncs[idx].custom_plugin_set_data(pathKeyString, (char*)buffer, buffer_size);
-
-				if ((0 < write_size) && ((unsigned int)write_size == buffer_size)) /* Check return value and send notification if OK */
-				{
-					int rval = pers_send_Notification_Signal(resource_id, &info->context, pclNotifyStatus_changed);
-					if(rval <= 0)
-					{
-						DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("setData - Err send noty sig"));
-						write_size = rval;
-					}
-				}
-      	}
-      	else
-      	{
-      		write_size = EPERS_NOPLUGINFUNCT;
-      	}
+      char pathKeyString[CustomPathKeySize];
+      Pers_custom_functs_s* customFuncs = custom_resource_get(info, dbPath, key, pathKeyString);
+
+      if(customFuncs != NULL && customFuncs->custom_plugin_set_data != NULL)
+      {
+         write_size = customFuncs->custom_plugin_set_data(pathKeyString, (char*)buffer, buffer_size);
+
+         if ((0 < write_size) && ((unsigned int)write_size == buffer_size)) /* Check return value and send notification if OK */
+         {
+            int rval = pers_send_Notification_Signal(resource_id, &info->context, pclNotifyStatus_changed);
+            if(rval <= 0)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("setData - Err send noty sig"));
+               write_size = rval;
+            }
+         }
       }
       else
       {
-         write_size = EPERS_NOPLUGINFUNCT;
+         write_size = custom_resource_error(dbPath);
       }
    }
    return write_size;
@@ -474,6 +1006,186 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
 
 
 
+int persistence_commit_data(const PclKvLogCommit_s* commit, const char* resource_id, PersistenceInfo_s* info)
+{
+   int rval = 0;
+
+   if(pclKvLogCommit(commit) < 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("commitData - commit failed"));
+      rval = EPERS_SETDTAFAILED;
+   }
+   else if(commit->seq != 0 && PersistenceStorage_shared == info->configKey.storage)
+   {
+      // other applications must not read the data before it is on disk
+      int notify = pers_send_Notification_Signal(resource_id, &info->context, pclNotifyStatus_changed);
+      if(notify <= 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("commitData - Err to send noty sig"));
+         rval = notify;
+      }
+   }
+
+   return rval;
+}
+
+
+
+/// access the custom storage keys of a batch with the batch functions of the plugins, one call per plugin.
+/// done is set to 1 for each key accessed, the other keys have to be accessed one by one.
+static void custom_batch_access(PersistenceBatchAccess_s* access, int numItems, int write, int done[])
+{
+   int i = 0, j = 0;
+   int plugin[KeyBatchSize];
+   int batchIdx[KeyBatchSize];
+   char pathKey[KeyBatchSize][CustomPathKeySize];
+   plugin_batch_item_s batch[KeyBatchSize];
+
+   for(i=0; i<numItems; i++)
+   {
+      done[i]   = 0;
+      plugin[i] = -1;
+
+      if(PersistenceStorage_custom == access[i].info.configKey.storage)
+      {
+         Pers_custom_functs_s* customFuncs = custom_resource_get(&access[i].info, access[i].dbPath, access[i].dbKey, pathKey[i]);
+
+         if(   customFuncs != NULL
+            && (   (write == 0 && customFuncs->custom_plugin_get_data_batch != NULL)
+                || (write == 1 && customFuncs->custom_plugin_set_data_batch != NULL)))
+         {
+            plugin[i] = (int)(customFuncs - gPersCustomFuncs);
+         }
+      }
+   }
+
+   for(i=0; i<numItems; i++)
+   {
+      int idx = plugin[i], numBatch = 0, rval = -1;
+
+      if(idx < 0)
+      {
+         continue;
+      }
+
+      for(j=i; j<numItems; j++)     // collect the keys of the plugin
+      {
+         if(plugin[j] == idx)
+         {
+            batch[numBatch].path   = pathKey[j];
+            batch[numBatch].buffer = (char*)access[j].buffer;
+            batch[numBatch].size   = access[j].buffer_size;
+            batch[numBatch].result = EPERS_NOPLUGINFUNCT;
+            batchIdx[numBatch++]   = j;
+            plugin[j] = -1;
+         }
+      }
+
+      if(write == 0 && gPersCustomFuncs[idx].custom_plugin_get_data_batch != NULL)
+      {
+         rval = gPersCustomFuncs[idx].custom_plugin_get_data_batch(batch, numBatch);
+      }
+      else if(write == 1 && gPersCustomFuncs[idx].custom_plugin_set_data_batch != NULL)
+      {
+         rval = gPersCustomFuncs[idx].custom_plugin_set_data_batch(batch, numBatch);
+      }
+
+      if(rval >= 0)
+      {
+         for(j=0; j<numBatch; j++)
+         {
+            access[batchIdx[j]].result = batch[j].result;
+            done[batchIdx[j]] = 1;
+         }
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("customBatch - plugin batch failed, access keys one by one:"), DLT_INT(rval));
+      }
+   }
+}
+
+
+
+int persistence_get_data_batch(PersistenceBatchAccess_s* access, int numItems)
+{
+   int i = 0, numRead = 0;
+   int done[KeyBatchSize];
+
+   if(numItems < 0 || numItems > KeyBatchSize)
+   {
+      return EPERS_COMMON;
+   }
+
+   custom_batch_access(access, numItems, 0, done);
+
+   for(i=0; i<numItems; i++)
+   {
+      PersistenceBatchAccess_s* item = &access[i];
+
+      if(done[i] == 0)
+      {
+         item->result = persistence_get_data(item->dbPath, item->dbKey, item->resource_id, &item->info, item->buffer, item->buffer_size);
+      }
+      else if(1 > item->result)     // Try to get default values
+      {
+         item->result = custom_get_defaults(item->dbPath, item->dbKey, item->resource_id, &item->info,
+                                            item->buffer, item->buffer_size, item->result);
+      }
+
+      if(item->result >= 0)
+      {
+         numRead++;
+      }
+   }
+
+   return numRead;
+}
+
+
+
+int persistence_set_data_batch(PersistenceBatchAccess_s* access, int numItems)
+{
+   int i = 0, numWritten = 0;
+   int done[KeyBatchSize];
+
+   if(numItems < 0 || numItems > KeyBatchSize)
+   {
+      return EPERS_COMMON;
+   }
+
+   custom_batch_access(access, numItems, 1, done);
+
+   for(i=0; i<numItems; i++)
+   {
+      PersistenceBatchAccess_s* item = &access[i];
+
+      if(done[i] == 0)
+      {
+         item->result = persistence_set_data(item->dbPath, item->dbKey, item->resource_id, &item->info,
+                                             item->buffer, item->buffer_size, &item->commit);
+      }
+      else if((0 < item->result) && (item->result == item->buffer_size)) /* Check return value and send notification if OK */
+      {
+         int rval = pers_send_Notification_Signal(item->resource_id, &item->info.context, pclNotifyStatus_changed);
+         if(rval <= 0)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("setDataBatch - Err send noty sig"));
+            item->result = rval;
+         }
+      }
+
+      if(item->result >= 0)
+      {
+         numWritten++;
+      }
+   }
+
+   return numWritten;
+}
+
+
+
 int persistence_get_data_size(char* dbPath, char* key, const char* resourceID, PersistenceInfo_s* info)
 {
    int read_size = -1, ret_defaults = -1;
@@ -481,12 +1193,13 @@ int persistence_get_data_size(char* dbPath, char* key, const char* resourceID, P
    if(   PersistenceStorage_shared == info->configKey.storage
       || PersistenceStorage_local == info->configKey.storage)
    {
-      int handleDB = database_get(info, dbPath, info->configKey.policy);
+      PclDbEntry_s* dbEntry = NULL;
+      int handleDB = database_get(info, dbPath, info->configKey.policy, &dbEntry);
       if(handleDB >= 0)
       {
-         if(*plugin_persComDbGetKeySize != NULL)
+         if(dbEntry->backend == DbBackend_Log || *plugin_persComDbGetKeySize != NULL)
          {
-            read_size = plugin_persComDbGetKeySize(handleDB, key);
+            read_size = database_get_key_size(dbEntry, key);
             if(read_size < 0)
             {
                read_size = pers_get_defaults( dbPath, (char*)resourceID, info, NULL, 0, PersGetDefault_Size);
@@ -497,71 +1210,24 @@ int persistence_get_data_size(char* dbPath, char* key, const char* resourceID, P
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("getDataSize - EPERS_NO_PLUGIN_FUNCT"));
             read_size = EPERS_NO_PLUGIN_FUNCT;
          }
+         database_put(dbEntry);
       }
    }
    else if(PersistenceStorage_custom == info->configKey.storage)   // custom storage implementation via custom library
    {
-   	int available = 0, idx = custom_client_name_to_id(dbPath, 1);
-
-      if(idx < PersCustomLib_LastEntry )
-      {
-      	if(gPersCustomFuncs[idx].custom_plugin_get_size == NULL )
-      	{
-      		if (getCustomLoadingType(idx) == LoadType_OnDemand)
-      		{
-					// plugin not loaded, try to load the requested plugin
-					if(load_custom_library(idx, &gPersCustomFuncs[idx]) == 1)
-					{
-						// check again if the plugin function is now available
-						if(gPersCustomFuncs[idx].custom_plugin_get_size != NULL)
-						{
-							available = 1;
-						}
-					}
-      		}
-      		else if(getCustomLoadingType(idx) == LoadType_PclInit)
-      		{
-   				if(gPersCustomFuncs[idx].custom_plugin_get_size != NULL)
-					{
-   					available = 1;
-					}
-      		}
-				else
-				{
-					 DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("getDataSize - Plugin not avail, unknown loading type: "),
-					                                       DLT_INT(getCustomLoadingType(idx)));
-					 read_size = EPERS_COMMON;
-				}
-      	}
-      	else
-      	{
-      		available = 1;	// already loaded
-      	}
-
-      	if(available == 1)
-      	{
-      		char pathKeyString[128] = {0};
-				if(info->configKey.customID[0] == '\0')   // if we have not a customID we use the key
-				{
-					snprintf(pathKeyString, 128, "0x%08X/%s/%s", info->context.ldbid, info->configKey.custom_name, key);
-				}
-				else
-				{
-					snprintf(pathKeyString, 128, "0x%08X/%s", info->context.ldbid, info->configKey.customID);
-				}
-				read_size = gPersCustomFuncs[idx].custom_plugin_get_size(pathKeyString);
-      	}
-      	else
-      	{
-      		read_size = EPERS_NOPLUGINFUNCT;
-      	}
+      char pathKeyString[CustomPathKeySize];
+      Pers_custom_functs_s* customFuncs = custom_resource_get(info, dbPath, key, pathKeyString);
+
+      if(customFuncs != NULL && customFuncs->custom_plugin_get_size != NULL)
+      {
+         read_size = customFuncs->custom_plugin_get_size(pathKeyString);
       }
       else
       {
-         read_size = EPERS_NOPLUGINFUNCT;
+         read_size = custom_resource_error(dbPath);
       }
 
-      if (1 > read_size)
+      if (1 > read_size && read_size != EPERS_NOT_READY)
       {
          info->configKey.policy = PersistencePolicy_wc;			/* Set the policy */
          info->configKey.type   = PersistenceResourceType_key;  /* Set the type */
@@ -585,12 +1251,13 @@ int persistence_delete_data(char* dbPath, char* key, const char* resource_id, Pe
    int ret = 0;
    if(PersistenceStorage_custom != info->configKey.storage)
    {
-      int handleDB = database_get(info, dbPath, info->configKey.policy);
+      PclDbEntry_s* dbEntry = NULL;
+      int handleDB = database_get(info, dbPath, info->configKey.policy, &dbEntry);
       if(handleDB >= 0)
       {
-         if(*plugin_persComDbDeleteKey != NULL)
+         if(dbEntry->backend == DbBackend_Log || *plugin_persComDbDeleteKey != NULL)
          {
-            ret = plugin_persComDbDeleteKey(handleDB, key) ;
+            ret = database_delete_key(dbEntry, key) ;
             if(ret < 0)
             {
                DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("deleteData - failed: "), DLT_STRING(key));
@@ -614,6 +1281,7 @@ int persistence_delete_data(char* dbPath, char* key, const char* resource_id, Pe
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("deleteData - EPERS_NO_PLUGIN_FUNCT"));
             ret = EPERS_NO_PLUGIN_FUNCT;
          }
+         database_put(dbEntry);
       }
       else
       {
@@ -623,69 +1291,21 @@ int persistence_delete_data(char* dbPath, char* key, const char* resource_id, Pe
    }
    else   // custom storage implementation via custom library
    {
-   	int available = 0, idx = custom_client_name_to_id(dbPath, 1);
-
-      if(idx < PersCustomLib_LastEntry)
-      {
-      	if(gPersCustomFuncs[idx].custom_plugin_delete_data == NULL )
-			{
-				if (getCustomLoadingType(idx) == LoadType_OnDemand)
-				{
-					// plugin not loaded, try to load the requested plugin
-					if(load_custom_library(idx, &gPersCustomFuncs[idx]) == 1)
-					{
-						// check again if the plugin function is now available
-						if(gPersCustomFuncs[idx].custom_plugin_delete_data != NULL)
-						{
-							available = 1;
-						}
-					}
-				}
-				else if(getCustomLoadingType(idx) == LoadType_PclInit)
-				{
-					if(gPersCustomFuncs[idx].custom_plugin_delete_data != NULL)
-					{
-						available = 1;
-					}
-				}
-				else
-				{
-					 DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("deleteData - Plugin not available, unknown loading type: "),
-					                                       DLT_INT(getCustomLoadingType(idx)));
-					 ret = EPERS_COMMON;
-				}
-			}
-      	else
-      	{
-      		available = 1;	// already loaded
-      	}
-
-      	if(available == 1)
-      	{
-				char pathKeyString[128] = {0};
-				if(info->configKey.customID[0] == '\0')   // if we have not a customID we use the key
-				{
-					snprintf(pathKeyString, 128, "0x%08X/%s/%s", info->context.ldbid, info->configKey.custom_name, key);
-				}
-				else
-				{
-					snprintf(pathKeyString, 128, "0x%08X/%s", info->context.ldbid, info->configKey.customID);
-				}
-				ret = gPersCustomFuncs[idx].custom_plugin_delete_data(pathKeyString);
-
-				if(0 <= ret) /* Check return value and send notification if OK */
-				{
-					pers_send_Notification_Signal(resource_id, &info->context, pclNotifyStatus_deleted);
-				}
-      	}
-      	else
-      	{
-      		ret = EPERS_NOPLUGINFUNCT;
-      	}
+      char pathKeyString[CustomPathKeySize];
+      Pers_custom_functs_s* customFuncs = custom_resource_get(info, dbPath, key, pathKeyString);
+
+      if(customFuncs != NULL && customFuncs->custom_plugin_delete_data != NULL)
+      {
+         ret = customFuncs->custom_plugin_delete_data(pathKeyString);
+
+         if(0 <= ret) /* Check return value and send notification if OK */
+         {
+            pers_send_Notification_Signal(resource_id, &info->context, pclNotifyStatus_deleted);
+         }
       }
       else
       {
-         ret = EPERS_NOPLUGINFUNCT;
+         ret = custom_resource_error(dbPath);
       }
    }
    return ret;
@@ -693,6 +1313,197 @@ int persistence_delete_data(char* dbPath, char* key, const char* resource_id, Pe
 
 
 
+/// get the plugin handle of a key handle and lock it, NULL if the key handle has no plugin handle
+/// or the resource configuration has changed since the plugin handle has been opened
+static PclCustomHandle_s* custom_handle_lock(int keyHandle)
+{
+   PclCustomHandle_s* entry = NULL;
+
+   if(keyHandle > 0 && keyHandle < MaxPersHandle && pthread_mutex_lock(&gCustomHandleMtx) == 0)
+   {
+      entry = &gCustomHandle[keyHandle];
+
+      if(entry->isOpen == 0 || entry->generation != get_rct_generation(entry->ldbid))
+      {
+         pthread_mutex_unlock(&gCustomHandleMtx);
+         entry = NULL;
+      }
+   }
+
+   return entry;
+}
+
+
+
+/// close the plugin handle of an entry, gCustomHandleMtx must be locked
+static void custom_handle_close(PclCustomHandle_s* entry)
+{
+   if(entry->isOpen != 0)
+   {
+      if(gPersCustomFuncs[entry->idx].custom_plugin_handle_close != NULL)
+      {
+         (void)gPersCustomFuncs[entry->idx].custom_plugin_handle_close(entry->handle);
+      }
+      entry->isOpen = 0;
+   }
+}
+
+
+
+int persistence_custom_handle_open(int keyHandle, char* dbPath, char* key, PersistenceInfo_s* info)
+{
+   int rval = 0;
+
+   if(keyHandle > 0 && keyHandle < MaxPersHandle && PersistenceStorage_custom == info->configKey.storage)
+   {
+      char pathKeyString[CustomPathKeySize];
+      unsigned int generation = get_rct_generation(info->context.ldbid);
+      Pers_custom_functs_s* customFuncs = custom_resource_get(info, dbPath, key, pathKeyString);
+
+      if(   customFuncs != NULL
+         && customFuncs->custom_plugin_handle_open  != NULL
+         && customFuncs->custom_plugin_handle_close != NULL)
+      {
+         int readOnly = (PersistencePermission_ReadOnly == info->configKey.permission) ? 1 : 0;
+         int handle = customFuncs->custom_plugin_handle_open(pathKeyString, (readOnly == 1) ? O_RDONLY : (O_RDWR | O_CREAT),
+                                                             S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+         if(handle >= 0)
+         {
+            if(pthread_mutex_lock(&gCustomHandleMtx) == 0)
+            {
+               PclCustomHandle_s* entry = &gCustomHandle[keyHandle];
+
+               custom_handle_close(entry);      // a stale plugin handle of a reused key handle
+
+               entry->handle     = handle;
+               entry->idx        = (int)(customFuncs - gPersCustomFuncs);
+               entry->ldbid      = info->context.ldbid;
+               entry->generation = generation;
+               entry->readOnly   = readOnly;
+               entry->isOpen     = 1;
+               rval = 1;
+
+               pthread_mutex_unlock(&gCustomHandleMtx);
+            }
+            else
+            {
+               (void)customFuncs->custom_plugin_handle_close(handle);
+            }
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("customHandleOpen - plugin handle open failed:"), DLT_INT(handle),
+                                                  DLT_STRING(pathKeyString));
+         }
+      }
+   }
+
+   return rval;
+}
+
+
+
+int persistence_custom_handle_get_data(int keyHandle, unsigned char* buffer, int buffer_size)
+{
+   int read_size = EPERS_NOPLUGINFUNCT;
+   PclCustomHandle_s* entry = custom_handle_lock(keyHandle);
+
+   if(entry != NULL)
+   {
+      if(gPersCustomFuncs[entry->idx].custom_plugin_handle_get_data != NULL)
+      {
+         read_size = gPersCustomFuncs[entry->idx].custom_plugin_handle_get_data(entry->handle, (char*)buffer, buffer_size);
+      }
+      pthread_mutex_unlock(&gCustomHandleMtx);
+   }
+
+   return read_size;
+}
+
+
+
+int persistence_custom_handle_set_data(int keyHandle, const char* resource_id, PersistenceDbContext_s* context,
+                                       unsigned char* buffer, int buffer_size)
+{
+   int write_size = EPERS_NOPLUGINFUNCT;
+   PclCustomHandle_s* entry = custom_handle_lock(keyHandle);
+
+   if(entry != NULL)
+   {
+      if(entry->readOnly == 0 && gPersCustomFuncs[entry->idx].custom_plugin_handle_set_data != NULL)
+      {
+         write_size = gPersCustomFuncs[entry->idx].custom_plugin_handle_set_data(entry->handle, (char*)buffer, buffer_size);
+      }
+      pthread_mutex_unlock(&gCustomHandleMtx);
+
+      if ((0 < write_size) && (write_size == buffer_size)) /* Check return value and send notification if OK */
+      {
+         int rval = pers_send_Notification_Signal(resource_id, context, pclNotifyStatus_changed);
+         if(rval <= 0)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("customHandleSetData - Err send noty sig"));
+            write_size = rval;
+         }
+      }
+   }
+
+   return write_size;
+}
+
+
+
+int persistence_custom_handle_get_size(int keyHandle)
+{
+   int size = EPERS_NOPLUGINFUNCT;
+   PclCustomHandle_s* entry = custom_handle_lock(keyHandle);
+
+   if(entry != NULL)
+   {
+      if(gPersCustomFuncs[entry->idx].custom_plugin_handle_get_size != NULL)
+      {
+         size = gPersCustomFuncs[entry->idx].custom_plugin_handle_get_size(entry->handle);
+      }
+      pthread_mutex_unlock(&gCustomHandleMtx);
+   }
+
+   return size;
+}
+
+
+
+void persistence_custom_handle_close(int keyHandle)
+{
+   if(keyHandle > 0 && keyHandle < MaxPersHandle && pthread_mutex_lock(&gCustomHandleMtx) == 0)
+   {
+      custom_handle_close(&gCustomHandle[keyHandle]);
+      pthread_mutex_unlock(&gCustomHandleMtx);
+   }
+}
+
+
+
+int persistence_custom_handle_close_all(void)
+{
+   int i = 0, numClosed = 0;
+
+   if(pthread_mutex_lock(&gCustomHandleMtx) == 0)
+   {
+      for(i=1; i<MaxPersHandle; i++)
+      {
+         if(gCustomHandle[i].isOpen != 0)
+         {
+            custom_handle_close(&gCustomHandle[i]);
+            numClosed++;
+         }
+      }
+      pthread_mutex_unlock(&gCustomHandleMtx);
+   }
+
+   return numClosed;
+}
+
+
+
 int persistence_notify_on_change(const char* resource_id, const char* dbKey, unsigned int ldbid, unsigned int user_no, unsigned int seat_no,
                                  pclChangeNotifyCallback_t callback, PersNotifyRegPolicy_e regPolicy)
 {
@@ -812,6 +1623,10 @@ int pers_send_Notification_Signal(const char* key, PersistenceDbContext_s* conte
          DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("sendNotifySig - Write to pipe"), DLT_INT(errno));
          rval = EPERS_NOTIFY_SIG;
       }
+      else
+      {
+         pers_stat_count(context->ldbid, PclStat_Notification);
+      }
    }
    else
    {
@@ -28,6 +28,7 @@ extern "C" {
 
 
 #include "persistence_client_library_data_organization.h"
+#include "persistence_client_library_kvlog.h"
 #include "../include/persistence_client_library_key.h"
 
 #include <persComRct.h>
@@ -85,11 +86,86 @@ int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned
  * @param info persistence information
  * @param buffer the buffer holding the data
  * @param buffer_size the size of the buffer
+ * @param commit if not NULL, a write to a write through log database returns without waiting for the commit,
+ *        ::persistence_commit_data must be called to wait until the data has been committed to disk
+ *        and to send the change notification of a shared resource.
+ *        Should be initialized to 0, it is left unchanged for other databases.
  *
  * @return the number of bytes written or a negative value if an error occured with the following error codes:
- *   EPERS_NO_PLUGIN_FUNCT, EPERS_SETDTAFAILED  EPERS_NOPRCTABLE  EPERS_NOKEYDATA  EPERS_NOKEY
+ *   EPERS_NO_PLUGIN_FUNCT, EPERS_SETDTAFAILED  EPERS_NOPRCTABLE  EPERS_NOKEYDATA  EPERS_NOKEY  EPERS_NOT_READY
  */
-int persistence_set_data(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size);
+int persistence_set_data(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size,
+                         PclKvLogCommit_s* commit);
+
+
+
+/**
+ * @brief wait until a write to a write through database has been committed to disk.
+ *        Concurrent writers to the same database share one commit, call it without holding locks.
+ *        The change notification of a shared resource is sent after the commit.
+ *
+ * @param commit the commit filled by ::persistence_set_data
+ * @param resource_id the resource identifier passed to ::persistence_set_data
+ * @param info persistence information passed to ::persistence_set_data
+ *
+ * @return 0 if the data has been committed or a negative value with the following error codes:
+ *   EPERS_SETDTAFAILED if the commit failed, EPERS_NOTIFY_SIG if the notification could not be sent
+ */
+int persistence_commit_data(const PclKvLogCommit_s* commit, const char* resource_id, PersistenceInfo_s* info);
+
+
+
+/// access to a key of a batch, see ::persistence_get_data_batch and ::persistence_set_data_batch
+typedef struct _PersistenceBatchAccess_s
+{
+   /// persistence information
+   PersistenceInfo_s info;
+   /// the database key
+   char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// the path to the database where the key is in
+   char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+   /// the resource id
+   const char* resource_id;
+   /// the buffer to read the data to or the data to write
+   unsigned char* buffer;
+   /// the size of the buffer or the number of bytes to write
+   int buffer_size;
+   /// index of the key in the batch of the caller
+   int idx;
+   /// the number of bytes read or written or a negative value on error
+   int result;
+   /// commit of a write to a write through database, see ::persistence_commit_data
+   PclKvLogCommit_s commit;
+} PersistenceBatchAccess_s;
+
+
+
+/**
+ * @brief get the data of several keys. The keys of a custom storage plugin providing
+ *        plugin_get_data_batch are read with one call of the plugin, the other keys
+ *        are read one by one like with ::persistence_get_data.
+ *
+ * @param access the keys to read, the result is returned in each access
+ * @param numItems the number of keys, at most ::KeyBatchSize
+ *
+ * @return the number of keys read or EPERS_COMMON if numItems is out of range
+ */
+int persistence_get_data_batch(PersistenceBatchAccess_s* access, int numItems);
+
+
+
+/**
+ * @brief set the data of several keys. The keys of a custom storage plugin providing
+ *        plugin_set_data_batch are written with one call of the plugin, the other keys
+ *        are written one by one like with ::persistence_set_data.
+ *        ::persistence_commit_data must be called for each key written.
+ *
+ * @param access the keys to write, the result is returned in each access
+ * @param numItems the number of keys, at most ::KeyBatchSize
+ *
+ * @return the number of keys written or EPERS_COMMON if numItems is out of range
+ */
+int persistence_set_data_batch(PersistenceBatchAccess_s* access, int numItems);
 
 
 
@@ -104,7 +180,7 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
  * @param buffer_size the size of the buffer
  *
  * @return the number of bytes read or a negative value if an error occured with the following error codes:
- *  EPERS_NO_PLUGIN_FUNCT, EPERS_NOPRCTABLE  EPERS_NOKEYDATA  EPERS_NOKEY
+ *  EPERS_NO_PLUGIN_FUNCT, EPERS_NOPRCTABLE  EPERS_NOKEYDATA  EPERS_NOKEY  EPERS_NOT_READY
  */
 int persistence_get_data(char* dbPath, char* key, const char* resourceID, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size);
 
@@ -119,7 +195,7 @@ int persistence_get_data(char* dbPath, char* key, const char* resourceID, Persis
  * @param info persistence information
  *
  * @return size of data in bytes read from the key or on error a negative value with the following error codes:
- *  EPERS_NO_PLUGIN_FUNCT, EPERS_NOPRCTABLE or EPERS_NOKEY
+ *  EPERS_NO_PLUGIN_FUNCT, EPERS_NOPRCTABLE, EPERS_NOKEY or EPERS_NOT_READY
  */
 int persistence_get_data_size(char* dbPath, char* key, const char* resourceID, PersistenceInfo_s* info);
 
@@ -134,16 +210,126 @@ int persistence_get_data_size(char* dbPath, char* key, const char* resourceID, P
  * @param info persistence information
  *
  * @return 0 if deletion was successfull;
- *         or an error code: EPERS_NO_PLUGIN_FUNCT, EPERS_DB_KEY_SIZE, EPERS_NOPRCTABLE, EPERS_DB_ERROR_INTERNAL or EPERS_NOPLUGINFUNCT
+ *         or an error code: EPERS_NO_PLUGIN_FUNCT, EPERS_DB_KEY_SIZE, EPERS_NOPRCTABLE, EPERS_DB_ERROR_INTERNAL, EPERS_NOPLUGINFUNCT or EPERS_NOT_READY
  */
 int persistence_delete_data(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info);
 
 
 
+/**
+ * @brief open a plugin handle for a key handle on a custom storage resource.
+ *        The plugin handle is used by ::persistence_custom_handle_get_data, ::persistence_custom_handle_set_data
+ *        and ::persistence_custom_handle_get_size instead of resolving the resource on each access.
+ *
+ * @param keyHandle the key handle
+ * @param dbPath the path to the database where the key is in
+ * @param key the database key
+ * @param info persistence information
+ *
+ * @return 1 if a plugin handle has been opened, 0 if the resource is not a custom storage resource,
+ *         the plugin does not support handles or the plugin handle could not be opened
+ */
+int persistence_custom_handle_open(int keyHandle, char* dbPath, char* key, PersistenceInfo_s* info);
+
+
+
+/**
+ * @brief get data through the plugin handle of a key handle
+ *
+ * @param keyHandle the key handle
+ * @param buffer the buffer holding the data
+ * @param buffer_size the size of the buffer
+ *
+ * @return the number of bytes read or a negative value of the plugin on error;
+ *         EPERS_NOPLUGINFUNCT if the key handle has no valid plugin handle
+ */
+int persistence_custom_handle_get_data(int keyHandle, unsigned char* buffer, int buffer_size);
+
+
+
+/**
+ * @brief set data through the plugin handle of a key handle and send the change notification
+ *
+ * @param keyHandle the key handle
+ * @param resource_id the resource identifier
+ * @param context the database context
+ * @param buffer the data to write
+ * @param buffer_size the size of the data
+ *
+ * @return the number of bytes written or a negative value on error;
+ *         EPERS_NOPLUGINFUNCT if the key handle has no valid plugin handle or the resource is read only
+ */
+int persistence_custom_handle_set_data(int keyHandle, const char* resource_id, PersistenceDbContext_s* context,
+                                       unsigned char* buffer, int buffer_size);
+
+
+
+/**
+ * @brief get the size of the data through the plugin handle of a key handle
+ *
+ * @param keyHandle the key handle
+ *
+ * @return the size of the data or a negative value of the plugin on error;
+ *         EPERS_NOPLUGINFUNCT if the key handle has no valid plugin handle
+ */
+int persistence_custom_handle_get_size(int keyHandle);
+
+
+
+/**
+ * @brief close the plugin handle of a key handle, if any
+ *
+ * @param keyHandle the key handle
+ */
+void persistence_custom_handle_close(int keyHandle);
+
+
+
+/**
+ * @brief close the plugin handles of all key handles, called before the plugins are unloaded
+ *
+ * @return the number of plugin handles closed
+ */
+int persistence_custom_handle_close_all(void);
+
+
+
 /**
  * @brief close all databases
+ *
+ * @param slowest list of PCL_SHUTDOWN_TIMING_SLOWEST entries to store the
+ *        slowest database closes, see ::shutdown_slowest_insert, can be NULL
+ *
+ * @return the number of databases closed
+ */
+int database_close_all(pclShutdownSlowest_s* slowest);
+
+
+
+/**
+ * @brief insert a resource into the list of the slowest resources of a shutdown.
+ *        The list is ordered by duration, the slowest first.
+ *        If the list is full, the fastest entry will be dropped.
+ *
+ * @param slowest list of PCL_SHUTDOWN_TIMING_SLOWEST entries
+ * @param duration the duration in microseconds
+ * @param path the path of the resource
+ */
+void shutdown_slowest_insert(pclShutdownSlowest_s* slowest, unsigned int duration, const char* path);
+
+
+
+/**
+ * @brief select the backend of the cached and write through databases of a logical database.
+ *        The selection applies to databases opened afterwards, on the first open of a
+ *        log database the keys of the existing plugin database will be imported.
+ *
+ * @param ldbid the logical database id
+ * @param backend ::DbBackend_Plugin or ::DbBackend_Log
+ *
+ * @return 0 on success or -1 if the ldbid or backend is invalid
  */
-void database_close_all();
+int database_set_backend(unsigned int ldbid, int backend);
 
 
 
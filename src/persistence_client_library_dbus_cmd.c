@@ -23,6 +23,7 @@
 #include "persistence_client_library_pas_interface.h"
 #include "persistence_client_library_db_access.h"
 #include "persistence_client_library_file.h"
+#include "persistence_client_library_backup_filelist.h"
 
 
 #if USE_FILECACHE
@@ -39,8 +40,12 @@
 #endif
 
 #include <errno.h>
+#include <string.h>
 #include <dlfcn.h>
 #include <dlt.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
 
 DLT_IMPORT_CONTEXT(gPclDLTContext);
 
@@ -54,6 +59,27 @@ static const char* gCreateSignal = "PersistenceResCreate";
 /// dbus timeout
 static int gTimeoutMs = 5000;
 
+#if !USE_FILECACHE
+/// file handles to be flushed on shutdown
+static int gFlushFd[MaxPersHandle] = {0};
+/// number of file handles to be flushed
+static int gFlushCount = 0;
+/// index of the next file handle to be flushed
+static int gFlushNext = 0;
+/// number of file handles not flushed because the deadline has been reached
+static int gFlushSkipped = 0;
+/// time in us the flush must be finished, 0 if not limited
+static unsigned long long gFlushDeadline = 0;
+/// function used to flush a file handle
+static int(*gFlushFunc)(int fd) = NULL;
+
+#endif
+
+/// timing of the last shutdown
+static pclShutdownTiming_s gShutdownTiming;
+/// mutex to protect the shutdown timing
+static pthread_mutex_t gShutdownTimingMtx = PTHREAD_MUTEX_INITIALIZER;
+
 // function prototype
 static void msg_pending_func(DBusPendingCall *call, void *data);
 
@@ -183,13 +209,227 @@ void process_send_notification_signal(DBusConnection* conn, unsigned int notifyL
 
 
 
+static unsigned long long shutdown_now_us(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return (unsigned long long)now.tv_sec * 1000000ULL + (unsigned long long)now.tv_nsec / 1000ULL;
+}
+
+
+
+#if !USE_FILECACHE
+/// a file not closed because of the flush deadline will not be verified against its backup on the next open,
+/// the data written will be committed by the final syncfs and a stale backup would replace it
+static void discard_skipped_file(int fd)
+{
+   int permission = get_file_permission(fd);
+
+   if(permission != -1 && permission != PersistencePermission_ReadOnly && permission != PersistencePermission_LastEntry)
+   {
+      if(gIsNodeStateManager != 0)
+      {
+         fsync(fd);     // no final syncfs
+      }
+
+      if(pclDiscardBackup(get_file_backup_path(fd), get_file_checksum_path(fd)) == -1)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("prepShtdwn - failed to discard backup of skipped file:"), DLT_INT(fd),
+                                               DLT_STRING(strerror(errno)));
+      }
+   }
+}
+
+
+
+static void* flush_worker(void* dataPtr)
+{
+   int idx = 0;
+   pclShutdownSlowest_s* slowest = (pclShutdownSlowest_s*)dataPtr;
+
+   while((idx = __sync_fetch_and_add(&gFlushNext, 1)) < gFlushCount)
+   {
+      unsigned long long start = shutdown_now_us();
+
+      if(gFlushDeadline != 0 && start >= gFlushDeadline)
+      {
+         (void)__sync_fetch_and_add(&gFlushSkipped, 1);
+
+         if(gFlushFunc == &pclFileClose)
+         {
+            discard_skipped_file(gFlushFd[idx]);
+         }
+      }
+      else
+      {
+         char fdPath[32] = {0};
+         char path[PCL_SHUTDOWN_TIMING_PATH_LEN] = {0};
+         unsigned int duration = 0;
+
+         // get the path before the file will be closed
+         snprintf(fdPath, sizeof(fdPath), "/proc/self/fd/%d", gFlushFd[idx]);
+         if(readlink(fdPath, path, sizeof(path)-1) == -1)
+         {
+            snprintf(path, sizeof(path), "fd %d", gFlushFd[idx]);
+         }
+
+         (void)gFlushFunc(gFlushFd[idx]);
+
+         duration = (unsigned int)(shutdown_now_us() - start);
+         DLT_LOG(gPclDLTContext, DLT_LOG_DEBUG, DLT_STRING("prepShtdwn - flushed file:"), DLT_STRING(path),
+                                                DLT_STRING("us:"), DLT_UINT(duration));
+         shutdown_slowest_insert(slowest, duration, path);
+      }
+   }
+
+   return NULL;
+}
+
+
+
+/**
+ * @brief flush the open files in parallel using a bounded number of threads.
+ *        On partial shutdown only files changed since the last sync will be flushed.
+ *        When the flush deadline is reached, the remaining files will be skipped.
+ *        On full shutdown the backups of the skipped files will be discarded,
+ *        their data will be committed by the final syncfs.
+ *
+ * @param complete Shutdown_Full to close the files, Shutdown_Partial to sync the files
+ * @param timing the shutdown timing to store the number of files and the slowest files
+ */
+static void flush_open_files(unsigned int complete, pclShutdownTiming_s* timing)
+{
+   int i = 0, j = 0, items = 0, numThreads = 0;
+   pthread_t threads[ShutdownFlushThreads];
+   static pclShutdownSlowest_s slowest[ShutdownFlushThreads+1][PCL_SHUTDOWN_TIMING_SLOWEST];
+
+   if(pthread_mutex_lock(&gFileAccessMtx) == 0)
+   {
+      items = list_get_items(&gOpenFdList, gFlushFd, MaxPersHandle);
+      pthread_mutex_unlock(&gFileAccessMtx);
+   }
+
+   gFlushCount = 0;
+   for(i=0; i<items; i++)
+   {
+      if(complete == Shutdown_Full || get_file_dirty(gFlushFd[i]) != FileDirty_Clean)
+      {
+         gFlushFd[gFlushCount++] = gFlushFd[i];
+      }
+   }
+
+   gFlushNext     = 0;
+   gFlushSkipped  = 0;
+   gFlushFunc     = (complete == Shutdown_Full) ? &pclFileClose : &pclFileSync;
+   gFlushDeadline = (gShutdownFlushDeadline != 0) ? shutdown_now_us() + (unsigned long long)gShutdownFlushDeadline * 1000ULL : 0;
+   memset(slowest, 0, sizeof(slowest));
+
+   if(gFlushCount > 1)
+   {
+      for(i=0; i<ShutdownFlushThreads && i<gFlushCount; i++)
+      {
+         if(pthread_create(&threads[numThreads], NULL, flush_worker, slowest[numThreads+1]) == 0)
+         {
+            numThreads++;
+         }
+      }
+   }
+
+   (void)flush_worker(slowest[0]);     // take part in flushing, done alone if no thread could be created
+
+   for(i=0; i<numThreads; i++)
+   {
+      pthread_join(threads[i], NULL);
+   }
+
+   timing->numFiles = (unsigned int)(gFlushCount - gFlushSkipped);
+   for(i=0; i<=numThreads; i++)
+   {
+      for(j=0; j<PCL_SHUTDOWN_TIMING_SLOWEST && slowest[i][j].path[0] != '\0'; j++)
+      {
+         shutdown_slowest_insert(timing->slowestFiles, slowest[i][j].duration, slowest[i][j].path);
+      }
+   }
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("prepShtdwn - flushed files:"), DLT_INT(gFlushCount - gFlushSkipped),
+                                         DLT_STRING("of open:"), DLT_INT(items));
+   if(gFlushSkipped > 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("prepShtdwn - flush deadline reached, files not flushed:"), DLT_INT(gFlushSkipped));
+   }
+}
+#endif
+
+
+
+static void log_shutdown_timing(const char* prefix)
+{
+   if(pthread_mutex_lock(&gShutdownTimingMtx) == 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING(prefix), DLT_STRING("shutdown timing us - total:"), DLT_UINT(gShutdownTiming.total),
+                                            DLT_STRING("files:"),   DLT_UINT(gShutdownTiming.fileFlush),
+                                            DLT_STRING("rct:"),     DLT_UINT(gShutdownTiming.rctClose),
+                                            DLT_STRING("db:"),      DLT_UINT(gShutdownTiming.dbClose),
+                                            DLT_STRING("plugins:"), DLT_UINT(gShutdownTiming.pluginDeinit),
+                                            DLT_STRING("syncfs:"),  DLT_UINT(gShutdownTiming.syncfs));
+      int i = 0;
+
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING(prefix), DLT_STRING("shutdown files:"), DLT_UINT(gShutdownTiming.numFiles),
+                                            DLT_STRING("dbs:"), DLT_UINT(gShutdownTiming.numDatabases));
+      for(i=0; i<PCL_SHUTDOWN_TIMING_SLOWEST; i++)
+      {
+         if(gShutdownTiming.slowestFiles[i].path[0] != '\0')
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING(prefix), DLT_STRING("shutdown slowest file:"), DLT_STRING(gShutdownTiming.slowestFiles[i].path),
+                                                  DLT_STRING("us:"), DLT_UINT(gShutdownTiming.slowestFiles[i].duration));
+         }
+         if(gShutdownTiming.slowestDatabases[i].path[0] != '\0')
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING(prefix), DLT_STRING("shutdown slowest db:"), DLT_STRING(gShutdownTiming.slowestDatabases[i].path),
+                                                  DLT_STRING("us:"), DLT_UINT(gShutdownTiming.slowestDatabases[i].duration));
+         }
+      }
+      pthread_mutex_unlock(&gShutdownTimingMtx);
+   }
+}
+
+
+
+void process_get_shutdown_timing(pclShutdownTiming_s* timing)
+{
+   if(pthread_mutex_lock(&gShutdownTimingMtx) == 0)
+   {
+      memcpy(timing, &gShutdownTiming, sizeof(pclShutdownTiming_s));
+      pthread_mutex_unlock(&gShutdownTimingMtx);
+   }
+}
+
+
+
 void process_block_and_write_data_back(unsigned int requestID, unsigned int status)
 {
+   int i = 0, items = 0;
+   int fds[MaxPersHandle];
+
    (void)requestID;
    (void)status;
    // lock persistence data access
    pers_lock_access();
+
+   // the files are synced without holding the list mutex, a close takes it while holding the file handle mutex
+   if(pthread_mutex_lock(&gFileAccessMtx) == 0)
+   {
+      items = list_get_items(&gOpenFdList, fds, MaxPersHandle);
+      pthread_mutex_unlock(&gFileAccessMtx);
+   }
+
    // sync data back to memory device
+   for(i=0; i<items; i++)
+   {
+      (void)pclFileSync(fds[i]);
+   }
 }
 
 
@@ -197,9 +437,14 @@ void process_block_and_write_data_back(unsigned int requestID, unsigned int stat
 void process_prepare_shutdown(unsigned int complete)
 {
    int i = 0;
+   unsigned long long start = 0, phase = 0, now = 0;
+   pclShutdownTiming_s timing;
 
    DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("prepShtdwn - writing all changed data / closing all handles"));
 
+   memset(&timing, 0, sizeof(timing));
+   start = shutdown_now_us();
+
    // block write
    pers_lock_access();
 
@@ -215,23 +460,30 @@ void process_prepare_shutdown(unsigned int complete)
       pfcWriteBackAndSync(i);
    }
 #else
-   if(complete == Shutdown_Full)
+   if(complete == Shutdown_Full || complete == Shutdown_Partial)
    {
-      list_iterate(&gOpenFdList, &pclFileClose);
-   }
-   else if(complete == Shutdown_Partial)
-   {
-      list_iterate(&gOpenFdList, &fsync);
+      flush_open_files(complete, &timing);
    }
 #endif
+   phase = shutdown_now_us();
+   timing.fileFlush = (unsigned int)(phase - start);
 
    pers_rct_close_all();      // close all opened resource configuration table
+   now = shutdown_now_us();
+   timing.rctClose = (unsigned int)(now - phase);
+   phase = now;
 
-   database_close_all();      // close opened database
+   // close opened database
+   timing.numDatabases = (unsigned int)database_close_all(timing.slowestDatabases);
+   now = shutdown_now_us();
+   timing.dbClose = (unsigned int)(now - phase);
+   phase = now;
 
    if(complete > 0)
    {
+      (void)persistence_custom_handle_close_all();    // close plugin handles before the plugins are unloaded
       close_all_persistence_handle();
+      pclFileAtomicAbortAll();                        // remove the temporary files of unfinished atomic replaces
 
 		for(i=0; i<PersCustomLib_LastEntry; i++)  // unload custom client libraries
 		{
@@ -245,9 +497,23 @@ void process_prepare_shutdown(unsigned int complete)
 			}
 		}
    }
+   now = shutdown_now_us();
+   timing.pluginDeinit = (unsigned int)(now - phase);
+   phase = now;
 
    if(gIsNodeStateManager == 0)
       syncfs(gSyncFd);  // finally make sure to commit buffer cache to disk
+
+   now = shutdown_now_us();
+   timing.syncfs = (unsigned int)(now - phase);
+   timing.total  = (unsigned int)(now - start);
+
+   if(pthread_mutex_lock(&gShutdownTimingMtx) == 0)
+   {
+      memcpy(&gShutdownTiming, &timing, sizeof(pclShutdownTiming_s));
+      pthread_mutex_unlock(&gShutdownTimingMtx);
+   }
+   log_shutdown_timing("prepShtdwn -");
 }
 
 
@@ -430,6 +696,7 @@ void process_send_lifecycle_request(DBusConnection* conn, unsigned int requestId
                                            DBUS_TYPE_INT32, &status, DBUS_TYPE_INVALID);
 
          DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("sendLcmRequest: "), DLT_UINT(requestId), DLT_UINT(status) );
+         log_shutdown_timing("sendLcmRequest -");    // the lifecycle interface has no timing parameter
          if(!dbus_connection_send(conn, message, 0))
          {
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("sendLcmRequest - Access denied"), DLT_STRING(error.message) );
@@ -22,6 +22,7 @@
 #include <dbus/dbus.h>
 
 #include "persistence_client_library_dbus_service.h"
+#include "../include/persistence_client_library.h"
 
 /**
  * @brief process a shutdown message (close all open files, open databases, ...
@@ -31,6 +32,14 @@
 void process_prepare_shutdown(unsigned int complete);
 
 
+/**
+ * @brief get the timing of the last shutdown
+ *
+ * @param timing the structure to store the timing
+ */
+void process_get_shutdown_timing(pclShutdownTiming_s* timing);
+
+
 /**
  * @brief send notification signal
  *
@@ -21,6 +21,8 @@
 #include "persistence_client_library_lc_interface.h"
 #include "persistence_client_library_pas_interface.h"
 #include "persistence_client_library_dbus_cmd.h"
+#include "persistence_client_library_prct_access.h"
+#include "persistence_client_library_file_async.h"
 
 #include <errno.h>
 #include <stdlib.h>
@@ -58,6 +60,12 @@ const char* gDbusPersAdminConsMsg       = "PersistenceAdminRequest";
 /// communication channel into the dbus mainloop
 static int gPipeFd[2] = {-1};
 
+/// file descriptor to watch the resource configuration tables for changes
+static int gRctWatchFd = -1;
+
+/// timer file descriptor to commit files with the interval sync policy
+static int gFileSyncTimerFd = -1;
+
 
 typedef enum EDBusObjectType
 {
@@ -550,6 +558,22 @@ int setup_dbus_mainloop(void)
       gPollInfo.fds[0].fd = gPipeFd[0];
       gPollInfo.fds[0].events = POLLIN;
 
+      gRctWatchFd = rct_watch_init();
+      if(gRctWatchFd != -1)      // reload changed resource configuration tables
+      {
+         gPollInfo.fds[gPollInfo.nfds].fd = gRctWatchFd;
+         gPollInfo.fds[gPollInfo.nfds].events = POLLIN;
+         ++gPollInfo.nfds;
+      }
+
+      gFileSyncTimerFd = pclFileSyncTimerInit();
+      if(gFileSyncTimerFd != -1)      // commit files with the interval sync policy
+      {
+         gPollInfo.fds[gPollInfo.nfds].fd = gFileSyncTimerFd;
+         gPollInfo.fds[gPollInfo.nfds].events = POLLIN;
+         ++gPollInfo.nfds;
+      }
+
       dbus_bus_add_match(conn, "type='signal',interface='org.genivi.persistence.admin',member='PersistenceModeChanged',path='/org/genivi/persistence/admin'", &err);
 #if USE_PASINTERFACE
       dbus_bus_add_match(conn, "type='signal',interface='org.freedesktop.DBus',member='NameOwnerChanged',path='/org/freedesktop/DBus'", &err);
@@ -598,6 +622,10 @@ int setup_dbus_mainloop(void)
          close(gPipeFd[0]);
          close(gPipeFd[1]);
       }
+      rct_watch_deinit();
+      gRctWatchFd = -1;
+      pclFileSyncTimerDeinit();
+      gFileSyncTimerFd = -1;
 
 #if USE_PASINTERFACE == 1
       dbus_connection_unregister_object_path(conn, gPersAdminConsumerPath);
@@ -743,6 +771,22 @@ void* mainLoop(void* userData)
                      }
                   }
                }
+               else if (gPollInfo.fds[i].fd == gRctWatchFd)
+               {
+                  if (0!=(gPollInfo.fds[i].revents & POLLIN))  // resource configuration table changed
+                  {
+                     rct_watch_process();
+                  }
+                  bContinue = TRUE;
+               }
+               else if (gPollInfo.fds[i].fd == gFileSyncTimerFd)
+               {
+                  if (0!=(gPollInfo.fds[i].revents & POLLIN))  // sync interval of a file elapsed
+                  {
+                     pclFileSyncTimerProcess();
+                  }
+                  bContinue = TRUE;
+               }
                else
                {
                   unsigned int flags = 0;
@@ -774,6 +818,10 @@ void* mainLoop(void* userData)
    // do some cleanup
    close(gPipeFd[0]);
    close(gPipeFd[1]);
+   rct_watch_deinit();
+   gRctWatchFd = -1;
+   pclFileSyncTimerDeinit();
+   gFileSyncTimerFd = -1;
 
 #if USE_PASINTERFACE == 1
    dbus_connection_unregister_object_path(conn, gPersAdminConsumerPath);
@@ -18,10 +18,13 @@
  */
 
 #include "persistence_client_library_file.h"
+#include "persistence_client_library_file_async.h"
 #include "persistence_client_library_backup_filelist.h"
 #include "persistence_client_library_pas_interface.h"
 #include "persistence_client_library_handle.h"
 #include "persistence_client_library_prct_access.h"
+#include "persistence_client_library_statistics.h"
+#include "persistence_client_library_trace.h"
 #include "crc32.h"
 
 
@@ -35,6 +38,9 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <time.h>
 #include <dlt.h>
 
 DLT_IMPORT_CONTEXT(gPclDLTContext);
@@ -46,18 +52,62 @@ static const char* gBackupPrefix     = PERS_ORG_ROOT_PATH "/mnt-backup/";
 static const char* gBackupPostfix    = "~";
 // backup checksum filename postfix
 static const char* gBackupCsPostfix  = "~.crc";
+// postfix of the temporary file of an atomic replace
+static const char* gAtomicPostfix    = "~atomic.";
 // size of cached path string
 static const int gCPathPrefixSize = sizeof(CACHEPREFIX)-1;
 // size of write through string
 static const int gWTPathPrefixSize = sizeof(WTPREFIX)-1;
 
+/// mutex to protect the handle table (open, remove, create path), file access is protected by gFileHandleMtx
 pthread_mutex_t gFileAccessMtx = PTHREAD_MUTEX_INITIALIZER;
+/// per file handle mutex, access to independent files is not serialized
+static pthread_mutex_t gFileHandleMtx[MaxPersHandle] = { [0 ... MaxPersHandle-1] = PTHREAD_MUTEX_INITIALIZER };
+
+/// mapping created with pclFileMapDataHinted
+typedef struct _PclFileMapping_s
+{
+   /// the file descriptor of the mapped file
+   int fd;
+   /// the address of the mapping
+   void* addr;
+   /// the size of the mapping
+   size_t size;
+   /// 1 if the mapping is writable, 0 if read only
+   int writable;
+   /// next mapping
+   struct _PclFileMapping_s* next;
+} PclFileMapping_s;
+
+/// atomic file replace in progress, see pclFileAtomicBegin
+typedef struct _PclAtomicFile_s
+{
+   /// path of the file to be replaced
+   char path[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+   /// path of the temporary file holding the new content
+   char tmpPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+   /// path of the backup file of the file to be replaced
+   char backupPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+   /// path of the checksum file of the file to be replaced
+   char csumPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+} PclAtomicFile_s;
+
+/// atomic file replaces in progress, indexed by the file descriptor of the temporary file
+static PclAtomicFile_s* gAtomicFile[MaxPersHandle] = {NULL};
+/// counter used to create unique temporary file names
+static unsigned int gAtomicFileCount = 0;
+
+/// list of tracked mappings
+static PclFileMapping_s* gFileMappings = NULL;
+/// mutex to protect the list of tracked mappings
+static pthread_mutex_t gFileMapMtx = PTHREAD_MUTEX_INITIALIZER;
 
 // local function prototype
 static int pclFileGetDefaultData(int handle, const char* resource_id, int policy);
 static int pclFileOpenDefaultData(PersistenceInfo_s* dbContext, const char* resource_id);
 static int pclFileOpenRegular(PersistenceInfo_s* dbContext, const char* resource_id,
                               char* dbKey, char* dbPath, int shared_DB, unsigned int user_no, unsigned int seat_no);
+static int pclFilePrepareWrite(int fd, off_t offset, size_t size);
 
 #if USE_APPCHECK
 extern int doAppcheck(void);
@@ -87,15 +137,296 @@ char* get_raw_string(char* dbKey)
 
 
 
+static int pclFileUseJournal(int fd)
+{
+   int rval = 0;
+   struct stat buf;
+
+#if USE_FILECACHE
+   if(get_file_cache_status(fd) == 1)
+   {
+      return rval;      // the file cache maintains its own file position, always use a full backup
+   }
+#endif
+
+   if(fstat(fd, &buf) != -1 && buf.st_size >= JournalMinFileSize)
+   {
+      rval = 1;
+   }
+
+   return rval;
+}
+
+
+
+static pthread_mutex_t* pclFileHandleMtx(int fd)
+{
+   if(fd >= 0 && fd < MaxPersHandle)
+   {
+      return &gFileHandleMtx[fd];
+   }
+
+   return &gFileAccessMtx;    // invalid handle, will be rejected by the handle table
+}
+
+
+
+static int pclFileIovSize(const struct iovec* iov, int iovcnt, size_t* size)
+{
+   int rval = -1;
+
+   if(iov != NULL && iovcnt > 0 && iovcnt <= IOV_MAX)
+   {
+      int i = 0;
+
+      *size = 0;
+      for(i=0; i<iovcnt; i++)
+      {
+         *size += iov[i].iov_len;
+      }
+      rval = 0;
+   }
+   else
+   {
+      errno = EINVAL;
+   }
+
+   return rval;
+}
+
+
+
+static unsigned long long pclFileGetTimeMs(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return ((unsigned long long)now.tv_sec * 1000ULL) + ((unsigned long long)now.tv_nsec / 1000000ULL);
+}
+
+
+
+static int pclFileSyncNeeded(int fd)
+{
+   int rval = 1;
+   unsigned int interval = 0;
+   int policy = get_file_sync_policy(fd, &interval);
+
+   if(policy == PCL_FILE_SYNC_ON_CLOSE)
+   {
+      rval = 0;
+   }
+   else if(policy == PCL_FILE_SYNC_INTERVAL)
+   {
+      // data will be committed by the sync timer when the interval since the last sync has elapsed
+      pclFileSyncTimerArm(get_file_last_sync(fd) + interval);
+      rval = 0;
+   }
+
+   return rval;
+}
+
+
+
+/// get the sync policy configured for a file resource in the resource configuration table,
+/// the custom id is only used by resources on custom storage
+static int pclFileGetConfiguredSyncPolicy(const PersistenceConfigurationKey_s* config, unsigned int* interval)
+{
+   int policy = PCL_FILE_SYNC_PER_WRITE;
+
+   if(config->storage != PersistenceStorage_custom)
+   {
+      char customID[PERS_RCT_MAX_LENGTH_CUSTOM_ID] = {0};
+
+      memcpy(customID, config->customID, sizeof(customID)-1);
+
+      if(strcmp(customID, PCL_FILE_SYNC_RCT_ON_CLOSE) == 0)
+      {
+         policy = PCL_FILE_SYNC_ON_CLOSE;
+      }
+      else if(strncmp(customID, PCL_FILE_SYNC_RCT_INTERVAL, strlen(PCL_FILE_SYNC_RCT_INTERVAL)) == 0)
+      {
+         policy = PCL_FILE_SYNC_INTERVAL;
+         *interval = (unsigned int)strtoul(customID + strlen(PCL_FILE_SYNC_RCT_INTERVAL), NULL, 10);
+      }
+   }
+
+   return policy;
+}
+
+
+#if !USE_FILECACHE
+static void* pclFileMap(void* addr, long size, long offset, int fd, int flags)
+{
+   void* ptr = MAP_FAILED;
+   int permission = get_file_permission(fd);
+   int prot = PROT_READ;
+   int mapFlags = MAP_SHARED;
+
+   if(AccessNoLock == isAccessLocked())  // check if access to persistent data is locked
+   {
+      return EPERS_MAP_LOCKFS;
+   }
+
+   if(permission == -1)
+   {
+      errno = EBADF;
+      return ptr;
+   }
+
+   if(permission != PersistencePermission_ReadOnly)
+   {
+      // the file can be modified through the mapping, create the backup before
+      int rval = pclFilePrepareWrite(fd, (off_t)offset, (size_t)size);
+      if(rval == EPERS_COMMON)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("fileMapData - Failed to journal range"), DLT_INT(fd));
+         errno = EIO;
+         return ptr;
+      }
+      else if(rval != 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileMapData - Failed to create backup"), DLT_INT(fd));
+      }
+      prot |= PROT_WRITE;
+      set_file_dirty(fd, FileDirty_Mapped);    // writes through the mapping can't be tracked
+   }
+
+   if(flags & PCL_FILE_MAP_POPULATE)
+   {
+      mapFlags |= MAP_POPULATE;
+   }
+
+   ptr = mmap(addr, (size_t)size, prot, mapFlags, fd, (off_t)offset);
+
+   if(ptr != MAP_FAILED)
+   {
+      int advice = -1;
+
+      if(flags & PCL_FILE_MAP_HINT_SEQUENTIAL)
+      {
+         advice = MADV_SEQUENTIAL;
+      }
+      else if(flags & PCL_FILE_MAP_HINT_RANDOM)
+      {
+         advice = MADV_RANDOM;
+      }
+
+      if(advice != -1 && madvise(ptr, (size_t)size, advice) == -1)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileMapData - madvise failed:"), DLT_STRING(strerror(errno)));
+      }
+
+      if((flags & PCL_FILE_MAP_HINT_WILLNEED) && madvise(ptr, (size_t)size, MADV_WILLNEED) == -1)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileMapData - madvise willneed failed:"), DLT_STRING(strerror(errno)));
+      }
+   }
+
+   return ptr;
+}
+
+
+
+static void pclFileTrackMapping(int fd, void* addr, size_t size, int writable)
+{
+   PclFileMapping_s* mapping = malloc(sizeof(PclFileMapping_s));
+
+   if(mapping != NULL)
+   {
+      mapping->fd       = fd;
+      mapping->addr     = addr;
+      mapping->size     = size;
+      mapping->writable = writable;
+
+      if(pthread_mutex_lock(&gFileMapMtx) == 0)
+      {
+         mapping->next = gFileMappings;
+         gFileMappings = mapping;
+         pthread_mutex_unlock(&gFileMapMtx);
+      }
+      else
+      {
+         free(mapping);
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileMapData - mapping will not be tracked, no memory"), DLT_INT(fd));
+   }
+}
+#endif
+
+
+
+static void pclFileSyncMappings(int fd, int unmap)
+{
+   if(pthread_mutex_lock(&gFileMapMtx) == 0)
+   {
+      PclFileMapping_s** mapping = &gFileMappings;
+
+      while(*mapping != NULL)
+      {
+         PclFileMapping_s* current = *mapping;
+
+         if(current->fd == fd)
+         {
+            if(current->writable == 1 && msync(current->addr, current->size, MS_SYNC) == -1)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileSyncMappings - msync failed:"), DLT_STRING(strerror(errno)));
+            }
+
+            if(unmap == 1)
+            {
+               munmap(current->addr, current->size);
+               *mapping = current->next;
+               free(current);
+               continue;
+            }
+         }
+         mapping = &current->next;
+      }
+      pthread_mutex_unlock(&gFileMapMtx);
+   }
+}
+
+
+
+static void pclFileUntrackMapping(void* address)
+{
+   if(pthread_mutex_lock(&gFileMapMtx) == 0)
+   {
+      PclFileMapping_s** mapping = &gFileMappings;
+
+      while(*mapping != NULL)
+      {
+         PclFileMapping_s* current = *mapping;
+
+         if(   (char*)address >= (char*)current->addr
+            && (char*)address <  (char*)current->addr + current->size)
+         {
+            *mapping = current->next;
+            free(current);
+            break;
+         }
+         mapping = &current->next;
+      }
+      pthread_mutex_unlock(&gFileMapMtx);
+   }
+}
+
+
+
 int pclFileClose(int fd)
 {
    int rval = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileClose - fd:"), DLT_INT(fd));
+   PCL_TRACE_LOG(DLT_STRING("pclFileClose - fd:"), DLT_INT(fd));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gFileAccessMtx);
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
       if(lock == 0)
       {
 #if USE_APPCHECK
@@ -106,20 +437,63 @@ int pclFileClose(int fd)
 
             if(permission != -1)	   // permission is here also used for range check
             {
+               // commit and unmap tracked mappings, the data must be in the file before the backup will be removed
+               pclFileSyncMappings(fd, 1);
+
+#if !USE_FILECACHE
+               // data must be on the memory device before the backup will be removed, clean files are already committed
+               if(get_file_dirty(fd) != FileDirty_Clean)
+               {
+                  fsync(fd);
+               }
+#endif
+
                // check if a backup and checksum file needs to be deleted
                if(permission != PersistencePermission_ReadOnly && permission != PersistencePermission_LastEntry)
                {
+                  int clean = 1;
+                  struct stat buf;
+
+                  if(get_file_backup_status(fd) == BackupStatus_Journal)
+                  {
+#if USE_FILECACHE
+                     // data must be on disk before the journal will be removed
+                     fsync(fd);
+#endif
+
+                     if(pclRemoveJournal(get_file_backup_path(fd)) == -1)
+                     {
+                        clean = 0;
+                        DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileClose - journal remove failed!"), DLT_STRING(strerror(errno)));
+                     }
+                  }
+
                   // remove backup file
                   if(remove(get_file_backup_path(fd)) == -1)
                   {
+                     clean = (errno == ENOENT);
                      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileClose - backup remove failed!"), DLT_STRING(strerror(errno)));
                   }
 
                   // remove checksum file
                   if(remove(get_file_checksum_path(fd)) == -1)
                   {
+                     clean = clean && (errno == ENOENT);
                      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileClose - csum remove failed!"), DLT_STRING(strerror(errno)) );
                   }
+
+                  // remember the clean state, the file will not be verified on the next open
+                  if(clean == 1 && fstat(fd, &buf) == 0)
+                  {
+                     pclLedgerAdd(get_file_backup_path(fd), &buf);
+                  }
+               }
+
+               // the open file list is part of the handle table, remove before the fd can be reused by an open
+               if(pthread_mutex_lock(&gFileAccessMtx) == 0)
+               {
+                  list_item_remove(&gOpenFdList, fd);
+                  pthread_mutex_unlock(&gFileAccessMtx);
                }
 
                // remove form file tree;
@@ -127,6 +501,7 @@ int pclFileClose(int fd)
                {
                   DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileClose - Failed to remove from tree!"), DLT_INT(fd) );
                }
+               pers_stat_file_close(fd);     // the fd can be reused by a file of another logical database
 
    #if USE_FILECACHE
                if(get_file_cache_status(fd) == 1)
@@ -139,10 +514,8 @@ int pclFileClose(int fd)
                   rval = close(fd);
                }
    #else
-               fsync(fd);
                rval = close(fd);
    #endif
-               list_item_remove(&gOpenFdList, fd);
             }
             else
             {
@@ -155,7 +528,7 @@ int pclFileClose(int fd)
             rval = EPERS_SHUTDOWN_NO_TRUSTED;
          }
 #endif
-         pthread_mutex_unlock(&gFileAccessMtx);
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
       }
       else
       {
@@ -178,11 +551,11 @@ int pclFileGetSize(int fd)
 {
    int size = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileGetSize fd: "), DLT_INT(fd));
+   PCL_TRACE_LOG(DLT_STRING("pclFileGetSize fd: "), DLT_INT(fd));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gFileAccessMtx);
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
       if(lock == 0)
       {
          struct stat buf;
@@ -209,7 +582,7 @@ int pclFileGetSize(int fd)
             size = (int)buf.st_size;
          }
 #endif
-         pthread_mutex_unlock(&gFileAccessMtx);
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
       }
       else
       {
@@ -239,22 +612,15 @@ void* pclFileMapData(void* addr, long size, long offset, int fd)
    (void)fd;
    DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileMapData not supported when using file cache"));
 #else
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileMapData fd: "), DLT_INT(fd));
+   PCL_TRACE_LOG(DLT_STRING("pclFileMapData fd: "), DLT_INT(fd));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gFileAccessMtx);
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
       if(lock == 0)
       {
-         if(AccessNoLock != isAccessLocked() )  // check if access to persistent data is locked
-         {
-            ptr = mmap(addr, (size_t)size, PROT_WRITE | PROT_READ, MAP_SHARED, fd, (off_t)offset);
-         }
-         else
-         {
-            ptr = EPERS_MAP_LOCKFS;
-         }
-         pthread_mutex_unlock(&gFileAccessMtx);
+         ptr = pclFileMap(addr, size, offset, fd, PCL_FILE_MAP_HINT_NORMAL);
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
       }
       else
       {
@@ -274,17 +640,54 @@ void* pclFileMapData(void* addr, long size, long offset, int fd)
 
 
 
-int pclFileOpenRegular(PersistenceInfo_s* dbContext, const char* resource_id, char* dbKey, char* dbPath, int shared_DB, unsigned int user_no, unsigned int seat_no)
+void* pclFileMapDataHinted(long size, long offset, int fd, int flags)
 {
-   int handle = -1, length = 0, wantBackup = 1, cacheStatus = -1;
+   void* ptr = 0;
 
-   char fileSubPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
-   char backupPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};    // backup file
-   char csumPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME]   = {0};    // checksum file
+#if USE_FILECACHE
+   (void)size;
+   (void)offset;
+   (void)fd;
+   (void)flags;
+   DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileMapDataHinted not supported when using file cache"));
+#else
+   PCL_TRACE_LOG(DLT_STRING("pclFileMapDataHinted fd: "), DLT_INT(fd), DLT_INT(flags));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
+      if(lock == 0)
+      {
+         ptr = pclFileMap(NULL, size, offset, fd, flags);
+
+         if(ptr != MAP_FAILED && ptr != EPERS_MAP_LOCKFS)
+         {
+            pclFileTrackMapping(fd, ptr, (size_t)size, get_file_permission(fd) != PersistencePermission_ReadOnly);
+         }
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileMapDataHinted - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileMapDataHinted - not initialized"));
+   }
+#endif
+
+   return ptr;
+}
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileOpenRegular - res:"), DLT_STRING(resource_id));
 
-   if(dbContext->configKey.policy ==  PersistencePolicy_wc)
+
+static void pclFileGetBackupPath(int policy, const char* dbPath, char* backupPath, char* csumPath)
+{
+   int length = 0;
+   char fileSubPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+   if(policy ==  PersistencePolicy_wc)
    {
       length = gCPathPrefixSize;
    }
@@ -297,6 +700,20 @@ int pclFileOpenRegular(PersistenceInfo_s* dbContext, const char* resource_id, ch
    fileSubPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
    snprintf(backupPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1, "%s%s%s", gBackupPrefix, fileSubPath, gBackupPostfix);
    snprintf(csumPath,   PERS_ORG_MAX_LENGTH_PATH_FILENAME-1, "%s%s%s", gBackupPrefix, fileSubPath, gBackupCsPostfix);
+}
+
+
+
+int pclFileOpenRegular(PersistenceInfo_s* dbContext, const char* resource_id, char* dbKey, char* dbPath, int shared_DB, unsigned int user_no, unsigned int seat_no)
+{
+   int handle = -1, wantBackup = 1, cacheStatus = -1, dirty = FileDirty_Clean;
+
+   char backupPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};    // backup file
+   char csumPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME]   = {0};    // checksum file
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileOpenRegular - res:"), DLT_STRING(resource_id));
+
+   pclFileGetBackupPath(dbContext->configKey.policy, dbPath, backupPath, csumPath);
 
    //
    // check valid database context
@@ -310,12 +727,20 @@ int pclFileOpenRegular(PersistenceInfo_s* dbContext, const char* resource_id, ch
          && (pclBackupNeeded(get_raw_string(dbKey)) == CREATE_BACKUP))
       {
          wantBackup = 0;
-         if((handle = pclVerifyConsistency(dbPath, backupPath, csumPath, flags)) == -1)
+
+         // files closed cleanly and unchanged since then don't need to be verified
+         if(   pclLedgerTake(backupPath, dbPath) != 1
+            && (handle = pclVerifyConsistency(dbPath, backupPath, csumPath, flags)) == -1)
          {
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("fileOpen - file inconsist, recov  N O T  possible!"));
             close(handle);
             return -1;
          }
+
+         if(handle > 0)      // file has been recovered, recovered content not yet synced
+         {
+            dirty = FileDirty_Written;
+         }
       }
       else
       {
@@ -383,6 +808,7 @@ int pclFileOpenRegular(PersistenceInfo_s* dbContext, const char* resource_id, ch
                   DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileOpen - no def data avail: "), DLT_STRING(resource_id));
                }
                set_file_cache_status(handle, cacheStatus);
+               dirty = FileDirty_Written;    // default data not yet synced
             }
          }
 
@@ -390,7 +816,16 @@ int pclFileOpenRegular(PersistenceInfo_s* dbContext, const char* resource_id, ch
          {
             if(set_file_handle_data(handle, dbContext->configKey.permission, backupPath, csumPath, NULL) != -1)
             {
+               unsigned int interval = 0;
+               int policy = pclFileGetConfiguredSyncPolicy(&dbContext->configKey, &interval);
+
                set_file_backup_status(handle, wantBackup);
+               set_file_dirty(handle, dirty);
+               if(policy != PCL_FILE_SYNC_PER_WRITE)     // can be changed per handle by pclFileSetSyncPolicy
+               {
+                  set_file_sync_policy(handle, policy, interval);
+                  set_file_last_sync(handle, pclFileGetTimeMs());
+               }
                list_item_insert(&gOpenFdList, handle);
             }
             else
@@ -460,7 +895,7 @@ int pclFileOpenDefaultData(PersistenceInfo_s* dbContext, const char* resource_id
 {
    int flags = pclGetPosixPermission(dbContext->configKey.permission);
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileOpenDefaultData - res:"), DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("pclFileOpenDefaultData - res:"), DLT_STRING(resource_id));
 
    // check if there is default data available
    char pathPrefix[PERS_ORG_MAX_LENGTH_PATH_FILENAME]  = { [0 ... PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = 0};
@@ -486,8 +921,9 @@ int pclFileOpenDefaultData(PersistenceInfo_s* dbContext, const char* resource_id
 int pclFileOpen(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no)
 {
    int handle = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileOpen - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("pclFileOpen - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -563,6 +999,9 @@ int pclFileOpen(unsigned int ldbid, const char* resource_id, unsigned int user_n
 
    //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileOpen - handle:"), DLT_INT(handle), DLT_STRING(" res:"), DLT_STRING(resource_id));
 
+   pers_stat_file_open(handle, ldbid, resource_id, start);
+   PCL_TRACE_EVENT(PclTrace_FileOpen, handle, ldbid, handle, start);
+
    return handle;
 }
 
@@ -571,12 +1010,13 @@ int pclFileOpen(unsigned int ldbid, const char* resource_id, unsigned int user_n
 int pclFileReadData(int fd, void * buffer, int buffer_size)
 {
    int readSize = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileReadData - fd:"), DLT_INT(fd));
+   PCL_TRACE_LOG(DLT_STRING("pclFileReadData - fd:"), DLT_INT(fd));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gFileAccessMtx);
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
       if(lock == 0)
       {
 #if USE_FILECACHE
@@ -591,7 +1031,7 @@ int pclFileReadData(int fd, void * buffer, int buffer_size)
 #else
          readSize = (int)read(fd, buffer, (size_t)buffer_size);
 #endif
-         pthread_mutex_unlock(&gFileAccessMtx);
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
       }
       else
       {
@@ -603,80 +1043,778 @@ int pclFileReadData(int fd, void * buffer, int buffer_size)
       DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileReadData - not initialized"));
    }
 
+   pers_stat_file_call(fd, PclStat_FileRead, readSize, start);
+   PCL_TRACE_EVENT(PclTrace_FileRead, fd, pers_stat_file_ldbid(fd), readSize, start);
+
    //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileReadData - fd:"), DLT_INT(fd));
    return readSize;
 }
 
 
 
-int pclFileRemove(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no)
+int pclFileReadAt(int fd, void * buffer, int buffer_size, long offset)
 {
-   int rval = EPERS_NOT_INITIALIZED;
+   int readSize = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileRemove - ldbid"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("pclFileReadAt - fd:"), DLT_INT(fd));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gFileAccessMtx);
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
       if(lock == 0)
       {
-         if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
-         {
+#if USE_FILECACHE
+         if(get_file_cache_status(fd) == 1 && get_file_user_id(fd) !=  (int)PCL_USER_DEFAULTDATA)
+         {
+            // the file cache has no positional read, keep the file offset unchanged
+            int curPos = pfcFileSeek(fd, 0, SEEK_CUR);
+            readSize = pfcFileSeek(fd, offset, SEEK_SET);
+            if(readSize != -1)
+            {
+               readSize = pfcReadFile(fd, buffer, buffer_size);
+            }
+            (void)pfcFileSeek(fd, curPos, SEEK_SET);
+         }
+         else
+         {
+            readSize = pread(fd, buffer, buffer_size, offset);
+         }
+#else
+         readSize = (int)pread(fd, buffer, (size_t)buffer_size, (off_t)offset);
+#endif
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileReadAt - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileReadAt - not initialized"));
+   }
+
+   pers_stat_file_call(fd, PclStat_FileRead, readSize, start);
+   PCL_TRACE_EVENT(PclTrace_FileRead, fd, pers_stat_file_ldbid(fd), readSize, start);
+
+   return readSize;
+}
+
+
+
+int pclFileReadV(int fd, const struct iovec* iov, int iovcnt)
+{
+   int readSize = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileReadV - fd:"), DLT_INT(fd));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
+      if(lock == 0)
+      {
+         size_t totalSize = 0;
+
+         if(pclFileIovSize(iov, iovcnt, &totalSize) != -1)
+         {
+#if USE_FILECACHE
+            if(get_file_cache_status(fd) == 1 && get_file_user_id(fd) !=  (int)PCL_USER_DEFAULTDATA)
+            {
+               int i = 0, read = 0;
+
+               readSize = 0;
+               for(i=0; i<iovcnt; i++)
+               {
+                  read = pfcReadFile(fd, iov[i].iov_base, (int)iov[i].iov_len);
+                  if(read == -1)
+                  {
+                     readSize = -1;
+                     break;
+                  }
+
+                  readSize += read;
+                  if(read < (int)iov[i].iov_len)   // end of file reached
+                  {
+                     break;
+                  }
+               }
+            }
+            else
+            {
+               readSize = readv(fd, iov, iovcnt);
+            }
+#else
+            readSize = (int)readv(fd, iov, iovcnt);
+#endif
+         }
+         else
+         {
+            readSize = EPERS_COMMON;
+         }
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileReadV - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileReadV - not initialized"));
+   }
+
+   pers_stat_file_call(fd, PclStat_FileRead, readSize, start);
+   PCL_TRACE_EVENT(PclTrace_FileRead, fd, pers_stat_file_ldbid(fd), readSize, start);
+
+   return readSize;
+}
+
+
+
+int pclFileRemove(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileRemove - ldbid"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(&gFileAccessMtx);
+      if(lock == 0)
+      {
+         if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         {
             int shared_DB = 0;
             PersistenceInfo_s dbContext;
 
-            char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};      // database key
-            char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};    // database location
+            char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};      // database key
+            char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};    // database location
+
+            dbContext.context.ldbid   = ldbid;
+            dbContext.context.seat_no = seat_no;
+            dbContext.context.user_no = user_no;
+
+            // get database context: database path and database key
+            shared_DB = get_db_context(&dbContext, resource_id, ResIsFile, dbKey, dbPath);
+
+            if(   (shared_DB >= 0)                                               // check valid database context
+               && (dbContext.configKey.type == PersistenceResourceType_file) )   // check if type matches
+            {
+               rval = remove(dbPath);
+               if(rval == -1)
+               {
+                  DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileRemove - remove()"), DLT_STRING(resource_id), DLT_STRING(strerror(errno)) );
+               }
+            }
+            else
+            {
+               rval = shared_DB;
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("fileRemove - no valid db context or res not a file"));
+            }
+         }
+         else
+         {
+            rval = EPERS_LOCKFS;
+         }
+         pthread_mutex_unlock(&gFileAccessMtx);
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileRemove - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileRemove - not initialized"));
+   }
+
+   pers_stat_call(ldbid, resource_id, PclStat_FileRemove, rval, start);
+   PCL_TRACE_EVENT(PclTrace_FileRemove, -1, ldbid, rval, start);
+
+   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileRemove - ldbid"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
+   return rval;
+}
+
+
+
+int pclFileSeek(int fd, long int offset, int whence)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileSeek - fd"), DLT_INT(fd));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
+      if(lock == 0)
+      {
+         if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         {
+#if USE_FILECACHE
+            if(get_file_cache_status(fd) == 1)
+            {
+               rval = pfcFileSeek(fd, offset, whence);
+            }
+            else
+            {
+                rval = lseek(fd, offset, whence);
+            }
+#else
+            rval = (int)lseek(fd, offset, whence);
+#endif
+         }
+         else
+         {
+            rval = EPERS_LOCKFS;
+         }
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileSeek - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileSeek - not initialized"));
+   }
+
+   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileSeek - fd"), DLT_INT(fd));
+
+   return rval;
+}
+
+
+
+int pclFileSetSyncPolicy(int fd, int policy, unsigned int interval_ms)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileSetSyncPolicy - fd"), DLT_INT(fd), DLT_STRING(" policy:"), DLT_INT(policy));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
+      if(lock == 0)
+      {
+         if(get_file_permission(fd) != -1)
+         {
+            if(   policy == PCL_FILE_SYNC_PER_WRITE
+               || policy == PCL_FILE_SYNC_ON_CLOSE
+               || policy == PCL_FILE_SYNC_INTERVAL)
+            {
+               set_file_sync_policy(fd, policy, interval_ms);
+               set_file_last_sync(fd, pclFileGetTimeMs());
+               rval = 0;
+            }
+            else
+            {
+               rval = EPERS_BADPOL;
+            }
+         }
+         else
+         {
+            rval = EPERS_MAXHANDLE;
+         }
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileSetSyncPolicy - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileSetSyncPolicy - not initialized"));
+   }
+
+   return rval;
+}
+
+
+
+int pclFileSync(int fd)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileSync - fd"), DLT_INT(fd));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
+      if(lock == 0)
+      {
+         // no access lock check, committing data must be possible while access is blocked
+         if(get_file_permission(fd) != -1)
+         {
+            pclFileSyncMappings(fd, 0);
+
+#if USE_FILECACHE
+            if(get_file_cache_status(fd) == 1)
+            {
+               rval = pfcWriteBackAndSync(fd);
+            }
+            else
+            {
+               rval = fsync(fd);
+            }
+#else
+#if USE_FSYNC
+            rval = fsync(fd);
+#else
+            rval = fdatasync(fd);
+#endif
+#endif
+            if(rval == -1)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileSync - Failed fsync ==>!"), DLT_STRING(strerror(errno)));
+            }
+            else
+            {
+               set_file_last_sync(fd, pclFileGetTimeMs());
+               set_file_dirty(fd, FileDirty_Clean);
+            }
+         }
+         else
+         {
+            rval = EPERS_MAXHANDLE;
+         }
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileSync - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileSync - not initialized"));
+   }
+
+   return rval;
+}
+
+
+
+int pclFileUnmapData(void* address, long size)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileUnmapData"));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(&gFileAccessMtx);
+      if(lock  == 0)
+      {
+         if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         {
+            pclFileUntrackMapping(address);
+            rval =  munmap(address, (size_t)size);
+         }
+         else
+         {
+            rval = EPERS_LOCKFS;
+         }
+         pthread_mutex_unlock(&gFileAccessMtx);
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileUnmapData - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileUnmapData - not initialized"));
+   }
+
+   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileUnmapData"));
+
+   return rval;
+}
+
+
+
+static int pclFilePrepareWrite(int fd, off_t offset, size_t size)
+{
+   int rval = 0;
+
+   if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+   {
+      int permission = get_file_permission(fd);
+      if(permission != -1)
+      {
+         if(permission != PersistencePermission_ReadOnly )
+         {
+            int backupStatus = get_file_backup_status(fd);
+
+            // check if a backup file has to be created
+            if( (backupStatus == 0) && get_file_user_id(fd) !=  (int)PCL_USER_DEFAULTDATA)
+            {
+               // large files: only journal the ranges that will be overwritten
+               if(   pclFileUseJournal(fd) == 1
+                  && pclCreateJournal(get_file_backup_path(fd), fd) != -1)
+               {
+                  backupStatus = BackupStatus_Journal;
+               }
+               else
+               {
+                  char csumBuf[ChecksumBufSize] = {0};
+
+                  pclCalcCrc32Csum(fd, csumBuf);      // calculate checksum
+
+                  pclCreateBackup(get_file_backup_path(fd), fd, get_file_checksum_path(fd), csumBuf); // create checksum and backup file
+
+                  backupStatus = 1;
+               }
+               set_file_backup_status(fd, backupStatus);
+            }
+
+            if(backupStatus == BackupStatus_Journal)
+            {
+               if(offset == -1)  // write at the current file offset
+               {
+                  offset = lseek(fd, 0, SEEK_CUR);
+               }
+
+               // save the original content of the range before it will be overwritten,
+               // an unprotected range would be restored only partially after a crash
+               if(pclJournalRange(get_file_backup_path(fd), fd, offset, size) == -1)
+               {
+                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("fileWriteData - Failed journal range, write rejected"), DLT_INT(fd));
+                  rval = EPERS_COMMON;
+               }
+            }
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("fileWriteData - Failed write ==> read only file!"), DLT_STRING(get_file_backup_path(fd)));
+            rval = EPERS_RESOURCE_READ_ONLY;
+         }
+      }
+      else
+      {
+         rval = EPERS_MAXHANDLE;
+      }
+   }
+   else
+   {
+      rval = EPERS_LOCKFS;
+   }
+
+   return rval;
+}
+
+
+
+static void pclFileSyncAfterWrite(int fd)
+{
+#if USE_FILECACHE
+   if(get_file_cache_status(fd) != 1 || get_file_user_id(fd) ==  (int)PCL_USER_DEFAULTDATA)
+   {
+      if(fsync(fd) == -1)
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileWriteData: Failed fsync ==>!"), DLT_STRING(strerror(errno)));
+   }
+   else
+   {
+      set_file_dirty(fd, FileDirty_Written);
+   }
+#else
+   if(get_file_cache_status(fd) == 1 && pclFileSyncNeeded(fd) == 1)
+   {
+#if USE_FSYNC
+      if(fsync(fd) == -1)
+#else
+      if(fdatasync(fd) == -1)
+#endif
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileWriteData - Failed fsync ==>!"), DLT_STRING(strerror(errno)));
+         set_file_dirty(fd, FileDirty_Written);
+      }
+      else
+      {
+         set_file_dirty(fd, FileDirty_Clean);      // data of a previously failed sync has been committed too
+      }
+   }
+   else
+   {
+      set_file_dirty(fd, FileDirty_Written);     // data will be committed on sync, close or shutdown
+   }
+#endif
+}
+
+
+
+int pclFileWriteData(int fd, const void * buffer, int buffer_size)
+{
+   int size = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileWriteData fd:"), DLT_INT(fd));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
+      if(lock == 0)
+      {
+         size = pclFilePrepareWrite(fd, -1, (size_t)buffer_size);
+         if(size == 0)
+         {
+#if USE_FILECACHE
+            if(get_file_cache_status(fd) == 1 && get_file_user_id(fd) !=  (int)PCL_USER_DEFAULTDATA)
+            {
+               size = pfcWriteFile(fd, buffer, buffer_size);
+            }
+            else
+            {
+               size = write(fd, buffer, buffer_size);
+            }
+#else
+            size = (int)write(fd, buffer, (size_t)buffer_size);
+#endif
+            pclFileSyncAfterWrite(fd);
+         }
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileWriteData - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileWriteData - not initialized"));
+   }
+
+   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileWriteData fd:"), DLT_INT(fd));
+
+   pers_stat_file_call(fd, PclStat_FileWrite, size, start);
+   PCL_TRACE_EVENT(PclTrace_FileWrite, fd, pers_stat_file_ldbid(fd), size, start);
+
+   return size;
+}
+
+
+
+int pclFileWriteAt(int fd, const void * buffer, int buffer_size, long offset)
+{
+   int size = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileWriteAt fd:"), DLT_INT(fd));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
+      if(lock == 0)
+      {
+         size = pclFilePrepareWrite(fd, (off_t)offset, (size_t)buffer_size);
+         if(size == 0)
+         {
+#if USE_FILECACHE
+            if(get_file_cache_status(fd) == 1 && get_file_user_id(fd) !=  (int)PCL_USER_DEFAULTDATA)
+            {
+               // the file cache has no positional write, keep the file offset unchanged
+               int curPos = pfcFileSeek(fd, 0, SEEK_CUR);
+               size = pfcFileSeek(fd, offset, SEEK_SET);
+               if(size != -1)
+               {
+                  size = pfcWriteFile(fd, buffer, buffer_size);
+               }
+               (void)pfcFileSeek(fd, curPos, SEEK_SET);
+            }
+            else
+            {
+               size = pwrite(fd, buffer, buffer_size, offset);
+            }
+#else
+            size = (int)pwrite(fd, buffer, (size_t)buffer_size, (off_t)offset);
+#endif
+            pclFileSyncAfterWrite(fd);
+         }
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileWriteAt - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileWriteAt - not initialized"));
+   }
+
+   pers_stat_file_call(fd, PclStat_FileWrite, size, start);
+   PCL_TRACE_EVENT(PclTrace_FileWrite, fd, pers_stat_file_ldbid(fd), size, start);
 
-            dbContext.context.ldbid   = ldbid;
-            dbContext.context.seat_no = seat_no;
-            dbContext.context.user_no = user_no;
+   return size;
+}
 
-            // get database context: database path and database key
-            shared_DB = get_db_context(&dbContext, resource_id, ResIsFile, dbKey, dbPath);
 
-            if(   (shared_DB >= 0)                                               // check valid database context
-               && (dbContext.configKey.type == PersistenceResourceType_file) )   // check if type matches
+
+int pclFileWriteV(int fd, const struct iovec* iov, int iovcnt)
+{
+   int size = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileWriteV fd:"), DLT_INT(fd));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(pclFileHandleMtx(fd));
+      if(lock == 0)
+      {
+         size_t totalSize = 0;
+
+         if(pclFileIovSize(iov, iovcnt, &totalSize) != -1)
+         {
+            // backup and journal cover the whole range of all buffers
+            size = pclFilePrepareWrite(fd, -1, totalSize);
+            if(size == 0)
             {
-               rval = remove(dbPath);
-               if(rval == -1)
+#if USE_FILECACHE
+               if(get_file_cache_status(fd) == 1 && get_file_user_id(fd) !=  (int)PCL_USER_DEFAULTDATA)
                {
-                  DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileRemove - remove()"), DLT_STRING(resource_id), DLT_STRING(strerror(errno)) );
+                  int i = 0, written = 0;
+
+                  for(i=0; i<iovcnt; i++)
+                  {
+                     written = pfcWriteFile(fd, iov[i].iov_base, (int)iov[i].iov_len);
+                     if(written == -1)
+                     {
+                        size = -1;
+                        break;
+                     }
+                     size += written;
+                  }
                }
-            }
-            else
-            {
-               rval = shared_DB;
-               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("fileRemove - no valid db context or res not a file"));
+               else
+               {
+                  size = writev(fd, iov, iovcnt);
+               }
+#else
+               size = (int)writev(fd, iov, iovcnt);
+#endif
+               pclFileSyncAfterWrite(fd);
             }
          }
          else
          {
-            rval = EPERS_LOCKFS;
+            size = EPERS_COMMON;
          }
-         pthread_mutex_unlock(&gFileAccessMtx);
+         pthread_mutex_unlock(pclFileHandleMtx(fd));
       }
       else
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileRemove - mutex lock failed:"), DLT_INT(lock));
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileWriteV - mutex lock failed:"), DLT_INT(lock));
       }
    }
    else
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileRemove - not initialized"));
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileWriteV - not initialized"));
+   }
+
+   pers_stat_file_call(fd, PclStat_FileWrite, size, start);
+   PCL_TRACE_EVENT(PclTrace_FileWrite, fd, pers_stat_file_ldbid(fd), size, start);
+
+   return size;
+}
+
+
+static int pclFileAtomicGetPath(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
+                                PclAtomicFile_s* atomic)
+{
+   int rval = 0, shared_DB = 0;
+   PersistenceInfo_s dbContext;
+   char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME] = {0};    // database key
+
+   dbContext.context.ldbid   = ldbid;
+   dbContext.context.seat_no = seat_no;
+   dbContext.context.user_no = user_no;
+
+   // get database context: database path and database key
+   shared_DB = get_db_context(&dbContext, resource_id, ResIsFile, dbKey, atomic->path);
+
+   if(dbContext.configKey.type != PersistenceResourceType_file)
+   {
+      rval = EPERS_RESOURCE_NO_FILE;
+   }
+   else if(user_no == (unsigned int)PCL_USER_DEFAULTDATA)
+   {
+      rval = EPERS_COMMON;             // default data will not be replaced
+   }
+   else if(shared_DB >= 0 && dbContext.configKey.permission == PersistencePermission_ReadOnly)
+   {
+      rval = EPERS_RESOURCE_READ_ONLY;
+   }
+   else
+   {
+      pclFileGetBackupPath(dbContext.configKey.policy, atomic->path, atomic->backupPath, atomic->csumPath);
+
+      if(shared_DB < 0)    // requested resource is not in the RCT, resource is local/cached (see pclFileOpenRegular)
+      {
+         snprintf(atomic->path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getLocalCacheFilePath(), gAppId, user_no, seat_no, resource_id);
+      }
+
+      snprintf(atomic->tmpPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s%d.%u", atomic->path, gAtomicPostfix,
+               getpid(), __sync_add_and_fetch(&gAtomicFileCount, 1));
    }
 
-   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileRemove - ldbid"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
    return rval;
 }
 
 
 
-int pclFileSeek(int fd, long int offset, int whence)
+static void pclFileSyncDir(const char* path)
 {
-   int rval = EPERS_NOT_INITIALIZED;
+   char dirPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+   char* delimiter = NULL;
+
+   strncpy(dirPath, path, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
+   dirPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
+
+   delimiter = strrchr(dirPath, '/');
+   if(delimiter != NULL && delimiter != dirPath)
+   {
+      int dirFd = -1;
+
+      *delimiter = '\0';
+      dirFd = open(dirPath, O_RDONLY | O_DIRECTORY);
+      if(dirFd != -1)
+      {
+         // commit the directory entry of the renamed file
+         if(fsync(dirFd) == -1)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileSyncDir - Failed fsync ==>!"), DLT_STRING(strerror(errno)));
+         }
+         close(dirFd);
+      }
+   }
+}
+
+
+
+/// close the temporary file of an atomic file replace and remove it, called with the file handle mutex locked
+static void pclFileAtomicRelease(int handle)
+{
+   pers_stat_file_close(handle);
+   close(handle);
+   (void)remove(gAtomicFile[handle]->tmpPath);
+   free(gAtomicFile[handle]);
+   gAtomicFile[handle] = NULL;
+}
+
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileSeek - fd"), DLT_INT(fd));
+
+int pclFileAtomicBegin(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no)
+{
+   int handle = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileAtomicBegin - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -685,174 +1823,286 @@ int pclFileSeek(int fd, long int offset, int whence)
       {
          if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
          {
-#if USE_FILECACHE
-            if(get_file_cache_status(fd) == 1)
+            PclAtomicFile_s* atomic = malloc(sizeof(PclAtomicFile_s));
+
+            if(atomic != NULL)
             {
-               rval = pfcFileSeek(fd, offset, whence);
+               handle = pclFileAtomicGetPath(ldbid, resource_id, user_no, seat_no, atomic);
+               if(handle == 0)
+               {
+                  // the temporary file is never cached, it will be renamed on commit
+                  handle = pclCreateFile(atomic->tmpPath, 0);
+
+                  if(handle >= MaxPersHandle)
+                  {
+                     close(handle);
+                     remove(atomic->tmpPath);
+                     handle = EPERS_MAXHANDLE;
+                  }
+                  else if(handle != -1)
+                  {
+                     gAtomicFile[handle] = atomic;
+                     atomic = NULL;
+                  }
+                  else
+                  {
+                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileAtomicBegin - failed create file: "), DLT_STRING(atomic->tmpPath));
+                  }
+               }
+               free(atomic);
             }
             else
             {
-                rval = lseek(fd, offset, whence);
+               handle = EPERS_COMMON;
             }
-#else
-            rval = (int)lseek(fd, offset, whence);
-#endif
          }
          else
          {
-            rval = EPERS_LOCKFS;
+            handle = EPERS_LOCKFS;
          }
          pthread_mutex_unlock(&gFileAccessMtx);
       }
       else
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileSeek - mutex lock failed:"), DLT_INT(lock));
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileAtomicBegin - mutex lock failed:"), DLT_INT(lock));
       }
    }
    else
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileSeek - not initialized"));
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileAtomicBegin - not initialized"));
    }
 
-   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileSeek - fd"), DLT_INT(fd));
+   pers_stat_file_open(handle, ldbid, resource_id, start);
+   PCL_TRACE_EVENT(PclTrace_FileOpen, handle, ldbid, handle, start);
 
-   return rval;
+   return handle;
 }
 
 
 
-int pclFileUnmapData(void* address, long size)
+int pclFileAtomicAppend(int handle, const void* buffer, int buffer_size)
 {
-   int rval = EPERS_NOT_INITIALIZED;
+   int size = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileUnmapData"));
+   PCL_TRACE_LOG(DLT_STRING("pclFileAtomicAppend - handle:"), DLT_INT(handle));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gFileAccessMtx);
-      if(lock  == 0)
+      int lock = pthread_mutex_lock(pclFileHandleMtx(handle));
+      if(lock == 0)
       {
-         if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         if(handle < 0 || handle >= MaxPersHandle || gAtomicFile[handle] == NULL)
          {
-            rval =  munmap(address, (size_t)size);
+            size = EPERS_MAXHANDLE;
+         }
+         else if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         {
+            size = (int)write(handle, buffer, (size_t)buffer_size);
          }
          else
          {
-            rval = EPERS_LOCKFS;
+            size = EPERS_LOCKFS;
          }
-         pthread_mutex_unlock(&gFileAccessMtx);
+         pthread_mutex_unlock(pclFileHandleMtx(handle));
       }
       else
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileUnmapData - mutex lock failed:"), DLT_INT(lock));
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileAtomicAppend - mutex lock failed:"), DLT_INT(lock));
       }
    }
    else
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileUnmapData - not initialized"));
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileAtomicAppend - not initialized"));
    }
 
-   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileUnmapData"));
+   pers_stat_file_call(handle, PclStat_FileWrite, size, start);
+   PCL_TRACE_EVENT(PclTrace_FileWrite, handle, pers_stat_file_ldbid(handle), size, start);
 
-   return rval;
+   return size;
 }
 
 
 
-int pclFileWriteData(int fd, const void * buffer, int buffer_size)
+int pclFileAtomicCommit(int handle)
 {
-   int size = EPERS_NOT_INITIALIZED;
+   int rval = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
+   unsigned int ldbid = pers_stat_file_ldbid(handle);
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileWriteData fd:"), DLT_INT(fd));
+   PCL_TRACE_LOG(DLT_STRING("pclFileAtomicCommit - handle:"), DLT_INT(handle));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gFileAccessMtx);
+      int lock = pthread_mutex_lock(pclFileHandleMtx(handle));
       if(lock == 0)
       {
-         if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         if(handle < 0 || handle >= MaxPersHandle || gAtomicFile[handle] == NULL)
          {
-            int permission = get_file_permission(fd);
-            if(permission != -1)
-            {
-               if(permission != PersistencePermission_ReadOnly )
-               {
-                  // check if a backup file has to be created
-                  if( (get_file_backup_status(fd) == 0) && get_file_user_id(fd) !=  (int)PCL_USER_DEFAULTDATA)
-                  {
-                     char csumBuf[ChecksumBufSize] = {0};
+            rval = EPERS_MAXHANDLE;
+         }
+         else if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         {
+            PclAtomicFile_s* atomic = gAtomicFile[handle];
+            gAtomicFile[handle] = NULL;
 
-                     pclCalcCrc32Csum(fd, csumBuf);      // calculate checksum
+            // the new content must be on the memory device before it replaces the file
+            rval = fsync(handle);
+            pers_stat_file_close(handle);
+            close(handle);
 
-                     pclCreateBackup(get_file_backup_path(fd), fd, get_file_checksum_path(fd), csumBuf); // create checksum and backup file
+            if(rval != -1)
+            {
+               rval = rename(atomic->tmpPath, atomic->path);
+            }
 
-                     set_file_backup_status(fd, 1);
-                  }
-#if USE_FILECACHE
-                  if(get_file_cache_status(fd) == 1 && get_file_user_id(fd) !=  (int)PCL_USER_DEFAULTDATA)
-                  {
-                     size = pfcWriteFile(fd, buffer, buffer_size);
-                  }
-                  else
-                  {
-                     size = write(fd, buffer, buffer_size);
+            if(rval != -1)
+            {
+               pclFileSyncDir(atomic->path);
 
-                     if(fsync(fd) == -1)
-                        DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileWriteData: Failed fsync ==>!"), DLT_STRING(strerror(errno)));
-                  }
-#else
-                  size = (int)write(fd, buffer, (size_t)buffer_size);
-                  if(get_file_cache_status(fd) == 1)
-                  {
-#if USE_FSYNC
-                     if(fsync(fd) == -1)
-#else
-                     if(fdatasync(fd) == -1)
-#endif
-                     {
-                        DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileWriteData - Failed fsync ==>!"), DLT_STRING(strerror(errno)));
-                     }
-                  }
-#endif
-               }
-               else
-               {
-                  DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("fileWriteData - Failed write ==> read only file!"), DLT_STRING(get_file_backup_path(fd)));
-                  size = EPERS_RESOURCE_READ_ONLY;
-               }
+               // a backup left by an interrupted write must not be used to recover the replaced file
+               (void)pclRemoveJournal(atomic->backupPath);
+               (void)remove(atomic->backupPath);
+               (void)remove(atomic->csumPath);
             }
             else
             {
-               size = EPERS_MAXHANDLE;
+               DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileAtomicCommit - Failed to replace file ==>!"), DLT_STRING(strerror(errno)));
+               remove(atomic->tmpPath);
             }
+            free(atomic);
          }
          else
          {
-            size = EPERS_LOCKFS;
+            rval = EPERS_LOCKFS;
          }
-         pthread_mutex_unlock(&gFileAccessMtx);
+         pthread_mutex_unlock(pclFileHandleMtx(handle));
       }
       else
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileWriteData - mutex lock failed:"), DLT_INT(lock));
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileAtomicCommit - mutex lock failed:"), DLT_INT(lock));
       }
    }
    else
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileWriteData - not initialized"));
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileAtomicCommit - not initialized"));
    }
 
-   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclFileWriteData fd:"), DLT_INT(fd));
+   // the commit completes the write of the new content, a failed replace is counted as error
+   pers_stat_call(ldbid, NULL, PclStat_FileWrite, rval, start);
+   PCL_TRACE_EVENT(PclTrace_FileAtomicCommit, handle, ldbid, rval, start);
+
+   return rval;
+}
+
+
+
+int pclFileAtomicAbort(int handle)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+#if USE_TRACE
+   unsigned long long start = pers_stat_now();
+   unsigned int ldbid = pers_stat_file_ldbid(handle);
+#endif
+
+   PCL_TRACE_LOG(DLT_STRING("pclFileAtomicAbort - handle:"), DLT_INT(handle));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      int lock = pthread_mutex_lock(pclFileHandleMtx(handle));
+      if(lock == 0)
+      {
+         if(handle < 0 || handle >= MaxPersHandle || gAtomicFile[handle] == NULL)
+         {
+            rval = EPERS_MAXHANDLE;
+         }
+         else
+         {
+            pclFileAtomicRelease(handle);
+            rval = 0;
+         }
+         pthread_mutex_unlock(pclFileHandleMtx(handle));
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclFileAtomicAbort - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileAtomicAbort - not initialized"));
+   }
+
+   PCL_TRACE_EVENT(PclTrace_FileAtomicAbort, handle, ldbid, rval, start);
+
+   return rval;
+}
+
+
+
+void pclFileAtomicAbortAll(void)
+{
+   int i = 0;
+
+   for(i=0; i<MaxPersHandle; i++)
+   {
+      if(gAtomicFile[i] != NULL && pthread_mutex_lock(pclFileHandleMtx(i)) == 0)
+      {
+         if(gAtomicFile[i] != NULL)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileAtomicAbortAll - atomic replace not committed:"),
+                                                  DLT_STRING(gAtomicFile[i]->path));
+            pclFileAtomicRelease(i);
+         }
+         pthread_mutex_unlock(pclFileHandleMtx(i));
+      }
+   }
+}
+
+
+
+int pclFileWriteAtomic(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
+                       const void* buffer, int buffer_size)
+{
+   int size = 0;
+   int handle = pclFileAtomicBegin(ldbid, resource_id, user_no, seat_no);
+
+   if(handle >= 0)
+   {
+      size = pclFileAtomicAppend(handle, buffer, buffer_size);
+
+      if(size == buffer_size)
+      {
+         int rval = pclFileAtomicCommit(handle);
+         if(rval < 0)
+         {
+            size = rval;
+         }
+      }
+      else
+      {
+         pclFileAtomicAbort(handle);
+         if(size >= 0)
+         {
+            size = EPERS_COMMON;    // incomplete write
+         }
+      }
+   }
+   else
+   {
+      size = handle;
+   }
 
    return size;
 }
 
 
+
 int pclFileCreatePath(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no, char** path, unsigned int* size)
 {
    int handle = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileCreatePath - ldbid"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("pclFileCreatePath - ldbid"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -889,7 +2139,9 @@ int pclFileCreatePath(unsigned int ldbid, const char* resource_id, unsigned int
                   snprintf(backupPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1, "%s%s", dbPath, gBackupPostfix);
                   snprintf(csumPath,   PERS_ORG_MAX_LENGTH_PATH_FILENAME-1, "%s%s", dbPath, gBackupCsPostfix);
 
-                  if((handle = pclVerifyConsistency(dbPath, backupPath, csumPath, flags)) == -1)
+                  // files released cleanly and unchanged since then don't need to be verified
+                  if(   pclLedgerTake(backupPath, dbPath) != 1
+                     && (handle = pclVerifyConsistency(dbPath, backupPath, csumPath, flags)) == -1)
                   {
                      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("fileCreatePath - file inconsistent, recovery  NOT  possible!"));
                      pthread_mutex_unlock(&gFileAccessMtx);
@@ -1015,7 +2267,7 @@ int pclFileReleasePath(int pathHandle)
 {
    int rval = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileClose fd: "), DLT_INT(pathHandle));
+   PCL_TRACE_LOG(DLT_STRING("pclFileClose fd: "), DLT_INT(pathHandle));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -1039,6 +2291,19 @@ int pclFileReleasePath(int pathHandle)
                {
                   DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclFileClose - backup remove failed!"), DLT_STRING(strerror(errno)) );
                }
+
+               // remember the state of the released file, it will not be verified on the next create path
+               if(get_ossfile_file_path(pathHandle) != NULL)
+               {
+                  struct stat buf;
+
+                  if(   access(get_ossfile_backup_path(pathHandle), F_OK) == -1
+                     && access(get_ossfile_checksum_path(pathHandle), F_OK) == -1
+                     && stat(get_ossfile_file_path(pathHandle), &buf) == 0)
+                  {
+                     pclLedgerAdd(get_ossfile_backup_path(pathHandle), &buf);
+                  }
+               }
             }
             free(get_ossfile_file_path(pathHandle));
 
@@ -1084,7 +2349,7 @@ int pclFileGetDefaultData(int handle, const char* resource_id, int policy)
 	char pathPrefix[PERS_ORG_MAX_LENGTH_PATH_FILENAME]  = { [0 ... PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = 0};
 	char defaultPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = { [0 ... PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = 0};
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclFileGetDefaultData fd: "), DLT_INT(handle), DLT_STRING(" res:"),DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("pclFileGetDefaultData fd: "), DLT_INT(handle), DLT_STRING(" res:"),DLT_STRING(resource_id));
 
 	// create path to default data
 	if(policy == PersistencePolicy_wc)
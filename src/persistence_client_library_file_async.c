@@ -0,0 +1,558 @@
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_file_async.c
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Implementation of the persistence client library asynchronous file access.
+ *                 Requests are queued and executed by a pool of worker threads
+ *                 using the synchronous file functions.
+ * @see
+ */
+
+#include "persistence_client_library_file_async.h"
+#include "persistence_client_library_file.h"
+#include "persistence_client_library_pas_interface.h"
+#include "persistence_client_library_handle.h"
+#include "persistence_client_library_trace.h"
+
+#include <sys/timerfd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <dlt.h>
+
+DLT_IMPORT_CONTEXT(gPclDLTContext);
+
+
+/// asynchronous request type
+typedef enum _PclAsyncType_e
+{
+   /// positional read ::pclFileReadAt
+   PclAsync_Read = 0,
+   /// positional write ::pclFileWriteAt
+   PclAsync_Write,
+   /// sync ::pclFileSync
+   PclAsync_Sync
+
+} PclAsyncType_e;
+
+/// asynchronous request state
+typedef enum _PclAsyncState_e
+{
+   /// request slot is not used
+   PclAsyncState_Free = 0,
+   /// request is queued or being executed
+   PclAsyncState_Pending,
+   /// request has been executed, result can be polled
+   PclAsyncState_Done
+
+} PclAsyncState_e;
+
+/// asynchronous request
+typedef struct _PclAsyncRequest_s
+{
+   /// the request type
+   PclAsyncType_e type;
+   /// the request state
+   PclAsyncState_e state;
+   /// the file descriptor
+   int fd;
+   /// the buffer to read to or write from
+   void* buffer;
+   /// the buffer size
+   int size;
+   /// the file offset
+   long offset;
+   /// the result of the synchronous function
+   int result;
+   /// the completion callback, if NULL the result must be polled
+   pclFileAsyncCallback_t callback;
+   /// the user data given to the callback
+   void* userData;
+} PclAsyncRequest_s;
+
+
+/// asynchronous request slots, the request id is the slot index + 1
+static PclAsyncRequest_s gAsyncRequest[MaxAsyncFileRequests];
+/// queue of pending request slots
+static int gAsyncQueue[MaxAsyncFileRequests] = {0};
+/// queue head index
+static int gAsyncQueueHead = 0;
+/// number of queued requests
+static int gAsyncQueueCount = 0;
+
+/// worker threads
+static pthread_t gAsyncWorker[AsyncFileWorkerThreads];
+/// number of running worker threads
+static int gAsyncWorkerCount = 0;
+/// flag to stop the worker threads when the queue is empty
+static int gAsyncWorkerStop = 0;
+/// flag set by the deinitialization, no requests are accepted and no workers are started until the next init
+static int gAsyncStopped = 0;
+
+/// mutex to protect request slots and queue
+static pthread_mutex_t gAsyncMtx        = PTHREAD_MUTEX_INITIALIZER;
+/// condition to signal a queued request to the workers
+static pthread_cond_t  gAsyncQueueCond  = PTHREAD_COND_INITIALIZER;
+/// condition to signal a finished request to waiting callers
+static pthread_cond_t  gAsyncDoneCond   = PTHREAD_COND_INITIALIZER;
+
+/// timer to commit the data of files with the interval sync policy
+static int gSyncTimerFd = -1;
+/// time in ms the sync timer is armed for, 0 if not armed
+static unsigned long long gSyncTimerDue = 0;
+/// mutex to protect the sync timer
+static pthread_mutex_t gSyncTimerMtx    = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+static void* pclFileAsyncWorker(void* dataPtr)
+{
+   (void)dataPtr;
+
+   pthread_mutex_lock(&gAsyncMtx);
+
+   for(;;)
+   {
+      int idx = 0;
+      PclAsyncRequest_s request;
+
+      while(gAsyncQueueCount == 0 && gAsyncWorkerStop == 0)
+      {
+         pthread_cond_wait(&gAsyncQueueCond, &gAsyncMtx);
+      }
+
+      if(gAsyncQueueCount == 0)    // stop requested and all requests done
+      {
+         break;
+      }
+
+      idx = gAsyncQueue[gAsyncQueueHead];
+      gAsyncQueueHead = (gAsyncQueueHead + 1) % MaxAsyncFileRequests;
+      gAsyncQueueCount--;
+
+      request = gAsyncRequest[idx];
+      pthread_mutex_unlock(&gAsyncMtx);
+
+      switch(request.type)
+      {
+         case PclAsync_Read:
+            request.result = pclFileReadAt(request.fd, request.buffer, request.size, request.offset);
+            break;
+         case PclAsync_Write:
+            request.result = pclFileWriteAt(request.fd, request.buffer, request.size, request.offset);
+            break;
+         case PclAsync_Sync:
+            request.result = pclFileSync(request.fd);
+            break;
+         default:
+            request.result = EPERS_COMMON;
+            break;
+      }
+
+      if(request.callback != NULL)
+      {
+         request.callback(idx+1, request.result, request.userData);
+      }
+
+      pthread_mutex_lock(&gAsyncMtx);
+      if(request.callback != NULL)
+      {
+         gAsyncRequest[idx].state = PclAsyncState_Free;
+      }
+      else
+      {
+         gAsyncRequest[idx].result = request.result;
+         gAsyncRequest[idx].state  = PclAsyncState_Done;
+      }
+      pthread_cond_broadcast(&gAsyncDoneCond);
+   }
+
+   pthread_mutex_unlock(&gAsyncMtx);
+
+   return NULL;
+}
+
+
+
+static int pclFileAsyncStartWorker(void)
+{
+   int rval = 0;
+
+   if(gAsyncWorkerCount == 0)
+   {
+      int i = 0;
+
+      gAsyncWorkerStop = 0;
+
+      for(i=0; i<AsyncFileWorkerThreads; i++)
+      {
+         if(pthread_create(&gAsyncWorker[gAsyncWorkerCount], NULL, pclFileAsyncWorker, NULL) == 0)
+         {
+            gAsyncWorkerCount++;
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("fileAsync - failed to create worker thread:"), DLT_INT(i));
+         }
+      }
+
+      if(gAsyncWorkerCount == 0)
+      {
+         rval = -1;
+      }
+   }
+
+   return rval;
+}
+
+
+
+static int pclFileAsyncSubmit(PclAsyncType_e type, int fd, void* buffer, int size, long offset,
+                              pclFileAsyncCallback_t callback, void* userData)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      if(type != PclAsync_Write || AccessNoLock != isAccessLocked())   // check if write access to persistent data is locked
+      {
+         int lock = pthread_mutex_lock(&gAsyncMtx);
+         if(lock == 0)
+         {
+            if(gAsyncStopped == 1)    // the library is being deinitialized, the files will be closed
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileAsyncSubmit - deinitialized"));
+            }
+            else if(pclFileAsyncStartWorker() != -1)
+            {
+               int i = 0;
+
+               rval = EPERS_MAXHANDLE;
+               for(i=0; i<MaxAsyncFileRequests; i++)
+               {
+                  if(gAsyncRequest[i].state == PclAsyncState_Free)
+                  {
+                     gAsyncRequest[i].type     = type;
+                     gAsyncRequest[i].state    = PclAsyncState_Pending;
+                     gAsyncRequest[i].fd       = fd;
+                     gAsyncRequest[i].buffer   = buffer;
+                     gAsyncRequest[i].size     = size;
+                     gAsyncRequest[i].offset   = offset;
+                     gAsyncRequest[i].result   = 0;
+                     gAsyncRequest[i].callback = callback;
+                     gAsyncRequest[i].userData = userData;
+
+                     gAsyncQueue[(gAsyncQueueHead + gAsyncQueueCount) % MaxAsyncFileRequests] = i;
+                     gAsyncQueueCount++;
+                     pthread_cond_signal(&gAsyncQueueCond);
+
+                     rval = i+1;    // request id
+                     break;
+                  }
+               }
+            }
+            else
+            {
+               rval = EPERS_COMMON;
+            }
+            pthread_mutex_unlock(&gAsyncMtx);
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("fileAsyncSubmit - mutex lock failed:"), DLT_INT(lock));
+         }
+      }
+      else
+      {
+         rval = EPERS_LOCKFS;
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileAsyncSubmit - not initialized"));
+   }
+
+   return rval;
+}
+
+
+
+static int pclFileAsyncResult(int requestId, int* result, int wait)
+{
+   int rval = EPERS_COMMON;
+   int idx = requestId - 1;
+
+   if(idx >= 0 && idx < MaxAsyncFileRequests && result != NULL)
+   {
+      int lock = pthread_mutex_lock(&gAsyncMtx);
+      if(lock == 0)
+      {
+         if(gAsyncRequest[idx].state != PclAsyncState_Free && gAsyncRequest[idx].callback == NULL)
+         {
+            while(wait == 1 && gAsyncRequest[idx].state == PclAsyncState_Pending)
+            {
+               pthread_cond_wait(&gAsyncDoneCond, &gAsyncMtx);
+            }
+
+            if(gAsyncRequest[idx].state == PclAsyncState_Done)
+            {
+               *result = gAsyncRequest[idx].result;
+               gAsyncRequest[idx].state = PclAsyncState_Free;
+               rval = 1;
+            }
+            else
+            {
+               rval = 0;
+            }
+         }
+         pthread_mutex_unlock(&gAsyncMtx);
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("fileAsyncResult - mutex lock failed:"), DLT_INT(lock));
+      }
+   }
+
+   return rval;
+}
+
+
+
+static unsigned long long pclFileSyncTimeMs(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return ((unsigned long long)now.tv_sec * 1000ULL) + ((unsigned long long)now.tv_nsec / 1000000ULL);
+}
+
+
+
+int pclFileSyncTimerInit(void)
+{
+   if(pthread_mutex_lock(&gSyncTimerMtx) == 0)
+   {
+      if(gSyncTimerFd == -1)
+      {
+         gSyncTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+         if(gSyncTimerFd == -1)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileSyncTimer - timerfd_create failed:"), DLT_STRING(strerror(errno)));
+         }
+         gSyncTimerDue = 0;
+      }
+      pthread_mutex_unlock(&gSyncTimerMtx);
+   }
+
+   return gSyncTimerFd;
+}
+
+
+
+void pclFileSyncTimerArm(unsigned long long dueMs)
+{
+   if(pthread_mutex_lock(&gSyncTimerMtx) == 0)
+   {
+      if(gSyncTimerFd != -1 && (gSyncTimerDue == 0 || dueMs < gSyncTimerDue))
+      {
+         struct itimerspec its;
+
+         memset(&its, 0, sizeof(its));
+         its.it_value.tv_sec  = (time_t)(dueMs / 1000ULL);
+         its.it_value.tv_nsec = (long)((dueMs % 1000ULL) * 1000000ULL);
+         if(its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+         {
+            its.it_value.tv_nsec = 1;     // a zero value would disarm the timer
+         }
+
+         if(timerfd_settime(gSyncTimerFd, TFD_TIMER_ABSTIME, &its, NULL) == 0)
+         {
+            gSyncTimerDue = dueMs;
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("fileSyncTimer - timerfd_settime failed:"), DLT_STRING(strerror(errno)));
+         }
+      }
+      pthread_mutex_unlock(&gSyncTimerMtx);
+   }
+}
+
+
+
+static void pclFileSyncTimerDone(int requestId, int result, void* userData)
+{
+   (void)requestId;
+   (void)userData;
+
+   if(result < 0)    // the file is still dirty, try again later
+   {
+      pclFileSyncTimerArm(pclFileSyncTimeMs() + FileSyncRetryMs);
+   }
+}
+
+
+
+void pclFileSyncTimerProcess(void)
+{
+   int i = 0, items = 0;
+   int fds[MaxPersHandle];
+   unsigned long long expirations = 0, next = 0, now = pclFileSyncTimeMs();
+
+   if(pthread_mutex_lock(&gSyncTimerMtx) == 0)
+   {
+      (void)read(gSyncTimerFd, &expirations, sizeof(expirations));
+      gSyncTimerDue = 0;
+      pthread_mutex_unlock(&gSyncTimerMtx);
+   }
+
+   if(pthread_mutex_lock(&gFileAccessMtx) == 0)
+   {
+      items = list_get_items(&gOpenFdList, fds, MaxPersHandle);
+      pthread_mutex_unlock(&gFileAccessMtx);
+   }
+
+   for(i=0; i<items; i++)
+   {
+      unsigned int interval = 0;
+
+      if(   get_file_dirty(fds[i]) != FileDirty_Clean
+         && get_file_sync_policy(fds[i], &interval) == PCL_FILE_SYNC_INTERVAL)
+      {
+         unsigned long long due = get_file_last_sync(fds[i]) + interval;
+
+         if(due <= now)
+         {
+            if(pclFileAsyncSubmit(PclAsync_Sync, fds[i], NULL, 0, 0, &pclFileSyncTimerDone, NULL) > 0)
+            {
+               continue;
+            }
+            due = now + FileSyncRetryMs;     // no request slot available
+         }
+
+         if(next == 0 || due < next)
+         {
+            next = due;
+         }
+      }
+   }
+
+   if(next != 0)
+   {
+      pclFileSyncTimerArm(next);
+   }
+}
+
+
+
+void pclFileSyncTimerDeinit(void)
+{
+   if(pthread_mutex_lock(&gSyncTimerMtx) == 0)
+   {
+      if(gSyncTimerFd != -1)
+      {
+         close(gSyncTimerFd);
+         gSyncTimerFd = -1;
+      }
+      gSyncTimerDue = 0;
+      pthread_mutex_unlock(&gSyncTimerMtx);
+   }
+}
+
+
+
+int pclFileReadAsync(int fd, void * buffer, int buffer_size, long offset, pclFileAsyncCallback_t callback, void* userData)
+{
+   PCL_TRACE_LOG(DLT_STRING("pclFileReadAsync - fd:"), DLT_INT(fd));
+
+   return pclFileAsyncSubmit(PclAsync_Read, fd, buffer, buffer_size, offset, callback, userData);
+}
+
+
+
+int pclFileWriteAsync(int fd, const void * buffer, int buffer_size, long offset, pclFileAsyncCallback_t callback, void* userData)
+{
+   PCL_TRACE_LOG(DLT_STRING("pclFileWriteAsync - fd:"), DLT_INT(fd));
+
+   return pclFileAsyncSubmit(PclAsync_Write, fd, (void*)buffer, buffer_size, offset, callback, userData);
+}
+
+
+
+int pclFileSyncAsync(int fd, pclFileAsyncCallback_t callback, void* userData)
+{
+   PCL_TRACE_LOG(DLT_STRING("pclFileSyncAsync - fd:"), DLT_INT(fd));
+
+   return pclFileAsyncSubmit(PclAsync_Sync, fd, NULL, 0, 0, callback, userData);
+}
+
+
+
+int pclFileAsyncPoll(int requestId, int* result)
+{
+   return pclFileAsyncResult(requestId, result, 0);
+}
+
+
+
+int pclFileAsyncWait(int requestId, int* result)
+{
+   return pclFileAsyncResult(requestId, result, 1);
+}
+
+
+
+void pclFileAsyncInit(void)
+{
+   if(pthread_mutex_lock(&gAsyncMtx) == 0)
+   {
+      gAsyncStopped = 0;
+      pthread_mutex_unlock(&gAsyncMtx);
+   }
+}
+
+
+
+void pclFileAsyncDeinit(void)
+{
+   if(pthread_mutex_lock(&gAsyncMtx) == 0)
+   {
+      gAsyncStopped = 1;      // the sync timer or the application must not start the workers again
+
+      if(gAsyncWorkerCount > 0)
+      {
+         int i = 0;
+
+         gAsyncWorkerStop = 1;
+         pthread_cond_broadcast(&gAsyncQueueCond);
+         pthread_mutex_unlock(&gAsyncMtx);
+
+         for(i=0; i<gAsyncWorkerCount; i++)   // workers finish the queued requests before they stop
+         {
+            pthread_join(gAsyncWorker[i], NULL);
+         }
+
+         pthread_mutex_lock(&gAsyncMtx);
+         gAsyncWorkerCount = 0;
+         gAsyncWorkerStop = 0;
+      }
+
+      memset(gAsyncRequest, 0, sizeof(gAsyncRequest));   // drop results which have not been polled
+      gAsyncQueueHead  = 0;
+      gAsyncQueueCount = 0;
+
+      pthread_mutex_unlock(&gAsyncMtx);
+   }
+}
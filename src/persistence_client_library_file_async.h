@@ -0,0 +1,69 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_FILE_ASYNC_H
+#define PERSISTENCE_CLIENT_LIBRARY_FILE_ASYNC_H
+
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_file_async.h
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Header of the persistence client library asynchronous file access.
+ * @see
+ */
+
+#include "persistence_client_library_data_organization.h"
+
+
+/**
+ * @brief accept asynchronous file requests, called on library initialization
+ */
+void pclFileAsyncInit(void);
+
+
+/**
+ * @brief finish all queued asynchronous file requests and stop the worker threads.
+ *        Requests submitted afterwards are rejected with ::EPERS_NOT_INITIALIZED
+ *        until ::pclFileAsyncInit has been called again.
+ */
+void pclFileAsyncDeinit(void);
+
+
+/**
+ * @brief create the timer used to commit the data of files with the ::PCL_FILE_SYNC_INTERVAL policy.
+ *        The timer is polled by the dbus mainloop.
+ *
+ * @return the timer file descriptor to poll or -1 on error
+ */
+int pclFileSyncTimerInit(void);
+
+
+/**
+ * @brief arm the sync timer, a timer armed for an earlier time will be kept
+ *
+ * @param dueMs the time in ms (monotonic clock) a file needs to be committed
+ */
+void pclFileSyncTimerArm(unsigned long long dueMs);
+
+
+/**
+ * @brief commit the data of the files whose sync interval has elapsed,
+ *        the files are committed by the asynchronous file worker threads
+ */
+void pclFileSyncTimerProcess(void);
+
+
+/**
+ * @brief close the sync timer
+ */
+void pclFileSyncTimerDeinit(void);
+
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_FILE_ASYNC_H */
@@ -50,6 +50,9 @@ static int gFreeHandleArray[MaxPersHandle] = { [0 ...MaxPersHandle-1] = 0 };
 /// free handle array head index
 static int gFreeHandleIdxHead = 0;
 
+/// dirty state of the file handles
+static int gFileDirty[MaxPersHandle] = { [0 ...MaxPersHandle-1] = FileDirty_Clean };
+
 
 
 int list_item_insert(PersList_item_s** list, int fd)
@@ -176,6 +179,22 @@ void list_iterate(PersList_item_s** list, int(*callback)(int a))
 }
 
 
+
+int list_get_items(PersList_item_s** list, int* items, int maxItems)
+{
+   int count = 0;
+   PersList_item_s *tmp = *list;
+
+   while(tmp != NULL && count < maxItems)
+   {
+      items[count++] = tmp->fd;
+      tmp = tmp->next;
+   }
+
+   return count;
+}
+
+
 int list_get_size(PersList_item_s** list)
 {
    int lSize = 0;
@@ -415,6 +434,11 @@ int remove_file_handle_data(int idx)
          }
       }
 
+      if(idx >= 0 && idx < MaxPersHandle)
+      {
+         __sync_lock_test_and_set(&gFileDirty[idx], FileDirty_Clean);    // handle will be reused
+      }
+
       pthread_mutex_unlock(&gFileHandleAccessMtx);
    }
 
@@ -449,6 +473,9 @@ int set_file_handle_data(int idx, PersistencePermission_e permission, const char
             item->value.fileHandle.cacheStatus   = -1;            // set to -1 by default
             item->value.fileHandle.userId        = 0;             // default value
             item->value.fileHandle.filePath      = filePath;
+            item->value.fileHandle.syncPolicy    = 0;             // sync per write by default
+            item->value.fileHandle.syncInterval  = 0;
+            item->value.fileHandle.lastSync      = 0;
 
             strncpy(item->value.fileHandle.backupPath, backup, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
             item->value.fileHandle.backupPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
@@ -606,6 +633,9 @@ void set_file_backup_status(int idx, int status)
             item->value.fileHandle.cacheStatus   = -1;            // set to -1 by default
             item->value.fileHandle.userId        = 0;             // default value
             item->value.fileHandle.filePath      = NULL;
+            item->value.fileHandle.syncPolicy    = 0;             // sync per write by default
+            item->value.fileHandle.syncInterval  = 0;
+            item->value.fileHandle.lastSync      = 0;
 
             //debugFileItem("set_file_backup_status => insert => item", item);
             jsw_rbinsert(gFileHandleTree, item);
@@ -685,6 +715,9 @@ void set_file_cache_status(int idx, int status)
             item->value.fileHandle.permission    = PersistencePermission_LastEntry;
             item->value.fileHandle.userId        = 0;             // default value
             item->value.fileHandle.filePath      = NULL;
+            item->value.fileHandle.syncPolicy    = 0;             // sync per write by default
+            item->value.fileHandle.syncInterval  = 0;
+            item->value.fileHandle.lastSync      = 0;
 
             memset(item->value.fileHandle.csumPath  , 0, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
             item->value.fileHandle.csumPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
@@ -766,6 +799,9 @@ void set_file_user_id(int idx, int userID)
             item->value.fileHandle.permission    = -1;
             item->value.fileHandle.cacheStatus   = -1;                  // set to -1 by default
             item->value.fileHandle.filePath      = NULL;
+            item->value.fileHandle.syncPolicy    = 0;             // sync per write by default
+            item->value.fileHandle.syncInterval  = 0;
+            item->value.fileHandle.lastSync      = 0;
 
             memset(item->value.fileHandle.csumPath  , 0, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
             item->value.fileHandle.csumPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
@@ -826,6 +862,166 @@ int get_file_user_id(int idx)
    return id;
 }
 
+
+void set_file_sync_policy(int idx, int policy, unsigned int interval)
+{
+   if(pthread_mutex_lock(&gFileHandleAccessMtx) == 0)
+   {
+      if(gFileHandleTree != NULL)
+      {
+         FileHandleTreeItem_s* item = malloc(sizeof(FileHandleTreeItem_s));
+         if(item != NULL)
+         {
+            FileHandleTreeItem_s* foundItem = NULL;
+            item->key = idx;
+            foundItem = (FileHandleTreeItem_s*)jsw_rbfind(gFileHandleTree, item);
+            if(foundItem != NULL)
+            {
+               FileHandleTreeItem_s* newItem = malloc(sizeof(FileHandleTreeItem_s));
+               if(newItem != NULL)
+               {
+                  memcpy(newItem->value.payload , foundItem->value.payload, sizeof(FileHandleData_u) ); // duplicate value
+
+                  jsw_rberase(gFileHandleTree, foundItem);
+
+                  newItem->key = idx;
+                  newItem->value.fileHandle.syncPolicy   = policy;
+                  newItem->value.fileHandle.syncInterval = interval;
+                  jsw_rbinsert(gFileHandleTree, newItem);
+
+                  free(newItem);
+               }
+            }
+            free(item);
+         }
+      }
+      pthread_mutex_unlock(&gFileHandleAccessMtx);
+   }
+}
+
+int get_file_sync_policy(int idx, unsigned int* interval)
+{
+   int policy = -1;
+   if(pthread_mutex_lock(&gFileHandleAccessMtx) == 0)
+   {
+      if(gFileHandleTree != NULL)
+      {
+         FileHandleTreeItem_s* item = malloc(sizeof(FileHandleTreeItem_s));
+         if(item != NULL)
+         {
+            FileHandleTreeItem_s* foundItem = NULL;
+            item->key = idx;
+            foundItem = (FileHandleTreeItem_s*)jsw_rbfind(gFileHandleTree, item);
+            if(foundItem != NULL)
+            {
+               policy = foundItem->value.fileHandle.syncPolicy;
+               if(interval != NULL)
+               {
+                  *interval = foundItem->value.fileHandle.syncInterval;
+               }
+            }
+            free(item);
+         }
+      }
+      pthread_mutex_unlock(&gFileHandleAccessMtx);
+   }
+   return policy;
+}
+
+
+void set_file_last_sync(int idx, unsigned long long time)
+{
+   if(pthread_mutex_lock(&gFileHandleAccessMtx) == 0)
+   {
+      if(gFileHandleTree != NULL)
+      {
+         FileHandleTreeItem_s* item = malloc(sizeof(FileHandleTreeItem_s));
+         if(item != NULL)
+         {
+            FileHandleTreeItem_s* foundItem = NULL;
+            item->key = idx;
+            foundItem = (FileHandleTreeItem_s*)jsw_rbfind(gFileHandleTree, item);
+            if(foundItem != NULL)
+            {
+               FileHandleTreeItem_s* newItem = malloc(sizeof(FileHandleTreeItem_s));
+               if(newItem != NULL)
+               {
+                  memcpy(newItem->value.payload , foundItem->value.payload, sizeof(FileHandleData_u) ); // duplicate value
+
+                  jsw_rberase(gFileHandleTree, foundItem);
+
+                  newItem->key = idx;
+                  newItem->value.fileHandle.lastSync = time;
+                  jsw_rbinsert(gFileHandleTree, newItem);
+
+                  free(newItem);
+               }
+            }
+            free(item);
+         }
+      }
+      pthread_mutex_unlock(&gFileHandleAccessMtx);
+   }
+}
+
+unsigned long long get_file_last_sync(int idx)
+{
+   unsigned long long time = 0;
+   if(pthread_mutex_lock(&gFileHandleAccessMtx) == 0)
+   {
+      if(gFileHandleTree != NULL)
+      {
+         FileHandleTreeItem_s* item = malloc(sizeof(FileHandleTreeItem_s));
+         if(item != NULL)
+         {
+            FileHandleTreeItem_s* foundItem = NULL;
+            item->key = idx;
+            foundItem = (FileHandleTreeItem_s*)jsw_rbfind(gFileHandleTree, item);
+            if(foundItem != NULL)
+            {
+               time = foundItem->value.fileHandle.lastSync;
+            }
+            free(item);
+         }
+      }
+      pthread_mutex_unlock(&gFileHandleAccessMtx);
+   }
+   return time;
+}
+
+
+void set_file_dirty(int idx, int state)
+{
+   if(idx >= 0 && idx < MaxPersHandle)
+   {
+      if(state == FileDirty_Mapped)
+      {
+         __sync_lock_test_and_set(&gFileDirty[idx], FileDirty_Mapped);
+      }
+      else if(state == FileDirty_Written)
+      {
+         (void)__sync_bool_compare_and_swap(&gFileDirty[idx], FileDirty_Clean, FileDirty_Written);
+      }
+      else
+      {
+         (void)__sync_bool_compare_and_swap(&gFileDirty[idx], FileDirty_Written, FileDirty_Clean);
+      }
+   }
+}
+
+
+int get_file_dirty(int idx)
+{
+   int state = FileDirty_Clean;
+
+   if(idx >= 0 && idx < MaxPersHandle)
+   {
+      state = __sync_add_and_fetch(&gFileDirty[idx], 0);
+   }
+
+   return state;
+}
+
 //----------------------------------------------------------
 //----------------------------------------------------------
 
@@ -22,6 +22,8 @@
 
 #include "persistence_client_library_data_organization.h"
 
+#include <pthread.h>
+
 
 /// key handle structure definition
 typedef struct _PersistenceKeyHandle_s
@@ -63,6 +65,12 @@ typedef struct _PersistenceFileHandle_s
    char csumPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
    /// the file path
    char* filePath;
+   /// the sync policy (PCL_FILE_SYNC_PER_WRITE, PCL_FILE_SYNC_ON_CLOSE, PCL_FILE_SYNC_INTERVAL)
+   int syncPolicy;
+   /// the sync interval in ms, used by PCL_FILE_SYNC_INTERVAL
+   unsigned int syncInterval;
+   /// the time of the last sync in ms (monotonic clock)
+   unsigned long long lastSync;
 } PersistenceFileHandle_s;
 
 
@@ -73,6 +81,9 @@ extern PersList_item_s* gCPOpenFdList;
 /// list to store open file handles
 extern PersList_item_s* gOpenFdList;
 
+/// mutex to protect the list of open file handles
+extern pthread_mutex_t gFileAccessMtx;
+
 
 //----------------------------------------------------------------
 //----------------------------------------------------------------
@@ -106,6 +117,13 @@ void set_persistence_handle_close_idx(int handle);
  */
 void close_all_persistence_handle();
 
+
+/**
+ * @brief abort the atomic file replaces in progress, the temporary files will be removed
+ *
+ */
+void pclFileAtomicAbortAll(void);
+
 //----------------------------------------------------------------
 //----------------------------------------------------------------
 
@@ -269,6 +287,72 @@ void set_file_user_id(int idx, int userID);
  * @return the user id
  */
 int get_file_user_id(int idx);
+
+
+/**
+ * @brief set the sync policy of the file
+ * @attention "No index check will be done"
+ *
+ * @param idx the index
+ * @param policy the sync policy
+ * @param interval the sync interval in ms
+ */
+void set_file_sync_policy(int idx, int policy, unsigned int interval);
+
+
+/**
+ * @brief get the sync policy of the file
+ * @attention "No index check will be done"
+ *
+ * @param idx the index
+ * @param interval returns the sync interval in ms, can be NULL
+ *
+ * @return the sync policy or -1 if the file is not available
+ */
+int get_file_sync_policy(int idx, unsigned int* interval);
+
+
+/**
+ * @brief set the time of the last sync of the file
+ * @attention "No index check will be done"
+ *
+ * @param idx the index
+ * @param time the time in ms
+ */
+void set_file_last_sync(int idx, unsigned long long time);
+
+
+/**
+ * @brief get the time of the last sync of the file
+ * @attention "No index check will be done"
+ *
+ * @param idx the index
+ *
+ * @return the time in ms
+ */
+unsigned long long get_file_last_sync(int idx);
+
+
+/**
+ * @brief set the dirty state of the file.
+ *        ::FileDirty_Written will not overwrite ::FileDirty_Mapped,
+ *        ::FileDirty_Clean only clears ::FileDirty_Written, a file mapped
+ *        writable stays dirty until it will be closed
+ *
+ * @param idx the index
+ * @param state ::FileDirty_Clean, ::FileDirty_Written or ::FileDirty_Mapped
+ */
+void set_file_dirty(int idx, int state);
+
+
+/**
+ * @brief get the dirty state of the file
+ *
+ * @param idx the index
+ *
+ * @return ::FileDirty_Clean, ::FileDirty_Written or ::FileDirty_Mapped
+ */
+int get_file_dirty(int idx);
 //----------------------------------------------------------------
 //----------------------------------------------------------------
 
@@ -417,5 +501,17 @@ void list_destroy(PersList_item_s** list);
  */
 void list_iterate(PersList_item_s** list, int(*callback)(int a));
 
+
+/**
+ * @brief copy the file handles of the list into an array
+ *
+ * @param list the list to copy the file handles from
+ * @param items the array to store the file handles
+ * @param maxItems the size of the array
+ *
+ * @return the number of file handles stored in the array
+ */
+int list_get_items(PersList_item_s** list, int* items, int maxItems);
+
 #endif /* PERSISTENCY_CLIENT_LIBRARY_HANDLE_H */
 
@@ -22,8 +22,11 @@
 #include "persistence_client_library_pas_interface.h"
 #include "persistence_client_library_prct_access.h"
 #include "persistence_client_library_db_access.h"
+#include "persistence_client_library_statistics.h"
+#include "persistence_client_library_trace.h"
 
 #include <dlt.h>
+#include <stdlib.h>
 
 DLT_IMPORT_CONTEXT(gPclDLTContext);
 
@@ -37,6 +40,9 @@ static pthread_mutex_t gKeyAPIAccessMtx = PTHREAD_MUTEX_INITIALIZER;
 static int handleRegNotifyOnChange(int key_handle, pclChangeNotifyCallback_t callback, PersNotifyRegPolicy_e regPolicy);
 static int regNotifyOnChange(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
                       pclChangeNotifyCallback_t callback, PersNotifyRegPolicy_e regPolicy);
+static int handleCustomAccess(int key_handle, const PersistenceKeyHandle_s* persHandle, PclStatCounter_e op,
+                              unsigned char* buffer, int buffer_size, int* size);
+static int batchAccess(pclKeyBatchItem_s* items, int numItems, int write);
 
 #if USE_APPCHECK
 extern int doAppcheck(void);
@@ -52,7 +58,7 @@ int pclKeyHandleOpen(unsigned int ldbid, const char* resource_id, unsigned int u
 {
    int rval   = 0, handle = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("keyHandleOpen - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("keyHandleOpen - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res:"), DLT_STRING(resource_id));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -81,6 +87,12 @@ int pclKeyHandleOpen(unsigned int ldbid, const char* resource_id, unsigned int u
                {
                   // remember data in handle array
                   handle = set_key_handle_data(get_persistence_handle_idx(), resource_id, ldbid, user_no, seat_no);
+
+                  if(handle > 0 && dbContext.configKey.storage == PersistenceStorage_custom)
+                  {
+                     // access the custom storage through a plugin handle, if supported by the plugin
+                     (void)persistence_custom_handle_open(handle, dbPath, dbKey, &dbContext);
+                  }
                }
                else
                {
@@ -121,7 +133,7 @@ int pclKeyHandleClose(int key_handle)
 {
    int rval = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleClose - key_handle:"), DLT_INT(key_handle));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyHandleClose - key_handle:"), DLT_INT(key_handle));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -140,6 +152,7 @@ int pclKeyHandleClose(int key_handle)
                if ('\0' != persHandle.resource_id[0])
                {
                   /* Invalidate key handle data */
+                  persistence_custom_handle_close(key_handle);
                   set_persistence_handle_close_idx(key_handle);
                   clear_key_handle_array(key_handle);
                   rval = 1;
@@ -183,7 +196,7 @@ int pclKeyHandleGetSize(int key_handle)
 {
    int size = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleGetSize - key_handle:"), DLT_INT(key_handle));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyHandleGetSize - key_handle:"), DLT_INT(key_handle));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -200,8 +213,11 @@ int pclKeyHandleGetSize(int key_handle)
             {
                if ('\0' != persHandle.resource_id[0])
                {
-                size = pclKeyGetSize(persHandle.ldbid, persHandle.resource_id,
-                                     persHandle.user_no, persHandle.seat_no);
+                if(handleCustomAccess(key_handle, &persHandle, PclStat_KeySize, NULL, 0, &size) == 0)
+                {
+                   size = pclKeyGetSize(persHandle.ldbid, persHandle.resource_id,
+                                        persHandle.user_no, persHandle.seat_no);
+                }
                }
                else
                {
@@ -242,7 +258,7 @@ int pclKeyHandleReadData(int key_handle, unsigned char* buffer, int buffer_size)
 {
    int size = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleReadData - key_handle:"), DLT_INT(key_handle));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyHandleReadData - key_handle:"), DLT_INT(key_handle));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -259,9 +275,12 @@ int pclKeyHandleReadData(int key_handle, unsigned char* buffer, int buffer_size)
             {
                if ('\0' != persHandle.resource_id[0])
                {
-                size = pclKeyReadData(persHandle.ldbid, persHandle.resource_id,
-                                      persHandle.user_no, persHandle.seat_no,
-                                      buffer, buffer_size);
+                if(handleCustomAccess(key_handle, &persHandle, PclStat_KeyRead, buffer, buffer_size, &size) == 0)
+                {
+                   size = pclKeyReadData(persHandle.ldbid, persHandle.resource_id,
+                                         persHandle.user_no, persHandle.seat_no,
+                                         buffer, buffer_size);
+                }
                }
                else
                {
@@ -302,7 +321,7 @@ int pclKeyHandleRegisterNotifyOnChange(int key_handle, pclChangeNotifyCallback_t
 {
    int rval = EPERS_COMMON;
    int lock = 0;
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleRegisterNotifyOnChange - key_handle:"), DLT_INT(key_handle));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyHandleRegisterNotifyOnChange - key_handle:"), DLT_INT(key_handle));
 
    lock = pthread_mutex_lock(&gKeyAPIHandleAccessMtx);
    if(lock == 0)
@@ -335,7 +354,7 @@ int pclKeyHandleUnRegisterNotifyOnChange(int key_handle, pclChangeNotifyCallback
    int rval = EPERS_NOT_INITIALIZED;
    int lock = 0;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleUnRegisterNotifyOnChange - key_handle:"), DLT_INT(key_handle));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyHandleUnRegisterNotifyOnChange - key_handle:"), DLT_INT(key_handle));
 
    lock = pthread_mutex_lock(&gKeyAPIHandleAccessMtx);
    if(lock == 0)
@@ -360,7 +379,7 @@ int handleRegNotifyOnChange(int key_handle, pclChangeNotifyCallback_t callback,
 {
    int rval = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("handleRegNotifyOnChange - key_handle:"), DLT_INT(key_handle));
+   PCL_TRACE_LOG(DLT_STRING("handleRegNotifyOnChange - key_handle:"), DLT_INT(key_handle));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -400,7 +419,7 @@ int pclKeyHandleWriteData(int key_handle, unsigned char* buffer, int buffer_size
 {
    int size = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleWriteData - key_handle:"), DLT_INT(key_handle));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyHandleWriteData - key_handle:"), DLT_INT(key_handle));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -417,8 +436,11 @@ int pclKeyHandleWriteData(int key_handle, unsigned char* buffer, int buffer_size
             {
                if ('\0' != persHandle.resource_id[0])
                {
-                size = pclKeyWriteData(persHandle.ldbid,   persHandle.resource_id,
-                                       persHandle.user_no, persHandle.seat_no, buffer, buffer_size);
+                if(handleCustomAccess(key_handle, &persHandle, PclStat_KeyWrite, buffer, buffer_size, &size) == 0)
+                {
+                   size = pclKeyWriteData(persHandle.ldbid,   persHandle.resource_id,
+                                          persHandle.user_no, persHandle.seat_no, buffer, buffer_size);
+                }
                }
                else
                {
@@ -457,6 +479,57 @@ int pclKeyHandleWriteData(int key_handle, unsigned char* buffer, int buffer_size
 
 
 
+/// access a key through the plugin handle of a key handle on a custom storage resource.
+/// Returns 0 if the access has to be done by the resource id: the key handle has no plugin handle,
+/// access is locked, the resource is read only or no data is available and the default data has to be read.
+static int handleCustomAccess(int key_handle, const PersistenceKeyHandle_s* persHandle, PclStatCounter_e op,
+                              unsigned char* buffer, int buffer_size, int* size)
+{
+   int rval = EPERS_NOPLUGINFUNCT;
+   unsigned long long start = pers_stat_now();
+
+   if(pthread_mutex_lock(&gKeyAPIAccessMtx) == 0)
+   {
+      if(AccessNoLock != isAccessLocked() )     // check if access to persistent data is locked
+      {
+         if(op == PclStat_KeyRead)
+         {
+            rval = persistence_custom_handle_get_data(key_handle, buffer, buffer_size);
+         }
+         else if(op == PclStat_KeySize)
+         {
+            rval = persistence_custom_handle_get_size(key_handle);
+         }
+         else if(buffer_size <= gMaxKeyValDataSize)
+         {
+            PersistenceDbContext_s context;
+
+            context.ldbid   = persHandle->ldbid;
+            context.user_no = persHandle->user_no;
+            context.seat_no = persHandle->seat_no;
+
+            rval = persistence_custom_handle_set_data(key_handle, persHandle->resource_id, &context, buffer, buffer_size);
+         }
+      }
+      pthread_mutex_unlock(&gKeyAPIAccessMtx);
+   }
+
+   if(rval == EPERS_NOPLUGINFUNCT || (op != PclStat_KeyWrite && rval < 1))
+   {
+      return 0;
+   }
+
+   pers_stat_call(persHandle->ldbid, persHandle->resource_id, op, rval, start);
+   PCL_TRACE_EVENT((op == PclStat_KeyRead) ? PclTrace_KeyRead : ((op == PclStat_KeySize) ? PclTrace_KeySize : PclTrace_KeyWrite),
+                   key_handle, persHandle->ldbid, rval, start);
+
+   *size = rval;
+
+   return 1;
+}
+
+
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 // functions to be used directly without a handle
@@ -466,8 +539,9 @@ int pclKeyHandleWriteData(int key_handle, unsigned char* buffer, int buffer_size
 int pclKeyDelete(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no)
 {
    int rval = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyDelete - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyDelete - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -527,6 +601,9 @@ int pclKeyDelete(unsigned int ldbid, const char* resource_id, unsigned int user_
       DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclKeyDelete - not initialized"));
    }
 
+   pers_stat_call(ldbid, resource_id, PclStat_KeyDelete, rval, start);
+   PCL_TRACE_EVENT(PclTrace_KeyDelete, -1, ldbid, rval, start);
+
    //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclKeyDelete - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    return rval;
@@ -537,8 +614,9 @@ int pclKeyDelete(unsigned int ldbid, const char* resource_id, unsigned int user_
 int pclKeyGetSize(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no)
 {
    int data_size = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyGetSize - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyGetSize - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -595,6 +673,9 @@ int pclKeyGetSize(unsigned int ldbid, const char* resource_id, unsigned int user
       DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclKeyGetSize - not initialized"));
    }
 
+   pers_stat_call(ldbid, resource_id, PclStat_KeySize, data_size, start);
+   PCL_TRACE_EVENT(PclTrace_KeySize, -1, ldbid, data_size, start);
+
    //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclKeyGetSize - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    return data_size;
@@ -606,8 +687,9 @@ int pclKeyReadData(unsigned int ldbid, const char* resource_id, unsigned int use
                   unsigned char* buffer, int buffer_size)
 {
    int data_size = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyReadData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyReadData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -672,6 +754,9 @@ int pclKeyReadData(unsigned int ldbid, const char* resource_id, unsigned int use
       DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("keyReadData - not initialized"));
    }
 
+   pers_stat_call(ldbid, resource_id, PclStat_KeyRead, data_size, start);
+   PCL_TRACE_EVENT(PclTrace_KeyRead, -1, ldbid, data_size, start);
+
    //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclKeyReadData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    return data_size;
@@ -683,8 +768,13 @@ int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int us
                    unsigned char* buffer, int buffer_size)
 {
    int data_size = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
+   PersistenceInfo_s dbContext;
+   PclKvLogCommit_s commit;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyWriteData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+   memset(&commit, 0, sizeof(commit));
+
+   PCL_TRACE_LOG(DLT_STRING("pclKeyWriteData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -699,8 +789,6 @@ int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int us
             {
                if(buffer_size <= gMaxKeyValDataSize)  // check data size
                {
-                  PersistenceInfo_s dbContext;
-
                   char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};       // database key
                   char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};       // database location
 
@@ -725,7 +813,7 @@ int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int us
                            }
                            else
                            {
-                              data_size = persistence_set_data(dbPath, dbKey, resource_id, &dbContext, buffer, buffer_size);
+                              data_size = persistence_set_data(dbPath, dbKey, resource_id, &dbContext, buffer, buffer_size, &commit);
                            }
                         }
                         else
@@ -761,6 +849,16 @@ int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int us
          }
 #endif
          pthread_mutex_unlock(&gKeyAPIAccessMtx);
+
+         // wait for the commit of a write through database, concurrent writers share one commit
+         if(data_size >= 0)
+         {
+            int rval = persistence_commit_data(&commit, resource_id, &dbContext);
+            if(rval < 0)
+            {
+               data_size = rval;
+            }
+         }
       }
       else
       {
@@ -772,6 +870,9 @@ int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int us
       DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclKeyWriteData - not initialized"));
    }
 
+   pers_stat_call(ldbid, resource_id, PclStat_KeyWrite, data_size, start);
+   PCL_TRACE_EVENT(PclTrace_KeyWrite, -1, ldbid, data_size, start);
+
    //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclKeyWriteData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    return data_size;
@@ -779,11 +880,203 @@ int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int us
 
 
 
+/// get the database context of a key of a batch and check if the key can be accessed,
+/// returns 1 if the key has to be accessed, 0 if the result of the item has been set to an error
+static int batchPrepare(pclKeyBatchItem_s* item, PersistenceBatchAccess_s* access, int write)
+{
+   memset(access, 0, sizeof(PersistenceBatchAccess_s));
+
+   access->info.context.ldbid   = item->ldbid;
+   access->info.context.seat_no = item->seat_no;
+   access->info.context.user_no = item->user_no;
+
+   if(write == 1 && item->buffer_size > gMaxKeyValDataSize)    // check data size
+   {
+      item->result = EPERS_BUFLIMIT;
+      return 0;
+   }
+
+   // get database context: database path and database key
+   item->result = get_db_context(&access->info, item->resource_id, ResIsNoFile, access->dbKey, access->dbPath);
+   if(item->result < 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyBatch - no db context:"), DLT_STRING(item->resource_id));
+      return 0;
+   }
+
+   if(access->info.configKey.type != PersistenceResourceType_key)
+   {
+      item->result = EPERS_RES_NO_KEY;
+   }
+   else if(access->info.configKey.storage >= PersistenceStorage_LastEntry)   // check if store policy is valid
+   {
+      item->result = EPERS_BADPOL;
+   }
+   else if(write == 1 && access->info.configKey.permission == PersistencePermission_ReadOnly)  // don't write to a read only resource
+   {
+      item->result = EPERS_RESOURCE_READ_ONLY;
+   }
+   else if(   write == 1
+           && access->info.configKey.storage == PersistenceStorage_shared
+           && 0 != strncmp(access->info.configKey.reponsible, gAppId, PERS_RCT_MAX_LENGTH_RESPONSIBLE))
+   {
+      item->result = EPERS_NOT_RESP_APP;
+   }
+   else
+   {
+      access->resource_id = item->resource_id;
+      access->buffer      = item->buffer;
+      access->buffer_size = item->buffer_size;
+      return 1;
+   }
+
+   return 0;
+}
+
+
+
+/// read or write the keys of a batch, the keys are accessed in chunks of ::KeyBatchSize keys
+static int batchAccess(pclKeyBatchItem_s* items, int numItems, int write)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+   unsigned long long start = pers_stat_now();
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      PersistenceBatchAccess_s* access = NULL;
+
+      if(items == NULL || numItems < 0)
+      {
+         rval = EPERS_COMMON;
+      }
+      else if((access = malloc(sizeof(PersistenceBatchAccess_s) * KeyBatchSize)) == NULL)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyBatch - failed to allocate memory"));
+         rval = EPERS_COMMON;
+      }
+      else
+      {
+         int first = 0, i = 0;
+
+         rval = 0;
+
+         for(first=0; first<numItems; first+=KeyBatchSize)
+         {
+            int last = (numItems - first > KeyBatchSize) ? first + KeyBatchSize : numItems;
+            int numAccess = 0, error = 0;
+            int lock = pthread_mutex_lock(&gKeyAPIAccessMtx);
+
+            if(lock == 0)
+            {
+#if USE_APPCHECK
+               if(doAppcheck() != 1)
+               {
+                  error = EPERS_SHUTDOWN_NO_TRUSTED;
+               }
+               else
+#endif
+               if(AccessNoLock == isAccessLocked() )  // check if access to persistent data is locked
+               {
+                  error = EPERS_LOCKFS;
+               }
+               else
+               {
+                  for(i=first; i<last; i++)
+                  {
+                     if(batchPrepare(&items[i], &access[numAccess], write) == 1)
+                     {
+                        access[numAccess++].idx = i;
+                     }
+                  }
+
+                  if(write == 0)
+                  {
+                     (void)persistence_get_data_batch(access, numAccess);
+                  }
+                  else
+                  {
+                     (void)persistence_set_data_batch(access, numAccess);
+                  }
+
+                  for(i=0; i<numAccess; i++)
+                  {
+                     items[access[i].idx].result = access[i].result;
+                  }
+               }
+               pthread_mutex_unlock(&gKeyAPIAccessMtx);
+
+               // wait for the commits of write through databases
+               for(i=0; i<numAccess && write == 1; i++)
+               {
+                  if(access[i].result >= 0)
+                  {
+                     int rval = persistence_commit_data(&access[i].commit, access[i].resource_id, &access[i].info);
+                     if(rval < 0)
+                     {
+                        items[access[i].idx].result = rval;
+                     }
+                  }
+               }
+            }
+            else
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyBatch - mutex lock failed:"), DLT_INT(lock));
+               error = EPERS_COMMON;
+            }
+
+            for(i=first; i<last; i++)
+            {
+               if(error != 0)
+               {
+                  items[i].result = error;
+               }
+               else if(items[i].result >= 0)
+               {
+                  rval++;
+               }
+
+               pers_stat_call(items[i].ldbid, items[i].resource_id, (write == 0) ? PclStat_KeyRead : PclStat_KeyWrite,
+                              items[i].result, start);
+               PCL_TRACE_EVENT((write == 0) ? PclTrace_KeyRead : PclTrace_KeyWrite, -1, items[i].ldbid, items[i].result, start);
+            }
+         }
+
+         free(access);
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("keyBatch - not initialized"));
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyReadDataBatch(pclKeyBatchItem_s* items, int numItems)
+{
+   PCL_TRACE_LOG(DLT_STRING("pclKeyReadDataBatch - items:"), DLT_INT(numItems));
+
+   return batchAccess(items, numItems, 0);
+}
+
+
+
+int pclKeyWriteDataBatch(pclKeyBatchItem_s* items, int numItems)
+{
+   PCL_TRACE_LOG(DLT_STRING("pclKeyWriteDataBatch - items:"), DLT_INT(numItems));
+
+   return batchAccess(items, numItems, 1);
+}
+
+
+
 int pclKeyUnRegisterNotifyOnChange( unsigned int  ldbid, const char *  resource_id, unsigned int  user_no, unsigned int  seat_no, pclChangeNotifyCallback_t  callback)
 {
    int rval = EPERS_NOT_INITIALIZED;
    int lock = 0;
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyUnRegisterNotifyOnChange - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+   PCL_TRACE_LOG(DLT_STRING("pclKeyUnRegisterNotifyOnChange - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    lock = pthread_mutex_lock(&gKeyAPIAccessMtx);
    if(lock == 0)
@@ -808,7 +1101,7 @@ int pclKeyRegisterNotifyOnChange(unsigned int ldbid, const char* resource_id, un
    int rval = EPERS_COMMON;
    int lock = 0;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyRegisterNotifyOnChange - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "), DLT_STRING(resource_id) );
+   PCL_TRACE_LOG(DLT_STRING("pclKeyRegisterNotifyOnChange - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "), DLT_STRING(resource_id) );
 
    lock = pthread_mutex_lock(&gKeyAPIAccessMtx);
    if(lock == 0)
@@ -840,7 +1133,7 @@ int regNotifyOnChange(unsigned int ldbid, const char* resource_id, unsigned int
 {
    int rval = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("regNotifyOnChange - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "), DLT_STRING(resource_id) );
+   PCL_TRACE_LOG(DLT_STRING("regNotifyOnChange - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "), DLT_STRING(resource_id) );
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
@@ -0,0 +1,1578 @@
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_kvlog.c
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Implementation of the persistence client library log-structured key/value database.
+ * @see
+ */
+
+#include "persistence_client_library_kvlog.h"
+#include "persistence_client_library_pas_interface.h"
+#include "crc32.h"
+
+#include <persComErrors.h>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <dlt.h>
+
+DLT_IMPORT_CONTEXT(gPclDLTContext);
+
+
+/// log magic
+static const char gKvLogMagic[4] = {'P', 'K', 'V', 'L'};
+/// index magic
+static const char gKvIndexMagic[4] = {'P', 'K', 'V', 'I'};
+/// log and index format version
+static const uint32_t gKvLogVersion = 1;
+/// value size of a record marking a deleted key
+static const uint32_t gKvLogTombstone = 0xFFFFFFFFU;
+/// index filename postfix (appended to the log path)
+static const char* gKvIndexPostfix = ".idx";
+/// compaction filename postfix (appended to the log path)
+static const char* gKvCompactPostfix = ".compact";
+/// ioprio_set() "who" value to select a thread
+static const int gKvIoprioWhoProcess = 1;
+/// ioprio_set() idle class, the thread only gets disk time if no other thread needs it
+static const int gKvIoprioIdle = 3 << 13;
+
+/// log file header
+typedef struct _PclKvLogHeader_s
+{
+   /// log magic ::gKvLogMagic
+   char magic[4];
+   /// log format version
+   uint32_t version;
+} PclKvLogHeader_s;
+
+/// log record header, followed by the key and the value, padded to 8 bytes
+typedef struct _PclKvLogRecord_s
+{
+   /// crc32 of the following header fields, the key and the value
+   uint32_t crc;
+   /// size of the key
+   uint32_t keySize;
+   /// size of the value or ::gKvLogTombstone if the key has been deleted
+   uint32_t valueSize;
+   /// reserved, set to 0
+   uint32_t reserved;
+} PclKvLogRecord_s;
+
+/// index file header, followed by the slots
+typedef struct _PclKvIndexHeader_s
+{
+   /// index magic ::gKvIndexMagic
+   char magic[4];
+   /// index format version
+   uint32_t version;
+   /// number of slots, power of two
+   uint32_t numSlots;
+   /// number of keys
+   uint32_t count;
+   /// size of the log covered by the index
+   uint64_t logSize;
+   /// size of the records in the log which have been overwritten or deleted
+   uint64_t deadBytes;
+   /// 1 if the database has been closed cleanly, the index is only used if set
+   uint32_t clean;
+   /// reserved, set to 0
+   uint32_t reserved;
+} PclKvIndexHeader_s;
+
+/// index slot
+typedef struct _PclKvIndexSlot_s
+{
+   /// offset of the latest record of the key in the log, 0 if the slot is empty
+   uint64_t offset;
+   /// crc32 of the key
+   uint32_t hash;
+   /// size of the record including padding
+   uint32_t recordSize;
+} PclKvIndexSlot_s;
+
+/// log database
+typedef struct _PclKvLog_s
+{
+   /// 1 if the handle is used
+   int used;
+   /// file descriptor of the log
+   int logFd;
+   /// file descriptor of the index
+   int idxFd;
+   /// 1 if each write will be committed to disk
+   int writeThrough;
+   /// 1 while the database is compacted
+   int compacting;
+   /// flag to abort a running compaction
+   int compactAbort;
+   /// 1 while a commit is flushing the log
+   int syncing;
+   /// number of writers waiting for a commit
+   int commitWaiters;
+   /// generation of the handle, identifies the database a commit belongs to
+   unsigned int generation;
+   /// number of bytes appended since the database has been opened
+   uint64_t appendSeq;
+   /// number of bytes appended which are committed to disk
+   uint64_t syncedSeq;
+   /// number of bytes appended for which the commit failed
+   uint64_t failedSeq;
+   /// size of the index mapping
+   size_t mapSize;
+   /// the mapped index
+   PclKvIndexHeader_s* index;
+   /// the slots of the mapped index
+   PclKvIndexSlot_s* slots;
+   /// path of the log
+   char* path;
+   // the synchronisation objects must be the last members, they are
+   // initialised once and survive closing and reopening the handle
+   /// mutex to protect the database
+   pthread_mutex_t mtx;
+   /// condition to signal the end of a compaction
+   pthread_cond_t compactDone;
+   /// condition to signal the end of a commit
+   pthread_cond_t commitDone;
+} PclKvLog_s;
+
+/// position of a record copied by the compaction
+typedef struct _PclKvCompactMap_s
+{
+   /// offset of the record in the log
+   uint64_t oldOffset;
+   /// offset of the record in the compacted log
+   uint64_t newOffset;
+} PclKvCompactMap_s;
+
+
+/// log databases, the handle is the index
+static PclKvLog_s gKvLog[MaxKvLogHandles];
+/// mutex to protect opening and closing the databases
+static pthread_mutex_t gKvLogMtx = PTHREAD_MUTEX_INITIALIZER;
+/// condition to wake up the compaction scheduler
+static pthread_cond_t  gKvCompactCond = PTHREAD_COND_INITIALIZER;
+/// background compaction thread
+static pthread_t gKvCompactThread;
+/// 1 if the background compaction thread is running
+static int gKvCompactRunning = 0;
+/// flag to stop the background compaction thread
+static int gKvCompactStop = 0;
+/// time of the last database access in microseconds
+static unsigned long long gKvLastAccess = 0;
+/// generation of the last opened database
+static unsigned int gKvLogGeneration = 0;
+/// initialise the synchronisation objects of the handles once
+static pthread_once_t gKvLogSyncOnce = PTHREAD_ONCE_INIT;
+
+
+
+/// a writer waiting for a commit may still lock a closed handle,
+/// so the mutex and conditions of a handle are never destroyed
+static void kvlog_sync_init(void)
+{
+   int i = 0;
+
+   for(i=0; i<MaxKvLogHandles; i++)
+   {
+      pthread_mutex_init(&gKvLog[i].mtx, NULL);
+      pthread_cond_init(&gKvLog[i].compactDone, NULL);
+      pthread_cond_init(&gKvLog[i].commitDone, NULL);
+   }
+}
+
+
+
+static unsigned long long kvlog_now_us(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return (unsigned long long)now.tv_sec * 1000000ULL + (unsigned long long)now.tv_nsec / 1000ULL;
+}
+
+
+
+/// remember the database access, the compaction is only started after an idle period
+static void kvlog_touch(void)
+{
+   (void)__sync_lock_test_and_set(&gKvLastAccess, kvlog_now_us());
+}
+
+
+
+/// commit the directory entry of a created or renamed log, returns 0 on success
+static int kvlog_sync_dir(const char* path)
+{
+   int rval = -1;
+   char dirPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+   char* delimiter = NULL;
+
+   strncpy(dirPath, path, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
+   dirPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
+
+   delimiter = strrchr(dirPath, '/');
+   if(delimiter != NULL)
+   {
+      int dirFd = -1;
+
+      *(delimiter == dirPath ? delimiter+1 : delimiter) = '\0';
+      dirFd = open(dirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+      if(dirFd != -1)
+      {
+         rval = fsync(dirFd);
+         close(dirFd);
+      }
+   }
+
+   if(rval == -1)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("kvLog - failed to sync dir:"), DLT_STRING(path), DLT_STRING(strerror(errno)));
+   }
+
+   return rval;
+}
+
+
+
+static uint32_t kvlog_record_size(uint32_t keySize, uint32_t valueSize)
+{
+   uint32_t size = (uint32_t)sizeof(PclKvLogRecord_s) + keySize;
+
+   if(valueSize != gKvLogTombstone)
+   {
+      size += valueSize;
+   }
+
+   return (size + 7U) & ~7U;
+}
+
+
+
+static uint32_t kvlog_record_crc(const PclKvLogRecord_s* record, const char* key, const char* value)
+{
+   uint32_t crc = pclCrc32(0, (const unsigned char*)&record->keySize, sizeof(PclKvLogRecord_s) - sizeof(record->crc));
+
+   crc = pclCrc32(crc, (const unsigned char*)key, record->keySize);
+   if(record->valueSize != gKvLogTombstone && record->valueSize > 0)
+   {
+      crc = pclCrc32(crc, (const unsigned char*)value, record->valueSize);
+   }
+
+   return crc;
+}
+
+
+
+static PclKvLog_s* kvlog_lock(int handle)
+{
+   PclKvLog_s* db = NULL;
+
+   if(handle >= 0 && handle < MaxKvLogHandles)
+   {
+      (void)pthread_once(&gKvLogSyncOnce, kvlog_sync_init);
+
+      pthread_mutex_lock(&gKvLog[handle].mtx);
+      if(gKvLog[handle].used == 1)
+      {
+         db = &gKvLog[handle];
+      }
+      else
+      {
+         pthread_mutex_unlock(&gKvLog[handle].mtx);
+      }
+   }
+
+   return db;
+}
+
+
+
+static int kvlog_index_map(PclKvLog_s* db, uint32_t numSlots)
+{
+   size_t size = sizeof(PclKvIndexHeader_s) + (size_t)numSlots * sizeof(PclKvIndexSlot_s);
+   void* map = NULL;
+
+   if(ftruncate(db->idxFd, (off_t)size) == -1)
+   {
+      return -1;
+   }
+
+   map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, db->idxFd, 0);
+   if(map == MAP_FAILED)
+   {
+      return -1;
+   }
+
+   db->index   = (PclKvIndexHeader_s*)map;
+   db->slots   = (PclKvIndexSlot_s*)(db->index + 1);
+   db->mapSize = size;
+
+   return 0;
+}
+
+
+
+static void kvlog_index_unmap(PclKvLog_s* db)
+{
+   if(db->index != NULL)
+   {
+      (void)munmap(db->index, db->mapSize);
+      db->index   = NULL;
+      db->slots   = NULL;
+      db->mapSize = 0;
+   }
+}
+
+
+
+/// find the slot of a key, or the empty slot where the key would be inserted
+static PclKvIndexSlot_s* kvlog_find(PclKvLog_s* db, const char* key, uint32_t keySize, uint32_t hash,
+                                    PclKvLogRecord_s* record, int* found)
+{
+   uint32_t mask = db->index->numSlots - 1;
+   uint32_t slot = hash & mask;
+   char buffer[sizeof(PclKvLogRecord_s) + PERS_DB_MAX_LENGTH_KEY_NAME];
+
+   *found = 0;
+
+   while(db->slots[slot].offset != 0)     // the index is never full, so probing ends at an empty slot
+   {
+      if(db->slots[slot].hash == hash)
+      {
+         ssize_t size = sizeof(PclKvLogRecord_s) + keySize;
+
+         if(pread(db->logFd, buffer, (size_t)size, (off_t)db->slots[slot].offset) == size)
+         {
+            const PclKvLogRecord_s* rec = (const PclKvLogRecord_s*)buffer;
+
+            if(rec->keySize == keySize && memcmp(buffer + sizeof(PclKvLogRecord_s), key, keySize) == 0)
+            {
+               if(record != NULL)
+               {
+                  memcpy(record, rec, sizeof(PclKvLogRecord_s));
+               }
+               *found = 1;
+               break;
+            }
+         }
+      }
+      slot = (slot + 1) & mask;
+   }
+
+   return &db->slots[slot];
+}
+
+
+
+/// remove a slot, following slots of the same probe sequence are moved up
+static void kvlog_remove_slot(PclKvLog_s* db, PclKvIndexSlot_s* removed)
+{
+   uint32_t mask = db->index->numSlots - 1;
+   uint32_t i = (uint32_t)(removed - db->slots);
+   uint32_t j = i;
+
+   db->slots[i].offset = 0;
+
+   for(;;)
+   {
+      uint32_t k = 0;
+
+      j = (j + 1) & mask;
+      if(db->slots[j].offset == 0)
+      {
+         break;
+      }
+
+      k = db->slots[j].hash & mask;
+      if((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+      {
+         continue;      // the slot is still reachable from its home slot
+      }
+
+      db->slots[i] = db->slots[j];
+      db->slots[j].offset = 0;
+      i = j;
+   }
+}
+
+
+
+static void kvlog_insert_slot(PclKvLog_s* db, uint32_t hash, uint64_t offset, uint32_t recordSize)
+{
+   uint32_t mask = db->index->numSlots - 1;
+   uint32_t slot = hash & mask;
+
+   while(db->slots[slot].offset != 0)
+   {
+      slot = (slot + 1) & mask;
+   }
+
+   db->slots[slot].offset     = offset;
+   db->slots[slot].hash       = hash;
+   db->slots[slot].recordSize = recordSize;
+}
+
+
+
+/// double the number of slots, keep the load factor <= 0.5
+static int kvlog_grow(PclKvLog_s* db)
+{
+   uint32_t i = 0, oldSlots = db->index->numSlots;
+   PclKvIndexHeader_s header;
+   PclKvIndexSlot_s* slots = malloc((size_t)oldSlots * sizeof(PclKvIndexSlot_s));
+
+   if(slots == NULL)
+   {
+      return -1;
+   }
+
+   memcpy(&header, db->index, sizeof(header));
+   memcpy(slots, db->slots, (size_t)oldSlots * sizeof(PclKvIndexSlot_s));
+   kvlog_index_unmap(db);
+
+   if(kvlog_index_map(db, oldSlots * 2) == -1)
+   {
+      free(slots);
+      return -1;
+   }
+
+   memcpy(db->index, &header, sizeof(header));
+   db->index->numSlots = oldSlots * 2;
+   memset(db->slots, 0, (size_t)db->index->numSlots * sizeof(PclKvIndexSlot_s));
+
+   for(i=0; i<oldSlots; i++)
+   {
+      if(slots[i].offset != 0)
+      {
+         kvlog_insert_slot(db, slots[i].hash, slots[i].offset, slots[i].recordSize);
+      }
+   }
+   free(slots);
+
+   return 0;
+}
+
+
+
+/// update the index with a record appended to the log
+static int kvlog_apply(PclKvLog_s* db, const char* key, uint32_t keySize, uint32_t valueSize, uint64_t offset)
+{
+   int found = 0;
+   uint32_t hash = pclCrc32(0, (const unsigned char*)key, keySize);
+   uint32_t recordSize = kvlog_record_size(keySize, valueSize);
+   PclKvIndexSlot_s* slot = kvlog_find(db, key, keySize, hash, NULL, &found);
+
+   if(found == 1)
+   {
+      db->index->deadBytes += slot->recordSize;
+
+      if(valueSize == gKvLogTombstone)
+      {
+         db->index->deadBytes += recordSize;
+         kvlog_remove_slot(db, slot);
+         db->index->count--;
+      }
+      else
+      {
+         slot->offset     = offset;
+         slot->recordSize = recordSize;
+      }
+   }
+   else if(valueSize == gKvLogTombstone)
+   {
+      db->index->deadBytes += recordSize;
+   }
+   else
+   {
+      if((db->index->count + 1) * 2 > db->index->numSlots && kvlog_grow(db) == -1)
+      {
+         return -1;
+      }
+      kvlog_insert_slot(db, hash, offset, recordSize);
+      db->index->count++;
+   }
+
+   return 0;
+}
+
+
+
+/// rebuild the index by scanning the log, an incomplete or corrupt record ends the log
+static int kvlog_rebuild(PclKvLog_s* db)
+{
+   int rval = 0;
+   struct stat buf;
+   uint64_t offset = sizeof(PclKvLogHeader_s);
+   char* record = malloc(kvlog_record_size(PERS_DB_MAX_LENGTH_KEY_NAME, PERS_DB_MAX_SIZE_KEY_DATA));
+
+   if(record == NULL || fstat(db->logFd, &buf) == -1)
+   {
+      free(record);
+      return -1;
+   }
+
+   kvlog_index_unmap(db);
+   if(ftruncate(db->idxFd, 0) == -1 || kvlog_index_map(db, KvLogIndexSlots) == -1)
+   {
+      free(record);
+      return -1;
+   }
+
+   memcpy(db->index->magic, gKvIndexMagic, sizeof(db->index->magic));
+   db->index->version  = gKvLogVersion;
+   db->index->numSlots = KvLogIndexSlots;
+
+   while(offset + sizeof(PclKvLogRecord_s) <= (uint64_t)buf.st_size)
+   {
+      const PclKvLogRecord_s* rec = (const PclKvLogRecord_s*)record;
+      uint32_t recordSize = 0;
+
+      if(pread(db->logFd, record, sizeof(PclKvLogRecord_s), (off_t)offset) != (ssize_t)sizeof(PclKvLogRecord_s))
+      {
+         break;
+      }
+
+      if(   rec->keySize == 0 || rec->keySize > PERS_DB_MAX_LENGTH_KEY_NAME
+         || (rec->valueSize > PERS_DB_MAX_SIZE_KEY_DATA && rec->valueSize != gKvLogTombstone))
+      {
+         break;
+      }
+
+      recordSize = kvlog_record_size(rec->keySize, rec->valueSize);
+      if(   offset + recordSize > (uint64_t)buf.st_size
+         || pread(db->logFd, record, recordSize, (off_t)offset) != (ssize_t)recordSize
+         || rec->crc != kvlog_record_crc(rec, record + sizeof(PclKvLogRecord_s), record + sizeof(PclKvLogRecord_s) + rec->keySize))
+      {
+         break;
+      }
+
+      if(kvlog_apply(db, record + sizeof(PclKvLogRecord_s), rec->keySize, rec->valueSize, offset) == -1)
+      {
+         rval = -1;
+         break;
+      }
+      offset += recordSize;
+   }
+
+   if(rval == 0 && offset < (uint64_t)buf.st_size)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("kvLog - incomplete record removed:"), DLT_STRING(db->path),
+                                            DLT_STRING("offset:"), DLT_UINT64(offset));
+      if(ftruncate(db->logFd, (off_t)offset) == -1)
+      {
+         rval = -1;
+      }
+   }
+   db->index->logSize = offset;
+
+   free(record);
+
+   return rval;
+}
+
+
+
+/// check if the index file belongs to the current log and has been closed cleanly
+static int kvlog_index_valid(PclKvLog_s* db, uint64_t logSize)
+{
+   int rval = 0;
+   struct stat buf;
+   PclKvIndexHeader_s header;
+
+   if(   fstat(db->idxFd, &buf) != -1
+      && pread(db->idxFd, &header, sizeof(header), 0) == (ssize_t)sizeof(header)
+      && memcmp(header.magic, gKvIndexMagic, sizeof(header.magic)) == 0
+      && header.version == gKvLogVersion
+      && header.clean == 1
+      && header.logSize == logSize
+      && header.numSlots >= KvLogIndexSlots && (header.numSlots & (header.numSlots - 1)) == 0
+      && (uint64_t)buf.st_size == sizeof(PclKvIndexHeader_s) + (uint64_t)header.numSlots * sizeof(PclKvIndexSlot_s))
+   {
+      rval = 1;
+   }
+
+   return rval;
+}
+
+
+
+/// check if the dead space of a database is large enough to be compacted
+static int kvlog_compact_needed(uint64_t logSize, uint64_t deadBytes)
+{
+   return (deadBytes >= KvLogCompactMinDead && deadBytes * 100 >= logSize * KvLogCompactDeadPercent) ? 1 : 0;
+}
+
+
+
+/// find the database with the highest dead space ratio, -1 if no database needs to be compacted
+static int kvlog_compact_candidate(void)
+{
+   int i = 0, handle = -1;
+   double bestRatio = 0.0;
+
+   for(i=0; i<MaxKvLogHandles; i++)
+   {
+      if(gKvLog[i].used == 1)
+      {
+         pthread_mutex_lock(&gKvLog[i].mtx);
+
+         if(gKvLog[i].compacting == 0 && kvlog_compact_needed(gKvLog[i].index->logSize, gKvLog[i].index->deadBytes) == 1)
+         {
+            double ratio = (double)gKvLog[i].index->deadBytes / (double)gKvLog[i].index->logSize;
+
+            if(ratio > bestRatio)
+            {
+               bestRatio = ratio;
+               handle = i;
+            }
+         }
+
+         pthread_mutex_unlock(&gKvLog[i].mtx);
+      }
+   }
+
+   return handle;
+}
+
+
+
+static void kvlog_timed_wait(unsigned int waitMs)
+{
+   struct timespec until;
+
+   clock_gettime(CLOCK_REALTIME, &until);
+   until.tv_sec  += (time_t)(waitMs / 1000);
+   until.tv_nsec += (long)(waitMs % 1000) * 1000000L;
+   if(until.tv_nsec >= 1000000000L)
+   {
+      until.tv_sec++;
+      until.tv_nsec -= 1000000000L;
+   }
+
+   (void)pthread_cond_timedwait(&gKvCompactCond, &gKvLogMtx, &until);
+}
+
+
+
+static int kvlog_compact(int handle, unsigned int budget);
+
+
+
+/// compaction scheduler, compacts the databases with the most dead space when the databases have not been accessed for a while
+static void* kvlog_compact_worker(void* dataPtr)
+{
+   struct sched_param param;
+
+   (void)dataPtr;
+
+   // the compaction shall not delay the application
+   memset(&param, 0, sizeof(param));
+   (void)pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+   (void)syscall(SYS_ioprio_set, gKvIoprioWhoProcess, 0, gKvIoprioIdle);
+
+   pthread_mutex_lock(&gKvLogMtx);
+
+   while(gKvCompactStop == 0)
+   {
+      int handle = kvlog_compact_candidate();
+
+      if(handle == -1)
+      {
+         pthread_cond_wait(&gKvCompactCond, &gKvLogMtx);
+      }
+      else if(AccessNoLock == isAccessLocked())     // paused while access is blocked by the PAS or shutdown
+      {
+         kvlog_timed_wait(KvLogCompactIdleMs);
+      }
+      else
+      {
+         unsigned long long idle = (kvlog_now_us() - __sync_add_and_fetch(&gKvLastAccess, 0)) / 1000ULL;
+
+         if(idle < KvLogCompactIdleMs)
+         {
+            kvlog_timed_wait(KvLogCompactIdleMs - (unsigned int)idle);
+         }
+         else
+         {
+            int rval = 0;
+
+            pthread_mutex_unlock(&gKvLogMtx);
+            rval = kvlog_compact(handle, KvLogCompactIoBudget);
+            pthread_mutex_lock(&gKvLogMtx);
+
+            if(rval < 0 && gKvCompactStop == 0)
+            {
+               kvlog_timed_wait(KvLogCompactIdleMs);     // don't retry immediately
+            }
+         }
+      }
+   }
+
+   pthread_mutex_unlock(&gKvLogMtx);
+
+   return NULL;
+}
+
+
+
+/// start the compaction scheduler if the database needs to be compacted
+static void kvlog_schedule_compaction(uint64_t logSize, uint64_t deadBytes)
+{
+   if(kvlog_compact_needed(logSize, deadBytes) == 1)
+   {
+      pthread_mutex_lock(&gKvLogMtx);
+
+      if(gKvCompactRunning == 0 && gKvCompactStop == 0)
+      {
+         if(pthread_create(&gKvCompactThread, NULL, kvlog_compact_worker, NULL) == 0)
+         {
+            (void)pthread_setname_np(gKvCompactThread, "pclKvCompact");
+            gKvCompactRunning = 1;
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("kvLog - failed to create compaction thread"));
+         }
+      }
+      pthread_cond_signal(&gKvCompactCond);
+
+      pthread_mutex_unlock(&gKvLogMtx);
+   }
+}
+
+
+
+/// append a record to the log and update the index
+static int kvlog_append(PclKvLog_s* db, const char* key, uint32_t keySize, const char* value, uint32_t valueSize)
+{
+   static const char padding[8] = {0};
+   PclKvLogRecord_s record;
+   struct iovec iov[4];
+   int iovcnt = 2;
+   uint32_t recordSize = kvlog_record_size(keySize, valueSize);
+   size_t dataSize = sizeof(record) + keySize;
+
+   record.keySize   = keySize;
+   record.valueSize = valueSize;
+   record.reserved  = 0;
+   record.crc       = kvlog_record_crc(&record, key, value);
+
+   iov[0].iov_base = &record;
+   iov[0].iov_len  = sizeof(record);
+   iov[1].iov_base = (void*)key;
+   iov[1].iov_len  = keySize;
+   if(valueSize != gKvLogTombstone && valueSize > 0)
+   {
+      iov[iovcnt].iov_base = (void*)value;
+      iov[iovcnt].iov_len  = valueSize;
+      dataSize += valueSize;
+      iovcnt++;
+   }
+   if(recordSize > dataSize)
+   {
+      iov[iovcnt].iov_base = (void*)padding;
+      iov[iovcnt].iov_len  = recordSize - dataSize;
+      iovcnt++;
+   }
+
+   if(pwritev(db->logFd, iov, iovcnt, (off_t)db->index->logSize) != (ssize_t)recordSize)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("kvLog - failed to append:"), DLT_STRING(db->path), DLT_STRING(strerror(errno)));
+      return PERS_COM_FAILURE;
+   }
+
+   if(kvlog_apply(db, key, keySize, valueSize, db->index->logSize) == -1)
+   {
+      return PERS_COM_ERR_OUT_OF_MEMORY;
+   }
+   db->index->logSize += recordSize;
+   db->appendSeq += recordSize;
+
+   return 0;
+}
+
+
+
+/**
+ * Wait until the log has been committed to disk up to the given sequence, called with the database locked.
+ * The first waiter flushes the log for all records appended so far, writers appending while
+ * the flush is running wait for the next flush, which commits all of them at once.
+ */
+static int kvlog_commit(PclKvLog_s* db, uint64_t seq)
+{
+   int rval = 0;
+
+   db->commitWaiters++;
+
+   while(db->syncedSeq < seq && rval == 0)
+   {
+      if(db->failedSeq >= seq)
+      {
+         rval = PERS_COM_FAILURE;
+      }
+      else if(db->syncing == 1)
+      {
+         pthread_cond_wait(&db->commitDone, &db->mtx);
+      }
+      else
+      {
+         uint64_t target = db->appendSeq;
+         int fd = dup(db->logFd);      // the log may be replaced by the compaction during the flush
+         int synced = 0;
+
+         db->syncing = 1;
+         pthread_mutex_unlock(&db->mtx);
+
+         if(fd != -1)
+         {
+            synced = (fdatasync(fd) == 0) ? 1 : 0;
+            close(fd);
+         }
+
+         pthread_mutex_lock(&db->mtx);
+         db->syncing = 0;
+         if(synced == 1)
+         {
+            db->syncedSeq = (target > db->syncedSeq) ? target : db->syncedSeq;
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("kvLog - failed to sync:"), DLT_STRING(db->path), DLT_STRING(strerror(errno)));
+            db->failedSeq = (target > db->failedSeq) ? target : db->failedSeq;
+         }
+         pthread_cond_broadcast(&db->commitDone);
+      }
+   }
+
+   db->commitWaiters--;
+   if(db->commitWaiters == 0)
+   {
+      pthread_cond_broadcast(&db->commitDone);     // a close may wait for the last waiter
+   }
+
+   return rval;
+}
+
+
+
+int pclKvLogOpen(const char* path, int writeThrough, int* created)
+{
+   int handle = PERS_COM_ERR_OUT_OF_MEMORY, i = 0;
+
+   if(path == NULL)
+   {
+      return PERS_COM_ERR_INVALID_PARAM;
+   }
+
+   (void)pthread_once(&gKvLogSyncOnce, kvlog_sync_init);
+
+   pthread_mutex_lock(&gKvLogMtx);
+
+   for(i=0; i<MaxKvLogHandles; i++)
+   {
+      if(gKvLog[i].used == 0)
+      {
+         handle = i;
+         break;
+      }
+   }
+
+   if(handle >= 0)
+   {
+      PclKvLog_s* db = &gKvLog[handle];
+      char idxPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+      char tmpPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+      PclKvLogHeader_s header;
+      struct stat buf;
+
+      memset(db, 0, offsetof(PclKvLog_s, mtx));    // keep the synchronisation objects
+      db->idxFd = -1;
+      db->writeThrough = writeThrough;
+      db->generation = ++gKvLogGeneration;
+      snprintf(idxPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", path, gKvIndexPostfix);
+      snprintf(tmpPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", path, gKvCompactPostfix);
+
+      // left over by an interrupted compaction, the log has not been replaced
+      if(unlink(tmpPath) == 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("kvLog - removed interrupted compaction:"), DLT_STRING(tmpPath));
+      }
+
+      db->logFd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+      if(db->logFd != -1 && fstat(db->logFd, &buf) != -1)
+      {
+         if(buf.st_size == 0)       // new log
+         {
+            memcpy(header.magic, gKvLogMagic, sizeof(header.magic));
+            header.version = gKvLogVersion;
+            // the new log must be on disk including its directory entry before keys will be written
+            if(   pwrite(db->logFd, &header, sizeof(header), 0) == (ssize_t)sizeof(header)
+               && fdatasync(db->logFd) == 0
+               && kvlog_sync_dir(path) == 0)
+            {
+               buf.st_size = (off_t)sizeof(header);
+               if(created != NULL)
+               {
+                  *created = 1;
+               }
+            }
+            else
+            {
+               handle = PERS_COM_FAILURE;
+            }
+         }
+         else if(   pread(db->logFd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)
+                 || memcmp(header.magic, gKvLogMagic, sizeof(header.magic)) != 0
+                 || header.version != gKvLogVersion)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("kvLog - invalid log:"), DLT_STRING(path));
+            handle = PERS_COM_FAILURE;
+         }
+
+         if(handle >= 0)
+         {
+            db->path  = strdup(path);
+            db->idxFd = open(idxPath, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+            if(db->idxFd == -1 || db->path == NULL)
+            {
+               handle = PERS_COM_FAILURE;
+            }
+            else if(kvlog_index_valid(db, (uint64_t)buf.st_size) == 1)
+            {
+               uint32_t numSlots = 0;
+
+               if(   pread(db->idxFd, &numSlots, sizeof(numSlots), offsetof(PclKvIndexHeader_s, numSlots)) != (ssize_t)sizeof(numSlots)
+                  || kvlog_index_map(db, numSlots) == -1)
+               {
+                  handle = PERS_COM_FAILURE;
+               }
+            }
+            else
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("kvLog - rebuild index:"), DLT_STRING(path));
+               if(kvlog_rebuild(db) == -1)
+               {
+                  handle = PERS_COM_FAILURE;
+               }
+            }
+         }
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("kvLog - failed to open:"), DLT_STRING(path), DLT_STRING(strerror(errno)));
+         handle = PERS_COM_FAILURE;
+      }
+
+      if(handle >= 0)
+      {
+         // the index is not valid anymore if the database will not be closed cleanly
+         db->index->clean = 0;
+         (void)msync(db->index, sizeof(PclKvIndexHeader_s), MS_SYNC);
+
+         pthread_mutex_lock(&db->mtx);
+         db->used = 1;
+         pthread_mutex_unlock(&db->mtx);
+      }
+      else
+      {
+         kvlog_index_unmap(db);
+         if(db->logFd != -1)
+         {
+            close(db->logFd);
+         }
+         if(db->idxFd != -1)
+         {
+            close(db->idxFd);
+         }
+         free(db->path);
+         db->path = NULL;
+      }
+   }
+
+   pthread_mutex_unlock(&gKvLogMtx);
+
+   return handle;
+}
+
+
+
+int pclKvLogClose(int handle)
+{
+   int rval = PERS_COM_ERR_INVALID_PARAM;
+
+   if(handle >= 0 && handle < MaxKvLogHandles)
+   {
+      pthread_mutex_lock(&gKvLogMtx);
+
+      if(gKvLog[handle].used == 1)
+      {
+         PclKvLog_s* db = &gKvLog[handle];
+
+         pthread_mutex_lock(&db->mtx);
+
+         // abort a running compaction
+         db->compactAbort = 1;
+         while(db->compacting == 1)
+         {
+            pthread_cond_wait(&db->compactDone, &db->mtx);
+         }
+
+         // commit the log, writers waiting for a commit are released
+         rval = 0;
+         if(db->syncedSeq < db->appendSeq || db->writeThrough == 0)
+         {
+            if(fdatasync(db->logFd) == 0)
+            {
+               db->syncedSeq = db->appendSeq;
+            }
+            else
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("kvLog - failed to sync:"), DLT_STRING(db->path), DLT_STRING(strerror(errno)));
+               db->failedSeq = db->appendSeq;
+               rval = PERS_COM_FAILURE;
+            }
+            pthread_cond_broadcast(&db->commitDone);
+         }
+         while(db->syncing == 1 || db->commitWaiters > 0)
+         {
+            pthread_cond_wait(&db->commitDone, &db->mtx);
+         }
+
+         // mark the index clean after the slots have been written
+         if(rval == 0 && msync(db->index, db->mapSize, MS_SYNC) == 0)
+         {
+            db->index->clean = 1;
+            (void)msync(db->index, sizeof(PclKvIndexHeader_s), MS_SYNC);
+         }
+
+         kvlog_index_unmap(db);
+         close(db->logFd);
+         close(db->idxFd);
+         free(db->path);
+         db->path = NULL;
+         db->used = 0;
+
+         pthread_mutex_unlock(&db->mtx);
+      }
+
+      pthread_mutex_unlock(&gKvLogMtx);
+   }
+
+   return rval;
+}
+
+
+
+int pclKvLogAppendKey(int handle, const char* key, const char* data, int dataSize, PclKvLogCommit_s* commit)
+{
+   int rval = PERS_COM_ERR_INVALID_PARAM;
+   size_t keySize = (key != NULL) ? strlen(key) : 0;
+
+   if(keySize > 0 && keySize <= PERS_DB_MAX_LENGTH_KEY_NAME && dataSize >= 0 && dataSize <= PERS_DB_MAX_SIZE_KEY_DATA
+      && (data != NULL || dataSize == 0) && commit != NULL)
+   {
+      PclKvLog_s* db = kvlog_lock(handle);
+
+      kvlog_touch();
+      if(db != NULL)
+      {
+         uint64_t logSize = 0, deadBytes = 0;
+
+         rval = kvlog_append(db, key, (uint32_t)keySize, data, (uint32_t)dataSize);
+         if(rval == 0)
+         {
+            rval = dataSize;
+         }
+         commit->handle     = handle;
+         commit->generation = db->generation;
+         commit->seq        = (db->writeThrough == 1) ? db->appendSeq : 0;
+         logSize   = db->index->logSize;
+         deadBytes = db->index->deadBytes;
+
+         pthread_mutex_unlock(&db->mtx);
+
+         kvlog_schedule_compaction(logSize, deadBytes);
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKvLogCommit(const PclKvLogCommit_s* commit)
+{
+   int rval = 0;
+
+   if(commit != NULL && commit->seq != 0)
+   {
+      PclKvLog_s* db = kvlog_lock(commit->handle);
+
+      if(db != NULL)
+      {
+         if(db->generation == commit->generation)     // otherwise the database has been committed on close
+         {
+            rval = kvlog_commit(db, commit->seq);
+         }
+         pthread_mutex_unlock(&db->mtx);
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKvLogWriteKey(int handle, const char* key, const char* data, int dataSize)
+{
+   PclKvLogCommit_s commit;
+   int rval = pclKvLogAppendKey(handle, key, data, dataSize, &commit);
+
+   if(rval >= 0 && pclKvLogCommit(&commit) < 0)
+   {
+      rval = PERS_COM_FAILURE;
+   }
+
+   return rval;
+}
+
+
+
+int pclKvLogReadKey(int handle, const char* key, char* buffer, int bufferSize)
+{
+   int rval = PERS_COM_ERR_INVALID_PARAM;
+   size_t keySize = (key != NULL) ? strlen(key) : 0;
+
+   if(keySize > 0 && keySize <= PERS_DB_MAX_LENGTH_KEY_NAME && buffer != NULL && bufferSize >= 0)
+   {
+      PclKvLog_s* db = kvlog_lock(handle);
+
+      kvlog_touch();
+      if(db != NULL)
+      {
+         int found = 0;
+         PclKvLogRecord_s record;
+         PclKvIndexSlot_s* slot = kvlog_find(db, key, (uint32_t)keySize, pclCrc32(0, (const unsigned char*)key, keySize), &record, &found);
+
+         if(found == 1)
+         {
+            size_t size = (record.valueSize < (uint32_t)bufferSize) ? record.valueSize : (size_t)bufferSize;
+
+            if(pread(db->logFd, buffer, size, (off_t)(slot->offset + sizeof(PclKvLogRecord_s) + keySize)) == (ssize_t)size)
+            {
+               rval = (int)size;
+            }
+            else
+            {
+               rval = PERS_COM_FAILURE;
+            }
+         }
+         else
+         {
+            rval = PERS_COM_ERR_NOT_FOUND;
+         }
+
+         pthread_mutex_unlock(&db->mtx);
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKvLogGetKeySize(int handle, const char* key)
+{
+   int rval = PERS_COM_ERR_INVALID_PARAM;
+   size_t keySize = (key != NULL) ? strlen(key) : 0;
+
+   if(keySize > 0 && keySize <= PERS_DB_MAX_LENGTH_KEY_NAME)
+   {
+      PclKvLog_s* db = kvlog_lock(handle);
+
+      kvlog_touch();
+      if(db != NULL)
+      {
+         int found = 0;
+         PclKvLogRecord_s record;
+
+         (void)kvlog_find(db, key, (uint32_t)keySize, pclCrc32(0, (const unsigned char*)key, keySize), &record, &found);
+         rval = (found == 1) ? (int)record.valueSize : PERS_COM_ERR_NOT_FOUND;
+
+         pthread_mutex_unlock(&db->mtx);
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKvLogDeleteKey(int handle, const char* key)
+{
+   int rval = PERS_COM_ERR_INVALID_PARAM;
+   size_t keySize = (key != NULL) ? strlen(key) : 0;
+
+   if(keySize > 0 && keySize <= PERS_DB_MAX_LENGTH_KEY_NAME)
+   {
+      PclKvLog_s* db = kvlog_lock(handle);
+
+      kvlog_touch();
+      if(db != NULL)
+      {
+         int found = 0;
+         uint64_t logSize = 0, deadBytes = 0;
+
+         (void)kvlog_find(db, key, (uint32_t)keySize, pclCrc32(0, (const unsigned char*)key, keySize), NULL, &found);
+         if(found == 1)
+         {
+            rval = kvlog_append(db, key, (uint32_t)keySize, NULL, gKvLogTombstone);
+            if(rval == 0 && db->writeThrough == 1)
+            {
+               rval = kvlog_commit(db, db->appendSeq);
+            }
+         }
+         else
+         {
+            rval = PERS_COM_ERR_NOT_FOUND;
+         }
+         logSize   = db->index->logSize;
+         deadBytes = db->index->deadBytes;
+
+         pthread_mutex_unlock(&db->mtx);
+
+         kvlog_schedule_compaction(logSize, deadBytes);
+      }
+   }
+
+   return rval;
+}
+
+
+
+/// find the slot of the record at the given offset, NULL if the record is not the latest of its key
+static PclKvIndexSlot_s* kvlog_slot_at(PclKvLog_s* db, uint32_t hash, uint64_t offset)
+{
+   uint32_t mask = db->index->numSlots - 1;
+   uint32_t slot = hash & mask;
+
+   while(db->slots[slot].offset != 0)
+   {
+      if(db->slots[slot].offset == offset)
+      {
+         return &db->slots[slot];
+      }
+      slot = (slot + 1) & mask;
+   }
+
+   return NULL;
+}
+
+
+
+static int kvlog_map_compare(const void* a, const void* b)
+{
+   uint64_t keyOffset = *(const uint64_t*)a;
+   uint64_t mapOffset = ((const PclKvCompactMap_s*)b)->oldOffset;
+
+   return (keyOffset < mapOffset) ? -1 : ((keyOffset > mapOffset) ? 1 : 0);
+}
+
+
+
+/**
+ * The log is copied record by record to the compacted log, only the latest record of each
+ * key is copied. With a budget the database is unlocked after each batch, so records appended
+ * in the meantime are copied as well. Deleted keys are dropped, except deletions appended
+ * during the compaction, they may refer to a record already copied.
+ * The compacted log replaces the log atomically, if interrupted the index is rebuilt from the log.
+ */
+static int kvlog_compact(int handle, unsigned int budget)
+{
+   int rval = PERS_COM_ERR_INVALID_PARAM;
+   PclKvLog_s* db = kvlog_lock(handle);
+
+   if(db != NULL && db->compacting == 1)
+   {
+      pthread_mutex_unlock(&db->mtx);
+      return 0;
+   }
+
+   if(db != NULL)
+   {
+      char tmpPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+      char* record = malloc(kvlog_record_size(PERS_DB_MAX_LENGTH_KEY_NAME, PERS_DB_MAX_SIZE_KEY_DATA));
+      PclKvCompactMap_s* map = NULL;
+      size_t mapCount = 0, mapSize = 0;
+      uint64_t startSize = db->index->logSize;
+      uint64_t readPos  = sizeof(PclKvLogHeader_s);
+      uint64_t writePos = sizeof(PclKvLogHeader_s);
+      int tmpFd = -1;
+
+      db->compacting   = 1;
+      db->compactAbort = 0;
+      snprintf(tmpPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", db->path, gKvCompactPostfix);
+
+      rval = PERS_COM_FAILURE;
+      if(record != NULL && (tmpFd = open(tmpPath, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) != -1)
+      {
+         PclKvLogHeader_s header;
+
+         memcpy(header.magic, gKvLogMagic, sizeof(header.magic));
+         header.version = gKvLogVersion;
+         rval = (pwrite(tmpFd, &header, sizeof(header), 0) == (ssize_t)sizeof(header)) ? 0 : PERS_COM_FAILURE;
+      }
+
+      while(rval == 0)
+      {
+         unsigned int batch = 0;
+
+         if(db->compactAbort == 1 || AccessNoLock == isAccessLocked())
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("kvLog - compaction aborted:"), DLT_STRING(db->path));
+            rval = PERS_COM_FAILURE;
+            break;
+         }
+
+         while(rval == 0 && readPos < db->index->logSize && (budget == 0 || batch < KvLogCompactBatchSize))
+         {
+            const PclKvLogRecord_s* rec = (const PclKvLogRecord_s*)record;
+            uint32_t recordSize = 0;
+            int keep = 0;
+
+            if(   pread(db->logFd, record, sizeof(PclKvLogRecord_s), (off_t)readPos) != (ssize_t)sizeof(PclKvLogRecord_s)
+               || rec->keySize == 0 || rec->keySize > PERS_DB_MAX_LENGTH_KEY_NAME
+               || (rec->valueSize > PERS_DB_MAX_SIZE_KEY_DATA && rec->valueSize != gKvLogTombstone))
+            {
+               rval = PERS_COM_FAILURE;
+               break;
+            }
+
+            recordSize = kvlog_record_size(rec->keySize, rec->valueSize);
+            if(pread(db->logFd, record, recordSize, (off_t)readPos) != (ssize_t)recordSize)
+            {
+               rval = PERS_COM_FAILURE;
+               break;
+            }
+
+            if(rec->valueSize == gKvLogTombstone)
+            {
+               keep = (readPos >= startSize) ? 1 : 0;
+            }
+            else if(kvlog_slot_at(db, pclCrc32(0, (const unsigned char*)record + sizeof(PclKvLogRecord_s), rec->keySize), readPos) != NULL)
+            {
+               if(mapCount == mapSize)
+               {
+                  PclKvCompactMap_s* newMap = realloc(map, (mapSize + KvLogIndexSlots) * sizeof(PclKvCompactMap_s));
+
+                  if(newMap == NULL)
+                  {
+                     rval = PERS_COM_ERR_OUT_OF_MEMORY;
+                     break;
+                  }
+                  map = newMap;
+                  mapSize += KvLogIndexSlots;
+               }
+               map[mapCount].oldOffset = readPos;
+               map[mapCount].newOffset = writePos;
+               mapCount++;
+               keep = 1;
+            }
+
+            if(keep == 1)
+            {
+               if(pwrite(tmpFd, record, recordSize, (off_t)writePos) != (ssize_t)recordSize)
+               {
+                  rval = PERS_COM_FAILURE;
+                  break;
+               }
+               writePos += recordSize;
+            }
+            readPos += recordSize;
+            batch += recordSize;
+         }
+
+         if(rval != 0 || readPos >= db->index->logSize)
+         {
+            break;      // done, the database is still locked
+         }
+
+         // stay within the I/O budget, the database can be accessed in the meantime
+         pthread_mutex_unlock(&db->mtx);
+         usleep((useconds_t)((unsigned long long)batch * 1000000ULL / budget));
+         pthread_mutex_lock(&db->mtx);
+      }
+
+      if(rval == 0)
+      {
+         uint32_t i = 0;
+
+         for(i=0; i<db->index->numSlots; i++)      // each latest record must have been copied
+         {
+            if(   db->slots[i].offset != 0
+               && bsearch(&db->slots[i].offset, map, mapCount, sizeof(PclKvCompactMap_s), kvlog_map_compare) == NULL)
+            {
+               rval = PERS_COM_FAILURE;
+               break;
+            }
+         }
+      }
+
+      if(rval == 0 && fdatasync(tmpFd) == 0 && rename(tmpPath, db->path) == 0)
+      {
+         uint32_t i = 0;
+         uint64_t liveBytes = 0;
+
+         close(db->logFd);
+         db->logFd = tmpFd;
+         tmpFd = -1;
+
+         for(i=0; i<db->index->numSlots; i++)
+         {
+            if(db->slots[i].offset != 0)
+            {
+               const PclKvCompactMap_s* entry = bsearch(&db->slots[i].offset, map, mapCount, sizeof(PclKvCompactMap_s), kvlog_map_compare);
+
+               db->slots[i].offset = entry->newOffset;
+               liveBytes += db->slots[i].recordSize;
+            }
+         }
+
+         // the compacted log has been committed including all records appended so far,
+         // as soon as the rename is on disk
+         if(kvlog_sync_dir(db->path) == 0)
+         {
+            db->syncedSeq = db->appendSeq;
+         }
+         else
+         {
+            db->failedSeq = db->appendSeq;
+         }
+         pthread_cond_broadcast(&db->commitDone);
+
+         rval = (int)(db->index->logSize - writePos);
+         db->index->logSize   = writePos;
+         db->index->deadBytes = writePos - sizeof(PclKvLogHeader_s) - liveBytes;
+
+         DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("kvLog - compacted:"), DLT_STRING(db->path),
+                                               DLT_STRING("removed:"), DLT_INT(rval));
+      }
+      else
+      {
+         if(db->compactAbort == 0)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("kvLog - failed to compact:"), DLT_STRING(db->path));
+         }
+         rval = PERS_COM_FAILURE;
+         (void)unlink(tmpPath);
+      }
+
+      if(tmpFd != -1)
+      {
+         close(tmpFd);
+      }
+
+      free(map);
+      free(record);
+
+      db->compacting = 0;
+      pthread_cond_broadcast(&db->compactDone);
+      pthread_mutex_unlock(&db->mtx);
+   }
+
+   return rval;
+}
+
+
+
+void pclKvLogRemove(const char* path)
+{
+   char idxPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+   snprintf(idxPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", path, gKvIndexPostfix);
+   (void)unlink(path);
+   (void)unlink(idxPath);
+}
+
+
+
+int pclKvLogRename(const char* oldPath, const char* newPath)
+{
+   int rval = PERS_COM_FAILURE;
+   char oldIdxPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+   char newIdxPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+   snprintf(oldIdxPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", oldPath, gKvIndexPostfix);
+   snprintf(newIdxPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", newPath, gKvIndexPostfix);
+
+   // the index is renamed first, it is rebuilt if it does not match the log
+   if(rename(oldIdxPath, newIdxPath) == -1)
+   {
+      (void)unlink(newIdxPath);
+   }
+
+   if(rename(oldPath, newPath) == 0 && kvlog_sync_dir(newPath) == 0)
+   {
+      rval = 0;
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("kvLog - failed to rename:"), DLT_STRING(oldPath), DLT_STRING(strerror(errno)));
+   }
+
+   return rval;
+}
+
+
+
+int pclKvLogCompact(int handle)
+{
+   return kvlog_compact(handle, 0);
+}
+
+
+
+void pclKvLogDeinit(void)
+{
+   int running = 0;
+
+   pthread_mutex_lock(&gKvLogMtx);
+   running = gKvCompactRunning;
+   gKvCompactStop = 1;
+   pthread_cond_broadcast(&gKvCompactCond);
+   pthread_mutex_unlock(&gKvLogMtx);
+
+   if(running == 1)
+   {
+      pthread_join(gKvCompactThread, NULL);
+   }
+
+   pthread_mutex_lock(&gKvLogMtx);
+   gKvCompactRunning = 0;
+   gKvCompactStop = 0;
+   pthread_mutex_unlock(&gKvLogMtx);
+}
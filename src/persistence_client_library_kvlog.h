@@ -0,0 +1,181 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_KVLOG_H
+#define PERSISTENCE_CLIENT_LIBRARY_KVLOG_H
+
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_kvlog.h
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Header of the persistence client library log-structured key/value database.
+ *                 Each write appends a record with a crc to the log, the position of the
+ *                 latest record of each key is kept in a hash index mapped from an index file.
+ *                 If the database has not been closed cleanly the index is rebuilt by scanning the log.
+ *                 The functions return the same values as the persistence common database functions.
+ * @see
+ */
+
+#include "persistence_client_library_data_organization.h"
+
+#include <stdint.h>
+
+
+/// pending commit of a write to a write through log database
+typedef struct _PclKvLogCommit_s
+{
+   /// the database handle
+   int handle;
+   /// the generation of the database handle
+   unsigned int generation;
+   /// the log sequence to be committed, 0 if nothing needs to be committed
+   uint64_t seq;
+} PclKvLogCommit_s;
+
+
+/**
+ * @brief open a log database, the database will be created if not existing
+ *
+ * @param path the path of the log, the index is stored next to the log
+ * @param writeThrough 1 if each write shall be committed to disk before returning,
+ *        0 if the data will be committed when the database is closed
+ * @param created set to 1 if the database has been created, can be NULL
+ *
+ * @return the database handle or a negative value on error
+ */
+int pclKvLogOpen(const char* path, int writeThrough, int* created);
+
+
+/**
+ * @brief close a log database
+ *
+ * @param handle the database handle
+ *
+ * @return 0 on success or a negative value on error
+ */
+int pclKvLogClose(int handle);
+
+
+/**
+ * @brief write the data of a key
+ *
+ * @param handle the database handle
+ * @param key the key
+ * @param data the data to write
+ * @param dataSize the size of the data
+ *
+ * @return the number of bytes written or a negative value on error
+ */
+int pclKvLogWriteKey(int handle, const char* key, const char* data, int dataSize);
+
+
+/**
+ * @brief append the data of a key to the log without waiting for the commit.
+ *        For write through databases ::pclKvLogCommit must be called to wait
+ *        until the data has been committed to disk. The database must not be
+ *        locked by the caller while waiting, so concurrent writers share one commit.
+ *
+ * @param handle the database handle
+ * @param key the key
+ * @param data the data to write
+ * @param dataSize the size of the data
+ * @param commit the commit to pass to ::pclKvLogCommit
+ *
+ * @return the number of bytes written or a negative value on error
+ */
+int pclKvLogAppendKey(int handle, const char* key, const char* data, int dataSize, PclKvLogCommit_s* commit);
+
+
+/**
+ * @brief wait until the data appended with ::pclKvLogAppendKey has been committed to disk
+ *
+ * @param commit the commit filled by ::pclKvLogAppendKey
+ *
+ * @return 0 on success or a negative value if the commit failed
+ */
+int pclKvLogCommit(const PclKvLogCommit_s* commit);
+
+
+/**
+ * @brief read the data of a key
+ *
+ * @param handle the database handle
+ * @param key the key
+ * @param buffer the buffer to read the data to
+ * @param bufferSize the size of the buffer
+ *
+ * @return the number of bytes read or a negative value on error, PERS_COM_ERR_NOT_FOUND if the key does not exist
+ */
+int pclKvLogReadKey(int handle, const char* key, char* buffer, int bufferSize);
+
+
+/**
+ * @brief get the size of the data of a key
+ *
+ * @param handle the database handle
+ * @param key the key
+ *
+ * @return the size of the data or a negative value on error, PERS_COM_ERR_NOT_FOUND if the key does not exist
+ */
+int pclKvLogGetKeySize(int handle, const char* key);
+
+
+/**
+ * @brief delete a key
+ *
+ * @param handle the database handle
+ * @param key the key
+ *
+ * @return 0 on success or a negative value on error, PERS_COM_ERR_NOT_FOUND if the key does not exist
+ */
+int pclKvLogDeleteKey(int handle, const char* key);
+
+
+/**
+ * @brief remove a log database which is not open, including its index
+ *
+ * @param path the path of the log
+ */
+void pclKvLogRemove(const char* path);
+
+
+/**
+ * @brief rename a log database which is not open, including its index.
+ *        The rename is committed to disk before returning.
+ *
+ * @param oldPath the path of the log
+ * @param newPath the new path of the log, an existing log will be replaced
+ *
+ * @return 0 on success or a negative value on error
+ */
+int pclKvLogRename(const char* oldPath, const char* newPath);
+
+
+/**
+ * @brief compact the log, only the latest record of each existing key will be kept.
+ *        Log databases with a high ratio of dead records are also compacted by a
+ *        low priority background thread when the databases have not been accessed
+ *        for a while. The background compaction is limited to an I/O budget and
+ *        is aborted while access is blocked by the PAS or on shutdown.
+ *
+ * @param handle the database handle
+ *
+ * @return the number of bytes removed from the log or a negative value on error
+ */
+int pclKvLogCompact(int handle);
+
+
+/**
+ * @brief stop the background compaction scheduler, called after all log databases have been closed
+ */
+void pclKvLogDeinit(void);
+
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_KVLOG_H */
@@ -19,6 +19,14 @@
 
 #include "persistence_client_library_prct_access.h"
 #include "persistence_client_library_custom_loader.h"
+#include "crc32.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/inotify.h>
 #include <dlt.h>
 
 DLT_IMPORT_CONTEXT(gPclDLTContext);
@@ -30,6 +38,58 @@ static int gResource_table[PrctDbTableSize] = {[0 ... PrctDbTableSize-1] = -1};
 static int gResourceOpen[PrctDbTableSize] = { [0 ... PrctDbTableSize-1] = 0 };
 
 
+/// resource configuration table index slot
+typedef struct _PclRctSlot_s
+{
+   /// crc32 of the resource id
+   uint32_t hash;
+   /// index of the record + 1, 0 if the slot is empty
+   uint32_t record;
+} PclRctSlot_s;
+
+/// resource configuration table index record
+typedef struct _PclRctRecord_s
+{
+   /// offset of the resource id in the string area
+   uint32_t nameOffset;
+   /// the resource configuration
+   PersistenceConfigurationKey_s config;
+} PclRctRecord_s;
+
+/// resource configuration table index, slots, records and string area are allocated in one block
+typedef struct _PclRctIndex_s
+{
+   /// number of slots, power of two
+   uint32_t numSlots;
+   /// number of records
+   uint32_t count;
+   /// the hash slots
+   PclRctSlot_s* slots;
+   /// the records
+   PclRctRecord_s* records;
+   /// the interned resource ids
+   char* strings;
+} PclRctIndex_s;
+
+/// in-memory index of the resource configuration tables
+static PclRctIndex_s* gRctIndex[PrctDbTableSize] = { [0 ... PrctDbTableSize-1] = NULL };
+/// state of the index ::RctIndex_None, ::RctIndex_Built or ::RctIndex_Failed
+static int gRctIndexState[PrctDbTableSize] = { [0 ... PrctDbTableSize-1] = RctIndex_None };
+/// mutex to protect building the index
+static pthread_mutex_t gRctIndexMtx = PTHREAD_MUTEX_INITIALIZER;
+
+/// lock to protect the tables and the index against a reload, lookups hold the read lock
+static pthread_rwlock_t gRctLock = PTHREAD_RWLOCK_INITIALIZER;
+/// inotify file descriptor to watch the tables for changes
+static int gRctWatchFd = -1;
+/// inotify watch descriptor of the folder of each table
+static int gRctWatch[PrctDbTableSize] = { [0 ... PrctDbTableSize-1] = -1 };
+/// path of each watched table
+static char* gRctPath[PrctDbTableSize] = { [0 ... PrctDbTableSize-1] = NULL };
+/// generation of each table, incremented when the table has been reloaded or closed, see ::get_rct_generation
+static unsigned int gRctGeneration[PrctDbTableSize] = { [0 ... PrctDbTableSize-1] = 0 };
+
+
 /// persistence resource config table type definition
 typedef enum _PersistenceRCT_e
 {
@@ -91,12 +151,76 @@ void invalidate_resource_cfg_table(int i)
 {
    if(i >= 0 && i < PrctDbTableSize)
    {
+      pthread_rwlock_wrlock(&gRctLock);
+
       gResource_table[i] = -1;
       gResourceOpen[i] = 0;
+      __sync_add_and_fetch(&gRctGeneration[i], 1);
+
+      pthread_mutex_lock(&gRctIndexMtx);
+      free(gRctIndex[i]);
+      gRctIndex[i] = NULL;
+      gRctIndexState[i] = RctIndex_None;
+      pthread_mutex_unlock(&gRctIndexMtx);
+
+      if(gRctWatch[i] != -1)
+      {
+         int j = 0, shared = 0;
+
+         for(j=0; j<PrctDbTableSize; j++)    // the folder might be watched for another table too
+         {
+            if(j != i && gRctWatch[j] == gRctWatch[i])
+            {
+               shared = 1;
+               break;
+            }
+         }
+         if(shared == 0 && gRctWatchFd != -1)
+         {
+            (void)inotify_rm_watch(gRctWatchFd, gRctWatch[i]);
+         }
+         gRctWatch[i] = -1;
+      }
+      free(gRctPath[i]);
+      gRctPath[i] = NULL;
+
+      pthread_rwlock_unlock(&gRctLock);
    }
 }
 
 
+
+/// watch the folder of a table, gRctLock must be write locked
+static void add_rct_watch(unsigned int arrayIdx, const char* filename)
+{
+   if(gRctWatchFd != -1 && gRctWatch[arrayIdx] == -1)
+   {
+      char folder[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+      char* slash = NULL;
+
+      strncpy(folder, filename, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
+      slash = strrchr(folder, '/');
+      if(slash != NULL && slash != folder)
+      {
+         *slash = '\0';
+
+         // watch the folder, an updated table might be moved into place
+         gRctWatch[arrayIdx] = inotify_add_watch(gRctWatchFd, folder, IN_CLOSE_WRITE | IN_MOVED_TO);
+         if(gRctWatch[arrayIdx] != -1)
+         {
+            free(gRctPath[arrayIdx]);
+            gRctPath[arrayIdx] = strdup(filename);
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("gRCT - failed to watch:"), DLT_STRING(folder), DLT_STRING(strerror(errno)));
+         }
+      }
+   }
+}
+
+
+/// get the table handle and open the table if needed, gRctLock must be write locked to open the table
 int get_resource_cfg_table(PersistenceRCT_e rct, int group)
 {
    unsigned int arrayIdx = 0;
@@ -139,6 +263,7 @@ int get_resource_cfg_table(PersistenceRCT_e rct, int group)
             else
             {
                 gResourceOpen[arrayIdx] = 1 ;
+                add_rct_watch(arrayIdx, filename);
             }
          }
          else
@@ -156,6 +281,170 @@ int get_resource_cfg_table(PersistenceRCT_e rct, int group)
 
 
 
+static PclRctIndex_s* build_rct_index(int handleRCT)
+{
+   PclRctIndex_s* index = NULL;
+   char* list = NULL;
+   int listSize = 0;
+
+   if(*plugin_persComRctGetSizeResourcesList == NULL || *plugin_persComRctGetResourcesList == NULL || *plugin_persComRctRead == NULL)
+   {
+      return NULL;
+   }
+
+   listSize = plugin_persComRctGetSizeResourcesList(handleRCT);
+   if(listSize > 0 && (list = malloc((size_t)listSize)) != NULL)
+   {
+      if(plugin_persComRctGetResourcesList(handleRCT, list, listSize) > 0)
+      {
+         int pos = 0;
+         uint32_t count = 0, numSlots = 2;
+
+         list[listSize-1] = '\0';
+         while(pos < listSize)            // the list contains '\0' separated resource ids
+         {
+            size_t len = strlen(list + pos);
+            if(len > 0)
+            {
+               count++;
+            }
+            pos += (int)len + 1;
+         }
+
+         while(numSlots < 2*count)        // keep the load factor <= 0.5
+         {
+            numSlots <<= 1;
+         }
+
+         index = calloc(1, sizeof(PclRctIndex_s) + numSlots * sizeof(PclRctSlot_s)
+                                                 + count * sizeof(PclRctRecord_s) + (size_t)listSize);
+         if(index != NULL)
+         {
+            uint32_t strOffset = 0;
+
+            index->numSlots = numSlots;
+            index->slots    = (PclRctSlot_s*)(index + 1);
+            index->records  = (PclRctRecord_s*)(index->slots + numSlots);
+            index->strings  = (char*)(index->records + count);
+
+            pos = 0;
+            while(pos < listSize && index->count < count)
+            {
+               const char* resourceId = list + pos;
+               size_t len = strlen(resourceId);
+
+               pos += (int)len + 1;
+               if(len > 0)
+               {
+                  PclRctRecord_s* record = &index->records[index->count];
+                  uint32_t hash = pclCrc32(0, (const unsigned char*)resourceId, len);
+                  uint32_t slot = hash & (numSlots - 1);
+
+                  if(plugin_persComRctRead(handleRCT, resourceId, &record->config) != sizeof(PersistenceConfigurationKey_s))
+                  {
+                     DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("gRCT - index: failed to read:"), DLT_STRING(resourceId));
+                     free(index);
+                     index = NULL;
+                     break;
+                  }
+
+                  memcpy(index->strings + strOffset, resourceId, len + 1);
+                  record->nameOffset = strOffset;
+                  strOffset += (uint32_t)(len + 1);
+
+                  while(index->slots[slot].record != 0)      // linear probing
+                  {
+                     slot = (slot + 1) & (numSlots - 1);
+                  }
+                  index->slots[slot].hash   = hash;
+                  index->slots[slot].record = ++index->count;
+               }
+            }
+         }
+      }
+      free(list);
+   }
+
+   return index;
+}
+
+
+
+static const PersistenceConfigurationKey_s* find_rct_index(const PclRctIndex_s* index, const char* resource_id)
+{
+   uint32_t mask = index->numSlots - 1;
+   uint32_t hash = pclCrc32(0, (const unsigned char*)resource_id, strlen(resource_id));
+   uint32_t slot = hash & mask;
+
+   while(index->slots[slot].record != 0)     // the index is never full, so probing ends at an empty slot
+   {
+      const PclRctRecord_s* record = &index->records[index->slots[slot].record - 1];
+
+      if(index->slots[slot].hash == hash && strcmp(index->strings + record->nameOffset, resource_id) == 0)
+      {
+         return &record->config;
+      }
+      slot = (slot + 1) & mask;
+   }
+
+   return NULL;
+}
+
+
+
+static const PclRctIndex_s* get_rct_index(PersistenceRCT_e rct, int group, int handleRCT)
+{
+   unsigned int arrayIdx = (rct + (unsigned int)group);
+   const PclRctIndex_s* index = NULL;
+
+   if(gRctPreload != 0 && arrayIdx < PrctDbTableSize)
+   {
+      if(__sync_add_and_fetch(&gRctIndexState[arrayIdx], 0) == RctIndex_None)
+      {
+         pthread_mutex_lock(&gRctIndexMtx);
+         if(gRctIndexState[arrayIdx] == RctIndex_None)     // check again, might have been built meanwhile
+         {
+            gRctIndex[arrayIdx] = build_rct_index(handleRCT);
+            __sync_synchronize();
+            gRctIndexState[arrayIdx] = (gRctIndex[arrayIdx] != NULL) ? RctIndex_Built : RctIndex_Failed;
+
+            DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("gRCT - index built:"), DLT_INT(gRctIndexState[arrayIdx]),
+                    DLT_STRING("entries:"), DLT_UINT((gRctIndex[arrayIdx] != NULL) ? gRctIndex[arrayIdx]->count : 0));
+         }
+         pthread_mutex_unlock(&gRctIndexMtx);
+      }
+
+      if(__sync_add_and_fetch(&gRctIndexState[arrayIdx], 0) == RctIndex_Built)
+      {
+         index = gRctIndex[arrayIdx];
+      }
+   }
+
+   return index;
+}
+
+
+
+/// lock the tables for a lookup and get the table handle, the table is opened with the write lock held.
+/// Returns with gRctLock locked.
+static int lock_resource_cfg_table(PersistenceRCT_e rct, int group)
+{
+   unsigned int arrayIdx = (rct + (unsigned int)group);
+
+   pthread_rwlock_rdlock(&gRctLock);    // the table must not be reloaded during the lookup
+
+   if(arrayIdx < PrctDbTableSize && gResourceOpen[arrayIdx] == 0)
+   {
+      // the read lock can't be upgraded, the table is checked again with the write lock held
+      pthread_rwlock_unlock(&gRctLock);
+      pthread_rwlock_wrlock(&gRctLock);
+   }
+
+   return get_resource_cfg_table(rct, group);
+}
+
+
+
 int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsigned int isFile, char dbKey[], char dbPath[])
 {
    int rval = 0, resourceFound = 0, groupId = 0, handleRCT = 0;
@@ -163,16 +452,32 @@ int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsign
 
    rct = get_table_id(dbContext->context.ldbid, &groupId);
 
-   handleRCT = get_resource_cfg_table(rct, groupId);    // get resource configuration table
+   handleRCT = lock_resource_cfg_table(rct, groupId);    // get resource configuration table
 
    if(handleRCT >= 0)
    {
-      if(*plugin_persComRctRead != NULL)
+      const PclRctIndex_s* index = get_rct_index(rct, groupId, handleRCT);
+
+      if(index != NULL || *plugin_persComRctRead != NULL)
       {
          PersistenceConfigurationKey_s sRctEntry ;
+         int iErrCode = 0;
 
-         // check if resouce id is in write through table
-         int iErrCode = plugin_persComRctRead(handleRCT, resource_id, &sRctEntry) ;
+         if(index != NULL)    // the index contains the complete table
+         {
+            const PersistenceConfigurationKey_s* config = find_rct_index(index, resource_id);
+            if(config != NULL)
+            {
+               memcpy(&sRctEntry, config, sizeof(sRctEntry));
+               iErrCode = sizeof(PersistenceConfigurationKey_s);
+            }
+         }
+         else
+         {
+            // check if resouce id is in write through table
+            iErrCode = plugin_persComRctRead(handleRCT, resource_id, &sRctEntry) ;
+         }
+         pthread_rwlock_unlock(&gRctLock);
 
          if(sizeof(PersistenceConfigurationKey_s) == iErrCode)
          {
@@ -198,12 +503,14 @@ int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsign
       }
       else
       {
+         pthread_rwlock_unlock(&gRctLock);
          DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("gDBCtx - no plugin function available"));
          rval = EPERS_NO_PLUGIN_FUNCT;
       }
    }  // resource table
    else
    {
+      pthread_rwlock_unlock(&gRctLock);
       DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("gDBCtx - RCT"));
       rval = handleRCT;
    }
@@ -244,6 +551,162 @@ int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsign
 
 
 
+static void reload_rct(int idx)
+{
+   int newHandle = -1, oldHandle = -1;
+   PclRctIndex_s* newIndex = NULL;
+   PclRctIndex_s* oldIndex = NULL;
+   char* path = NULL;
+
+   pthread_rwlock_rdlock(&gRctLock);
+   if(*plugin_persComRctOpen != NULL && gResourceOpen[idx] != 0 && gRctPath[idx] != NULL)
+   {
+      path = strdup(gRctPath[idx]);
+   }
+   pthread_rwlock_unlock(&gRctLock);
+
+   if(path == NULL)
+   {
+      return;
+   }
+
+   // load the new table completely before it will be used
+   newHandle = plugin_persComRctOpen(path, 0x04);   // 0x04 ==> open in read only mode
+   if(newHandle < 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("gRCT - reload failed, keep table:"), DLT_STRING(path), DLT_INT(newHandle));
+      free(path);
+      return;
+   }
+
+   if(gRctPreload != 0)
+   {
+      newIndex = build_rct_index(newHandle);
+   }
+
+   pthread_rwlock_wrlock(&gRctLock);     // swap, no lookup is using the old table anymore
+
+   // the table might have been closed in the meantime
+   if(gResourceOpen[idx] != 0 && gRctPath[idx] != NULL && strcmp(gRctPath[idx], path) == 0)
+   {
+      oldHandle = gResource_table[idx];
+      gResource_table[idx] = newHandle;
+      __sync_add_and_fetch(&gRctGeneration[idx], 1);
+
+      pthread_mutex_lock(&gRctIndexMtx);
+      oldIndex = gRctIndex[idx];
+      gRctIndex[idx] = newIndex;
+      gRctIndexState[idx] = (newIndex != NULL) ? RctIndex_Built : RctIndex_None;
+      pthread_mutex_unlock(&gRctIndexMtx);
+
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("gRCT - reloaded:"), DLT_STRING(path));
+   }
+   else
+   {
+      oldHandle = newHandle;
+      oldIndex  = newIndex;
+   }
+
+   pthread_rwlock_unlock(&gRctLock);
+
+   free(oldIndex);
+   if(oldHandle >= 0 && *plugin_persComRctClose != NULL)
+   {
+      (void)plugin_persComRctClose(oldHandle);
+   }
+   free(path);
+}
+
+
+
+unsigned int get_rct_generation(unsigned int ldbid)
+{
+   int groupId = 0;
+   unsigned int arrayIdx = get_table_id(ldbid, &groupId) + (unsigned int)groupId;
+
+   return (arrayIdx < PrctDbTableSize) ? __sync_add_and_fetch(&gRctGeneration[arrayIdx], 0) : 0;
+}
+
+
+
+int rct_watch_init(void)
+{
+   if(gRctWatchFd == -1)
+   {
+      gRctWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if(gRctWatchFd == -1)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("gRCT - inotify_init failed:"), DLT_STRING(strerror(errno)));
+      }
+   }
+
+   return gRctWatchFd;
+}
+
+
+
+void rct_watch_process(void)
+{
+   char buffer[RctWatchBufferSize] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+   ssize_t len = 0;
+
+   while((len = read(gRctWatchFd, buffer, sizeof(buffer))) > 0)
+   {
+      char* ptr = buffer;
+
+      while(ptr < buffer + len)
+      {
+         const struct inotify_event* event = (const struct inotify_event*)ptr;
+
+         if(event->len > 0)
+         {
+            int i = 0;
+
+            for(i=0; i<PrctDbTableSize; i++)
+            {
+               int changed = 0;
+
+               pthread_rwlock_rdlock(&gRctLock);
+               if(gRctWatch[i] == event->wd && gRctPath[i] != NULL)
+               {
+                  const char* name = strrchr(gRctPath[i], '/');
+
+                  changed = (name != NULL && strcmp(name+1, event->name) == 0) ? 1 : 0;
+               }
+               pthread_rwlock_unlock(&gRctLock);
+
+               if(changed == 1)
+               {
+                  reload_rct(i);
+               }
+            }
+         }
+         ptr += sizeof(struct inotify_event) + event->len;
+      }
+   }
+}
+
+
+
+void rct_watch_deinit(void)
+{
+   int i = 0;
+
+   pthread_rwlock_wrlock(&gRctLock);
+   if(gRctWatchFd != -1)
+   {
+      close(gRctWatchFd);
+      gRctWatchFd = -1;
+   }
+   for(i=0; i<PrctDbTableSize; i++)
+   {
+      gRctWatch[i] = -1;
+   }
+   pthread_rwlock_unlock(&gRctLock);
+}
+
+
+
 int get_db_path_and_key(PersistenceInfo_s* dbContext, const char* resource_id, char dbKey[], char dbPath[])
 {
    int storePolicy = PersistenceStorage_LastEntry;
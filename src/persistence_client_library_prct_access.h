@@ -69,4 +69,42 @@ void invalidate_resource_cfg_table(int i);
 
 
 
+/**
+ * @brief get the generation of the resource configuration table of a logical database.
+ *        The generation changes when the table has been reloaded or closed,
+ *        so values derived from a resource configuration can be cached until then.
+ *
+ * @param ldbid the logical database id
+ *
+ * @return the generation
+ */
+unsigned int get_rct_generation(unsigned int ldbid);
+
+
+
+/**
+ * @brief create the inotify file descriptor used to watch the resource configuration tables.
+ *        The folder of each table will be watched when the table has been opened,
+ *        a changed table will be reloaded by ::rct_watch_process.
+ *
+ * @return the file descriptor to poll for changes or -1 on error
+ */
+int rct_watch_init(void);
+
+
+/**
+ * @brief reload the changed resource configuration tables.
+ *        The new table is loaded completely and swapped with the old one,
+ *        lookups use either the old or the new table.
+ */
+void rct_watch_process(void);
+
+
+/**
+ * @brief close the inotify file descriptor used to watch the resource configuration tables
+ */
+void rct_watch_deinit(void);
+
+
+
 #endif /* PERSISTENCE_CLIENT_LIBRARY_ACCESS_HELPER_H */
@@ -0,0 +1,391 @@
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_statistics.c
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Implementation of the persistence client library access statistics.
+ * @see
+ */
+
+#include "persistence_client_library_statistics.h"
+#include "persistence_client_library_trace.h"
+#include "crc32.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+
+/// statistics of a logical database
+typedef struct _PclStatLdbid_s
+{
+   /// the counters ::PclStatCounter_e
+   unsigned long long counter[PclStat_LastEntry];
+   /// number of bytes read from keys
+   unsigned long long keyBytesRead;
+   /// number of bytes written to keys
+   unsigned long long keyBytesWritten;
+   /// number of bytes read from files
+   unsigned long long fileBytesRead;
+   /// number of bytes written to files
+   unsigned long long fileBytesWritten;
+   /// number of failed calls
+   unsigned long long errors;
+   /// histogram of the duration of key API calls
+   unsigned long long keyLatency[PCL_STAT_LATENCY_BUCKETS];
+   /// histogram of the duration of file API calls
+   unsigned long long fileLatency[PCL_STAT_LATENCY_BUCKETS];
+} PclStatLdbid_s;
+
+/// access count of a resource
+typedef struct _PclStatResource_s
+{
+   /// crc32 of the resource id, 0 if the slot is empty
+   uint32_t hash;
+   /// logical database id
+   unsigned int ldbid;
+   /// number of accesses
+   unsigned long long accesses;
+   /// the resource id
+   char resource_id[PCL_STAT_RESOURCE_LEN];
+} PclStatResource_s;
+
+
+/// statistics per logical database, the last entry counts logical database ids out of range
+static PclStatLdbid_s gStatLdbid[StatLdbidSlots + 1];
+/// logical database of the open files, indexed by the file handle, stored as slot + 1
+static unsigned short gStatFileLdbid[MaxPersHandle] = {0};
+/// most accessed resources
+static PclStatResource_s gStatResource[StatResourceSlots];
+/// mutex to protect the resource access counts, only taken with ::PCL_STAT_RESOURCES
+static pthread_mutex_t gStatResourceMtx = PTHREAD_MUTEX_INITIALIZER;
+/// the statistics mode ::PCL_STAT_OFF or a combination of ::PCL_STAT_COUNTERS and ::PCL_STAT_RESOURCES
+static int gStatMode = PCL_STAT_COUNTERS;
+
+
+
+static unsigned int stat_slot(unsigned int ldbid)
+{
+   return (ldbid < StatLdbidSlots) ? ldbid : StatLdbidSlots;
+}
+
+
+
+static unsigned int stat_latency_bucket(unsigned long long durationUs)
+{
+   unsigned int bucket = 0;
+   unsigned long long limit = 1;
+
+   while(durationUs >= limit && bucket < PCL_STAT_LATENCY_BUCKETS - 1)
+   {
+      limit *= 4;
+      bucket++;
+   }
+
+   return bucket;
+}
+
+
+
+/// count an access of a resource, when the probed slots are used the least accessed of them will be replaced
+static void stat_resource(unsigned int ldbid, const char* resource_id)
+{
+   uint32_t hash = pclCrc32(ldbid, (const unsigned char*)resource_id, strlen(resource_id)) | 1U;
+
+   if(pthread_mutex_lock(&gStatResourceMtx) == 0)
+   {
+      unsigned int i = 0, slot = hash & (StatResourceSlots - 1);
+      PclStatResource_s* entry = NULL;
+      PclStatResource_s* least = &gStatResource[slot];
+
+      for(i=0; i<StatResourceProbe; i++)
+      {
+         PclStatResource_s* probe = &gStatResource[(slot + i) & (StatResourceSlots - 1)];
+
+         if(probe->accesses < least->accesses)
+         {
+            least = probe;
+         }
+
+         if(probe->hash == 0)
+         {
+            probe->hash     = hash;
+            probe->ldbid    = ldbid;
+            probe->accesses = 0;
+            snprintf(probe->resource_id, PCL_STAT_RESOURCE_LEN, "%s", resource_id);
+            entry = probe;
+            break;
+         }
+         else if(probe->hash == hash && probe->ldbid == ldbid && strncmp(probe->resource_id, resource_id, PCL_STAT_RESOURCE_LEN - 1) == 0)
+         {
+            entry = probe;
+            break;
+         }
+      }
+
+      if(entry == NULL)    // all probed slots used, replace the least accessed resource
+      {
+         entry = least;
+         entry->hash  = hash;
+         entry->ldbid = ldbid;
+         snprintf(entry->resource_id, PCL_STAT_RESOURCE_LEN, "%s", resource_id);
+      }
+      entry->accesses++;
+
+      pthread_mutex_unlock(&gStatResourceMtx);
+   }
+}
+
+
+
+unsigned long long pers_stat_now(void)
+{
+   struct timespec now;
+
+   if(gStatMode == PCL_STAT_OFF && (gPclTraceMode & PCL_TRACE_RING) == 0)
+   {
+      return 0;      // no latency needed, don't read the clock
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return (unsigned long long)now.tv_sec * 1000000ULL + (unsigned long long)now.tv_nsec / 1000ULL;
+}
+
+
+
+void pers_stat_call(unsigned int ldbid, const char* resource_id, PclStatCounter_e op, int result, unsigned long long start)
+{
+   PclStatLdbid_s* stat = &gStatLdbid[stat_slot(ldbid)];
+   int mode = gStatMode;
+
+   if((mode & PCL_STAT_RESOURCES) != 0 && resource_id != NULL)
+   {
+      stat_resource(ldbid, resource_id);
+   }
+
+   if((mode & PCL_STAT_COUNTERS) == 0)
+   {
+      return;
+   }
+
+   __sync_fetch_and_add(&stat->counter[op], 1);
+
+   if(start != 0)       // 0 if the statistics have been enabled during the call
+   {
+      unsigned int bucket = stat_latency_bucket(pers_stat_now() - start);
+
+      if(op < PclStat_FileOpen)
+      {
+         __sync_fetch_and_add(&stat->keyLatency[bucket], 1);
+      }
+      else
+      {
+         __sync_fetch_and_add(&stat->fileLatency[bucket], 1);
+      }
+   }
+
+   if(result < 0)
+   {
+      __sync_fetch_and_add(&stat->errors, 1);
+   }
+   else if(op == PclStat_KeyRead)
+   {
+      __sync_fetch_and_add(&stat->keyBytesRead, (unsigned long long)result);
+   }
+   else if(op == PclStat_KeyWrite)
+   {
+      __sync_fetch_and_add(&stat->keyBytesWritten, (unsigned long long)result);
+   }
+   else if(op == PclStat_FileRead)
+   {
+      __sync_fetch_and_add(&stat->fileBytesRead, (unsigned long long)result);
+   }
+   else if(op == PclStat_FileWrite)
+   {
+      __sync_fetch_and_add(&stat->fileBytesWritten, (unsigned long long)result);
+   }
+}
+
+
+
+void pers_stat_file_open(int fd, unsigned int ldbid, const char* resource_id, unsigned long long start)
+{
+   if(fd >= 0 && fd < MaxPersHandle)
+   {
+      gStatFileLdbid[fd] = (unsigned short)(stat_slot(ldbid) + 1);
+   }
+
+   pers_stat_call(ldbid, resource_id, PclStat_FileOpen, fd, start);
+}
+
+
+
+void pers_stat_file_close(int fd)
+{
+   if(fd >= 0 && fd < MaxPersHandle)
+   {
+      gStatFileLdbid[fd] = 0;
+   }
+}
+
+
+
+unsigned int pers_stat_file_ldbid(int fd)
+{
+   unsigned int ldbid = StatLdbidSlots;      // unknown file, counted as out of range
+
+   if(fd >= 0 && fd < MaxPersHandle && gStatFileLdbid[fd] != 0)
+   {
+      ldbid = (unsigned int)gStatFileLdbid[fd] - 1;
+   }
+
+   return ldbid;
+}
+
+
+
+void pers_stat_file_call(int fd, PclStatCounter_e op, int result, unsigned long long start)
+{
+   pers_stat_call(pers_stat_file_ldbid(fd), NULL, op, result, start);
+}
+
+
+
+void pers_stat_count(unsigned int ldbid, PclStatCounter_e counter)
+{
+   if((gStatMode & PCL_STAT_COUNTERS) != 0)
+   {
+      __sync_fetch_and_add(&gStatLdbid[stat_slot(ldbid)].counter[counter], 1);
+   }
+}
+
+
+
+void pers_stat_get(unsigned int ldbid, pclStatistics_s* statistics)
+{
+   unsigned int i = 0, b = 0;
+
+   memset(statistics, 0, sizeof(pclStatistics_s));
+
+   for(i=0; i<=StatLdbidSlots; i++)
+   {
+      const PclStatLdbid_s* stat = &gStatLdbid[i];
+
+      if(ldbid != PCL_STAT_LDBID_ALL && stat_slot(ldbid) != i)
+      {
+         continue;
+      }
+
+      statistics->keyReads         += stat->counter[PclStat_KeyRead];
+      statistics->keyWrites        += stat->counter[PclStat_KeyWrite];
+      statistics->keyDeletes       += stat->counter[PclStat_KeyDelete];
+      statistics->keySizes         += stat->counter[PclStat_KeySize];
+      statistics->fileOpens        += stat->counter[PclStat_FileOpen];
+      statistics->fileReads        += stat->counter[PclStat_FileRead];
+      statistics->fileWrites       += stat->counter[PclStat_FileWrite];
+      statistics->fileRemoves      += stat->counter[PclStat_FileRemove];
+      statistics->dbCacheHits      += stat->counter[PclStat_DbCacheHit];
+      statistics->dbCacheMisses    += stat->counter[PclStat_DbCacheMiss];
+      statistics->defaultFallbacks += stat->counter[PclStat_DefaultFallback];
+      statistics->notifications    += stat->counter[PclStat_Notification];
+      statistics->keyBytesRead     += stat->keyBytesRead;
+      statistics->keyBytesWritten  += stat->keyBytesWritten;
+      statistics->fileBytesRead    += stat->fileBytesRead;
+      statistics->fileBytesWritten += stat->fileBytesWritten;
+      statistics->errors           += stat->errors;
+
+      for(b=0; b<PCL_STAT_LATENCY_BUCKETS; b++)
+      {
+         statistics->keyLatency[b]  += stat->keyLatency[b];
+         statistics->fileLatency[b] += stat->fileLatency[b];
+      }
+   }
+
+   if(pthread_mutex_lock(&gStatResourceMtx) == 0)
+   {
+      for(i=0; i<StatResourceSlots; i++)
+      {
+         const PclStatResource_s* entry = &gStatResource[i];
+
+         if(entry->hash != 0 && (ldbid == PCL_STAT_LDBID_ALL || entry->ldbid == ldbid))
+         {
+            unsigned int pos = statistics->numTopResources;
+
+            // insertion sort into the top resources, most accessed first
+            while(pos > 0 && statistics->topResources[pos - 1].accesses < entry->accesses)
+            {
+               if(pos < PCL_STAT_TOP_RESOURCES)
+               {
+                  statistics->topResources[pos] = statistics->topResources[pos - 1];
+               }
+               pos--;
+            }
+
+            if(pos < PCL_STAT_TOP_RESOURCES)
+            {
+               statistics->topResources[pos].ldbid    = entry->ldbid;
+               statistics->topResources[pos].accesses = entry->accesses;
+               memcpy(statistics->topResources[pos].resource_id, entry->resource_id, PCL_STAT_RESOURCE_LEN);
+
+               if(statistics->numTopResources < PCL_STAT_TOP_RESOURCES)
+               {
+                  statistics->numTopResources++;
+               }
+            }
+         }
+      }
+
+      pthread_mutex_unlock(&gStatResourceMtx);
+   }
+}
+
+
+
+void pers_stat_reset(void)
+{
+   // the statistics consist of counters only, clear them one by one with atomic operations,
+   // so counts added concurrently by atomic adds will not be lost partially
+   unsigned int i = 0;
+   size_t c = 0;
+
+   for(i=0; i<=StatLdbidSlots; i++)
+   {
+      unsigned long long* counter = (unsigned long long*)&gStatLdbid[i];
+
+      for(c=0; c<sizeof(PclStatLdbid_s) / sizeof(unsigned long long); c++)
+      {
+         (void)__sync_fetch_and_and(&counter[c], 0ULL);
+      }
+   }
+
+   if(pthread_mutex_lock(&gStatResourceMtx) == 0)
+   {
+      memset(gStatResource, 0, sizeof(gStatResource));
+      pthread_mutex_unlock(&gStatResourceMtx);
+   }
+}
+
+
+
+int pers_stat_set_mode(int mode)
+{
+   if((mode & ~(PCL_STAT_COUNTERS | PCL_STAT_RESOURCES)) != 0)
+   {
+      return -1;
+   }
+
+   gStatMode = mode;
+
+   return 0;
+}
@@ -0,0 +1,156 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_STATISTICS_H
+#define PERSISTENCE_CLIENT_LIBRARY_STATISTICS_H
+
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_statistics.h
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Header of the persistence client library access statistics.
+ *                 The counters are kept per logical database and updated without locking,
+ *                 only the tracking of the most accessed resources is locked.
+ * @see
+ */
+
+#include "persistence_client_library_data_organization.h"
+#include "../include/persistence_client_library.h"
+
+
+/// statistics counters
+typedef enum _PclStatCounter_e
+{
+   /// key read, the result is the number of bytes read
+   PclStat_KeyRead = 0,
+   /// key write, the result is the number of bytes written
+   PclStat_KeyWrite,
+   /// key deletion
+   PclStat_KeyDelete,
+   /// key size request
+   PclStat_KeySize,
+   /// file open, the result is the file handle
+   PclStat_FileOpen,
+   /// file read, the result is the number of bytes read
+   PclStat_FileRead,
+   /// file write, the result is the number of bytes written
+   PclStat_FileWrite,
+   /// file removal
+   PclStat_FileRemove,
+   /// access to a database which was already open
+   PclStat_DbCacheHit,
+   /// access which opened a database
+   PclStat_DbCacheMiss,
+   /// access answered with default data
+   PclStat_DefaultFallback,
+   /// change notification sent
+   PclStat_Notification,
+
+   /// last entry
+   PclStat_LastEntry
+} PclStatCounter_e;
+
+
+/**
+ * @brief get the start time of an API call
+ *
+ * @return the time in microseconds, 0 if neither the statistics nor the trace ring buffer need it
+ */
+unsigned long long pers_stat_now(void);
+
+
+/**
+ * @brief count a key or file API call
+ *
+ * @param ldbid the logical database id
+ * @param resource_id the resource id, NULL if the resource shall not be counted
+ * @param op the API call ::PclStat_KeyRead to ::PclStat_FileRemove
+ * @param result the result of the call, a negative value is counted as error
+ * @param start the start time of the call from ::pers_stat_now
+ */
+void pers_stat_call(unsigned int ldbid, const char* resource_id, PclStatCounter_e op, int result, unsigned long long start);
+
+
+/**
+ * @brief count a file open, the logical database of the file is remembered for ::pers_stat_file_call
+ *
+ * @param fd the file handle or a negative value if the open failed
+ * @param ldbid the logical database id
+ * @param resource_id the resource id
+ * @param start the start time of the call from ::pers_stat_now
+ */
+void pers_stat_file_open(int fd, unsigned int ldbid, const char* resource_id, unsigned long long start);
+
+
+/**
+ * @brief forget the logical database of a file when the file is closed
+ *
+ * @param fd the file handle
+ */
+void pers_stat_file_close(int fd);
+
+
+/**
+ * @brief get the logical database of an open file
+ *
+ * @param fd the file handle
+ *
+ * @return the logical database id, ::StatLdbidSlots if the logical database is not known
+ *         or out of the range of logical databases with separate statistics
+ */
+unsigned int pers_stat_file_ldbid(int fd);
+
+
+/**
+ * @brief count a file API call of an open file
+ *
+ * @param fd the file handle
+ * @param op the API call ::PclStat_FileRead or ::PclStat_FileWrite
+ * @param result the result of the call, a negative value is counted as error
+ * @param start the start time of the call from ::pers_stat_now
+ */
+void pers_stat_file_call(int fd, PclStatCounter_e op, int result, unsigned long long start);
+
+
+/**
+ * @brief increment a counter
+ *
+ * @param ldbid the logical database id
+ * @param counter the counter ::PclStat_DbCacheHit to ::PclStat_Notification
+ */
+void pers_stat_count(unsigned int ldbid, PclStatCounter_e counter);
+
+
+/**
+ * @brief get the statistics, see ::pclGetStatistics
+ *
+ * @param ldbid the logical database id or ::PCL_STAT_LDBID_ALL
+ * @param statistics the structure to store the statistics
+ */
+void pers_stat_get(unsigned int ldbid, pclStatistics_s* statistics);
+
+
+/**
+ * @brief reset the statistics
+ */
+void pers_stat_reset(void);
+
+
+/**
+ * @brief set the statistics mode
+ *
+ * @param mode the statistics mode, see ::pclSetStatisticsMode
+ *
+ * @return 0 on success, -1 if the mode is not supported
+ */
+int pers_stat_set_mode(int mode);
+
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_STATISTICS_H */
@@ -0,0 +1,281 @@
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_trace.c
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Implementation of the persistence client library API call tracing.
+ * @see
+ */
+
+#include "persistence_client_library_trace.h"
+#include "persistence_client_library_statistics.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+
+DLT_IMPORT_CONTEXT(gPclDLTContext);
+
+
+/// the trace mode, API calls are logged to DLT by default
+int gPclTraceMode = PCL_TRACE_DLT;
+
+
+#if USE_TRACE
+
+/// recorded API call
+typedef struct _PclTraceEvent_s
+{
+   /// start time of the call in microseconds
+   uint64_t timestamp;
+   /// duration of the call in microseconds
+   uint32_t duration;
+   /// the result of the call
+   int32_t result;
+   /// the key or file handle
+   int32_t handle;
+   /// the logical database id
+   uint32_t ldbid;
+   /// the API call ::PclTraceApi_e
+   uint32_t api;
+   /// reserved for alignment
+   uint32_t reserved;
+} PclTraceEvent_s;
+
+/// ring buffer of a thread, only written by the owning thread
+typedef struct _PclTraceRing_s
+{
+   /// next ring buffer, ring buffers are never freed
+   struct _PclTraceRing_s* next;
+   /// 1 while the ring buffer is used by a thread, 0 if it can be taken over by a new thread
+   int owned;
+   /// thread id of the owning thread
+   int tid;
+   /// number of events written
+   volatile uint32_t head;
+   /// number of events dumped on error
+   uint32_t dumped;
+   /// the events
+   PclTraceEvent_s event[TraceRingSize];
+} PclTraceRing_s;
+
+
+/// all ring buffers
+static PclTraceRing_s* gTraceRings = NULL;
+/// ring buffer of the calling thread
+static __thread PclTraceRing_s* gTraceRing = NULL;
+/// key to release the ring buffer when the thread exits
+static pthread_key_t gTraceRingKey;
+/// create the key only once
+static pthread_once_t gTraceRingKeyOnce = PTHREAD_ONCE_INIT;
+
+/// names of the traced API calls
+static const char* gTraceApiName[PclTrace_LastEntry] =
+{
+   "keyRead", "keyWrite", "keyDelete", "keySize", "fileOpen", "fileRead", "fileWrite", "fileRemove",
+   "fileAtomicCommit", "fileAtomicAbort"
+};
+
+
+
+static void trace_ring_release(void* ring)
+{
+   __sync_lock_release(&((PclTraceRing_s*)ring)->owned);
+}
+
+
+
+static void trace_ring_key_create(void)
+{
+   (void)pthread_key_create(&gTraceRingKey, trace_ring_release);
+}
+
+
+
+/// get the ring buffer of the calling thread, a ring buffer of an exited thread is reused
+static PclTraceRing_s* trace_ring_get(void)
+{
+   PclTraceRing_s* ring = gTraceRing;
+
+   if(ring == NULL)
+   {
+      (void)pthread_once(&gTraceRingKeyOnce, trace_ring_key_create);
+
+      for(ring = gTraceRings; ring != NULL; ring = ring->next)
+      {
+         if(__sync_bool_compare_and_swap(&ring->owned, 0, 1))
+         {
+            break;
+         }
+      }
+
+      if(ring == NULL)
+      {
+         ring = calloc(1, sizeof(PclTraceRing_s));
+         if(ring == NULL)
+         {
+            return NULL;
+         }
+         ring->owned = 1;
+
+         do
+         {
+            ring->next = gTraceRings;
+         }
+         while(!__sync_bool_compare_and_swap(&gTraceRings, ring->next, ring));
+      }
+
+      ring->tid     = (int)syscall(SYS_gettid);
+      ring->dumped  = ring->head;
+      gTraceRing    = ring;
+      (void)pthread_setspecific(gTraceRingKey, ring);
+   }
+
+   return ring;
+}
+
+
+
+/// dump the events of a ring buffer starting at the event number first, the ring buffer may be written concurrently
+static int trace_ring_dump(PclTraceRing_s* ring, uint32_t first)
+{
+   static PclTraceEvent_s copy[TraceRingSize];   // only used with gTraceDumpMtx locked
+   static pthread_mutex_t gTraceDumpMtx = PTHREAD_MUTEX_INITIALIZER;
+   uint32_t head = 0, i = 0;
+   int numEvents = 0;
+
+   if(pthread_mutex_lock(&gTraceDumpMtx) != 0)
+   {
+      return 0;
+   }
+
+   head = ring->head;
+   __sync_synchronize();
+   if(head - first > TraceRingSize)
+   {
+      first = head - TraceRingSize;
+   }
+
+   for(i=first; i != head; i++)
+   {
+      copy[i & (TraceRingSize - 1)] = ring->event[i & (TraceRingSize - 1)];
+   }
+
+   // events which have been overwritten while copying are dropped
+   __sync_synchronize();
+   if(ring->head - first >= TraceRingSize)
+   {
+      first = ring->head - TraceRingSize + 1;
+   }
+
+   for(i=first; (int32_t)(head - i) > 0; i++)
+   {
+      const PclTraceEvent_s* event = &copy[i & (TraceRingSize - 1)];
+
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("trace - tid:"), DLT_INT(ring->tid),
+                                            DLT_STRING(event->api < PclTrace_LastEntry ? gTraceApiName[event->api] : "unknown"),
+                                            DLT_STRING("ldbid:"), DLT_UINT(event->ldbid),
+                                            DLT_STRING("handle:"), DLT_INT(event->handle),
+                                            DLT_STRING("result:"), DLT_INT(event->result),
+                                            DLT_STRING("us:"), DLT_UINT(event->duration),
+                                            DLT_STRING("at:"), DLT_UINT64(event->timestamp));
+      numEvents++;
+   }
+
+   pthread_mutex_unlock(&gTraceDumpMtx);
+
+   return numEvents;
+}
+
+
+
+void pers_trace_event(PclTraceApi_e api, int handle, unsigned int ldbid, int result, unsigned long long start)
+{
+   PclTraceRing_s* ring = trace_ring_get();
+
+   if(ring != NULL)
+   {
+      uint32_t pos = ring->head;
+      unsigned long long duration = (start != 0) ? pers_stat_now() - start : 0;
+      PclTraceEvent_s* event = &ring->event[pos & (TraceRingSize - 1)];
+
+      event->timestamp = start;
+      event->duration  = (duration > UINT32_MAX) ? UINT32_MAX : (uint32_t)duration;
+      event->result    = result;
+      event->handle    = handle;
+      event->ldbid     = ldbid;
+      event->api       = (uint32_t)api;
+
+      __sync_synchronize();      // publish the event before the head
+      ring->head = pos + 1;
+
+      if(result < 0 && (gPclTraceMode & PCL_TRACE_DUMP_ERROR) != 0)
+      {
+         (void)trace_ring_dump(ring, ring->dumped);
+         ring->dumped = ring->head;
+      }
+   }
+}
+
+
+
+int pers_trace_set_mode(int mode)
+{
+   if((mode & ~(PCL_TRACE_DLT | PCL_TRACE_RING | PCL_TRACE_DUMP_ERROR)) != 0)
+   {
+      return -1;
+   }
+
+   gPclTraceMode = mode;
+
+   return 0;
+}
+
+
+
+int pers_trace_dump(void)
+{
+   PclTraceRing_s* ring = NULL;
+   int numEvents = 0;
+
+   for(ring = gTraceRings; ring != NULL; ring = ring->next)
+   {
+      numEvents += trace_ring_dump(ring, 0);
+   }
+
+   return numEvents;
+}
+
+#else
+
+int pers_trace_set_mode(int mode)
+{
+   if((mode & ~PCL_TRACE_DLT) != 0)     // ring buffers are not built
+   {
+      return -1;
+   }
+
+   gPclTraceMode = mode;
+
+   return 0;
+}
+
+
+
+int pers_trace_dump(void)
+{
+   return 0;
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_TRACE_H
+#define PERSISTENCE_CLIENT_LIBRARY_TRACE_H
+
+/******************************************************************************
+ * Project         Persistency
+ * (c) copyright   2014
+ * Company         XS Embedded GmbH
+ *****************************************************************************/
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_trace.h
+ * @ingroup        Persistence client library
+ * @author         Ingo Huerner
+ * @brief          Header of the persistence client library API call tracing.
+ *                 API calls are recorded as fixed size binary events in a ring buffer per thread,
+ *                 which is written without locking and converted to DLT messages only when dumped.
+ *                 The ring buffers are only built if configured with --enable-trace (default).
+ * @see
+ */
+
+#include "persistence_client_library_data_organization.h"
+#include "../include/persistence_client_library.h"
+
+#include <dlt.h>
+
+
+/// traced API calls
+typedef enum _PclTraceApi_e
+{
+   /// pclKeyReadData
+   PclTrace_KeyRead = 0,
+   /// pclKeyWriteData
+   PclTrace_KeyWrite,
+   /// pclKeyDelete
+   PclTrace_KeyDelete,
+   /// pclKeyGetSize
+   PclTrace_KeySize,
+   /// pclFileOpen, pclFileAtomicBegin
+   PclTrace_FileOpen,
+   /// pclFileReadData, pclFileReadAt, pclFileReadV
+   PclTrace_FileRead,
+   /// pclFileWriteData, pclFileWriteAt, pclFileWriteV, pclFileAtomicAppend
+   PclTrace_FileWrite,
+   /// pclFileRemove
+   PclTrace_FileRemove,
+   /// pclFileAtomicCommit
+   PclTrace_FileAtomicCommit,
+   /// pclFileAtomicAbort
+   PclTrace_FileAtomicAbort,
+
+   /// last entry
+   PclTrace_LastEntry
+} PclTraceApi_e;
+
+
+/// the trace mode ::PCL_TRACE_OFF, ::PCL_TRACE_DLT, ::PCL_TRACE_RING, ::PCL_TRACE_DUMP_ERROR
+extern int gPclTraceMode;
+
+
+/// log the call of an API function with log level info to DLT if enabled by the trace mode
+#define PCL_TRACE_LOG(...)                                              \
+   do {                                                                 \
+      if((gPclTraceMode & PCL_TRACE_DLT) != 0)                          \
+      {                                                                 \
+         DLT_LOG(gPclDLTContext, DLT_LOG_INFO, __VA_ARGS__);            \
+      }                                                                 \
+   } while(0)
+
+
+#if USE_TRACE
+
+/**
+ * @brief record an API call in the ring buffer of the calling thread
+ *
+ * @param api the API call
+ * @param handle the key or file handle, -1 if the call has no handle
+ * @param ldbid the logical database id
+ * @param result the result of the call
+ * @param start the start time of the call in microseconds, see ::pers_stat_now
+ */
+void pers_trace_event(PclTraceApi_e api, int handle, unsigned int ldbid, int result, unsigned long long start);
+
+/// record an API call if enabled by the trace mode
+#define PCL_TRACE_EVENT(api, handle, ldbid, result, start)             \
+   do {                                                                 \
+      if((gPclTraceMode & PCL_TRACE_RING) != 0)                         \
+      {                                                                 \
+         pers_trace_event(api, handle, ldbid, result, start);           \
+      }                                                                 \
+   } while(0)
+
+#else
+
+#define PCL_TRACE_EVENT(api, handle, ldbid, result, start)   do { } while(0)
+
+#endif
+
+
+/**
+ * @brief set the trace mode
+ *
+ * @param mode the trace mode, see ::pclSetTraceMode
+ *
+ * @return 0 on success, -1 if the mode is not supported
+ */
+int pers_trace_set_mode(int mode);
+
+
+/**
+ * @brief dump the ring buffers of all threads to DLT
+ *
+ * @return the number of events dumped
+ */
+int pers_trace_dump(void);
+
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_TRACE_H */
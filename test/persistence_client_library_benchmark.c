@@ -19,10 +19,12 @@
 #include "../include/persistence_client_library_key.h"
 #include "../include/persistence_client_library_file.h"
 #include "../include/persistence_client_library_error_def.h"
+#include "../include/persistence_client_library.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>     /* atoi */
+#include <unistd.h>     /* usleep */
 
 #include <dlt.h>
 #include <dlt_common.h>
@@ -53,6 +55,19 @@ double gAverageBytesWriteSecond = 0, gAverageTimeWriteSecond = 0;
 double gDurationRead = 0, gSizeRead = 0;
 double gDurationReadSecond = 0, gSizeReadSecond = 0;
 double gDurationInit = 0, gDurationDeinit = 0;
+double gDurationInitAsync = 0, gDurationInitReady = 0;
+double gDurationSync[3] = {0}, gSizeKbSync = 0;
+double gDurationReadAlone = 0, gDurationReadParallel = 0;
+double gDurationShutdown = 0;
+int gShutdownNumFiles = 0, gShutdownNumKeys = 0;
+pclShutdownTiming_s gShutdownTiming;
+double gBackendWrite[2] = {0}, gBackendRead[2] = {0};
+double gBackendOpenClean[2] = {0}, gBackendOpenRecover = 0;
+double gWtWritesPerSec[2][2] = {{0}};
+static const int gWtThreads[2] = {1, 4};
+static volatile int gStopWriter = 0;
+double gTraceRead[3] = {0};
+static const int gTraceModes[3] = {PCL_TRACE_OFF, PCL_TRACE_DLT, PCL_TRACE_RING};
 
 
 inline long long getNsDuration(struct timespec* start, struct timespec* end)
@@ -73,6 +88,7 @@ void init_benchmark(int numLoops)
    int i = 0;
    long long durationInit = 0;
    long long durationDeInit = 0;
+   long long durationReady = 0;
    struct timespec initStart, initEnd;
    struct timespec deInitStart, deInitEnd;
    int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
@@ -94,6 +110,28 @@ void init_benchmark(int numLoops)
 
    gDurationInit = (double)durationInit/(double)numLoops/(double)NANO2MIL;
    gDurationDeinit = (double)durationDeInit/(double)numLoops/(double)NANO2MIL;
+
+   // init with IPC registrations in the background
+   durationInit = 0;
+   for(i=0; i<numLoops; i++)
+   {
+      clock_gettime(CLOCK_ID, &initStart);
+      (void)pclInitLibraryAsync(gAppName , shutdownReg, NULL);
+      clock_gettime(CLOCK_ID, &initEnd);
+      durationInit += getNsDuration(&initStart, &initEnd);
+
+      while(pclGetInitState() == PCL_INIT_STATE_PENDING)
+      {
+         usleep(100);
+      }
+      clock_gettime(CLOCK_ID, &initEnd);
+      durationReady += getNsDuration(&initStart, &initEnd);
+
+      (void)pclDeinitLibrary();
+   }
+
+   gDurationInitAsync = (double)durationInit/(double)numLoops/(double)NANO2MIL;
+   gDurationInitReady = (double)durationReady/(double)numLoops/(double)NANO2MIL;
 }
 
 
@@ -256,6 +294,369 @@ void write_benchmark(int numLoops)
 
 
 
+void sync_benchmark(int numLoops)
+{
+   int i = 0, fd = 0, policy = 0;
+   long long duration = 0;
+   struct timespec writeStart, writeEnd;
+   const char* chunk = "Pack my box with five dozen liquor jugs. - Jackdaws love my big sphinx of quartz. - "
+                       "The five boxing wizards jump quickly. ------";  // 128 bytes
+   int shutdownReg = PCL_SHUTDOWN_TYPE_NONE;
+
+   (void)pclInitLibrary(gAppName , shutdownReg);
+
+   for(policy = PCL_FILE_SYNC_PER_WRITE; policy <= PCL_FILE_SYNC_INTERVAL; policy++)
+   {
+      (void)pclFileRemove(PCL_LDBID_LOCAL, "nonRCT/benchmarkSync.db", 1, 1);
+
+      clock_gettime(CLOCK_ID, &writeStart);
+
+      fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/benchmarkSync.db", 1, 1);
+      (void)pclFileSetSyncPolicy(fd, policy, 50);
+
+      // write the file in many small chunks, the close commits the remaining data
+      for(i=0; i<numLoops; i++)
+      {
+         (void)pclFileWriteData(fd, chunk, (int)strlen(chunk));
+      }
+      (void)pclFileClose(fd);
+
+      clock_gettime(CLOCK_ID, &writeEnd);
+
+      duration = getNsDuration(&writeStart, &writeEnd);
+      gDurationSync[policy] = (double)duration/(double)NANO2MIL;
+   }
+   (void)pclFileRemove(PCL_LDBID_LOCAL, "nonRCT/benchmarkSync.db", 1, 1);
+
+   gSizeKbSync = (double)numLoops * (double)strlen(chunk) / (double)1024;
+
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+}
+
+
+
+static void* large_file_writer(void* dataPtr)
+{
+   int fd = 0;
+   static char buffer[64*1024] = {0};   // 64kB
+
+   (void)dataPtr;
+
+   memset(buffer, 'w', sizeof(buffer));
+
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/benchmarkLarge.db", 1, 1);
+
+   // write and sync large chunks until the reader has finished
+   while(gStopWriter == 0)
+   {
+      (void)pclFileSeek(fd, 0, SEEK_SET);
+      (void)pclFileWriteData(fd, buffer, (int)sizeof(buffer));
+   }
+   (void)pclFileClose(fd);
+
+   return NULL;
+}
+
+
+
+static long long small_file_read(int numLoops)
+{
+   int i = 0, fd = 0;
+   long long duration = 0;
+   struct timespec readStart, readEnd;
+   char buffer[1024] = {0};
+
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/benchmarkSmall.db", 1, 1);
+
+   for(i=0; i<numLoops; i++)
+   {
+      clock_gettime(CLOCK_ID, &readStart);
+      (void)pclFileSeek(fd, 0, SEEK_SET);
+      (void)pclFileReadData(fd, buffer, (int)sizeof(buffer));
+      clock_gettime(CLOCK_ID, &readEnd);
+
+      duration += getNsDuration(&readStart, &readEnd);
+   }
+   (void)pclFileClose(fd);
+
+   return duration;
+}
+
+
+
+void parallel_benchmark(int numLoops)
+{
+   int fd = 0;
+   pthread_t writer;
+   char buffer[1024] = {0};
+   int shutdownReg = PCL_SHUTDOWN_TYPE_NONE;
+
+   (void)pclInitLibrary(gAppName , shutdownReg);
+
+   memset(buffer, 'r', sizeof(buffer));
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/benchmarkSmall.db", 1, 1);
+   (void)pclFileWriteData(fd, buffer, (int)sizeof(buffer));
+   (void)pclFileClose(fd);
+
+   // read the small file without any other file access
+   gDurationReadAlone = (double)small_file_read(numLoops)/(double)numLoops;
+
+   // read the small file while another thread writes and syncs a large file
+   gStopWriter = 0;
+   if(pthread_create(&writer, NULL, large_file_writer, NULL) == 0)
+   {
+      gDurationReadParallel = (double)small_file_read(numLoops)/(double)numLoops;
+
+      gStopWriter = 1;
+      pthread_join(writer, NULL);
+   }
+
+   (void)pclFileRemove(PCL_LDBID_LOCAL, "nonRCT/benchmarkSmall.db", 1, 1);
+   (void)pclFileRemove(PCL_LDBID_LOCAL, "nonRCT/benchmarkLarge.db", 1, 1);
+
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+}
+
+
+
+void shutdown_benchmark(int numFiles, int numKeys)
+{
+   int i = 0;
+   int* fd = NULL;
+   long long duration = 0;
+   struct timespec shutdownStart, shutdownEnd;
+   char resource[128] = {0};
+   int shutdownReg = PCL_SHUTDOWN_TYPE_NONE;
+
+   (void)pclInitLibrary(gAppName , shutdownReg);
+
+   fd = malloc((size_t)numFiles * sizeof(int));
+   if(fd != NULL)
+   {
+      // open files and write data, so all files need to be flushed on shutdown
+      for(i=0; i<numFiles; i++)
+      {
+         snprintf(resource, 128, "nonRCT/benchmarkShutdown%d.db", i);
+         fd[i] = pclFileOpen(PCL_LDBID_LOCAL, resource, 1, 1);
+         (void)pclFileWriteData(fd[i], gWriteBuffer, (int)strlen(gWriteBuffer));
+      }
+
+      // write keys to the local databases
+      for(i=0; i<numKeys; i++)
+      {
+         snprintf(resource, 128, "pos/last_position_s_bench%d", i);
+         (void)pclKeyWriteData(PCL_LDBID_LOCAL, resource, 10, 10, (unsigned char*)gWriteBuffer2, (int)strlen(gWriteBuffer2));
+      }
+
+      // the deinit closes the files and databases and waits for the shutdown to be finished
+      clock_gettime(CLOCK_ID, &shutdownStart);
+      (void)pclDeinitLibrary();
+      clock_gettime(CLOCK_ID, &shutdownEnd);
+
+      duration = getNsDuration(&shutdownStart, &shutdownEnd);
+      gDurationShutdown = (double)duration/(double)NANO2MIL;
+      (void)pclGetShutdownTiming(&gShutdownTiming);
+
+      // remove the files
+      (void)pclInitLibrary(gAppName , shutdownReg);
+      for(i=0; i<numFiles; i++)
+      {
+         snprintf(resource, 128, "nonRCT/benchmarkShutdown%d.db", i);
+         (void)pclFileRemove(PCL_LDBID_LOCAL, resource, 1, 1);
+      }
+      free(fd);
+   }
+
+   gShutdownNumFiles = numFiles;
+   gShutdownNumKeys  = numKeys;
+
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+}
+
+
+
+static double backend_first_read(int backend)
+{
+   long long duration = 0;
+   struct timespec start, end;
+   unsigned char buffer[64] = {0};
+   int shutdownReg = PCL_SHUTDOWN_TYPE_NONE;
+
+   // the database is opened on the first access after the init
+   clock_gettime(CLOCK_ID, &start);
+   (void)pclInitLibrary(gAppName , shutdownReg);
+   (void)pclSetDatabaseBackend(PCL_LDBID_LOCAL, backend);
+   (void)pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position_b_bench0", 20, 20, buffer, (int)sizeof(buffer));
+   clock_gettime(CLOCK_ID, &end);
+
+   duration = getNsDuration(&start, &end);
+
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+
+   return (double)duration/(double)NANO2MIL;
+}
+
+
+
+void backend_benchmark(int numLoops)
+{
+   int i = 0, backend = 0;
+   long long duration = 0;
+   struct timespec start, end;
+   char key[128] = { 0 };
+   unsigned char buffer[64] = {0};
+   const char* value = "small value of 32 bytes ......\n";
+   int shutdownReg = PCL_SHUTDOWN_TYPE_NONE;
+
+   for(backend = PCL_DB_BACKEND_DEFAULT; backend <= PCL_DB_BACKEND_LOG; backend++)
+   {
+      (void)pclInitLibrary(gAppName , shutdownReg);
+      (void)pclSetDatabaseBackend(PCL_LDBID_LOCAL, backend);
+
+      // open the database (and import the existing keys into a new log) before measuring
+      (void)pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position_b_bench0", 20, 20, buffer, (int)sizeof(buffer));
+
+      duration = 0;
+      for(i=0; i <numLoops; i++)
+      {
+         snprintf(key, 128, "pos/last_position_b_bench%d", i);
+
+         clock_gettime(CLOCK_ID, &start);
+         (void)pclKeyWriteData(PCL_LDBID_LOCAL, key, 20, 20, (unsigned char*)value, (int)strlen(value));
+         clock_gettime(CLOCK_ID, &end);
+         duration += getNsDuration(&start, &end);
+      }
+      gBackendWrite[backend] = (double)duration/(double)numLoops;
+
+      duration = 0;
+      for(i=0; i <numLoops; i++)
+      {
+         snprintf(key, 128, "pos/last_position_b_bench%d", i);
+
+         clock_gettime(CLOCK_ID, &start);
+         (void)pclKeyReadData(PCL_LDBID_LOCAL, key, 20, 20, buffer, (int)sizeof(buffer));
+         clock_gettime(CLOCK_ID, &end);
+         duration += getNsDuration(&start, &end);
+      }
+      gBackendRead[backend] = (double)duration/(double)numLoops;
+
+      pclLifecycleSet(PCL_SHUTDOWN);
+      (void)pclDeinitLibrary();
+
+      gBackendOpenClean[backend] = backend_first_read(backend);
+   }
+
+   // without the index the log is scanned as after an unclean shutdown
+   (void)remove("/Data/mnt-c/lt-persistence_client_library_test/cached.itz.kvl.idx");
+   gBackendOpenRecover = backend_first_read(PCL_DB_BACKEND_LOG);
+
+   // keep using the default backend
+   (void)pclInitLibrary(gAppName , shutdownReg);
+   (void)pclSetDatabaseBackend(PCL_LDBID_LOCAL, PCL_DB_BACKEND_DEFAULT);
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+}
+
+
+
+static void* wt_writer(void* dataPtr)
+{
+   int i = 0;
+   int numLoops = *(int*)dataPtr;
+
+   for(i=0; i<numLoops; i++)
+   {
+      // write through key, returns when the data has been committed to disk
+      (void)pclKeyWriteData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, (unsigned char*)"WT_ /var/opt/bench.pdf", (int)strlen("WT_ /var/opt/bench.pdf"));
+   }
+
+   return NULL;
+}
+
+
+
+void wt_benchmark(int numLoops)
+{
+   int backend = 0, t = 0, i = 0;
+   long long duration = 0;
+   struct timespec start, end;
+   pthread_t threads[4];
+   unsigned char buffer[64] = {0};
+   int shutdownReg = PCL_SHUTDOWN_TYPE_NONE;
+
+   for(backend = PCL_DB_BACKEND_DEFAULT; backend <= PCL_DB_BACKEND_LOG; backend++)
+   {
+      (void)pclInitLibrary(gAppName , shutdownReg);
+      (void)pclSetDatabaseBackend(PCL_LDBID_LOCAL, backend);
+
+      // open the database before measuring
+      (void)pclKeyReadData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, buffer, (int)sizeof(buffer));
+
+      for(t=0; t<2; t++)
+      {
+         int loopsPerThread = numLoops / gWtThreads[t];
+
+         clock_gettime(CLOCK_ID, &start);
+         for(i=0; i<gWtThreads[t]; i++)
+         {
+            (void)pthread_create(&threads[i], NULL, wt_writer, &loopsPerThread);
+         }
+         for(i=0; i<gWtThreads[t]; i++)
+         {
+            (void)pthread_join(threads[i], NULL);
+         }
+         clock_gettime(CLOCK_ID, &end);
+
+         duration = getNsDuration(&start, &end);
+         gWtWritesPerSec[backend][t] = (double)(loopsPerThread * gWtThreads[t]) / ((double)duration/(double)SECONDS2NANO);
+      }
+
+      (void)pclSetDatabaseBackend(PCL_LDBID_LOCAL, PCL_DB_BACKEND_DEFAULT);
+      pclLifecycleSet(PCL_SHUTDOWN);
+      (void)pclDeinitLibrary();
+   }
+}
+
+
+
+void trace_benchmark(int numLoops)
+{
+   int i = 0, mode = 0;
+   long long duration = 0;
+   struct timespec start, end;
+   unsigned char buffer[64] = {0};
+   int shutdownReg = PCL_SHUTDOWN_TYPE_NONE;
+
+   (void)pclInitLibrary(gAppName , shutdownReg);
+
+   (void)pclKeyWriteData(PCL_LDBID_LOCAL, "pos/last_position_t_bench", 20, 20, (unsigned char*)"trace", (int)strlen("trace"));
+
+   for(mode=0; mode<3; mode++)
+   {
+      (void)pclSetTraceMode(gTraceModes[mode]);
+
+      duration = 0;
+      for(i=0; i <numLoops; i++)
+      {
+         clock_gettime(CLOCK_ID, &start);
+         (void)pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position_t_bench", 20, 20, buffer, (int)sizeof(buffer));
+         clock_gettime(CLOCK_ID, &end);
+         duration += getNsDuration(&start, &end);
+      }
+      gTraceRead[mode] = (double)duration/(double)numLoops;
+   }
+
+   (void)pclSetTraceMode(PCL_TRACE_DLT);
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+}
+
+
+
 void printAppManual()
 {
    printf("\n\n==================================================================================\n");
@@ -263,7 +664,7 @@ void printAppManual()
    printf("   ./persistence_client_library_benchmark - run PCL benchmarks");
 
    printf("\nSYNOPSIS\n");
-   printf("   persistence_client_library_benchmark [-l loop] [-irwh]\n");
+   printf("   persistence_client_library_benchmark [-l loop] [-f files] [-irwspdbmth]\n");
 
    printf("\nDESCRIPTION\n");
    printf("   Run persistence client library benchmarks.\n");
@@ -274,6 +675,13 @@ void printAppManual()
    printf("   -i   Run init/deinit benchmarks\n");
    printf("   -r   Run read benchmarks\n");
    printf("   -w   Run write benchmarks\n");
+   printf("   -s   Run file sync policy benchmarks\n");
+   printf("   -p   Run parallel file access benchmarks\n");
+   printf("   -d   Run shutdown benchmarks (-f files open, -l keys written)\n");
+   printf("   -f   number of files open on shutdown (default 64)\n");
+   printf("   -b   Run database backend benchmarks (default and log backend)\n");
+   printf("   -m   Run multithreaded write through benchmarks\n");
+   printf("   -t   Run trace overhead benchmarks (tracing off, DLT, ring buffer)\n");
    printf("   -h   Display this help\n");
    printf("==================================================================================\n");
 }
@@ -282,14 +690,15 @@ void printAppManual()
 
 int main(int argc, char *argv[])
 {
-   int ret = 0;
+   int ret = 0, i = 0;
 
    int numLoops = 1024;          // number of default loops
    long long resolution = 0;
 
    struct timespec clockRes;
 
-   int opt = 0, doInit = 0, doRead = 0, doWrite = 0, printManual = 0;
+   int numFiles = 64;            // number of default files for the shutdown benchmark
+   int opt = 0, doInit = 0, doRead = 0, doWrite = 0, doSync = 0, doParallel = 0, doShutdown = 0, doBackend = 0, doWt = 0, doTrace = 0, printManual = 0;
 
    const char* envVariable = "PERS_CLIENT_LIB_CUSTOM_LOAD";
 
@@ -301,11 +710,17 @@ int main(int argc, char *argv[])
       doInit  = 1;
       doRead  = 1;
       doWrite = 1;
+      doSync  = 1;
+      doParallel = 1;
+      doShutdown = 1;
+      doBackend = 1;
+      doWt = 1;
+      doTrace = 1;
       printManual = 1;
    }
 
 
-   while ((opt = getopt(argc, argv, "l:irwh")) != -1)
+   while ((opt = getopt(argc, argv, "l:f:irwspdbmth")) != -1)
    {
       switch (opt)
       {
@@ -321,6 +736,27 @@ int main(int argc, char *argv[])
          case 'w':
             doWrite = 1;
             break;
+         case 's':
+            doSync = 1;
+            break;
+         case 'p':
+            doParallel = 1;
+            break;
+         case 'd':
+            doShutdown = 1;
+            break;
+         case 'f':
+            numFiles = atoi(optarg);
+            break;
+         case 'b':
+            doBackend = 1;
+            break;
+         case 'm':
+            doWt = 1;
+            break;
+         case 't':
+            doTrace = 1;
+            break;
          case 'h':
             printManual = 1;
          break;
@@ -346,6 +782,24 @@ int main(int argc, char *argv[])
    if(doWrite == 1)
       write_benchmark(numLoops);
 
+   if(doSync == 1)
+      sync_benchmark(numLoops);
+
+   if(doParallel == 1)
+      parallel_benchmark(numLoops);
+
+   if(doShutdown == 1)
+      shutdown_benchmark(numFiles, numLoops);
+
+   if(doBackend == 1)
+      backend_benchmark(numLoops);
+
+   if(doWt == 1)
+      wt_benchmark(numLoops);
+
+   if(doTrace == 1)
+      trace_benchmark(numLoops);
+
 
    if(printManual == 1)
    {
@@ -360,6 +814,7 @@ int main(int argc, char *argv[])
       printf("Init benchmark\n");
       printf("  Init      => %.2f ms \n", gDurationInit);
       printf("  Deinit    => %.2f ms \n", gDurationDeinit);
+      printf("  Init async => %.2f ms until local data access, %.2f ms until ready\n", gDurationInitAsync, gDurationInitReady);
    }
    else
    {
@@ -400,6 +855,120 @@ int main(int argc, char *argv[])
       printf("Write benchmark - not activated.\n");
    }
    printf("==================================================================================\n");
+   if(doSync == 1)
+   {
+      printf("File sync policy benchmark\n");
+      printf("  Per write => %.3f ms for \t [%.2f Kilobytes] => %.2f KB/s\n", gDurationSync[PCL_FILE_SYNC_PER_WRITE], gSizeKbSync, gSizeKbSync/gDurationSync[PCL_FILE_SYNC_PER_WRITE]*MIL2SEC);
+      printf("  On close  => %.3f ms for \t [%.2f Kilobytes] => %.2f KB/s\n", gDurationSync[PCL_FILE_SYNC_ON_CLOSE],  gSizeKbSync, gSizeKbSync/gDurationSync[PCL_FILE_SYNC_ON_CLOSE]*MIL2SEC);
+      printf("  Interval  => %.3f ms for \t [%.2f Kilobytes] => %.2f KB/s\n", gDurationSync[PCL_FILE_SYNC_INTERVAL],  gSizeKbSync, gSizeKbSync/gDurationSync[PCL_FILE_SYNC_INTERVAL]*MIL2SEC);
+
+      printf("Explanation:\n");
+      printf("  The file is written in chunks of 128 bytes, measured from open to close.\n");
+      printf("  Per write commits each chunk to the memory device, on close only once,\n");
+      printf("  interval (50 ms) at most once per interval and on close.\n");
+   }
+   else
+   {
+      printf("File sync policy benchmark - not activated.\n");
+   }
+   printf("==================================================================================\n");
+   if(doParallel == 1)
+   {
+      printf("Parallel file access benchmark\n");
+      printf("  Read alone    => %.0f ns for \t [1 Kilobyte item]\n", gDurationReadAlone);
+      printf("  Read parallel => %.0f ns for \t [1 Kilobyte item]\n", gDurationReadParallel);
+
+      printf("Explanation:\n");
+      printf("  A small file is read alone and while another thread writes and syncs\n");
+      printf("  a large file. Access to independent files is not serialized, the read\n");
+      printf("  does not wait for the write of the other thread.\n");
+   }
+   else
+   {
+      printf("Parallel file access benchmark - not activated.\n");
+   }
+   printf("==================================================================================\n");
+   if(doShutdown == 1)
+   {
+      printf("Shutdown benchmark\n");
+      printf("  Shutdown  => %.3f ms for \t [%d files, %d keys]\n", gDurationShutdown, gShutdownNumFiles, gShutdownNumKeys);
+      printf("  Files     => %.3f ms for \t [%u files]\n", (double)gShutdownTiming.fileFlush/(double)MIL2SEC, gShutdownTiming.numFiles);
+      printf("  RCT       => %.3f ms\n", (double)gShutdownTiming.rctClose/(double)MIL2SEC);
+      printf("  Databases => %.3f ms for \t [%u databases]\n", (double)gShutdownTiming.dbClose/(double)MIL2SEC, gShutdownTiming.numDatabases);
+      printf("  Plugins   => %.3f ms\n", (double)gShutdownTiming.pluginDeinit/(double)MIL2SEC);
+      printf("  Syncfs    => %.3f ms\n", (double)gShutdownTiming.syncfs/(double)MIL2SEC);
+      for(i=0; i<PCL_SHUTDOWN_TIMING_SLOWEST && gShutdownTiming.slowestFiles[i].path[0] != '\0'; i++)
+      {
+         printf("  Slowest file     => %.3f ms \t [%s]\n", (double)gShutdownTiming.slowestFiles[i].duration/(double)MIL2SEC, gShutdownTiming.slowestFiles[i].path);
+      }
+      for(i=0; i<PCL_SHUTDOWN_TIMING_SLOWEST && gShutdownTiming.slowestDatabases[i].path[0] != '\0'; i++)
+      {
+         printf("  Slowest database => %.3f ms \t [%s]\n", (double)gShutdownTiming.slowestDatabases[i].duration/(double)MIL2SEC, gShutdownTiming.slowestDatabases[i].path);
+      }
+
+      printf("Explanation:\n");
+      printf("  Files are opened and written, keys are written to the local databases.\n");
+      printf("  The shutdown is measured from calling the deinit until it has returned,\n");
+      printf("  the phases are reported by the library itself.\n");
+   }
+   else
+   {
+      printf("Shutdown benchmark - not activated.\n");
+   }
+   printf("==================================================================================\n");
+   if(doBackend == 1)
+   {
+      printf("Database backend benchmark\n");
+      printf("  Write default => %.0f ns \t Write log => %.0f ns \t [32 bytes item]\n", gBackendWrite[PCL_DB_BACKEND_DEFAULT], gBackendWrite[PCL_DB_BACKEND_LOG]);
+      printf("  Read default  => %.0f ns \t Read log  => %.0f ns \t [32 bytes item]\n", gBackendRead[PCL_DB_BACKEND_DEFAULT], gBackendRead[PCL_DB_BACKEND_LOG]);
+      printf("  Open default  => %.3f ms \t Open log  => %.3f ms \t [clean shutdown]\n", gBackendOpenClean[PCL_DB_BACKEND_DEFAULT], gBackendOpenClean[PCL_DB_BACKEND_LOG]);
+      printf("  Open log      => %.3f ms \t\t\t\t [index rebuilt]\n", gBackendOpenRecover);
+
+      printf("Explanation:\n");
+      printf("  Small values are written and read with the default database backend\n");
+      printf("  and with the log backend. The open is measured from the init until the\n");
+      printf("  first key has been read, the log backend rebuilds its index by scanning\n");
+      printf("  the log if the index is missing or has not been closed cleanly.\n");
+   }
+   else
+   {
+      printf("Database backend benchmark - not activated.\n");
+   }
+   printf("==================================================================================\n");
+   if(doWt == 1)
+   {
+      printf("Multithreaded write through benchmark\n");
+      printf("  Default => %.0f writes/s with %d thread \t %.0f writes/s with %d threads\n",
+             gWtWritesPerSec[PCL_DB_BACKEND_DEFAULT][0], gWtThreads[0], gWtWritesPerSec[PCL_DB_BACKEND_DEFAULT][1], gWtThreads[1]);
+      printf("  Log     => %.0f writes/s with %d thread \t %.0f writes/s with %d threads\n",
+             gWtWritesPerSec[PCL_DB_BACKEND_LOG][0], gWtThreads[0], gWtWritesPerSec[PCL_DB_BACKEND_LOG][1], gWtThreads[1]);
+
+      printf("Explanation:\n");
+      printf("  A write through key is written by one and by several threads, each write\n");
+      printf("  returns when the data has been committed to disk. With the log backend\n");
+      printf("  writers arriving while a commit is running share the next commit.\n");
+   }
+   else
+   {
+      printf("Multithreaded write through benchmark - not activated.\n");
+   }
+   printf("==================================================================================\n");
+   if(doTrace == 1)
+   {
+      printf("Trace benchmark\n");
+      printf("  Off     => %.0f ns per key read\n", gTraceRead[0]);
+      printf("  DLT     => %.0f ns per key read\n", gTraceRead[1]);
+      printf("  Ring    => %.0f ns per key read\n", gTraceRead[2]);
+
+      printf("Explanation:\n");
+      printf("  A cached key is read with tracing switched off, with each call logged to DLT\n");
+      printf("  and with each call recorded as binary event in the ring buffer of the thread.\n");
+   }
+   else
+   {
+      printf("Trace benchmark - not activated.\n");
+   }
+   printf("==================================================================================\n");
 
    // unregister debug log and trace
    DLT_UNREGISTER_APP();
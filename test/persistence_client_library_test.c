@@ -666,6 +666,142 @@ END_TEST
 
 
 
+START_TEST(test_PluginGeneration)
+{
+   int ret = 0, rctFd = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+   const char* rctPath = "/Data/mnt-wt/lt-persistence_client_library_test/resource-table-cfg.itz";
+   const char* expected = "Custom plugin -> plugin_get_data: custom3!";
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_PluginGeneration"));
+
+   // resolve the plugin of the resource, the result is cached until the table changes
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "custom3", 0, 0, buffer, READ_SIZE);
+   fail_unless(ret == (int)strlen(expected), "Failed to read custom data => ret: %d", ret);
+   fail_unless(strncmp((char*)buffer, expected, strlen(expected)) == 0, "Buffer CUSTOM 3 not correctly read");
+
+   // signal an updated table, the reload changes the generation of the table
+   rctFd = open(rctPath, O_RDWR);
+   fail_unless(rctFd != -1, "Could not open RCT ==> %s", rctPath);
+   close(rctFd);
+   usleep(200000);
+
+   // the cached plugin of the old generation must be resolved again
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "custom3", 0, 0, buffer, READ_SIZE);
+   fail_unless(ret == (int)strlen(expected), "Failed to read custom data after RCT reload => ret: %d", ret);
+   fail_unless(strncmp((char*)buffer, expected, strlen(expected)) == 0, "Buffer CUSTOM 3 not correctly read after RCT reload");
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "custom3", 0, 0, (unsigned char*)"This is a message to write", READ_SIZE);
+   fail_unless(ret == 321456, "Failed to write custom data after RCT reload");  // plugin should return 321456
+
+   ret = pclKeyGetSize(PCL_LDBID_LOCAL, "custom3", 0, 0);
+   fail_unless(ret == 44332211, "Failed query custom data size after RCT reload"); // plugin should return 44332211
+
+   // closing the table on deinit changes the generation too, the plugins are loaded again
+   (void)pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL);
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "custom3", 0, 0, buffer, READ_SIZE);
+   fail_unless(ret == (int)strlen(expected), "Failed to read custom data after reinit => ret: %d", ret);
+   fail_unless(strncmp((char*)buffer, expected, strlen(expected)) == 0, "Buffer CUSTOM 3 not correctly read after reinit");
+
+   ret = pclKeyDelete(PCL_LDBID_LOCAL, "custom3", 0, 0);
+   fail_unless(ret == 13579, "Failed to delete custom data after reinit"); // plugin should return 13579
+}
+END_TEST
+
+
+
+START_TEST(test_PluginBatch)
+{
+   int ret = 0;
+   unsigned char buffer[4][READ_SIZE];
+   pclKeyBatchItem_s items[4];
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_PluginBatch"));
+
+   memset(buffer, 0, sizeof(buffer));
+   memset(items, 0, sizeof(items));
+
+   // keys of custom storage plugins are read with one call per plugin, other keys one by one
+   items[0].ldbid = PCL_LDBID_LOCAL; items[0].resource_id = "secured";
+   items[1].ldbid = PCL_LDBID_LOCAL; items[1].resource_id = "custom3";
+   items[2].ldbid = PCL_LDBID_LOCAL; items[2].resource_id = "statusHandle/default01"; items[2].user_no = 3; items[2].seat_no = 2;
+   items[3].ldbid = PCL_LDBID_LOCAL; items[3].resource_id = "custom2";
+   for(ret=0; ret<4; ret++)
+   {
+      items[ret].buffer = buffer[ret];
+      items[ret].buffer_size = READ_SIZE;
+   }
+
+   ret = pclKeyReadDataBatch(items, 4);
+   fail_unless(ret == 4, "Failed to read batch");
+   fail_unless(strncmp((char*)buffer[0], "Custom plugin -> plugin_get_data_batch: secure!", READ_SIZE) == 0, "Buffer SECURE not correctly read by batch");
+   fail_unless(items[1].result == strlen("Custom plugin -> plugin_get_data_batch: custom3!"));
+   fail_unless(strncmp((char*)buffer[1], "Custom plugin -> plugin_get_data_batch: custom3!", READ_SIZE) == 0, "Buffer CUSTOM 3 not correctly read by batch");
+   fail_unless(items[2].result == strlen("DEFAULT_01!"));
+   fail_unless(strncmp((char*)buffer[2], "DEFAULT_01!", strlen("DEFAULT_01!")) == 0, "Buffer default01 not correctly read by batch");
+   fail_unless(strncmp((char*)buffer[3], "Custom plugin -> plugin_get_data_batch: custom2!", READ_SIZE) == 0, "Buffer CUSTOM 2 not correctly read by batch");
+
+   // write a custom storage key and a local key
+   memset(items, 0, sizeof(items));
+   items[0].ldbid = PCL_LDBID_LOCAL; items[0].resource_id = "custom3";
+   items[0].buffer = (unsigned char*)"This is a message to write"; items[0].buffer_size = (int)strlen("This is a message to write");
+   items[1].ldbid = PCL_LDBID_LOCAL; items[1].resource_id = "70"; items[1].user_no = 1; items[1].seat_no = 2;
+   items[1].buffer = (unsigned char*)"Batch write"; items[1].buffer_size = (int)strlen("Batch write");
+
+   ret = pclKeyWriteDataBatch(items, 2);
+   fail_unless(ret == 2, "Failed to write batch");
+   fail_unless(items[0].result == 654321, "Failed to write custom data by batch");  // plugin should return 654321
+   fail_unless(items[1].result == strlen("Batch write"), "Failed to write local data by batch");
+
+   memset(buffer, 0, sizeof(buffer));
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "70", 1, 2, buffer[0], READ_SIZE);
+   fail_unless(ret == strlen("Batch write"));
+   fail_unless(strncmp((char*)buffer[0], "Batch write", strlen("Batch write")) == 0, "Buffer not correctly written by batch");
+
+   ret = pclKeyReadDataBatch(NULL, 1);
+   fail_unless(ret == EPERS_COMMON, "Batch without items not rejected");
+}
+END_TEST
+
+
+
+START_TEST(test_PluginHandle)
+{
+   int ret = 0, handle = 0;
+   unsigned char buffer[READ_SIZE]  = {0};
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_PluginHandle"));
+
+   handle = pclKeyHandleOpen(PCL_LDBID_LOCAL, "custom3", 0, 0);
+   fail_unless(handle >= 0, "Failed to open handle custom3");
+
+   // key handles on custom storage access the plugin through a plugin handle
+   ret = pclKeyHandleReadData(handle, buffer, READ_SIZE);
+   fail_unless(ret == strlen("Custom plugin -> plugin_get_data_handle: custom3!"));
+   fail_unless(strncmp((char*)buffer,"Custom plugin -> plugin_get_data_handle: custom3!",
+               strlen((char*)buffer)) == 0, "Buffer CUSTOM 3 not correctly read by handle");
+
+   ret = pclKeyHandleWriteData(handle, (unsigned char*)"This is a message to write", READ_SIZE);
+   fail_unless(ret == 123654, "Failed to write custom data by handle");   // plugin should return 123654
+
+   ret = pclKeyHandleGetSize(handle);
+   fail_unless(ret == 11223344, "Failed query custom data size by handle"); // plugin should return 11223344
+
+   ret = pclKeyHandleClose(handle);
+   fail_unless(ret != -1, "Failed to close handle!!");
+
+   // access by resource id is not affected
+   ret = pclKeyGetSize(PCL_LDBID_LOCAL, "custom3",   0, 0);
+   fail_unless(ret == 44332211, "Failed query custom data size"); // plugin should return 44332211
+}
+END_TEST
+
+
+
 
 
 START_TEST(test_ReadDefault)
@@ -1762,6 +1898,388 @@ END_TEST
 
 
 
+START_TEST(test_DatabaseLimits)
+{
+   int ret = 0, i = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_DatabaseLimits"));
+
+   // keep only one database open, each access to another database closes the previous one
+   ret = pclSetDatabaseLimits(0, 1);
+   fail_unless(ret >= 0, "Failed to set database limits => ret: %d", ret);
+
+   for(i=0; i<2; i++)
+   {
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position",    1, 1, buffer, READ_SIZE);
+      ck_assert_str_eq( (char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+      ck_assert_int_eq( ret,  (int)strlen("CACHE_ +48 10' 38.95, +8 44' 39.06") );
+      memset(buffer, 0, READ_SIZE);
+
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, buffer, READ_SIZE);
+      ck_assert_str_eq( (char*)buffer, "WT_ /var/opt/user_manual_climateControl.pdf");
+      ck_assert_int_eq(ret, (int)strlen("WT_ /var/opt/user_manual_climateControl.pdf"));
+      memset(buffer, 0, READ_SIZE);
+
+      ret = pclKeyReadData(0x20, "address/home_address",            4, 0, buffer, READ_SIZE);
+      ck_assert_str_eq( (char*)buffer, "WT_ 55327 Heimatstadt, Wohnstrasse 31");
+      ck_assert_int_eq(ret, (int)strlen("WT_ 55327 Heimatstadt, Wohnstrasse 31"));
+      memset(buffer, 0, READ_SIZE);
+   }
+
+   // close databases not used for 1ms
+   ret = pclSetDatabaseLimits(1, 0);
+   fail_unless(ret >= 0, "Failed to set database limits => ret: %d", ret);
+   usleep(5000);
+
+   ret = pclKeyReadData(0x20, "links/last_link",                    2, 0, buffer, READ_SIZE);
+   ck_assert_str_eq( (char*)buffer, "CACHE_ /last_exit/queens");
+   ck_assert_int_eq(ret, (int)strlen("CACHE_ /last_exit/queens"));
+   memset(buffer, 0, READ_SIZE);
+
+   usleep(5000);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position",       1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq( (char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+   ck_assert_int_eq( ret,  (int)strlen("CACHE_ +48 10' 38.95, +8 44' 39.06") );
+
+   ret = pclSetDatabaseLimits(0, 0);
+   fail_unless(ret >= 0, "Failed to reset database limits => ret: %d", ret);
+}
+END_TEST
+
+
+
+START_TEST(test_DatabaseBackend)
+{
+   int ret = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+   const char* origData = "CACHE_ +48 10' 38.95, +8 44' 39.06";
+   const char* newData  = "LOG_ +48 10' 38.95, +8 44' 39.06";
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_DatabaseBackend"));
+
+   ret = pclSetDatabaseBackend(PCL_LDBID_LOCAL, 5);
+   ck_assert_int_eq(ret, EPERS_COMMON);
+
+   ret = pclSetDatabaseBackend(PCL_LDBID_LOCAL, PCL_DB_BACKEND_LOG);
+   fail_unless(ret >= 0, "Failed to set database backend => ret: %d", ret);
+
+   // the keys of the existing database are imported into the log
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq( (char*)buffer, origData);
+   ck_assert_int_eq(ret, (int)strlen(origData));
+   memset(buffer, 0, READ_SIZE);
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, (unsigned char*)newData, (int)strlen(newData));
+   ck_assert_int_eq(ret, (int)strlen(newData));
+
+   ret = pclKeyGetSize(PCL_LDBID_LOCAL, "pos/last_position", 1, 1);
+   ck_assert_int_eq(ret, (int)strlen(newData));
+
+   // the data is read from the log after the database has been closed
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq( (char*)buffer, newData);
+   ck_assert_int_eq(ret, (int)strlen(newData));
+   memset(buffer, 0, READ_SIZE);
+
+   // the index is rebuilt from the log if it is missing
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+   (void)remove("/Data/mnt-c/lt-persistence_client_library_test/cached.itz.kvl.idx");
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq( (char*)buffer, newData);
+   ck_assert_int_eq(ret, (int)strlen(newData));
+
+   ret = pclSetDatabaseBackend(PCL_LDBID_LOCAL, PCL_DB_BACKEND_DEFAULT);
+   fail_unless(ret >= 0, "Failed to reset database backend => ret: %d", ret);
+
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+   (void)remove("/Data/mnt-c/lt-persistence_client_library_test/cached.itz.kvl");
+   (void)remove("/Data/mnt-c/lt-persistence_client_library_test/cached.itz.kvl.idx");
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+}
+END_TEST
+
+
+
+START_TEST(test_DatabaseCompaction)
+{
+   int ret = 0, i = 0, round = 0;
+   char key[32] = {0};
+   char data[READ_SIZE] = {0};
+   unsigned char buffer[READ_SIZE] = {0};
+   struct stat buf;
+   off_t logSize = 0;
+   const char* logPath = "/Data/mnt-c/lt-persistence_client_library_test/cached.itz.kvl";
+   const char* tmpPath = "/Data/mnt-c/lt-persistence_client_library_test/cached.itz.kvl.compact";
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_DatabaseCompaction"));
+
+   ret = pclSetDatabaseBackend(PCL_LDBID_LOCAL, PCL_DB_BACKEND_LOG);
+   fail_unless(ret >= 0, "Failed to set database backend => ret: %d", ret);
+
+   // rewrite the keys until most of the log is dead
+   for(round=0; round<8; round++)
+   {
+      for(i=0; i<16; i++)
+      {
+         snprintf(key, sizeof(key), "compact/key_%02d", i);
+         memset(data, 'a' + round, sizeof(data));
+         snprintf(data, sizeof(data), "round %d key %d", round, i);
+         ret = pclKeyWriteData(PCL_LDBID_LOCAL, key, 1, 1, (unsigned char*)data, (int)sizeof(data));
+         ck_assert_int_eq(ret, (int)sizeof(data));
+      }
+   }
+
+   fail_unless(stat(logPath, &buf) == 0, "Log database not available");
+   logSize = buf.st_size;
+
+   // the compaction starts after an idle period
+   for(i=0; i<50 && stat(logPath, &buf) == 0 && buf.st_size >= logSize; i++)
+   {
+      usleep(100000);
+   }
+   fail_unless(buf.st_size < logSize, "Log database not compacted => size: %d", (int)buf.st_size);
+
+   for(i=0; i<16; i++)
+   {
+      snprintf(key, sizeof(key), "compact/key_%02d", i);
+      memset(data, 'a' + 7, sizeof(data));
+      snprintf(data, sizeof(data), "round %d key %d", 7, i);
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, key, 1, 1, buffer, READ_SIZE);
+      ck_assert_int_eq(ret, (int)sizeof(data));
+      fail_unless(memcmp(buffer, data, sizeof(data)) == 0, "Wrong data after compaction => %s", key);
+   }
+
+   // an interrupted compaction leaves the compaction file, the log has not been replaced
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+
+   ret = open(tmpPath, O_CREAT|O_RDWR|O_TRUNC, S_IRUSR | S_IWUSR);
+   fail_unless(ret != -1, "Failed to create compaction file");
+   (void)write(ret, "PKVL interrupted", strlen("PKVL interrupted"));
+   close(ret);
+
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+
+   for(i=0; i<16; i++)
+   {
+      snprintf(key, sizeof(key), "compact/key_%02d", i);
+      memset(data, 'a' + 7, sizeof(data));
+      snprintf(data, sizeof(data), "round %d key %d", 7, i);
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, key, 1, 1, buffer, READ_SIZE);
+      ck_assert_int_eq(ret, (int)sizeof(data));
+      fail_unless(memcmp(buffer, data, sizeof(data)) == 0, "Wrong data after reopen => %s", key);
+   }
+   fail_unless(access(tmpPath, F_OK) == -1, "Compaction file not removed");
+
+   ret = pclSetDatabaseBackend(PCL_LDBID_LOCAL, PCL_DB_BACKEND_DEFAULT);
+   fail_unless(ret >= 0, "Failed to reset database backend => ret: %d", ret);
+
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+   (void)remove(logPath);
+   (void)remove("/Data/mnt-c/lt-persistence_client_library_test/cached.itz.kvl.idx");
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+}
+END_TEST
+
+
+
+#define NUM_COMMIT_THREADS  4
+#define NUM_COMMIT_WRITES   32
+
+void* groupCommitThread(void* userData)
+{
+   int ret = 0, i = 0;
+   int index = *(int*)userData;
+   char data[64] = {0};
+
+   pthread_barrier_wait(&gBarrierTwo);
+
+   for(i=0; i<NUM_COMMIT_WRITES; i++)
+   {
+      // returns when the data has been committed, the writers share the commits
+      snprintf(data, sizeof(data), "WT_ commit thread %d write %d", index, i);
+      ret = pclKeyWriteData(PCL_LDBID_LOCAL, "status/open_document", (unsigned int)index+1, 2, (unsigned char*)data, (int)strlen(data));
+      fail_unless(ret == (int)strlen(data), "Wrong write size => thread %d ret: %d", index, ret);
+   }
+
+   pthread_exit(0);
+}
+
+
+
+START_TEST(test_GroupCommit)
+{
+   int ret = 0, i = 0;
+   int index[NUM_COMMIT_THREADS];
+   pthread_t threads[NUM_COMMIT_THREADS];
+   char data[64] = {0};
+   unsigned char buffer[READ_SIZE] = {0};
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_GroupCommit"));
+
+   ret = pclSetDatabaseBackend(PCL_LDBID_LOCAL, PCL_DB_BACKEND_LOG);
+   fail_unless(ret >= 0, "Failed to set database backend => ret: %d", ret);
+
+   fail_unless(pthread_barrier_init(&gBarrierTwo, NULL, NUM_COMMIT_THREADS) == 0, "Failed to init barrier");
+
+   for(i=0; i<NUM_COMMIT_THREADS; i++)
+   {
+      index[i] = i;
+      fail_unless(pthread_create(&threads[i], NULL, groupCommitThread, &index[i]) == 0, "Failed to create thread %d", i);
+   }
+   for(i=0; i<NUM_COMMIT_THREADS; i++)
+   {
+      pthread_join(threads[i], NULL);
+   }
+   (void)pthread_barrier_destroy(&gBarrierTwo);
+
+   // the last write of each thread must be available after reopen
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+
+   for(i=0; i<NUM_COMMIT_THREADS; i++)
+   {
+      snprintf(data, sizeof(data), "WT_ commit thread %d write %d", i, NUM_COMMIT_WRITES-1);
+      memset(buffer, 0, READ_SIZE);
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, "status/open_document", (unsigned int)i+1, 2, buffer, READ_SIZE);
+      ck_assert_int_eq(ret, (int)strlen(data));
+      fail_unless(strncmp((char*)buffer, data, strlen(data)) == 0, "Wrong data after reopen => thread %d: %s", i, buffer);
+   }
+
+   ret = pclSetDatabaseBackend(PCL_LDBID_LOCAL, PCL_DB_BACKEND_DEFAULT);
+   fail_unless(ret >= 0, "Failed to reset database backend => ret: %d", ret);
+
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+   (void)remove("/Data/mnt-wt/lt-persistence_client_library_test/wt.itz.kvl");
+   (void)remove("/Data/mnt-wt/lt-persistence_client_library_test/wt.itz.kvl.idx");
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+}
+END_TEST
+
+
+
+START_TEST(test_Statistics)
+{
+   int ret = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+   pclStatistics_s stat;
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_Statistics"));
+
+   ret = pclGetStatistics(PCL_LDBID_LOCAL, NULL);
+   ck_assert_int_eq(ret, EPERS_COMMON);
+
+   ret = pclSetStatisticsMode(0x80);
+   ck_assert_int_eq(ret, EPERS_COMMON);
+   ret = pclSetStatisticsMode(PCL_STAT_COUNTERS | PCL_STAT_RESOURCES);
+   fail_unless(ret >= 0, "Failed to set statistics mode => ret: %d", ret);
+
+   ret = pclResetStatistics();
+   fail_unless(ret >= 0, "Failed to reset statistics => ret: %d", ret);
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   fail_unless(ret >= 0, "Failed to read data => ret: %d", ret);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   fail_unless(ret >= 0, "Failed to read data => ret: %d", ret);
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, ret);
+   fail_unless(ret >= 0, "Failed to write data => ret: %d", ret);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/no_valid_key", 1, 1, buffer, READ_SIZE);
+   fail_unless(ret < 0, "Read of invalid key succeeded => ret: %d", ret);
+
+   ret = pclGetStatistics(PCL_LDBID_LOCAL, &stat);
+   fail_unless(ret >= 0, "Failed to get statistics => ret: %d", ret);
+   ck_assert_int_eq((int)stat.keyReads, 3);
+   ck_assert_int_eq((int)stat.keyWrites, 1);
+   ck_assert_int_eq((int)stat.keyBytesRead, 2 * (int)stat.keyBytesWritten);
+   ck_assert_int_eq((int)stat.errors, 1);
+   fail_unless(stat.numTopResources >= 1, "No top resource");
+   ck_assert_str_eq(stat.topResources[0].resource_id, "pos/last_position");
+   ck_assert_int_eq((int)stat.topResources[0].accesses, 3);
+
+   // other logical databases are not counted
+   ret = pclGetStatistics(PCL_LDBID_PUBLIC, &stat);
+   fail_unless(ret >= 0, "Failed to get statistics => ret: %d", ret);
+   ck_assert_int_eq((int)stat.keyReads, 0);
+
+   ret = pclGetStatistics(PCL_STAT_LDBID_ALL, &stat);
+   fail_unless(ret >= 0, "Failed to get statistics => ret: %d", ret);
+   ck_assert_int_eq((int)stat.keyReads, 3);
+
+   ret = pclResetStatistics();
+   fail_unless(ret >= 0, "Failed to reset statistics => ret: %d", ret);
+   ret = pclGetStatistics(PCL_STAT_LDBID_ALL, &stat);
+   ck_assert_int_eq((int)stat.keyReads, 0);
+   ck_assert_int_eq((int)stat.numTopResources, 0);
+
+   // the resources are not tracked by default
+   ret = pclSetStatisticsMode(PCL_STAT_COUNTERS);
+   fail_unless(ret >= 0, "Failed to set statistics mode => ret: %d", ret);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   fail_unless(ret >= 0, "Failed to read data => ret: %d", ret);
+   ret = pclGetStatistics(PCL_STAT_LDBID_ALL, &stat);
+   ck_assert_int_eq((int)stat.keyReads, 1);
+   ck_assert_int_eq((int)stat.numTopResources, 0);
+
+   // nothing is counted if the statistics are off
+   ret = pclSetStatisticsMode(PCL_STAT_OFF);
+   fail_unless(ret >= 0, "Failed to set statistics mode => ret: %d", ret);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   fail_unless(ret >= 0, "Failed to read data => ret: %d", ret);
+   ret = pclGetStatistics(PCL_STAT_LDBID_ALL, &stat);
+   ck_assert_int_eq((int)stat.keyReads, 1);
+
+   ret = pclSetStatisticsMode(PCL_STAT_COUNTERS);
+   fail_unless(ret >= 0, "Failed to set statistics mode => ret: %d", ret);
+   ret = pclResetStatistics();
+   fail_unless(ret >= 0, "Failed to reset statistics => ret: %d", ret);
+}
+END_TEST
+
+
+
+START_TEST(test_TraceMode)
+{
+   int ret = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_TraceMode"));
+
+   ret = pclSetTraceMode(0x10);
+   ck_assert_int_eq(ret, EPERS_COMMON);
+
+   ret = pclSetTraceMode(PCL_TRACE_RING);
+   fail_unless(ret >= 0, "Failed to set trace mode => ret: %d", ret);
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   fail_unless(ret >= 0, "Failed to read data => ret: %d", ret);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   fail_unless(ret >= 0, "Failed to read data => ret: %d", ret);
+
+   ret = pclTraceDump();
+   fail_unless(ret >= 2, "Calls not recorded => ret: %d", ret);
+
+   ret = pclSetTraceMode(PCL_TRACE_OFF);
+   fail_unless(ret >= 0, "Failed to set trace mode => ret: %d", ret);
+
+   ret = pclSetTraceMode(PCL_TRACE_DLT);
+   fail_unless(ret >= 0, "Failed to set trace mode => ret: %d", ret);
+}
+END_TEST
+
+
+
 static Suite* persistenceClientLib_suite_multi()
 {
    const char* testSuiteName = "\n\nPersistence Client Library (Key-API) - Multi";
@@ -1830,8 +2348,14 @@ static Suite * persistenceClientLib_suite()
 
    TCase * tc_Plugin = tcase_create("Plugin");
    tcase_add_test(tc_Plugin, test_Plugin);
+   tcase_add_test(tc_Plugin, test_PluginHandle);
+   tcase_add_test(tc_Plugin, test_PluginBatch);
    tcase_set_timeout(tc_Plugin, 3);
 
+   TCase * tc_PluginGeneration = tcase_create("PluginGeneration");
+   tcase_add_test(tc_PluginGeneration, test_PluginGeneration);
+   tcase_set_timeout(tc_PluginGeneration, 5);
+
    TCase * tc_ReadDefault = tcase_create("ReadDefault");
    tcase_add_test(tc_ReadDefault, test_ReadDefault);
    tcase_set_timeout(tc_ReadDefault, 3);
@@ -1908,6 +2432,26 @@ static Suite * persistenceClientLib_suite()
    tcase_add_test(tc_PclInitPasNotAllowed, test_PclInitPasNotAllowed);
    tcase_set_timeout(tc_PclInitPasNotAllowed, 20);
 
+   TCase * tc_DatabaseLimits = tcase_create("DatabaseLimits");
+   tcase_add_test(tc_DatabaseLimits, test_DatabaseLimits);
+
+   TCase * tc_DatabaseBackend = tcase_create("DatabaseBackend");
+   tcase_add_test(tc_DatabaseBackend, test_DatabaseBackend);
+
+   TCase * tc_DatabaseCompaction = tcase_create("DatabaseCompaction");
+   tcase_add_test(tc_DatabaseCompaction, test_DatabaseCompaction);
+   tcase_set_timeout(tc_DatabaseCompaction, 10);
+
+   TCase * tc_GroupCommit = tcase_create("GroupCommit");
+   tcase_add_test(tc_GroupCommit, test_GroupCommit);
+   tcase_set_timeout(tc_GroupCommit, 10);
+
+   TCase * tc_Statistics = tcase_create("Statistics");
+   tcase_add_test(tc_Statistics, test_Statistics);
+
+   TCase * tc_TraceMode = tcase_create("TraceMode");
+   tcase_add_test(tc_TraceMode, test_TraceMode);
+
 #if 1
    suite_add_tcase(s, tc_NoPluginFunc);
 
@@ -1953,6 +2497,9 @@ static Suite * persistenceClientLib_suite()
    suite_add_tcase(s, tc_Plugin);
    tcase_add_checked_fixture(tc_Plugin, data_setup, data_teardown);
 
+   suite_add_tcase(s, tc_PluginGeneration);
+   tcase_add_checked_fixture(tc_PluginGeneration, data_setup, data_teardown);
+
    suite_add_tcase(s, tc_SharedAccess);
 
    suite_add_tcase(s, tc_VO722);
@@ -1969,6 +2516,24 @@ static Suite * persistenceClientLib_suite()
 
    suite_add_tcase(s, tc_RemoveSem);
 
+   suite_add_tcase(s, tc_DatabaseLimits);
+   tcase_add_checked_fixture(tc_DatabaseLimits, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_DatabaseBackend);
+   tcase_add_checked_fixture(tc_DatabaseBackend, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_DatabaseCompaction);
+   tcase_add_checked_fixture(tc_DatabaseCompaction, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_GroupCommit);
+   tcase_add_checked_fixture(tc_GroupCommit, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_Statistics);
+   tcase_add_checked_fixture(tc_Statistics, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_TraceMode);
+   tcase_add_checked_fixture(tc_TraceMode, data_setup, data_teardown);
+
    suite_add_tcase(s, tc_PclInitPasNotAllowed);    // NOTE: make sure this test is run as the last test
 
 #else
@@ -20,6 +20,7 @@
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>     /* exit */
+#include <stdint.h>
 #include <time.h>
 #include <fcntl.h>
 #include <dlt.h>
@@ -28,6 +29,7 @@
 
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <glob.h>
 
 #include <dbus/dbus.h>
 
@@ -38,6 +40,8 @@
 #include "../include/persistence_client_library.h"
 #include "../include/persistence_client_library_error_def.h"
 
+#include <persComRct.h>
+
 
 #define READ_SIZE       1024
 #define MaxAppNameLen   256
@@ -197,6 +201,12 @@ void setupRecoveryData(const char* originalFileName, const char* origData,
 }
 
 extern int pclCreateFile(const char* path, int chached);
+extern int pclCreateJournal(const char* backupPath, int srcfd);
+extern int pclJournalRange(const char* backupPath, int srcfd, off_t offset, size_t size);
+extern int pclVerifyConsistency(const char* origPath, const char* backupPath, const char* csumPath, int openFlags);
+extern void pclLedgerAdd(const char* backupPath, const struct stat* buf);
+extern int pclLedgerTake(const char* backupPath, const char* origPath);
+extern unsigned int pclCrc32(unsigned int crc, const unsigned char *buf, size_t theSize);
 
 void data_setupBandR(void)
 {
@@ -1466,6 +1476,1069 @@ END_TEST
 
 
 
+/*
+ * Write to a large file protected by a range journal and verify
+ * the original content is restored when the journal is still present on open
+ */
+START_TEST(test_FileJournalRecovery)
+{
+   int fd = -1, i = 0;
+   ssize_t rval = 0;
+   struct stat buf;
+   char origBuffer[READ_SIZE] = {0};
+   char readBuffer[READ_SIZE] = {0};
+   const char* path    = "/Data/mnt-c/lt-persistence_client_library_test/user/200/seat/100/media/journal.db";
+   const char* backup  = "/Data/mnt-backup/lt-persistence_client_library_test/user/200/seat/100/media/journal.db~";
+   const char* csum    = "/Data/mnt-backup/lt-persistence_client_library_test/user/200/seat/100/media/journal.db~.crc";
+   const char* journal = "/Data/mnt-backup/lt-persistence_client_library_test/user/200/seat/100/media/journal.db~.jnl";
+   const off_t origSize = 128 * READ_SIZE;
+
+   memset(origBuffer, 'a', READ_SIZE);
+
+   fd = pclCreateFile(path, 0);
+   fail_unless(fd != -1, "Failed to create file");
+
+   for(i=0; i<128; i++)
+   {
+      rval = write(fd, origBuffer, READ_SIZE);
+      fail_unless(rval == READ_SIZE, "Failed to write original data");
+   }
+
+   fail_unless(pclCreateJournal(backup, fd) == 1, "Failed to create journal");
+   fail_unless(access(journal, F_OK) == 0, "Journal should exist, but does not");
+
+   // overwrite a range inside the file
+   memset(readBuffer, 'b', READ_SIZE);
+   fail_unless(pclJournalRange(backup, fd, 1000, 100) == 100, "Failed to journal range");
+   rval = pwrite(fd, readBuffer, 100, 1000);
+   fail_unless(rval == 100, "Failed to overwrite range");
+
+   // overwrite the same range again, only the oldest content must be restored
+   memset(readBuffer, 'c', READ_SIZE);
+   fail_unless(pclJournalRange(backup, fd, 1000, 100) == 100, "Failed to journal range");
+   rval = pwrite(fd, readBuffer, 100, 1000);
+   fail_unless(rval == 100, "Failed to overwrite range");
+
+   // write beyond the end of the file, only the part inside the original size is journaled
+   fail_unless(pclJournalRange(backup, fd, origSize - 10, 50) == 10, "Failed to journal end of file");
+   rval = pwrite(fd, readBuffer, 50, origSize - 10);
+   fail_unless(rval == 50, "Failed to append data");
+
+   // simulate a crash: close the file without removing the journal
+   close(fd);
+
+   fd = pclVerifyConsistency(path, backup, csum, O_RDWR);
+   fail_unless(fd != -1, "Failed to recover from journal");
+   if(fd > 0)
+      close(fd);
+
+   fail_unless(access(journal, F_OK) != 0, "Journal does exist, but should not");
+
+   memset(&buf, 0, sizeof(buf));
+   fail_unless(stat(path, &buf) == 0, "Failed to stat recovered file");
+   fail_unless(buf.st_size == origSize, "Wrong file size => soll:%d - ist: %d\n", (int)origSize, (int)buf.st_size);
+
+   fd = open(path, O_RDONLY);
+   for(i=0; i<128; i++)
+   {
+      rval = read(fd, readBuffer, READ_SIZE);
+      fail_unless(rval == READ_SIZE, "Failed to read recovered data");
+      fail_unless(memcmp(readBuffer, origBuffer, READ_SIZE) == 0, "Recovered data does not match");
+   }
+   close(fd);
+
+   (void)remove(path);
+}
+END_TEST
+
+
+
+/*
+ * Reject a write to a large file if the original content of the range
+ * can't be saved in the journal, the range would be unprotected on a crash
+ */
+START_TEST(test_FileJournalWriteFail)
+{
+   int fd = -1, ret = 0, i = 0;
+   char origBuffer[READ_SIZE] = {0};
+   char writeBuffer[READ_SIZE] = {0};
+   char readBuffer[READ_SIZE] = {0};
+   const char* journal = "/Data/mnt-backup/lt-persistence_client_library_test/user/1/seat/1/media/journalFail.db~.jnl";
+
+   memset(origBuffer, 'a', READ_SIZE);
+   memset(writeBuffer, 'b', READ_SIZE);
+
+   // create a file large enough to be protected by a range journal
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/journalFail.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> media/journalFail.db");
+   for(i=0; i<128; i++)
+   {
+      ret = pclFileWriteData(fd, origBuffer, READ_SIZE);
+      fail_unless(ret == READ_SIZE, "Failed to write original data => ret: %d", ret);
+   }
+   ret = pclFileClose(fd);
+   fail_unless(ret == 0, "Failed to close file");
+
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/journalFail.db", 1, 1);
+   fail_unless(fd != -1, "Could not reopen file ==> media/journalFail.db");
+
+   ret = pclFileWriteData(fd, writeBuffer, 100);
+   fail_unless(ret == 100, "Failed to write journaled range => ret: %d", ret);
+   fail_unless(access(journal, F_OK) == 0, "Journal should exist, but does not");
+
+   // let the journal append fail, a directory can't be opened for writing
+   fail_unless(remove(journal) == 0, "Failed to remove journal");
+   fail_unless(mkdir(journal, 0700) == 0, "Failed to create journal directory");
+
+   ret = pclFileWriteData(fd, writeBuffer, 100);
+   fail_unless(ret == EPERS_COMMON, "Write without journaled range accepted => ret: %d", ret);
+
+   // the range must not have been overwritten
+   ret = pclFileSeek(fd, 100, SEEK_SET);
+   fail_unless(ret == 100, "Failed to seek file => ret: %d", ret);
+   ret = pclFileReadData(fd, readBuffer, 100);
+   fail_unless(ret == 100, "Failed to read range => ret: %d", ret);
+   fail_unless(memcmp(readBuffer, origBuffer, 100) == 0, "Range overwritten without journal");
+
+   (void)rmdir(journal);
+   ret = pclFileClose(fd);
+   fail_unless(ret == 0, "Failed to close file");
+
+   (void)pclFileRemove(PCL_LDBID_LOCAL, "media/journalFail.db", 1, 1);
+}
+END_TEST
+
+
+
+/// offset of the layout version in the header of a configuration binary form
+#define CONFIG_CACHE_VERSION_OFFSET    4
+/// offset of the modification time of the configuration file in the header
+#define CONFIG_CACHE_MTIME_OFFSET      16
+/// size of the header, the configuration data follows
+#define CONFIG_CACHE_HEADER_SIZE       40
+
+static uint32_t config_cache_version(const char* cachePath)
+{
+   uint32_t version = 0;
+   int fd = open(cachePath, O_RDONLY);
+
+   if(fd != -1)
+   {
+      if(pread(fd, &version, sizeof(version), CONFIG_CACHE_VERSION_OFFSET) != (ssize_t)sizeof(version))
+      {
+         version = 0;
+      }
+      close(fd);
+   }
+   return version;
+}
+
+
+static void config_cache_patch(const char* cachePath, off_t offset, const void* data, size_t size)
+{
+   int fd = open(cachePath, O_WRONLY);
+
+   fail_unless(fd != -1, "Failed to open binary form ==> %s", cachePath);
+   fail_unless(pwrite(fd, data, size, offset) == (ssize_t)size, "Failed to patch binary form ==> %s", cachePath);
+   close(fd);
+}
+
+
+static void config_cache_reinit(void)
+{
+   pclDeinitLibrary();
+   fail_unless(pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL) > 0, "Failed to init library");
+}
+
+
+static void config_cache_check_blacklist(void)
+{
+   int fd = 0;
+   const char* backup = "/Data/mnt-backup/lt-persistence_client_library_test/user/2/seat/1/media/doNotBackupMe_01.txt~";
+
+   (void)remove(backup);
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/doNotBackupMe_01.txt", 2, 1);
+   fail_unless(fd != -1, "Could not open file ==> media/doNotBackupMe_01.txt");
+   (void)pclFileWriteData(fd, "blacklisted", (int)strlen("blacklisted"));
+   (void)pclFileClose(fd);
+   fail_unless(access(backup, F_OK) == -1, "Backup of blacklisted file available, but should not");
+}
+
+
+
+/*
+ * The binary form of the blacklist is mapped on the next init,
+ * rebuilt if the blacklist changed, has another layout version or is corrupt
+ */
+START_TEST(test_ConfigCacheBlacklist)
+{
+   struct stat binBuf, newBuf, srcBuf;
+   struct timespec times[2];
+   uint32_t version = 1;
+   uint64_t mtime = 0;
+   unsigned char corrupt = 0xFF;
+   int fd = 0;
+   const char* blacklist = "/Data/mnt-c/lt-persistence_client_library_test/BackupFileList.info";
+   const char* cachePath = "/Data/mnt-c/lt-persistence_client_library_test/BackupFileList.info.bin";
+
+   fail_unless(stat(cachePath, &binBuf) == 0, "Binary form of the blacklist not available");
+   fail_unless(config_cache_version(cachePath) == 2, "Wrong blacklist layout version");
+
+   // the second init maps the binary form, it is not rebuilt
+   config_cache_reinit();
+   fail_unless(stat(cachePath, &newBuf) == 0, "Binary form of the blacklist not available");
+   fail_unless(newBuf.st_ino == binBuf.st_ino, "Binary form rebuilt, but should be mapped");
+   config_cache_check_blacklist();
+
+   // a changed modification time of the blacklist rebuilds the binary form
+   pclDeinitLibrary();
+   fail_unless(stat(blacklist, &srcBuf) == 0, "Blacklist not available");
+   times[0] = srcBuf.st_atim;
+   times[1] = srcBuf.st_mtim;
+   times[1].tv_sec += 1;
+   fail_unless(utimensat(AT_FDCWD, blacklist, times, 0) == 0, "Failed to change blacklist mtime");
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL);
+
+   binBuf = newBuf;
+   fail_unless(stat(cachePath, &newBuf) == 0, "Binary form of the blacklist not available");
+   fail_unless(newBuf.st_ino != binBuf.st_ino, "Binary form not rebuilt after blacklist change");
+   fd = open(cachePath, O_RDONLY);
+   fail_unless(pread(fd, &mtime, sizeof(mtime), CONFIG_CACHE_MTIME_OFFSET) == (ssize_t)sizeof(mtime), "Failed to read header");
+   close(fd);
+   fail_unless(mtime == (uint64_t)times[1].tv_sec, "Binary form not created from the changed blacklist");
+   config_cache_check_blacklist();
+
+   // the previous layout (version 1) is rebuilt
+   pclDeinitLibrary();
+   config_cache_patch(cachePath, CONFIG_CACHE_VERSION_OFFSET, &version, sizeof(version));
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL);
+
+   binBuf = newBuf;
+   fail_unless(stat(cachePath, &newBuf) == 0, "Binary form of the blacklist not available");
+   fail_unless(newBuf.st_ino != binBuf.st_ino, "Binary form of the previous layout not rebuilt");
+   fail_unless(config_cache_version(cachePath) == 2, "Wrong blacklist layout version after rebuild");
+   config_cache_check_blacklist();
+
+   // a corrupt binary form is rejected and rebuilt
+   pclDeinitLibrary();
+   config_cache_patch(cachePath, CONFIG_CACHE_HEADER_SIZE, &corrupt, sizeof(corrupt));
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL);
+
+   binBuf = newBuf;
+   fail_unless(stat(cachePath, &newBuf) == 0, "Binary form of the blacklist not available");
+   fail_unless(newBuf.st_ino != binBuf.st_ino, "Corrupt binary form not rebuilt");
+   config_cache_check_blacklist();
+}
+END_TEST
+
+
+
+/*
+ * The binary form of the custom library config is mapped on the next init,
+ * rebuilt if it has another layout version or is corrupt
+ */
+START_TEST(test_ConfigCacheCustomLib)
+{
+   struct stat binBuf, newBuf;
+   char cachePath[256] = {0};
+   uint32_t version = 7;
+   unsigned char corrupt = 0xFF;
+   const char* envVariable = "PERS_CLIENT_LIB_CUSTOM_LOAD";
+   const char* filename = "/etc/pclCustomLibConfigFileTest.cfg";
+
+   snprintf(cachePath, sizeof(cachePath), "/Data/mnt-c/pclCustomLibConfig_%08x.bin",
+            pclCrc32(0, (const unsigned char*)filename, strlen(filename)));
+
+   setenv(envVariable, filename, 1);
+   config_cache_reinit();
+
+   fail_unless(stat(cachePath, &binBuf) == 0, "Binary form of the custom library config not available ==> %s", cachePath);
+   fail_unless(config_cache_version(cachePath) == 1, "Wrong custom library config layout version");
+
+   // the second init maps the binary form, it is not rebuilt
+   config_cache_reinit();
+   fail_unless(stat(cachePath, &newBuf) == 0, "Binary form of the custom library config not available");
+   fail_unless(newBuf.st_ino == binBuf.st_ino, "Binary form rebuilt, but should be mapped");
+
+   // another layout version is rebuilt
+   pclDeinitLibrary();
+   config_cache_patch(cachePath, CONFIG_CACHE_VERSION_OFFSET, &version, sizeof(version));
+   config_cache_reinit();
+
+   binBuf = newBuf;
+   fail_unless(stat(cachePath, &newBuf) == 0, "Binary form of the custom library config not available");
+   fail_unless(newBuf.st_ino != binBuf.st_ino, "Binary form of another layout not rebuilt");
+   fail_unless(config_cache_version(cachePath) == 1, "Wrong custom library config layout version after rebuild");
+
+   // a corrupt binary form is rejected and rebuilt
+   pclDeinitLibrary();
+   config_cache_patch(cachePath, CONFIG_CACHE_HEADER_SIZE, &corrupt, sizeof(corrupt));
+   config_cache_reinit();
+
+   binBuf = newBuf;
+   fail_unless(stat(cachePath, &newBuf) == 0, "Binary form of the custom library config not available");
+   fail_unless(newBuf.st_ino != binBuf.st_ino, "Corrupt binary form not rebuilt");
+
+   unsetenv(envVariable);
+}
+END_TEST
+
+
+
+static void blacklist_write(const char* resource, const char* backup, const char* csum, int expectBackup)
+{
+   int fd = 0;
+
+   (void)remove(backup);
+   (void)remove(csum);
+
+   fd = pclFileOpen(PCL_LDBID_LOCAL, resource, 2, 1);
+   fail_unless(fd != -1, "Could not open file ==> %s", resource);
+   fail_unless(pclFileWriteData(fd, "backup?", (int)strlen("backup?")) == (int)strlen("backup?"), "Failed to write ==> %s", resource);
+   (void)pclFileClose(fd);
+
+   if(expectBackup == 1)
+   {
+      fail_unless(access(backup, F_OK) == 0, "Backup not available, but should ==> %s", backup);
+      fail_unless(access(csum, F_OK) == 0, "Checksum not available, but should ==> %s", csum);
+   }
+   else
+   {
+      fail_unless(access(backup, F_OK) == -1, "Backup available, but should not ==> %s", backup);
+      fail_unless(access(csum, F_OK) == -1, "Checksum available, but should not ==> %s", csum);
+   }
+
+   (void)pclFileRemove(PCL_LDBID_LOCAL, resource, 2, 1);
+   (void)remove(backup);
+   (void)remove(csum);
+}
+
+
+
+/*
+ * Only exact blacklist entries suppress backup and checksum,
+ * paths sharing a prefix with a listed path are backed up
+ */
+START_TEST(test_BlacklistExactMatch)
+{
+#define BL_BACKUP_PATH "/Data/mnt-backup/lt-persistence_client_library_test/user/2/seat/1/"
+
+   // listed
+   blacklist_write("media/doNotBackupMe_01.txt",
+                   BL_BACKUP_PATH "media/doNotBackupMe_01.txt~", BL_BACKUP_PATH "media/doNotBackupMe_01.txt~.crc", 0);
+   blacklist_write("media/iDontWantDoBeBackuped_05.txt_END",
+                   BL_BACKUP_PATH "media/iDontWantDoBeBackuped_05.txt_END~", BL_BACKUP_PATH "media/iDontWantDoBeBackuped_05.txt_END~.crc", 0);
+
+   // not listed
+   blacklist_write("media/doBackupMe.txt",
+                   BL_BACKUP_PATH "media/doBackupMe.txt~", BL_BACKUP_PATH "media/doBackupMe.txt~.crc", 1);
+
+   // a listed path is a prefix of this path
+   blacklist_write("media/doNotBackupMe_01.txt.old",
+                   BL_BACKUP_PATH "media/doNotBackupMe_01.txt.old~", BL_BACKUP_PATH "media/doNotBackupMe_01.txt.old~.crc", 1);
+
+   // this path is a prefix of a listed path
+   blacklist_write("media/doNotBackupMe_0",
+                   BL_BACKUP_PATH "media/doNotBackupMe_0~", BL_BACKUP_PATH "media/doNotBackupMe_0~.crc", 1);
+
+#undef BL_BACKUP_PATH
+}
+END_TEST
+
+
+
+START_TEST(test_FileSyncPolicy)
+{
+   int fd = 0, ret = 0, i = 0;
+   const char* writeBuffer = "Sync policy test data written in small chunks ";
+   pclShutdownTiming_s timing;
+
+   // lifecycle set is only allowed without shutdown registration
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/mediaDB_write_01.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> media/mediaDB_write_01.db");
+
+   ret = pclFileSetSyncPolicy(fd, 42, 0);
+   fail_unless(ret == EPERS_BADPOL, "Invalid sync policy accepted => ret: %d", ret);
+
+   ret = pclFileSetSyncPolicy(fd, PCL_FILE_SYNC_ON_CLOSE, 0);
+   fail_unless(ret == 0, "Failed to set sync policy on close => ret: %d", ret);
+   for(i=0; i<16; i++)
+   {
+      ret = pclFileWriteData(fd, writeBuffer, (int)strlen(writeBuffer));
+      fail_unless(ret == (int)strlen(writeBuffer), "Failed to write data");
+   }
+
+   ret = pclFileSync(fd);
+   fail_unless(ret == 0, "Failed to sync file => ret: %d", ret);
+
+   ret = pclFileSetSyncPolicy(fd, PCL_FILE_SYNC_INTERVAL, 100);
+   fail_unless(ret == 0, "Failed to set sync policy interval => ret: %d", ret);
+   for(i=0; i<16; i++)
+   {
+      ret = pclFileWriteData(fd, writeBuffer, (int)strlen(writeBuffer));
+      fail_unless(ret == (int)strlen(writeBuffer), "Failed to write data");
+   }
+
+   // the data is committed by the sync timer, a partial shutdown has no dirty file to flush
+   usleep(300000);
+   ret = pclLifecycleSet(PCL_SHUTDOWN);
+   fail_unless(ret != EPERS_SHUTDOWN_NO_PERMIT, "Lifecycle set NOT allowed, but should");
+   ret = pclGetShutdownTiming(&timing);
+   fail_unless(ret == 1, "Failed to get shutdown timing => ret: %d", ret);
+   fail_unless(timing.numFiles == 0, "File not committed by the sync timer => flushed: %u", timing.numFiles);
+   ret = pclLifecycleSet(PCL_SHUTDOWN_CANCEL);
+
+   ret = pclFileClose(fd);
+   fail_unless(ret == 0, "Failed to close file");
+
+   ret = pclFileSetSyncPolicy(fd, PCL_FILE_SYNC_PER_WRITE, 0);
+   fail_unless(ret == EPERS_MAXHANDLE, "Sync policy set on closed file => ret: %d", ret);
+
+   ret = pclFileSync(fd);
+   fail_unless(ret == EPERS_MAXHANDLE, "Closed file synced => ret: %d", ret);
+
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL);
+}
+END_TEST
+
+
+
+START_TEST(test_FilePositionalIO)
+{
+   int fd = 0, ret = 0;
+   char readBuffer[64] = {0};
+   char part1[16] = {0}, part2[16] = {0}, part3[16] = {0};
+   struct iovec iov[3];
+
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/positionalIO.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> nonRCT/positionalIO.db");
+
+   // gather write of three records
+   iov[0].iov_base = "record_0_0123456";
+   iov[0].iov_len  = 16;
+   iov[1].iov_base = "record_1_0123456";
+   iov[1].iov_len  = 16;
+   iov[2].iov_base = "record_2_0123456";
+   iov[2].iov_len  = 16;
+   ret = pclFileWriteV(fd, iov, 3);
+   fail_unless(ret == 48, "Failed to write vector => ret: %d", ret);
+
+   ret = pclFileWriteV(fd, NULL, 3);
+   fail_unless(ret == EPERS_COMMON, "Invalid vector accepted => ret: %d", ret);
+
+   // positional access must not change the file offset
+   ret = pclFileWriteAt(fd, "RECORD_1", 8, 16);
+   fail_unless(ret == 8, "Failed to write at offset => ret: %d", ret);
+
+   ret = pclFileReadAt(fd, readBuffer, 16, 16);
+   fail_unless(ret == 16, "Failed to read at offset => ret: %d", ret);
+   fail_unless(strncmp(readBuffer, "RECORD_1_0123456", 16) == 0, "Wrong data read => %s", readBuffer);
+
+   ret = pclFileSeek(fd, 0, SEEK_CUR);
+   fail_unless(ret == 48, "File offset changed by positional access => ret: %d", ret);
+
+   // scatter read of the three records
+   ret = pclFileSeek(fd, 0, SEEK_SET);
+   iov[0].iov_base = part1;
+   iov[1].iov_base = part2;
+   iov[2].iov_base = part3;
+   ret = pclFileReadV(fd, iov, 3);
+   fail_unless(ret == 48, "Failed to read vector => ret: %d", ret);
+   fail_unless(strncmp(part1, "record_0_0123456", 16) == 0, "Wrong data read => record 0");
+   fail_unless(strncmp(part2, "RECORD_1_0123456", 16) == 0, "Wrong data read => record 1");
+   fail_unless(strncmp(part3, "record_2_0123456", 16) == 0, "Wrong data read => record 2");
+
+   ret = pclFileClose(fd);
+   fail_unless(ret == 0, "Failed to close file");
+
+   ret = pclFileRemove(PCL_LDBID_LOCAL, "nonRCT/positionalIO.db", 1, 1);
+   fail_unless(ret == 0, "Failed to remove file => ret: %d", ret);
+}
+END_TEST
+
+
+
+static volatile int gAsyncSyncResult = -1;
+
+static void asyncSyncCallback(int requestId, int result, void* userData)
+{
+   (void)requestId;
+   *(volatile int*)userData = result;
+}
+
+
+START_TEST(test_FileAsync)
+{
+   int fd = 0, ret = 0, i = 0, result = 0;
+   int requestId[4] = {0};
+   char readBuffer[64] = {0};
+   const char* records[4] = {"async_record_0__", "async_record_1__", "async_record_2__", "async_record_3__"};
+
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/asyncIO.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> nonRCT/asyncIO.db");
+
+   // several outstanding writes, completion will be polled
+   for(i=0; i<4; i++)
+   {
+      requestId[i] = pclFileWriteAsync(fd, records[i], 16, i*16, NULL, NULL);
+      fail_unless(requestId[i] > 0, "Failed to submit async write => ret: %d", requestId[i]);
+   }
+
+   for(i=0; i<4; i++)
+   {
+      ret = pclFileAsyncWait(requestId[i], &result);
+      fail_unless(ret == 1, "Failed to wait for async write => ret: %d", ret);
+      fail_unless(result == 16, "Async write failed => result: %d", result);
+   }
+
+   // completed request ids have been released
+   ret = pclFileAsyncPoll(requestId[0], &result);
+   fail_unless(ret == EPERS_COMMON, "Released request id still valid => ret: %d", ret);
+
+   // sync with completion callback
+   gAsyncSyncResult = -1;
+   ret = pclFileSyncAsync(fd, asyncSyncCallback, (void*)&gAsyncSyncResult);
+   fail_unless(ret > 0, "Failed to submit async sync => ret: %d", ret);
+   for(i=0; i<100 && gAsyncSyncResult == -1; i++)
+   {
+      usleep(10000);
+   }
+   fail_unless(gAsyncSyncResult == 0, "Async sync failed => result: %d", gAsyncSyncResult);
+
+   ret = pclFileReadAsync(fd, readBuffer, 64, 0, NULL, NULL);
+   fail_unless(ret > 0, "Failed to submit async read => ret: %d", ret);
+   ret = pclFileAsyncWait(ret, &result);
+   fail_unless(ret == 1 && result == 64, "Async read failed => result: %d", result);
+   for(i=0; i<4; i++)
+   {
+      fail_unless(strncmp(readBuffer + i*16, records[i], 16) == 0, "Wrong data read => record %d", i);
+   }
+
+   ret = pclFileClose(fd);
+   fail_unless(ret == 0, "Failed to close file");
+
+   ret = pclFileRemove(PCL_LDBID_LOCAL, "nonRCT/asyncIO.db", 1, 1);
+   fail_unless(ret == 0, "Failed to remove file => ret: %d", ret);
+}
+END_TEST
+
+
+
+
+START_TEST(test_FileMapHinted)
+{
+   int fd = 0, fd_RO = 0, ret = 0, size = 0;
+   char* fileMap = NULL;
+   char readBuffer[16] = {0};
+   char writeBuffer[4096];
+
+   memset(writeBuffer, 'a', sizeof(writeBuffer));
+
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/mapHinted.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> nonRCT/mapHinted.db");
+
+   ret = pclFileWriteData(fd, writeBuffer, (int)sizeof(writeBuffer));
+   fail_unless(ret == (int)sizeof(writeBuffer), "Failed to write data");
+
+   fileMap = pclFileMapDataHinted((long)sizeof(writeBuffer), 0, fd,
+                                  PCL_FILE_MAP_HINT_SEQUENTIAL | PCL_FILE_MAP_HINT_WILLNEED | PCL_FILE_MAP_POPULATE);
+   fail_unless(fileMap != MAP_FAILED && fileMap != EPERS_MAP_LOCKFS, "Failed to map file");
+
+   // modify the file through the mapping, sync must commit the mapping
+   memcpy(fileMap + 1024, "mapped_record_0_", 16);
+   ret = pclFileSync(fd);
+   fail_unless(ret == 0, "Failed to sync file => ret: %d", ret);
+
+   ret = pclFileReadAt(fd, readBuffer, 16, 1024);
+   fail_unless(ret == 16, "Failed to read data => ret: %d", ret);
+   fail_unless(strncmp(readBuffer, "mapped_record_0_", 16) == 0, "Mapped data not written");
+
+   // read only files will be mapped read only
+   fd_RO = pclFileOpen(PCL_LDBID_LOCAL, "media/mediaDB_ReadOnly.db", 1, 1);
+   fail_unless(fd_RO != -1, "Could not open file ==> /media/mediaDB_ReadOnly.db");
+   size = pclFileGetSize(fd_RO);
+   fail_unless(size > 0, "Failed to get file size");
+
+   fileMap = pclFileMapDataHinted(size, 0, fd_RO, PCL_FILE_MAP_HINT_RANDOM);
+   fail_unless(fileMap != MAP_FAILED && fileMap != EPERS_MAP_LOCKFS, "Failed to map read only file");
+
+   // the mappings will be unmapped on close
+   ret = pclFileClose(fd_RO);
+   fail_unless(ret == 0, "Failed to close file");
+   ret = pclFileClose(fd);
+   fail_unless(ret == 0, "Failed to close file");
+
+   ret = pclFileRemove(PCL_LDBID_LOCAL, "nonRCT/mapHinted.db", 1, 1);
+   fail_unless(ret == 0, "Failed to remove file => ret: %d", ret);
+}
+END_TEST
+
+
+
+
+START_TEST(test_FileWriteAtomic)
+{
+   int fd = 0, ret = 0, handle = 0;
+   char readBuffer[64] = {0};
+   char tmpPattern[256] = {0};
+   glob_t tmpFiles;
+   const char* content = "atomic content of the whole file";
+
+   ret = pclFileWriteAtomic(PCL_LDBID_LOCAL, "nonRCT/atomic.db", 1, 1, content, (int)strlen(content));
+   fail_unless(ret == (int)strlen(content), "Failed to write atomic => ret: %d", ret);
+
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/atomic.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> nonRCT/atomic.db");
+   ret = pclFileReadData(fd, readBuffer, 64);
+   fail_unless(ret == (int)strlen(content), "Wrong file size => ret: %d", ret);
+   fail_unless(strncmp(readBuffer, content, strlen(content)) == 0, "Wrong data read");
+   ret = pclFileClose(fd);
+   fail_unless(ret == 0, "Failed to close file");
+
+   // streaming variant, the file is replaced with the commit
+   handle = pclFileAtomicBegin(PCL_LDBID_LOCAL, "nonRCT/atomic.db", 1, 1);
+   fail_unless(handle >= 0, "Failed to begin atomic replace => ret: %d", handle);
+   ret = pclFileAtomicAppend(handle, "part_1__", 8);
+   fail_unless(ret == 8, "Failed to append => ret: %d", ret);
+   ret = pclFileAtomicAppend(handle, "part_2__", 8);
+   fail_unless(ret == 8, "Failed to append => ret: %d", ret);
+   ret = pclFileAtomicCommit(handle);
+   fail_unless(ret == 0, "Failed to commit => ret: %d", ret);
+   ret = pclFileAtomicAppend(handle, "part_3__", 8);
+   fail_unless(ret == EPERS_MAXHANDLE, "Append after commit possible => ret: %d", ret);
+
+   // aborted replace does not change the file
+   handle = pclFileAtomicBegin(PCL_LDBID_LOCAL, "nonRCT/atomic.db", 1, 1);
+   fail_unless(handle >= 0, "Failed to begin atomic replace => ret: %d", handle);
+   ret = pclFileAtomicAppend(handle, "aborted", 7);
+   fail_unless(ret == 7, "Failed to append => ret: %d", ret);
+   ret = pclFileAtomicAbort(handle);
+   fail_unless(ret == 0, "Failed to abort => ret: %d", ret);
+
+   memset(readBuffer, 0, sizeof(readBuffer));
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/atomic.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> nonRCT/atomic.db");
+   ret = pclFileReadData(fd, readBuffer, 64);
+   fail_unless(ret == 16, "Wrong file size => ret: %d", ret);
+   fail_unless(strncmp(readBuffer, "part_1__part_2__", 16) == 0, "Wrong data read");
+   ret = pclFileClose(fd);
+   fail_unless(ret == 0, "Failed to close file");
+
+   // an unfinished replace is aborted on deinit, the temporary file will be removed
+   handle = pclFileAtomicBegin(PCL_LDBID_LOCAL, "nonRCT/atomic.db", 1, 1);
+   fail_unless(handle >= 0, "Failed to begin atomic replace => ret: %d", handle);
+   ret = pclFileAtomicAppend(handle, "unfinished", 10);
+   fail_unless(ret == 10, "Failed to append => ret: %d", ret);
+
+   snprintf(tmpPattern, sizeof(tmpPattern), "%suser/1/seat/1/nonRCT/atomic.db~atomic.*", gSourcePath);
+   ret = glob(tmpPattern, 0, NULL, &tmpFiles);
+   fail_unless(ret == 0 && tmpFiles.gl_pathc == 1, "Temporary file not found => ret: %d", ret);
+   globfree(&tmpFiles);
+
+   pclDeinitLibrary();
+   ret = glob(tmpPattern, 0, NULL, &tmpFiles);
+   fail_unless(ret == GLOB_NOMATCH, "Temporary file not removed on deinit => ret: %d", ret);
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL);
+
+   memset(readBuffer, 0, sizeof(readBuffer));
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "nonRCT/atomic.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> nonRCT/atomic.db");
+   ret = pclFileReadData(fd, readBuffer, 64);
+   fail_unless(ret == 16, "Wrong file size => ret: %d", ret);
+   ret = pclFileClose(fd);
+   fail_unless(ret == 0, "Failed to close file");
+
+   ret = pclFileWriteAtomic(PCL_LDBID_LOCAL, "media/mediaDB_ReadOnly.db", 1, 1, content, (int)strlen(content));
+   fail_unless(ret == EPERS_RESOURCE_READ_ONLY, "Read only file replaced => ret: %d", ret);
+
+   ret = pclFileRemove(PCL_LDBID_LOCAL, "nonRCT/atomic.db", 1, 1);
+   fail_unless(ret == 0, "Failed to remove file => ret: %d", ret);
+}
+END_TEST
+
+
+
+
+START_TEST(test_FileVerifyLedger)
+{
+   int fd = -1;
+   ssize_t rval = 0;
+   struct stat buf;
+   const char* path    = "/Data/mnt-c/lt-persistence_client_library_test/user/200/seat/100/media/ledger.db";
+   const char* backup  = "/Data/mnt-backup/lt-persistence_client_library_test/user/200/seat/100/media/ledger.db~";
+
+   fd = pclCreateFile(path, 0);
+   fail_unless(fd != -1, "Failed to create file");
+   rval = write(fd, gWriteBuffer, strlen(gWriteBuffer));
+   fail_unless(rval == (ssize_t)strlen(gWriteBuffer), "Failed to write data");
+
+   // file closed cleanly, verification not needed
+   fail_unless(fstat(fd, &buf) == 0, "Failed to stat file");
+   pclLedgerAdd(backup, &buf);
+   fail_unless(pclLedgerTake(backup, path) == 1, "Unchanged file must not be verified");
+
+   // the ledger entry has been consumed by the open
+   fail_unless(pclLedgerTake(backup, path) == 0, "Ledger entry not consumed");
+
+   // file changed after it has been closed, must be verified
+   fail_unless(fstat(fd, &buf) == 0, "Failed to stat file");
+   pclLedgerAdd(backup, &buf);
+   rval = write(fd, gWriteBuffer2, strlen(gWriteBuffer2));
+   fail_unless(rval == (ssize_t)strlen(gWriteBuffer2), "Failed to write data");
+   fail_unless(pclLedgerTake(backup, path) == 0, "Changed file must be verified");
+
+   close(fd);
+   (void)remove(path);
+}
+END_TEST
+
+
+
+
+START_TEST(test_FileCreateFolders)
+{
+   int fd = -1;
+   const char* path1 = "/Data/mnt-c/lt-persistence_client_library_test/user/200/seat/100/folders/a/b/file_1.db";
+   const char* path2 = "/Data/mnt-c/lt-persistence_client_library_test/user/200/seat/100/folders/a/b/file_2.db";
+   const char* path3 = "/Data/mnt-c/lt-persistence_client_library_test/user/200/seat/100/folders/a/c/file_3.db";
+
+   fd = pclCreateFile(path1, 0);
+   fail_unless(fd != -1, "Failed to create file ==> %s", path1);
+   close(fd);
+
+   // folder is cached now
+   fd = pclCreateFile(path2, 0);
+   fail_unless(fd != -1, "Failed to create file ==> %s", path2);
+   close(fd);
+
+   // sibling folder, created relative to the cached parent
+   fd = pclCreateFile(path3, 0);
+   fail_unless(fd != -1, "Failed to create file ==> %s", path3);
+   close(fd);
+
+   // remove the cached folders, they must be created again
+   (void)remove(path1);
+   (void)remove(path2);
+   (void)remove(path3);
+   (void)rmdir("/Data/mnt-c/lt-persistence_client_library_test/user/200/seat/100/folders/a/b");
+   (void)rmdir("/Data/mnt-c/lt-persistence_client_library_test/user/200/seat/100/folders/a/c");
+   (void)rmdir("/Data/mnt-c/lt-persistence_client_library_test/user/200/seat/100/folders/a");
+
+   fd = pclCreateFile(path2, 0);
+   fail_unless(fd != -1, "Failed to create file in removed folder ==> %s", path2);
+   close(fd);
+
+   (void)remove(path2);
+}
+END_TEST
+
+
+
+START_TEST(test_FileShutdownFlush)
+{
+   int fd1 = 0, fd2 = 0, ret = 0;
+   char buffer[64] = {0};
+   const char* writeBuffer = "Shutdown flush test data";
+   pclShutdownTiming_s timing;
+
+   // lifecycle set is only allowed without shutdown registration
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+
+   ret = pclSetShutdownFlushDeadline(1000);
+   fail_unless(ret == 1, "Failed to set shutdown flush deadline => ret: %d", ret);
+
+   fd1 = pclFileOpen(PCL_LDBID_LOCAL, "media/mediaDB_write_01.db", 1, 1);
+   fail_unless(fd1 != -1, "Could not open file ==> media/mediaDB_write_01.db");
+
+   fd2 = pclFileOpen(PCL_LDBID_LOCAL, "media/mediaDB_write_02.db", 1, 1);
+   fail_unless(fd2 != -1, "Could not open file ==> media/mediaDB_write_02.db");
+
+   ret = pclFileWriteData(fd1, writeBuffer, (int)strlen(writeBuffer));
+   fail_unless(ret == (int)strlen(writeBuffer), "Failed to write data");
+
+   // only the written file will be flushed
+   ret = pclLifecycleSet(PCL_SHUTDOWN);
+   fail_unless(ret != EPERS_SHUTDOWN_NO_PERMIT, "Lifecycle set NOT allowed, but should");
+
+   ret = pclLifecycleSet(PCL_SHUTDOWN_CANCEL);
+
+   ret = pclFileSeek(fd1, 0, SEEK_SET);
+   ret = pclFileReadData(fd1, buffer, (int)strlen(writeBuffer));
+   fail_unless(ret == (int)strlen(writeBuffer), "Failed to read data");
+   fail_unless(strncmp(buffer, writeBuffer, strlen(writeBuffer)) == 0, "Buffer not correctly read => %s", buffer);
+
+   ret = pclFileClose(fd1);
+   fail_unless(ret == 0, "Failed to close file");
+   ret = pclFileClose(fd2);
+   fail_unless(ret == 0, "Failed to close file");
+
+   ret = pclSetShutdownFlushDeadline(0);
+   fail_unless(ret == 1, "Failed to reset shutdown flush deadline => ret: %d", ret);
+
+   pclDeinitLibrary();
+
+   // deinit has done a shutdown, the timing is available after deinit
+   ret = pclGetShutdownTiming(&timing);
+   fail_unless(ret == 1, "Failed to get shutdown timing => ret: %d", ret);
+   fail_unless(timing.total >= timing.fileFlush + timing.dbClose, "Invalid shutdown timing => total: %u", timing.total);
+
+   ret = pclGetShutdownTiming(NULL);
+   fail_unless(ret == EPERS_COMMON, "Shutdown timing stored to NULL => ret: %d", ret);
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL);
+}
+END_TEST
+
+
+
+START_TEST(test_FileShutdownDeadline)
+{
+   int i = 0, ret = 0, size = 0;
+   int fdFill[48] = {0};
+   int fd[4] = {0};
+   char resource[64] = {0};
+   char buffer[64] = {0};
+   char writeBuffer[64] = {0};
+   static char fillBuffer[256*1024];
+   pclShutdownTiming_s timing;
+
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+
+   ret = pclSetShutdownFlushDeadline(1);
+   fail_unless(ret == 1, "Failed to set shutdown flush deadline => ret: %d", ret);
+
+   // the files will be flushed in open order, the files opened first keep the flush busy until the deadline
+   memset(fillBuffer, 'x', sizeof(fillBuffer));
+   for(i=0; i<48; i++)
+   {
+      snprintf(resource, sizeof(resource), "media/shutdownDeadline_%02d.db", i);
+      fdFill[i] = pclFileOpen(PCL_LDBID_LOCAL, resource, 1, 1);
+      fail_unless(fdFill[i] != -1, "Could not open file ==> %s", resource);
+      ret = pclFileWriteData(fdFill[i], fillBuffer, (int)sizeof(fillBuffer));
+      fail_unless(ret == (int)sizeof(fillBuffer), "Failed to write data => ret: %d", ret);
+   }
+
+   // the first write of a file configured in the RCT creates a backup
+   for(i=0; i<4; i++)
+   {
+      snprintf(resource, sizeof(resource), "media/mediaDB_write_%02d.db", i+1);
+      fd[i] = pclFileOpen(PCL_LDBID_LOCAL, resource, 1, 1);
+      fail_unless(fd[i] != -1, "Could not open file ==> %s", resource);
+
+      snprintf(writeBuffer, sizeof(writeBuffer), "Shutdown deadline data %d", i);
+      ret = pclFileSeek(fd[i], 0, SEEK_END);
+      fail_unless(ret >= 0, "Failed to seek file => ret: %d", ret);
+      ret = pclFileWriteData(fd[i], writeBuffer, (int)strlen(writeBuffer));
+      fail_unless(ret == (int)strlen(writeBuffer), "Failed to write data => ret: %d", ret);
+   }
+
+   pclDeinitLibrary();
+
+   ret = pclGetShutdownTiming(&timing);
+   fail_unless(ret == 1, "Failed to get shutdown timing => ret: %d", ret);
+   fail_unless(timing.numFiles < 52, "Flush deadline not reached => flushed: %u", timing.numFiles);
+
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_NONE);
+
+   // the data of the skipped files must not be replaced by the backup on the next open
+   for(i=0; i<4; i++)
+   {
+      snprintf(resource, sizeof(resource), "media/mediaDB_write_%02d.db", i+1);
+      fd[i] = pclFileOpen(PCL_LDBID_LOCAL, resource, 1, 1);
+      fail_unless(fd[i] != -1, "Could not open file ==> %s", resource);
+
+      snprintf(writeBuffer, sizeof(writeBuffer), "Shutdown deadline data %d", i);
+      size = pclFileGetSize(fd[i]);
+      fail_unless(size >= (int)strlen(writeBuffer), "Invalid file size => %d", size);
+
+      memset(buffer, 0, sizeof(buffer));
+      ret = pclFileSeek(fd[i], size - (int)strlen(writeBuffer), SEEK_SET);
+      ret = pclFileReadData(fd[i], buffer, (int)strlen(writeBuffer));
+      fail_unless(ret == (int)strlen(writeBuffer), "Failed to read data => ret: %d", ret);
+      fail_unless(strncmp(buffer, writeBuffer, strlen(writeBuffer)) == 0, "Data lost after deadline => %s", buffer);
+
+      ret = pclFileClose(fd[i]);
+      fail_unless(ret == 0, "Failed to close file");
+   }
+
+   for(i=0; i<48; i++)
+   {
+      snprintf(resource, sizeof(resource), "media/shutdownDeadline_%02d.db", i);
+      (void)pclFileRemove(PCL_LDBID_LOCAL, resource, 1, 1);
+   }
+
+   ret = pclSetShutdownFlushDeadline(0);
+   fail_unless(ret == 1, "Failed to reset shutdown flush deadline => ret: %d", ret);
+
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL);
+}
+END_TEST
+
+
+
+static volatile int gInitReadyState = -100;
+
+static void init_ready_callback(int state)
+{
+   gInitReadyState = state;
+}
+
+
+
+START_TEST(test_InitAsync)
+{
+   int fd = 0, ret = 0, i = 0;
+   char buffer[64] = {0};
+
+   pclDeinitLibrary();
+
+   gInitReadyState = -100;
+   ret = pclInitLibraryAsync(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL, init_ready_callback);
+   fail_unless(ret >= 0, "Failed to init library async => ret: %d", ret);
+
+   // local data can be accessed before the library is ready
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/mediaDB_write_01.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> media/mediaDB_write_01.db");
+   ret = pclFileReadData(fd, buffer, (int)sizeof(buffer));
+   fail_unless(ret >= 0, "Failed to read file => ret: %d", ret);
+   (void)pclFileClose(fd);
+
+   for(i=0; i<200 && pclGetInitState() == PCL_INIT_STATE_PENDING; i++)
+   {
+      usleep(10000);
+   }
+   fail_unless(pclGetInitState() == PCL_INIT_STATE_READY, "Library not ready => state: %d", pclGetInitState());
+   fail_unless(gInitReadyState == PCL_INIT_STATE_READY, "Ready callback not called => state: %d", gInitReadyState);
+
+   pclDeinitLibrary();
+   fail_unless(pclGetInitState() == EPERS_NOT_INITIALIZED, "Init state available after deinit");
+
+   (void)pclInitLibrary(gTheAppId, PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL);
+   fail_unless(pclGetInitState() == PCL_INIT_STATE_READY, "Library not ready after sync init");
+}
+END_TEST
+
+
+
+START_TEST(test_RctPreload)
+{
+   int fd = 0, ret = 0, size = 0;
+   char buffer[READ_SIZE] = {0};
+   char bufferPreload[READ_SIZE] = {0};
+
+   // read the resource configuration from the table
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/mediaDB_write_01.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> media/mediaDB_write_01.db");
+   size = pclFileReadData(fd, buffer, READ_SIZE);
+   fail_unless(size >= 0, "Failed to read file => ret: %d", size);
+   (void)pclFileClose(fd);
+
+   ret = pclSetRctPreload(1);
+   fail_unless(ret >= 0, "Failed to enable RCT preload => ret: %d", ret);
+
+   // the resource configuration is now found in the index
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/mediaDB_write_01.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file with RCT preload ==> media/mediaDB_write_01.db");
+   ret = pclFileReadData(fd, bufferPreload, READ_SIZE);
+   fail_unless(ret == size, "Wrong size read with RCT preload => ret: %d, expected: %d", ret, size);
+   fail_unless(memcmp(buffer, bufferPreload, (size_t)size) == 0, "Wrong data read with RCT preload");
+   (void)pclFileClose(fd);
+
+   // resources not in the table are still created as local resources
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/rctPreload_notInTable.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file not in RCT with RCT preload");
+   (void)pclFileClose(fd);
+
+   ret = pclSetRctPreload(0);
+   fail_unless(ret >= 0, "Failed to disable RCT preload => ret: %d", ret);
+}
+END_TEST
+
+
+
+START_TEST(test_RctReload)
+{
+   int fd = 0, rctFd = 0, tmpFd = 0, handleRCT = 0, ret = 0, size = 0, i = 0;
+   char buffer[READ_SIZE] = {0};
+   char bufferReload[READ_SIZE] = {0};
+   char copyBuffer[READ_SIZE] = {0};
+   const char* rctPath = "/Data/mnt-wt/lt-persistence_client_library_test/resource-table-cfg.itz";
+   const char* tmpPath = "/Data/mnt-wt/lt-persistence_client_library_test/resource-table-cfg.itz.new";
+   const char* resource = "rctReload/readOnlyKey";
+   const char* data = "RCT reload";
+   PersistenceConfigurationKey_s config;
+
+   // open the resource configuration table, the resource is not configured yet
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/mediaDB_write_01.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file ==> media/mediaDB_write_01.db");
+   size = pclFileReadData(fd, buffer, READ_SIZE);
+   fail_unless(size >= 0, "Failed to read file => ret: %d", size);
+   (void)pclFileClose(fd);
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, resource, 1, 1, (unsigned char*)data, (int)strlen(data));
+   fail_unless(ret == (int)strlen(data), "Failed to write not configured resource => ret: %d", ret);
+
+   // update a copy of the table and move it into place, it will be reloaded by the mainloop
+   rctFd = open(rctPath, O_RDONLY);
+   fail_unless(rctFd != -1, "Could not open RCT ==> %s", rctPath);
+   tmpFd = open(tmpPath, O_CREAT|O_RDWR|O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+   fail_unless(tmpFd != -1, "Could not create RCT copy ==> %s", tmpPath);
+   while((ret = (int)read(rctFd, copyBuffer, READ_SIZE)) > 0)
+   {
+      fail_unless(write(tmpFd, copyBuffer, (size_t)ret) == ret, "Failed to copy RCT");
+   }
+   close(tmpFd);
+   close(rctFd);
+
+   memset(&config, 0, sizeof(config));
+   config.policy     = PersistencePolicy_wc;
+   config.storage    = PersistenceStorage_local;
+   config.type       = PersistenceResourceType_key;
+   config.permission = PersistencePermission_ReadOnly;
+   config.max_size   = 1024;
+   strncpy(config.reponsible,  "default",     PERS_RCT_MAX_LENGTH_RESPONSIBLE-1);
+   strncpy(config.custom_name, "default",     PERS_RCT_MAX_LENGTH_CUSTOM_NAME-1);
+   strncpy(config.customID,    "A_CUSTOM_ID", PERS_RCT_MAX_LENGTH_CUSTOM_ID-1);
+
+   handleRCT = persComRctOpen(tmpPath, 0x01);
+   fail_unless(handleRCT >= 0, "Could not open RCT copy => ret: %d", handleRCT);
+   ret = persComRctWrite(handleRCT, resource, &config);
+   fail_unless(ret == (int)sizeof(config), "Failed to write RCT => ret: %d", ret);
+   (void)persComRctClose(handleRCT);
+
+   ret = rename(tmpPath, rctPath);
+   fail_unless(ret == 0, "Failed to move RCT into place");
+
+   // the resource is read only as soon as the new table is used
+   for(i=0; i<100; i++)
+   {
+      ret = pclKeyWriteData(PCL_LDBID_LOCAL, resource, 1, 1, (unsigned char*)data, (int)strlen(data));
+      if(ret == EPERS_RESOURCE_READ_ONLY)
+      {
+         break;
+      }
+      usleep(20000);
+   }
+   fail_unless(ret == EPERS_RESOURCE_READ_ONLY, "RCT not reloaded => ret: %d", ret);
+
+   // the resources configured before are still available
+   fd = pclFileOpen(PCL_LDBID_LOCAL, "media/mediaDB_write_01.db", 1, 1);
+   fail_unless(fd != -1, "Could not open file after RCT reload ==> media/mediaDB_write_01.db");
+   ret = pclFileReadData(fd, bufferReload, READ_SIZE);
+   fail_unless(ret == size, "Wrong size read after RCT reload => ret: %d, expected: %d", ret, size);
+   fail_unless(memcmp(buffer, bufferReload, (size_t)size) == 0, "Wrong data read after RCT reload");
+   (void)pclFileClose(fd);
+}
+END_TEST
+
+
+
 
 static Suite * persistencyClientLib_suite()
 {
@@ -1522,6 +2595,71 @@ static Suite * persistencyClientLib_suite()
    tcase_add_test(tc_FileBackupAndRecovery, test_FileBackupAndRecovery);
    tcase_set_timeout(tc_FileBackupAndRecovery, 30);
 
+   TCase * tc_FileJournalRecovery = tcase_create("FileJournalRecovery");
+   tcase_add_test(tc_FileJournalRecovery, test_FileJournalRecovery);
+   tcase_set_timeout(tc_FileJournalRecovery, 3);
+
+   TCase * tc_FileJournalWriteFail = tcase_create("FileJournalWriteFail");
+   tcase_add_test(tc_FileJournalWriteFail, test_FileJournalWriteFail);
+   tcase_set_timeout(tc_FileJournalWriteFail, 3);
+
+   TCase * tc_ConfigCache = tcase_create("ConfigCache");
+   tcase_add_test(tc_ConfigCache, test_ConfigCacheBlacklist);
+   tcase_add_test(tc_ConfigCache, test_ConfigCacheCustomLib);
+   tcase_set_timeout(tc_ConfigCache, 10);
+
+   TCase * tc_BlacklistExactMatch = tcase_create("BlacklistExactMatch");
+   tcase_add_test(tc_BlacklistExactMatch, test_BlacklistExactMatch);
+   tcase_set_timeout(tc_BlacklistExactMatch, 3);
+
+   TCase * tc_FileSyncPolicy = tcase_create("FileSyncPolicy");
+   tcase_add_test(tc_FileSyncPolicy, test_FileSyncPolicy);
+   tcase_set_timeout(tc_FileSyncPolicy, 3);
+
+   TCase * tc_FilePositionalIO = tcase_create("FilePositionalIO");
+   tcase_add_test(tc_FilePositionalIO, test_FilePositionalIO);
+   tcase_set_timeout(tc_FilePositionalIO, 3);
+
+   TCase * tc_FileAsync = tcase_create("FileAsync");
+   tcase_add_test(tc_FileAsync, test_FileAsync);
+   tcase_set_timeout(tc_FileAsync, 5);
+
+   TCase * tc_FileMapHinted = tcase_create("FileMapHinted");
+   tcase_add_test(tc_FileMapHinted, test_FileMapHinted);
+   tcase_set_timeout(tc_FileMapHinted, 3);
+
+   TCase * tc_FileWriteAtomic = tcase_create("FileWriteAtomic");
+   tcase_add_test(tc_FileWriteAtomic, test_FileWriteAtomic);
+   tcase_set_timeout(tc_FileWriteAtomic, 3);
+
+   TCase * tc_FileVerifyLedger = tcase_create("FileVerifyLedger");
+   tcase_add_test(tc_FileVerifyLedger, test_FileVerifyLedger);
+   tcase_set_timeout(tc_FileVerifyLedger, 3);
+
+   TCase * tc_FileCreateFolders = tcase_create("FileCreateFolders");
+   tcase_add_test(tc_FileCreateFolders, test_FileCreateFolders);
+   tcase_set_timeout(tc_FileCreateFolders, 3);
+
+   TCase * tc_FileShutdownFlush = tcase_create("FileShutdownFlush");
+   tcase_add_test(tc_FileShutdownFlush, test_FileShutdownFlush);
+   tcase_set_timeout(tc_FileShutdownFlush, 3);
+
+   TCase * tc_FileShutdownDeadline = tcase_create("FileShutdownDeadline");
+   tcase_add_test(tc_FileShutdownDeadline, test_FileShutdownDeadline);
+   tcase_set_timeout(tc_FileShutdownDeadline, 10);
+
+   TCase * tc_InitAsync = tcase_create("InitAsync");
+   tcase_add_test(tc_InitAsync, test_InitAsync);
+   tcase_set_timeout(tc_InitAsync, 5);
+
+   TCase * tc_RctPreload = tcase_create("RctPreload");
+   tcase_add_test(tc_RctPreload, test_RctPreload);
+   tcase_set_timeout(tc_RctPreload, 3);
+
+   TCase * tc_RctReload = tcase_create("RctReload");
+   tcase_add_test(tc_RctReload, test_RctReload);
+   tcase_set_timeout(tc_RctReload, 3);
+
 #if 1
 
    suite_add_tcase(s, tc_persDataFile);
@@ -1554,6 +2692,54 @@ static Suite * persistencyClientLib_suite()
    suite_add_tcase(s, tc_FileBackupAndRecovery);
    tcase_add_checked_fixture(tc_FileBackupAndRecovery, data_setupBandR, data_teardownBandR);
 
+   suite_add_tcase(s, tc_FileJournalRecovery);
+   tcase_add_checked_fixture(tc_FileJournalRecovery, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FileJournalWriteFail);
+   tcase_add_checked_fixture(tc_FileJournalWriteFail, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_ConfigCache);
+   tcase_add_checked_fixture(tc_ConfigCache, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_BlacklistExactMatch);
+   tcase_add_checked_fixture(tc_BlacklistExactMatch, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FileSyncPolicy);
+   tcase_add_checked_fixture(tc_FileSyncPolicy, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FilePositionalIO);
+   tcase_add_checked_fixture(tc_FilePositionalIO, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FileAsync);
+   tcase_add_checked_fixture(tc_FileAsync, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FileMapHinted);
+   tcase_add_checked_fixture(tc_FileMapHinted, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FileWriteAtomic);
+   tcase_add_checked_fixture(tc_FileWriteAtomic, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FileVerifyLedger);
+   tcase_add_checked_fixture(tc_FileVerifyLedger, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FileCreateFolders);
+   tcase_add_checked_fixture(tc_FileCreateFolders, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FileShutdownFlush);
+   tcase_add_checked_fixture(tc_FileShutdownFlush, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_FileShutdownDeadline);
+   tcase_add_checked_fixture(tc_FileShutdownDeadline, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_InitAsync);
+   tcase_add_checked_fixture(tc_InitAsync, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_RctPreload);
+   tcase_add_checked_fixture(tc_RctPreload, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_RctReload);
+   tcase_add_checked_fixture(tc_RctReload, data_setup, data_teardown);
+
 
     suite_add_tcase(s, tc_InitDeinit);    // I M P O R T A N T: this needs to be the last test, as this tests ends NSM
 
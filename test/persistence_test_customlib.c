@@ -295,6 +295,33 @@ int plugin_handle_get_size(int handle)
    return rval;
 }
 
+int plugin_get_data_batch(plugin_batch_item_s* items, int numItems)
+{
+   int i = 0;
+
+   //printf("* * * * * plugin_get_data_batch: %d | %s!\n", numItems, LIBIDENT);
+   for(i=0; i<numItems; i++)
+   {
+      items[i].result = snprintf(items[i].buffer, (size_t)items[i].size, "Custom plugin -> plugin_get_data_batch: %s!", LIBIDENT);
+   }
+
+   return numItems;
+}
+
+
+int plugin_set_data_batch(plugin_batch_item_s* items, int numItems)
+{
+   int i = 0;
+
+   //printf("* * * * * plugin_set_data_batch: %d | %s!\n", numItems, LIBIDENT);
+   for(i=0; i<numItems; i++)
+   {
+      items[i].result = 654321;
+   }
+
+   return numItems;
+}
+
 // OK
 int plugin_get_size(const char* path)
 {